@@ -4,6 +4,7 @@
 #include "animationSystem.h"
 #include "core/camera.h"
 #include "fmt/base.h"
+#include "fmt/ostream.h"
 #include "glm/fwd.hpp"
 #include "types.h"
 #include <glm/gtc/matrix_transform.hpp>
@@ -11,18 +12,20 @@
 #include "core/road.h"
 #include "entityMovement.h"
 #include "utils/worldNodeMapper.h"
+#include "worldGenerator.h"
 
 
+#include <chrono>
 #include <fstream>
-#include <iostream>
 
 #include "events/eventBus.h"
+#include "utils/log.h"
 #include "window.h"
 
 
 namespace df {
 	static void glfwErrorCallback(int error, const char* description) {
-		fmt::println(stderr, "[GLFW Error {}]: {}", error, description);
+		DF_LOG_ERROR(APPLICATION, "[GLFW Error {}]: {}", error, description);
 	}
 
 	::std::optional<Application> Application::init(const CommandLineOptions& options) noexcept {
@@ -30,14 +33,15 @@ namespace df {
 			return ::std::nullopt;
 
 		Application self;
-		fmt::println("\"{}\" version {}.{}", PROJECT_NAME, VERSION_MAJOR, VERSION_MINOR);
+		self.benchmarkMapScaling = options.hasBenchmarkMapScaling();
+		DF_LOG_INFO(APPLICATION, "\"{}\" version {}.{}", PROJECT_NAME, VERSION_MAJOR, VERSION_MINOR);
 
 		if (options.hasX11())
 			glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_X11);
 
 		glfwSetErrorCallback(glfwErrorCallback);
 		if (!glfwInit()) {
-			fmt::println(stderr, "Failed to initialize GLFW");
+			DF_LOG_ERROR(APPLICATION, "Failed to initialize GLFW");
 			return ::std::nullopt;
 		}
 
@@ -51,18 +55,19 @@ namespace df {
 		self.window->makeContextCurrent();
 
 		if (gl3wInit()) {
-			fmt::println(stderr, "Failed to initialize OpenGL context");
+			DF_LOG_ERROR(APPLICATION, "Failed to initialize OpenGL context");
 			self.window->deinit();
 			glfwTerminate();
 			return ::std::nullopt;
 		}
-		fmt::println("Loaded OpenGL {} & GLSL {}", (char*)glGetString(GL_VERSION), (char*)glGetString(GL_SHADING_LANGUAGE_VERSION));
+		DF_LOG_INFO(APPLICATION, "Loaded OpenGL {} & GLSL {}", (char*)glGetString(GL_VERSION), (char*)glGetString(GL_SHADING_LANGUAGE_VERSION));
 
 		self.eventBus = std::make_shared<EventBus>();
 		self.audioEngine = std::make_unique<AudioSystem>(self.eventBus);
 		self.registry = Registry::init();
 		self.gameState = std::make_shared<GameState>(self.registry);
 		self.gameController = std::make_shared<GameController>(*self.gameState);
+		self.autosave = std::make_unique<Autosave>(std::filesystem::path(getBasePath()) / "autosave.dfsave", Autosave::Mode::JOURNAL);
 		self.world = WorldSystem::init(self.window.get(), self.registry, self.audioEngine.get(), *self.gameState);
 		// self.physics = PhysicsSystem::init(self.registry, self.audioEngine);
 		self.render = RenderSystem::init(self.window.get(), self.registry, self.gameState);
@@ -71,7 +76,7 @@ namespace df {
 		// for testing hero movement until we have a triggerpoint
 		self.movementSystem = EntityMovementSystem::init(self.registry, *self.gameState);
 		// building preview system
-		self.buildingPreviewSystem = BuildingPreviewSystem::init(self.window.get(), self.registry, *self.gameState);
+		self.buildingPreviewSystem = BuildingPreviewSystem::init(self.window.get(), self.registry, *self.gameState, *self.gameController);
 		// Create config menu
 		self.configMenu.init(self.window.get(), self.registry);
 
@@ -79,6 +84,7 @@ namespace df {
 	}
 
 	void Application::deinit() noexcept {
+		autosave.reset(); // finishes the last save
 		audioEngine.reset();
 		render.deinit();
 		delete registry;
@@ -99,7 +105,7 @@ namespace df {
 		// Store RenderTextSystem in registry to use it in any other System.
 		registry->addSystem<RenderTextSystem>(&render.getRenderTextSystem());
 		if (!this->window || !this->window->getHandle()) {
-			std::cerr << "Invalid window or GLFWwindow handle!" << std::endl;
+			DF_LOG_ERROR(APPLICATION, "Invalid window or GLFWwindow handle!");
 			return;
 		}
 
@@ -146,6 +152,10 @@ namespace df {
 		glfwGetFramebufferSize(window->getHandle(), &fbWidth, &fbHeight);
 		onResizeCallback(window->getHandle(), fbWidth, fbHeight);
 
+		if (this->benchmarkMapScaling) {
+			this->runMapScalingBenchmark();
+			return;
+		}
 
 
 		while (!window->shouldClose()) {
@@ -160,7 +170,7 @@ namespace df {
 			// Start turn when first entering PLAY phase -> future TODO: adjust for multiple players + ending game + reentering
 			if (gamePhase == types::GamePhase::PLAY && previousGamePhase != types::GamePhase::PLAY) {
 				gameController->startTurn();
-				fmt::println("Turn started for player {}", gameState->getCurrentPlayerId());
+				DF_LOG_INFO(GAME, "Turn started for player {}", gameState->getCurrentPlayerId());
 			}
 
 			switch (gamePhase) {
@@ -178,7 +188,7 @@ namespace df {
 				// physics.handleCollisions(delta_time);
 
 				if (gameState->isGameOver()) {
-					fmt::println("Victory! You survived {} rounds.", gameState->getRoundNumber());
+					DF_LOG_INFO(GAME, "Victory! You survived {} rounds.", gameState->getRoundNumber());
 					this->reset();
 					gameState->setPhase(types::GamePhase::START);
 					break;
@@ -205,10 +215,10 @@ namespace df {
 
 						auto tileId = render.renderTilesSystem.getTileIdAtPosition(mouseCoords.x, extent.y - mouseCoords.y);
 						auto mapId = render.renderTilesSystem.tileIdToMapId(tileId);
-						// fmt::println("Picked: TileId {} / MapId {} at mouse ({}, {})", tileId, mapId, mouseCoords.x, mouseCoords.y);
+						// DF_LOG_DEBUG(APPLICATION, "Picked: TileId {} / MapId {} at mouse ({}, {})", tileId, mapId, mouseCoords.x, mouseCoords.y);
 
 						glm::vec2 tilePosition = movementSystem.getTileWorldPosition(mapId);
-						// fmt::println("Tile Position: ({},{})", tilePosition.x, tilePosition.y);
+						// DF_LOG_DEBUG(APPLICATION, "Tile Position: ({},{})", tilePosition.x, tilePosition.y);
 
 						Entity hero = registry->animations.entities.front();
 						glm::vec2 targetPos = tilePosition;
@@ -216,7 +226,7 @@ namespace df {
 
 						movementSystem.moveEntityTo(hero, targetPos, delta_time);
 					} else {
-						fmt::println("No hero entity available!");
+						DF_LOG_DEBUG(APPLICATION, "No hero entity available!");
 					}
 				}
 				// ------------------------------------------------------------
@@ -228,8 +238,84 @@ namespace df {
 			// Update previous phase for next iteration -> future TODO: adjust for multiple players + ending game + reentering
 			previousGamePhase = gamePhase;
 
+			// events the frame posted (sounds, ...), after the game logic and before the next frame starts
+			this->eventBus->dispatchQueued();
+			this->eventBus->endFrame();
+			this->registry->nextFrame();
+
+			window->swapBuffers();
+		}
+	}
+
+	// Measures how map generation, graph population and the first rendered frame scale with the map size.
+	// Started with --benchmark-map-scaling; uses the world generation config from the json (with a fixed seed).
+	void Application::runMapScalingBenchmark() noexcept {
+		using Clock = std::chrono::steady_clock;
+		auto millisecondsBetween = [](const Clock::time_point start, const Clock::time_point end) {
+			return std::chrono::duration<double, std::milli>(end - start).count();
+		};
+
+		WorldGeneratorConfig config;
+		if (const auto worldGenConfResult = WorldGeneratorConfig::deserialize(); worldGenConfResult.isOk()) {
+			config = worldGenConfResult.unwrap<>();
+		}
+		if (config.seed == 0) {
+			config.seed = 1;
+		}
+
+		// generate + populate is what Graph::regenerate() costs
+		constexpr double TARGET_MILLISECONDS = 1000.0;
+		unsigned largestSize = 0;
+		double largestGenerate = 0.0;
+		double largestRegenerate = 0.0;
+
+		fmt::println("{:>10} {:>10} {:>14} {:>14} {:>16} {:>16}", "size", "tiles", "generate [ms]", "populate [ms]", "regenerate [ms]", "first frame [ms]");
+		for (const unsigned size : { 100u, 250u, 500u, 1000u }) {
+			config.columns = size;
+			config.rows = size;
+
+			const auto generateStart = Clock::now();
+			auto generatedTiles = WorldGenerator::generateTiles(config);
+			if (generatedTiles.isErr()) {
+				DF_LOG_ERROR(WORLD, "{}", fmt::streamed(generatedTiles.unwrapErr()));
+				continue;
+			}
+
+			const auto populateStart = Clock::now();
+			gameState->getMap().rebuild(std::move(generatedTiles.storage().template get<std::vector<Tile>>()), size);
+
+			const auto frameStart = Clock::now();
+			if (const auto result = render.renderTilesSystem.updateMap(); result.isErr()) {
+				DF_LOG_ERROR(RENDER, "{}", fmt::streamed(result.unwrapErr()));
+				continue;
+			}
+			render.renderHeroSystem.updateDimensionsFromMap();
+			glClear(GL_COLOR_BUFFER_BIT);
+			render.step(0.0f);
+			glFinish();
+			const auto frameEnd = Clock::now();
 			window->swapBuffers();
+
+			largestSize = size;
+			largestGenerate = millisecondsBetween(generateStart, populateStart);
+			largestRegenerate = millisecondsBetween(generateStart, frameStart);
+			fmt::println("{:>10} {:>10} {:>14.1f} {:>14.1f} {:>16.1f} {:>16.1f}",
+				fmt::format("{0}x{0}", size),
+				gameState->getMap().getTileCount(),
+				largestGenerate,
+				millisecondsBetween(populateStart, frameStart),
+				largestRegenerate,
+				millisecondsBetween(frameStart, frameEnd));
 		}
+
+		// the largest map against the one second target, the tile generation alone and the whole regenerate
+		if (largestSize == 0) {
+			return;
+		}
+		fmt::println("{0}x{0}: generate {1:.0f} ms ({2} the {3:.0f} ms target), regenerate {4:.0f} ms ({5} the target)",
+			largestSize,
+			largestGenerate, (largestGenerate <= TARGET_MILLISECONDS) ? "within" : "over", TARGET_MILLISECONDS,
+			largestRegenerate, (largestRegenerate <= TARGET_MILLISECONDS) ? "within" : "over");
 	}
 
 	void Application::toggleMovement() noexcept {
@@ -259,6 +345,7 @@ namespace df {
 
 		gameState->setRoundNumber(0);
 		gameState->setCurrentPlayerId(0);
+		gameController->clearHistory();
 
 		registry->animations.emplace(playerEntity);
 
@@ -281,7 +368,7 @@ namespace df {
 		// read config from json file
 		WorldGeneratorConfig config;
 		if (const auto worldGenConfResult = WorldGeneratorConfig::deserialize(); worldGenConfResult.isErr()) {
-			std::cerr << worldGenConfResult.unwrapErr() << std::endl;
+			DF_LOG_ERROR(WORLD, "{}", fmt::streamed(worldGenConfResult.unwrapErr()));
 		} else {
 			config = worldGenConfResult.unwrap<>();
 		}
@@ -319,7 +406,7 @@ namespace df {
 			heightName = "kept as " + std::to_string(config.rows);
 		}
 
-		fmt::println("set worldGen parameters to seed: {}, width: {}, height: {}, mode: {}", seedName, widthName, heightName, modeName);
+		DF_LOG_INFO(WORLD, "set worldGen parameters to seed: {}, width: {}, height: {}, mode: {}", seedName, widthName, heightName, modeName);
 
 
 		// write config to json
@@ -328,39 +415,34 @@ namespace df {
 		{ // open the stream in an extra block, so the stream gets closed before deserialize tries to open the json
 			std::ofstream file(path);
 			if (!file) {
-				std::cerr << "Could not open config file: " << path << '\n';
+				DF_LOG_ERROR(WORLD, "Could not open config file: {}", path);
 				return;
 			}
 			file << config.serialize().dump(4);
 		}
-		fmt::println("[DEBUG] config written to file: {}", path.c_str());
+		DF_LOG_DEBUG(APPLICATION, "config written to file: {}", path);
 
 		// generate map with the WorldGeneratorConfig
 		if (const auto worldGenConfResult = WorldGeneratorConfig::deserialize(); worldGenConfResult.isErr()) {
-			fmt::println("[DEBUG] config deserialized");
-			std::cerr << worldGenConfResult.unwrapErr() << std::endl;
-			fmt::println("[DEBUG] start regenerating...");
+			DF_LOG_ERROR(WORLD, "{}", fmt::streamed(worldGenConfResult.unwrapErr()));
+			DF_LOG_DEBUG(APPLICATION, "start regenerating with the default config...");
 			gameState->getMap().regenerate();
 		} else {
 			gameState->getMap().regenerate(worldGenConfResult.unwrap<>());
 		}
-		fmt::println("[DEBUG] regenerated world");
+		DF_LOG_DEBUG(APPLICATION, "regenerated world");
 		{
 			// only supports one player for now. TODO: if we do multplayer update this.
 			if (gameState->getPlayer(0)) {
 				Player* player = gameState->getPlayer(0);
 				player->reset();
-				player->addResources(types::TileType::FOREST, 100);	  // give player 100 wood
-				player->addResources(types::TileType::MOUNTAIN, 100); // give player 100 stone
-				player->addResources(types::TileType::FIELD, 50);	  // give player 50 grain
+				player->addResources(GameController::STARTING_RESOURCES);
 			} else {
 				Player player{};
-				player.addResources(types::TileType::FOREST, 100);	 // give player 100 wood
-				player.addResources(types::TileType::MOUNTAIN, 100); // give player 100 stone
-				player.addResources(types::TileType::FIELD, 50);	 // give player 50 grain
+				player.addResources(GameController::STARTING_RESOURCES);
 				gameState->addPlayer(player);
 			}
-			fmt::println("[DEBUG] resources distributed to player");
+			DF_LOG_DEBUG(APPLICATION, "resources distributed to player");
 			const int width = gameState->getMap().getMapWidth();
 			const int height = gameState->getMap().getTileCount() / width;
 
@@ -374,16 +456,16 @@ namespace df {
 					}
 				}
 			}
-			fmt::println("[DEBUG] randomly explored tiles for player");
+			DF_LOG_DEBUG(APPLICATION, "randomly explored tiles for player");
 		}
 		if (const auto result = render.renderTilesSystem.updateMap(); result.isErr()) {
-			std::cerr << result.unwrapErr() << std::endl;
+			DF_LOG_ERROR(RENDER, "{}", fmt::streamed(result.unwrapErr()));
 		}
 		render.renderHeroSystem.updateDimensionsFromMap();
 
 		gameState->initTutorial(); // Init the Tutorial
 		gameState->setPhase(types::GamePhase::PLAY);
-		fmt::println("[DEBUG] Application::startGame completed");
+		DF_LOG_DEBUG(APPLICATION, "Application::startGame completed");
 	}
 
 	void Application::onKeyCallback(GLFWwindow* windowParam, int key, int scancode, int action, int mods) noexcept {
@@ -397,6 +479,12 @@ namespace df {
 			configMenu.onKeyCallback(windowParam, key, scancode, action, mods);
 			break;
 		case types::GamePhase::PLAY:
+			// Ctrl+Z / Ctrl+Y: undo / redo the last build of the current turn
+			if (action == GLFW_PRESS && (mods & GLFW_MOD_CONTROL) && (key == GLFW_KEY_Z || key == GLFW_KEY_Y)) {
+				const bool changed = key == GLFW_KEY_Z ? gameController->undo() : gameController->redo();
+				DF_LOG_INFO(GAME, "{} {}", key == GLFW_KEY_Z ? "Undo" : "Redo", changed ? "done" : "not possible");
+				break;
+			}
 			world.onKeyCallback(windowParam, key, scancode, action, mods);
 			render.onKeyCallback(windowParam, key, scancode, action, mods);
 			// Update Tutorial if step == moveCamera
@@ -446,6 +534,11 @@ namespace df {
 			if (!movementSystem.getMovementState()) {
 				if (render.renderHudSystem.wasEndTurnClicked(mouse, button, action)) {
 					gameController->endTurn();
+					try {
+						autosave->request(*gameState); // only the snapshot, the file is written in the background
+					} catch (const std::exception& e) {
+						DF_LOG_ERROR(SAVE, "Autosave failed: {}", e.what());
+					}
 					movementSystem.toggleMovementState();
 					gameController->startTurn(); // Start turn for the next player
 					return;
@@ -459,11 +552,11 @@ namespace df {
 			// Handle building placement -> ONLY possible when preview is active
 			if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS) {
 				if (this->world.isSettlementPreviewActive || this->world.isRoadPreviewActive) {
-					fmt::println("Building placement started...");
+					DF_LOG_DEBUG(GAME, "Building placement started...");
 
 					Entity previewEntity = buildingPreviewSystem.getPreviewEntity();
 					if (!registry->positions.has(previewEntity)) {
-						fmt::println("No preview entity found");
+						DF_LOG_DEBUG(GAME, "No preview entity found");
 						return;
 					}
 					const glm::vec2& cameraRelativePos = registry->positions.get(previewEntity);
@@ -476,78 +569,57 @@ namespace df {
 
 					size_t currentPlayerId = this->gameState->getCurrentPlayerId();
 
-					// TODO: This is just temporary...
-					// Settlement: 1 WOOD, 1 CLAY, 1 GRASS
-					const std::vector<int> settlementCost = {
-						0, // EMPTY
-						0, // WATER
-						1, // FOREST (wood)
-						1, // GRASS
-						0, // MOUNTAIN
-						0, // FIELD
-						1, // CLAY
-						0  // ICE
-					};
-					// Road: 1 WOOD
-					const std::vector<int> roadCost = {
-						0, // EMPTY
-						0, // WATER
-						1, // FOREST (wood)
-						0, // GRASS
-						0, // MOUNTAIN
-						0, // FIELD
-						0, // CLAY
-						0  // ICE
-					};
+					const ResourceBundle& settlementCost = GameController::SETTLEMENT_COST;
+					const ResourceBundle& roadCost = GameController::ROAD_COST;
 
 					if (this->world.isSettlementPreviewActive) {
-						fmt::println("Checking if player can build settlement at world position {},{}", worldPos.x, worldPos.y);
+						DF_LOG_DEBUG(GAME, "Checking if player can build settlement at world position {},{}", worldPos.x, worldPos.y);
 						// Find closest vertex for settlement placement
 						auto vertexIdOpt = WorldNodeMapper::findClosestVertexToWorldPos(worldPos, map);
 						if (vertexIdOpt.has_value()) {
-							fmt::println("Closest vertex found at {}", vertexIdOpt.value());
+							DF_LOG_DEBUG(GAME, "Closest vertex found at {}", vertexIdOpt.value());
 							size_t vertexId = vertexIdOpt.value();
 							if (gameController->canBuildSettlement(currentPlayerId, vertexId)) { // validate player can build settlement
-								fmt::println("Player can build settlement at vertex {}", vertexId);
+								DF_LOG_DEBUG(GAME, "Player can build settlement at vertex {}", vertexId);
 								bool success = gameController->buildSettlement(currentPlayerId, vertexId, settlementCost);
 
 								if (success) {
-									fmt::println("Settlement built at vertex {}", vertexId);
+									DF_LOG_INFO(GAME, "Settlement built at vertex {}", vertexId);
 									this->world.isSettlementPreviewActive = false;
 								} else {
-									fmt::println("Failed to build settlement at vertex {}", vertexId);
+									DF_LOG_INFO(GAME, "Failed to build settlement at vertex {}", vertexId);
 								}
 
 							} else {
-								fmt::println("Cannot build settlement at vertex {}: insufficient resources or invalid placement", vertexId);
+								DF_LOG_INFO(GAME, "Cannot build settlement at vertex {}: insufficient resources or invalid placement", vertexId);
 							}
 						} else
-							fmt::println("No closest vertex found");
+							DF_LOG_DEBUG(GAME, "No closest vertex found");
 
 					} else if (this->world.isRoadPreviewActive) {
-						fmt::println("Checking if player can build road at world position {},{}", worldPos.x, worldPos.y);
+						DF_LOG_DEBUG(GAME, "Checking if player can build road at world position {},{}", worldPos.x, worldPos.y);
 						// Find closest edge for road placement
 						auto edgeIdOpt = WorldNodeMapper::findClosestEdgeToWorldPos(worldPos, map);
 						if (edgeIdOpt.has_value()) {
-							fmt::println("Closest edge found at {}", edgeIdOpt.value());
+							DF_LOG_DEBUG(GAME, "Closest edge found at {}", edgeIdOpt.value());
 							size_t edgeId = edgeIdOpt.value();
 
 							if (gameController->canBuildRoad(currentPlayerId, edgeId)) { // validate player can build road
-								fmt::println("Player can build road at edge {}", edgeId);
+								DF_LOG_DEBUG(GAME, "Player can build road at edge {}", edgeId);
 								bool success = gameController->buildRoad(currentPlayerId, edgeId, RoadLevel::Path, roadCost);
 								if (success) {
-									fmt::println("Road built at edge {}", edgeId);
+									DF_LOG_INFO(GAME, "Road built at edge {}", edgeId);
 									this->world.isRoadPreviewActive = false;
 								} else {
-									fmt::println("Failed to build road at edge {}", edgeId);
+									DF_LOG_INFO(GAME, "Failed to build road at edge {}", edgeId);
 								}
 
 							} else {
-								fmt::println("Cannot build road at edge {}: insufficient resources or invalid placement", edgeId);
+								DF_LOG_INFO(GAME, "Cannot build road at edge {}: insufficient resources or invalid placement", edgeId);
 							}
 
 						} else
-							fmt::println("No closest edge found");
+							DF_LOG_DEBUG(GAME, "No closest edge found");
 					}
 
 					return; // ignore other mouse callbacks when placing buildings...
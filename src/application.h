@@ -1,5 +1,6 @@
 #pragma once
 
+#include "core/autosave.h"
 #include "core/configMenu.h"
 #include "core/gamecontroller.h"
 #include "core/gamestate.h"
@@ -59,6 +60,7 @@ namespace df {
 		void setInsular() noexcept;
 		void setPerlin() noexcept;
 		void generateMap(WorldGeneratorConfig config) noexcept;
+		void runMapScalingBenchmark() noexcept;
 
 		void onKeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) noexcept;
 		void onMouseButtonCallback(GLFWwindow* window, int button, int action, int mods) noexcept;
@@ -67,11 +69,14 @@ namespace df {
 
 
 		bool test = false;
+		bool benchmarkMapScaling = false;
 
 		// GameState
 		std::shared_ptr<GameState> gameState;
 		// GameController
 		std::shared_ptr<GameController> gameController;
+		// saves at the end of every turn, in the background
+		std::unique_ptr<Autosave> autosave;
 		// MainMenu
 		MainMenu mainMenu;
 		// ConfigMenu
@@ -0,0 +1,110 @@
+#include "autosave.h"
+
+#include <chrono>
+#include <exception>
+#include <utility>
+
+#include "gamestate.h"
+#include "log.h"
+
+
+
+
+
+namespace df {
+
+    Autosave::Autosave(std::filesystem::path filepath, Mode mode)
+        : filepath(std::move(filepath)),
+          journal(mode == Mode::JOURNAL ? std::optional<SaveJournal>(std::in_place, this->filepath) : std::nullopt),
+          worker(&Autosave::run, this) {}
+
+
+    Autosave::~Autosave() {
+        {
+            std::lock_guard lock(this->mutex);
+            this->stopping = true;
+        }
+        this->wakeWorker.notify_one();
+        this->worker.join();
+    }
+
+
+    void Autosave::request(const GameState& state) {
+        const auto start = std::chrono::steady_clock::now();
+        SaveSnapshot snapshot = state.snapshot();
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        {
+            std::lock_guard lock(this->mutex);
+            if (this->pending) {
+                this->stats.replaced++;
+            }
+            this->pending = std::move(snapshot);
+            this->stats.requested++;
+            this->stats.lastSnapshotSeconds = seconds;
+        }
+        this->wakeWorker.notify_one();
+    }
+
+
+    void Autosave::flush() {
+        std::unique_lock lock(this->mutex);
+        this->idle.wait(lock, [this] { return !this->pending && !this->writing; });
+    }
+
+
+    Autosave::Stats Autosave::getStats() const {
+        std::lock_guard lock(this->mutex);
+        return this->stats;
+    }
+
+
+    void Autosave::run() {
+        std::unique_lock lock(this->mutex);
+        while (true) {
+            this->wakeWorker.wait(lock, [this] { return this->pending || this->stopping; });
+            if (!this->pending) {
+                return; // stopping and nothing left to write
+            }
+
+            const SaveSnapshot snapshot = std::move(*this->pending);
+            this->pending.reset();
+            this->writing = true;
+            lock.unlock();
+
+            // the snapshot owns all its data -> no lock while writing, the game can request the next one
+            const auto start = std::chrono::steady_clock::now();
+            std::string error;
+            size_t bytes = 0;
+            try {
+                if (this->journal) {
+                    this->journal->append(snapshot);
+                    bytes = this->journal->getStats().lastAppendBytes;
+                } else {
+                    const std::vector<std::uint8_t> file = snapshot.encodeFile();
+                    replaceFile(this->filepath, file);
+                    bytes = file.size();
+                }
+            } catch (const std::exception& e) {
+                error = e.what();
+                DF_LOG_ERROR(SAVE, "Autosave failed: {}", error);
+            }
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            lock.lock();
+            this->writing = false;
+            this->stats.lastWriteSeconds = seconds;
+            this->stats.lastWriteBytes = bytes;
+            if (error.empty()) {
+                this->stats.written++;
+            } else {
+                this->stats.failed++;
+                this->stats.lastError = std::move(error);
+            }
+            if (!this->pending) {
+                this->idle.notify_all();
+            }
+        }
+    }
+
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "saveJournal.h"
+#include "saveSnapshot.h"
+
+
+
+
+
+namespace df {
+
+    class GameState;
+
+
+    /*
+     * Saves the game in the background. request() only takes a GameState::snapshot() on the calling thread
+     * (the game loop pauses for well under a millisecond, independent of the map size). A worker thread
+     * serializes, compresses and writes it through SaveSnapshot::writeFile(), so a crash never leaves a
+     * half-written save behind.
+     * Only the latest state matters: a snapshot that is still waiting when the next one comes in is replaced.
+     * In JOURNAL mode the worker appends to a SaveJournal instead, so a turn writes only what changed.
+     */
+    class Autosave {
+    public:
+        enum class Mode {
+            FULL, // the complete save every time
+            JOURNAL,
+        };
+
+        struct Stats {
+            size_t requested = 0;
+            size_t written = 0;
+            size_t replaced = 0; // dropped in favour of a newer snapshot before they were written
+            size_t failed = 0;
+            double lastSnapshotSeconds = 0.0; // pause of the caller in request()
+            double lastWriteSeconds = 0.0; // serialize + compress + write on the worker
+            size_t lastWriteBytes = 0;
+            std::string lastError;
+        };
+
+        explicit Autosave(std::filesystem::path filepath, Mode mode = Mode::FULL);
+        // writes the snapshot that is still waiting, then stops the worker
+        ~Autosave();
+
+        Autosave(const Autosave&) = delete;
+        Autosave& operator=(const Autosave&) = delete;
+
+        void request(const GameState& state);
+        // blocks until every requested snapshot is written (or failed)
+        void flush();
+
+        const std::filesystem::path& getPath() const { return this->filepath; }
+        Stats getStats() const;
+
+    private:
+        std::filesystem::path filepath;
+        std::optional<SaveJournal> journal; // only used by the worker
+
+        mutable std::mutex mutex;
+        std::condition_variable wakeWorker;
+        std::condition_variable idle;
+        std::optional<SaveSnapshot> pending;
+        bool writing = false;
+        bool stopping = false;
+        Stats stats;
+
+        std::thread worker; // last member, starts after everything above is initialized
+
+        void run();
+    };
+
+}
@@ -0,0 +1,200 @@
+#include "compactGameState.h"
+
+#include <algorithm>
+
+#include "gamecontroller.h"
+#include "gamestate.h"
+#include "graph.h"
+
+
+
+
+
+namespace df {
+
+    namespace {
+        std::uint32_t toIndex(size_t index) {
+            return index == SIZE_MAX ? CompactBoard::NONE : static_cast<std::uint32_t>(index);
+        }
+    }
+
+
+    CompactBoard CompactBoard::fromGraph(const Graph& map) {
+        CompactBoard board;
+        const auto& vertices = map.getVertices();
+        constexpr std::array<std::uint32_t, 3> noNodes = { NONE, NONE, NONE };
+        board.vertexNeighbours.assign(vertices.size(), noNodes);
+        board.vertexEdges.assign(vertices.size(), noNodes);
+        board.vertexTiles.assign(vertices.size(), noNodes);
+        board.vertexYields.resize(vertices.size());
+
+        for (size_t vertexIndex = 0; vertexIndex < vertices.size(); ++vertexIndex) {
+            const VertexHandle vertex = vertices[vertexIndex];
+            board.vertexYields[vertexIndex] = map.getExpectedYield(vertex);
+
+            if (const auto edges = map.getVertexEdges(vertex)) {
+                for (size_t i = 0; i < edges->size(); ++i) {
+                    const EdgeHandle edge = (*edges)[i];
+                    if (!edge) continue;
+                    board.vertexEdges[vertexIndex][i] = toIndex(map.indexOfEdge(edge->getId()));
+
+                    const auto edgeVertices = map.getEdgeVertices(edge);
+                    if (!edgeVertices) continue;
+                    for (const VertexHandle neighbour : *edgeVertices) {
+                        if (neighbour && neighbour != vertex) {
+                            board.vertexNeighbours[vertexIndex][i] = toIndex(map.indexOfVertex(neighbour->getId()));
+                        }
+                    }
+                }
+            }
+
+            if (const auto tiles = map.getVertexTiles(vertex)) {
+                for (size_t i = 0; i < tiles->size(); ++i) {
+                    if ((*tiles)[i]) board.vertexTiles[vertexIndex][i] = toIndex(map.indexOfTile((*tiles)[i]->getId()));
+                }
+            }
+        }
+
+        const auto& tiles = map.getTiles();
+        board.tileThresholds.resize(tiles.size());
+        board.tileTypes.resize(tiles.size());
+        for (size_t tileIndex = 0; tileIndex < tiles.size(); ++tileIndex) {
+            const double threshold = static_cast<double>(tiles[tileIndex]->getExpectedYield()) * 4294967296.0;
+            board.tileThresholds[tileIndex] = static_cast<std::uint32_t>(std::min(threshold, 4294967295.0));
+            board.tileTypes[tileIndex] = tiles[tileIndex]->getType();
+        }
+
+        board.edgeCount = map.getEdgeCount();
+        return board;
+    }
+
+
+    CompactGameState CompactGameState::fromGameState(const GameState& state, const CompactBoard& board) {
+        CompactGameState compact;
+        if (state.getPlayerCount() > MAX_PLAYERS) {
+            return compact;
+        }
+
+        Header& header = compact.header;
+        header.playerCount = static_cast<std::uint32_t>(state.getPlayerCount());
+        header.currentPlayerId = static_cast<std::uint32_t>(state.getCurrentPlayerId());
+        header.roundNumber = static_cast<std::uint32_t>(state.getRoundNumber());
+        header.vertexCount = static_cast<std::uint32_t>(board.getVertexCount());
+        header.edgeCount = static_cast<std::uint32_t>(board.getEdgeCount());
+        header.tileCount = static_cast<std::uint32_t>(board.getTileCount());
+        header.latestSettlements.fill(CompactBoard::NONE);
+        compact.arena.assign(compact.settledTilesOffset() + header.tileCount, 0);
+
+        const Graph& map = state.getMap();
+        for (size_t playerId = 0; playerId < header.playerCount; ++playerId) {
+            if (const Player* player = state.getPlayer(playerId)) header.resources[playerId] = player->getResources();
+            for (const size_t settlementId : state.getPlayerSettlementIds(playerId)) {
+                const Settlement* settlement = state.findSettlement(settlementId);
+                const size_t vertexIndex = settlement ? map.indexOfVertex(settlement->getVertexId()) : SIZE_MAX;
+                if (vertexIndex != SIZE_MAX) {
+                    compact.placeSettlement(board, playerId, static_cast<std::uint32_t>(vertexIndex));
+                }
+            }
+            for (const size_t roadId : state.getPlayerRoadIds(playerId)) {
+                const Road* road = state.findRoad(roadId);
+                const size_t edgeIndex = road ? map.indexOfEdge(road->getEdgeId()) : SIZE_MAX;
+                if (edgeIndex != SIZE_MAX) {
+                    compact.buildRoad(playerId, static_cast<std::uint32_t>(edgeIndex));
+                }
+            }
+        }
+        return compact;
+    }
+
+
+    void CompactGameState::copyFrom(const CompactGameState& other) {
+        this->header = other.header;
+        this->arena = other.arena; // same size -> copy into the existing buffer
+    }
+
+
+    bool CompactGameState::isSettlementAllowed(std::uint32_t vertex) const {
+        return vertex < this->header.vertexCount && this->bytes()[vertex] == 0 && this->bytes()[this->blockedOffset() + vertex] == 0;
+    }
+
+
+    void CompactGameState::buildSettlement(const CompactBoard& board, size_t playerId, std::uint32_t vertex) {
+        this->header.resources[playerId] -= GameController::SETTLEMENT_COST;
+        this->placeSettlement(board, playerId, vertex);
+    }
+
+
+    void CompactGameState::placeSettlement(const CompactBoard& board, size_t playerId, std::uint32_t vertex) {
+        std::uint8_t* bytes = this->bytes();
+        bytes[vertex] = static_cast<std::uint8_t>(playerId + 1);
+        for (const std::uint32_t neighbour : board.vertexNeighbours[vertex]) {
+            if (neighbour != CompactBoard::NONE) bytes[this->blockedOffset() + neighbour]++;
+        }
+
+        std::uint32_t* settledTiles = this->arena.data() + this->settledTilesOffset();
+        for (const std::uint32_t tile : board.vertexTiles[vertex]) {
+            if (tile == CompactBoard::NONE) continue;
+            std::uint8_t* shares = bytes + this->shareOffset() + static_cast<size_t>(tile) * MAX_PLAYERS;
+            if (std::all_of(shares, shares + MAX_PLAYERS, [](std::uint8_t share) { return share == 0; })) {
+                settledTiles[this->header.settledTileCount++] = tile;
+            }
+            shares[playerId]++;
+        }
+
+        this->header.settlementCounts[playerId]++;
+        this->header.latestSettlements[playerId] = vertex;
+    }
+
+
+    std::uint32_t CompactGameState::findRoadSpot(const CompactBoard& board, size_t playerId) const {
+        const std::uint32_t vertex = this->header.latestSettlements[playerId];
+        if (vertex == CompactBoard::NONE) {
+            return CompactBoard::NONE;
+        }
+        for (const std::uint32_t edge : board.vertexEdges[vertex]) {
+            if (edge != CompactBoard::NONE && this->bytes()[this->edgeOffset() + edge] == 0) return edge;
+        }
+        return CompactBoard::NONE;
+    }
+
+
+    void CompactGameState::buildRoad(size_t playerId, std::uint32_t edge) {
+        this->bytes()[this->edgeOffset() + edge] = static_cast<std::uint8_t>(playerId + 1);
+        this->header.roadCounts[playerId]++;
+    }
+
+
+    void CompactGameState::advanceTurn(const CompactBoard& board, std::mt19937& rng) {
+        Header& header = this->header;
+        header.currentPlayerId = (header.currentPlayerId + 1) % header.playerCount;
+        if (header.currentPlayerId == 0) {
+            header.roundNumber++;
+        }
+
+        // GameController::distributeResources(): one roll per settled tile, paid to every player next to it
+        const std::uint32_t* settledTiles = this->arena.data() + this->settledTilesOffset();
+        const std::uint8_t* shares = this->bytes() + this->shareOffset();
+        for (std::uint32_t i = 0; i < header.settledTileCount; ++i) {
+            const std::uint32_t tile = settledTiles[i];
+            if (static_cast<std::uint32_t>(rng()) >= board.tileThresholds[tile]) continue;
+
+            const types::TileType type = board.tileTypes[tile];
+            for (size_t playerId = 0; playerId < header.playerCount; ++playerId) {
+                header.resources[playerId][type] += shares[static_cast<size_t>(tile) * MAX_PLAYERS + playerId];
+            }
+        }
+    }
+
+
+    bool CompactGameState::isLeading(size_t playerId) const {
+        const Header& header = this->header;
+        const int resources = header.resources[playerId].getTotal();
+        for (size_t other = 0; other < header.playerCount; ++other) {
+            if (other == playerId) continue;
+            if (header.settlementCounts[other] > header.settlementCounts[playerId]) return false;
+            if (header.settlementCounts[other] == header.settlementCounts[playerId] && header.resources[other].getTotal() >= resources) return false;
+        }
+        return true;
+    }
+
+}
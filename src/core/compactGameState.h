@@ -0,0 +1,115 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "resourceBundle.h"
+#include "types.h"
+
+
+
+
+
+namespace df {
+
+    class GameState;
+    class Graph;
+
+
+    // Read-only topology of a map for the AI: flat index arrays, index = index into the Graph's
+    // getVertices()/getEdges()/getTiles(). Built once per decision and shared by all rollouts and threads.
+    struct CompactBoard {
+        static constexpr std::uint32_t NONE = UINT32_MAX;
+
+        std::vector<std::array<std::uint32_t, 3>> vertexNeighbours;
+        std::vector<std::array<std::uint32_t, 3>> vertexEdges;
+        std::vector<std::array<std::uint32_t, 3>> vertexTiles;
+        std::vector<float> vertexYields; // Graph::getExpectedYield() of the vertex
+        std::vector<std::uint32_t> tileThresholds; // a 32 bit roll below the threshold produces (expected yield * 2^32)
+        std::vector<types::TileType> tileTypes;
+        size_t edgeCount = 0;
+
+        static CompactBoard fromGraph(const Graph& map);
+
+        size_t getVertexCount() const { return this->vertexYields.size(); }
+        size_t getEdgeCount() const { return this->edgeCount; }
+        size_t getTileCount() const { return this->tileTypes.size(); }
+    };
+
+
+    // The mutable part of a game for the AI: no shared_ptr, no ECS, no hash maps. A trivially copyable header and
+    // one flat arena of occupancy bytes, so a clone is two copies and, into a reused clone, no allocation at all.
+    // Mirrors the rules of the GameController: distance rule, building costs, every settled tile rolls at the
+    // start of every turn and pays all players next to it. Roads go next to the player's latest settlement,
+    // like the scripted players build them.
+    class CompactGameState {
+    public:
+        static constexpr size_t MAX_PLAYERS = 4;
+
+        CompactGameState() = default;
+        // empty state (getPlayerCount() == 0) if the game has more than MAX_PLAYERS players
+        static CompactGameState fromGameState(const GameState& state, const CompactBoard& board);
+
+        // copies the other state into this one, reusing the arena
+        void copyFrom(const CompactGameState& other);
+
+        size_t getPlayerCount() const { return this->header.playerCount; }
+        size_t getCurrentPlayerId() const { return this->header.currentPlayerId; }
+        size_t getRoundNumber() const { return this->header.roundNumber; }
+        size_t getSettlementCount(size_t playerId) const { return this->header.settlementCounts[playerId]; }
+        size_t getRoadCount(size_t playerId) const { return this->header.roadCounts[playerId]; }
+        const ResourceBundle& getResources(size_t playerId) const { return this->header.resources[playerId]; }
+
+        bool isSettlementAllowed(std::uint32_t vertex) const;
+        bool canAfford(size_t playerId, const ResourceBundle& cost) const { return this->header.resources[playerId].covers(cost); }
+
+        // no checks, see isSettlementAllowed() / canAfford()
+        void buildSettlement(const CompactBoard& board, size_t playerId, std::uint32_t vertex);
+        // first free edge next to the player's latest settlement, CompactBoard::NONE if there is none
+        std::uint32_t findRoadSpot(const CompactBoard& board, size_t playerId) const;
+        void buildRoad(size_t playerId, std::uint32_t edge);
+
+        // endTurn() of the current player, then the production at the start of the next turn
+        void advanceTurn(const CompactBoard& board, std::mt19937& rng);
+
+        // most settlements, ties go to more resources (like the tournament leader)
+        bool isLeading(size_t playerId) const;
+
+    private:
+        struct Header {
+            std::array<ResourceBundle, MAX_PLAYERS> resources{};
+            std::array<std::uint32_t, MAX_PLAYERS> settlementCounts{};
+            std::array<std::uint32_t, MAX_PLAYERS> roadCounts{};
+            std::array<std::uint32_t, MAX_PLAYERS> latestSettlements{}; // vertex index, NONE if none
+            std::uint32_t playerCount = 0;
+            std::uint32_t currentPlayerId = 0;
+            std::uint32_t roundNumber = 0;
+            std::uint32_t settledTileCount = 0;
+            std::uint32_t vertexCount = 0;
+            std::uint32_t edgeCount = 0;
+            std::uint32_t tileCount = 0;
+        };
+        static_assert(std::is_trivially_copyable_v<Header>);
+
+        Header header;
+        // vertex owners | vertex blocked counters | edge owners | tile shares (MAX_PLAYERS per tile) as bytes,
+        // then the indices of the settled tiles. Owners are player id + 1, 0 = free.
+        std::vector<std::uint32_t> arena;
+
+        std::uint8_t* bytes() { return reinterpret_cast<std::uint8_t*>(this->arena.data()); }
+        const std::uint8_t* bytes() const { return reinterpret_cast<const std::uint8_t*>(this->arena.data()); }
+        size_t blockedOffset() const { return this->header.vertexCount; }
+        size_t edgeOffset() const { return 2 * static_cast<size_t>(this->header.vertexCount); }
+        size_t shareOffset() const { return this->edgeOffset() + this->header.edgeCount; }
+        // in words, after all byte arrays
+        size_t settledTilesOffset() const { return (this->shareOffset() + static_cast<size_t>(this->header.tileCount) * MAX_PLAYERS + 3) / 4; }
+
+        void placeSettlement(const CompactBoard& board, size_t playerId, std::uint32_t vertex);
+    };
+
+}
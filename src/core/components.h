@@ -18,6 +18,7 @@ namespace df {
 
     struct BuildingPreviewComponent {
         BuildingPreviewType type = BuildingPreviewType::Settlement;
+        bool legal = true; // the current player may build on the vertex/edge closest to the cursor
     };
 
 }
\ No newline at end of file
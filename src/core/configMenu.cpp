@@ -1,5 +1,6 @@
 #include "configMenu.h"
-#include <iostream>
+#include "worldGenerator.h"
+#include "log.h"
 
 namespace df {
 
@@ -256,9 +257,12 @@ namespace df {
             }
             if (widthButton.hovered) {
                 textSystem->renderText(
-                    "Click this button to start the map-size input.\n"
-                    "You can type a number between 1 and 100 \n"
-                    "and confirm with enter.",
+                    fmt::format(
+                        "Click this button to start the map-size input.\n"
+                        "You can type a number between 1 and {} \n"
+                        "and confirm with enter.",
+                        WorldGenerator::MAX_MAP_DIMENSION
+                    ),
                     infoPos,
                     0.4f,
                     { 1.0f, 0.0f, 0.0f }
@@ -293,7 +297,7 @@ namespace df {
         mouseY = static_cast<float>(extent.y) - mouseY;
 
         if (isCursorOnButton(mouseX, mouseY, startButton)) {
-            fmt::println("Game started");
+            DF_LOG_DEBUG(MENU, "Game started");
             onStart(
                 worldSeed,
                 worldWidth,
@@ -302,27 +306,27 @@ namespace df {
             );
         }
         if (isCursorOnButton(mouseX, mouseY, insularButton)) {
-            fmt::println("Insular generation chosen");
+            DF_LOG_DEBUG(MENU, "Insular generation chosen");
             worldGenerationMode = 0;
         }
         if (isCursorOnButton(mouseX, mouseY, perlinButton)) {
-            fmt::println("Perlin generation chosen");
+            DF_LOG_DEBUG(MENU, "Perlin generation chosen");
             worldGenerationMode = 1;
         }
         if (isCursorOnButton(mouseX, mouseY, seedButton)) {
-            fmt::println("Enter seed");
+            DF_LOG_DEBUG(MENU, "Enter seed");
             activeInput = InputField::SEED;
             inputString.clear();
         }
         if (isCursorOnButton(mouseX, mouseY, widthButton)) {
-            fmt::println("Enter width");
+            DF_LOG_DEBUG(MENU, "Enter width");
             activeInput = InputField::WIDTH;
             inputString.clear();
         }
         /*
         * heightButton is used when map can be non quadratic
         if (isCursorOnButton(mouseX, mouseY, heightButton)) {
-            fmt::println("Enter height");
+            DF_LOG_DEBUG(MENU, "Enter height");
             activeInput = InputField::HEIGHT;
             inputString.clear();
         }
@@ -351,10 +355,10 @@ namespace df {
                 warningMessage = "Map size too small, must be >= 1";
                 inputString = "1";
             }
-            if (value > 100) {
+            if (value > static_cast<int>(WorldGenerator::MAX_MAP_DIMENSION)) {
                 warningTimer = 2.0f;
-                warningMessage = "Map size too big, must be <= 100";
-                inputString = "100";
+                warningMessage = fmt::format("Map size too big, must be <= {}", WorldGenerator::MAX_MAP_DIMENSION);
+                inputString = std::to_string(WorldGenerator::MAX_MAP_DIMENSION);
             }
         }
     }
@@ -363,13 +367,13 @@ namespace df {
         if (inputString.length() > 10) { // INT_MAX = 2147483647 so more than 10 digits are not allowed
             warningTimer = 2.0f;
             warningMessage = "Input length too long, defaulting to INT_MAX";
-            fmt::println("Input length too long, defaulting to INT_MAX");
+            DF_LOG_WARNING(MENU, "Input length too long, defaulting to INT_MAX");
             inputString = std::to_string(INT_MAX);
         }
         else if (inputString.length() == 10 && inputString > "2147483647") {
             warningTimer = 2.0f;
             warningMessage = "Value too large, defaulting to INT_MAX";
-            fmt::println("Value too large, defaulting to INT_MAX");
+            DF_LOG_WARNING(MENU, "Value too large, defaulting to INT_MAX");
             inputString = std::to_string(INT_MAX);
         }
         if (inputString.length() > 0) capMapsize();
@@ -390,7 +394,7 @@ namespace df {
             // finish input with enter
             else if (key == GLFW_KEY_ENTER) {
                 if (inputString.empty()) {
-                    fmt::println("Input an empty string"); 
+                    DF_LOG_DEBUG(MENU, "Input an empty string");
                     activeInput = InputField::NONE;
                     inputString.clear();
                     return;
@@ -399,18 +403,18 @@ namespace df {
                 switch (activeInput) {
                 case InputField::SEED:
                     worldSeed = value;
-                    fmt::println("Seed: {}", value);
+                    DF_LOG_DEBUG(MENU, "Seed: {}", value);
                     break;
                 case InputField::WIDTH:
                     worldWidth = value;
-                    fmt::println("width: {}", value);
+                    DF_LOG_DEBUG(MENU, "width: {}", value);
                     // TEMPORARY while map is only quadratic
                     worldHeight = value;
-                    fmt::println("height: {}", value);
+                    DF_LOG_DEBUG(MENU, "height: {}", value);
                     break;
                 case InputField::HEIGHT:
                     worldHeight = value;
-                    fmt::println("height: {}", value);
+                    DF_LOG_DEBUG(MENU, "height: {}", value);
                     break;
                 default:
                     break;
@@ -0,0 +1,72 @@
+#pragma once
+#include <atomic>
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "mpscQueue.h"
+#include "queuedSignal.h"
+#include "signal.h"
+
+/*
+ * A queued signal that any thread may post to (world generation, asset loading or the AI on worker threads).
+ * post() is lock-free (it only allocates if an argument does, e.g. a std::string); the events are delivered on the main thread by
+ * EventBus::dispatchQueued(), at most the frame budget per frame. At most `capacity` events wait, so an event is delivered
+ * within getMaxLatencyFrames() = ceil(capacity / budget) frames after its post() returned; with the default budget (the
+ * capacity) that is the next frame. A post() that is still in progress (a producer preempted inside it) holds back the
+ * events behind it until it finishes. Everything else (connect, disconnect, emit) stays main thread only, like for every Signal.
+*/
+
+namespace df {
+	template<typename... Arguments>
+	class ChannelSignal : public Signal<Arguments...>, public QueuedSignalBase {
+	public:
+		static constexpr size_t DEFAULT_CAPACITY = 1024;
+
+		// capacity is rounded up to a power of two; frameBudget defaults to the capacity, a full channel drains in one frame
+		explicit ChannelSignal(std::string signalName, size_t capacity = DEFAULT_CAPACITY, std::optional<size_t> frameBudget = std::nullopt)
+			: Signal<Arguments...>(std::move(signalName)), events(capacity) {
+			this->setFrameBudget(frameBudget.value_or(this->events.getCapacity()));
+		}
+
+		// Any thread. Returns false and drops the event if `capacity` events are already waiting.
+		template<typename... Arguments2>
+		bool post(Arguments2&&... arguments) {
+			if (this->events.tryPush(std::forward<Arguments2>(arguments)...)) {
+				return true;
+			}
+			this->dropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		// main thread
+		size_t dispatch(size_t budget) override {
+			size_t delivered = 0;
+			Payload payload;
+			while (delivered < budget && this->events.tryPop(payload)) {
+				std::apply([this](auto&... values) { this->emit(values...); }, payload);
+				delivered++;
+			}
+			return delivered;
+		}
+
+		size_t getQueuedCount() const override { return this->events.getApproximateSize(); }
+		size_t getFrameBudget() const override { return this->frameBudget; }
+		void setFrameBudget(size_t budget) { this->frameBudget = std::max<size_t>(budget, 1); }
+		size_t getCapacity() const { return this->events.getCapacity(); }
+		// frames between post() and delivery at most, see above
+		size_t getMaxLatencyFrames() const { return (this->getCapacity() + this->frameBudget - 1) / this->frameBudget; }
+		size_t getDroppedCount() const { return this->dropped.load(std::memory_order_relaxed); }
+
+	private:
+		using Payload = std::tuple<std::decay_t<Arguments>...>;
+
+		MpscQueue<Payload> events;
+		size_t frameBudget = 1;
+		std::atomic<size_t> dropped{ 0 };
+	};
+}
@@ -1,8 +1,13 @@
 #pragma once
+#include <algorithm>
 #include <string>
+#include <vector>
 
 #include "assets.h"
+#include "./events/channelSignal.h"
+#include "./events/queuedSignal.h"
 #include "./events/signal.h"
+#include "./events/signalStats.h"
 
 /*
  * This idea is inspired from Signals in Godot engine and the event bus pattern.
@@ -16,16 +21,90 @@
  *     on + Signal
 */
 
+// every signal has to be added to EventBus::initializeSignalList() too (for the stats)
 #define RegisterSignal(name, ...) Signal<__VA_ARGS__> name{#name}
+// queued signals have to be added to EventBus::initializeQueuedSignals() too
+#define RegisterQueuedSignal(name, policy, ...) QueuedSignal<__VA_ARGS__> name{#name, policy}
+// signals other threads post to, also queued
+#define RegisterChannelSignal(name, ...) ChannelSignal<__VA_ARGS__> name{#name}
 
 namespace df {
 	class EventBus {
 	public:
 		EventBus() {
+#ifdef DF_SIGNAL_INSTRUMENTATION
+			initializeSignalList();
+#endif
+			initializeQueuedSignals();
 			initializeSignalDecoration();
 		}
 		~EventBus() = default;
 
+		// Delivers the events post()ed to queued signals, at most each signal's frame budget. Called once per frame.
+		// Returns the number of delivered events.
+		size_t dispatchQueued() {
+			size_t delivered = 0;
+			for (QueuedSignalBase* signal : this->queuedSignals) {
+				delivered += signal->dispatch(signal->getFrameBudget());
+			}
+			return delivered;
+		}
+
+		// Called once per frame, after dispatchQueued(). Only does something with DF_SIGNAL_INSTRUMENTATION:
+		// closes the per-frame emit counts and dumps the stats every getStatsDumpInterval() frames.
+		void endFrame() {
+#ifdef DF_SIGNAL_INSTRUMENTATION
+			for (SignalBase* signal : this->signals) {
+				signal->endFrame();
+			}
+			if (this->statsDumpInterval > 0 && ++this->framesSinceDump >= this->statsDumpInterval) {
+				this->framesSinceDump = 0;
+				this->dumpSignalStats();
+			}
+#endif
+		}
+
+#ifdef DF_SIGNAL_INSTRUMENTATION
+		static constexpr size_t DEFAULT_STATS_DUMP_INTERVAL = 600; // frames, ~10 s
+
+		std::vector<SignalStats> getSignalStats() const {
+			std::vector<SignalStats> stats;
+			stats.reserve(this->signals.size());
+			for (const SignalBase* signal : this->signals) {
+				stats.push_back(signal->getStats());
+			}
+			return stats;
+		}
+
+		// Logs every signal that was emitted, its callbacks by total time (EVENTS module, info level).
+		void dumpSignalStats() const {
+			for (SignalStats& stats : this->getSignalStats()) {
+				if (stats.emits == 0) continue;
+				DF_LOG_INFO(EVENTS, "signal {}: {} emits in {} frames, {} last frame, max {} per frame, callbacks {:.3f} ms",
+					stats.name, stats.emits, stats.frames, stats.lastFrameEmits, stats.maxFrameEmits,
+					std::chrono::duration<double, std::milli>(stats.getTotalCallbackTime()).count());
+
+				std::sort(stats.callbacks.begin(), stats.callbacks.end(), [](const CallbackStats& a, const CallbackStats& b) { return a.total > b.total; });
+				for (const CallbackStats& callback : stats.callbacks) {
+					DF_LOG_INFO(EVENTS, "    {}: {} calls, total {:.3f} ms, avg {:.2f} us, max {:.2f} us", callback.identifier, callback.calls,
+						std::chrono::duration<double, std::milli>(callback.total).count(),
+						std::chrono::duration<double, std::micro>(callback.getAverage()).count(),
+						std::chrono::duration<double, std::micro>(callback.max).count());
+				}
+			}
+		}
+
+		void resetSignalStats() {
+			for (SignalBase* signal : this->signals) {
+				signal->resetStats();
+			}
+		}
+
+		// 0 = no periodic dump
+		void setStatsDumpInterval(size_t frames) { this->statsDumpInterval = frames; }
+		size_t getStatsDumpInterval() const { return this->statsDumpInterval; }
+#endif
+
 		// Application Events {
 		RegisterSignal(applicationRunStarted);
 		// }
@@ -39,16 +118,37 @@ namespace df {
 		// Instead, use the signal decoration feature
 		// and add a new sound attachment to a signal
 		// from above in df::SignalDecoration::initializeSignalDecoration
-		RegisterSignal(playSoundRequested, const std::string&, const bool);
+		// Queued: sounds are loaded and started in dispatchQueued(), not inside the game logic that triggered them.
+		RegisterQueuedSignal(playSoundRequested, QueuePolicy::ALL, const std::string&, const bool);
+		// }
+
+		// Worker Thread Events (post() from any thread, delivered on the main thread) {
+		// task name, progress in [0, 1]
+		RegisterChannelSignal(workerProgressReported, const std::string&, const float);
 		// }
 
 	private:
+		std::vector<QueuedSignalBase*> queuedSignals;
+#ifdef DF_SIGNAL_INSTRUMENTATION
+		std::vector<SignalBase*> signals;
+		size_t statsDumpInterval = DEFAULT_STATS_DUMP_INTERVAL;
+		size_t framesSinceDump = 0;
+
+		void initializeSignalList() {
+			this->signals = { &this->applicationRunStarted, &this->playSoundRequested, &this->workerProgressReported };
+		}
+#endif
+
+		void initializeQueuedSignals() {
+			this->queuedSignals = { &this->playSoundRequested, &this->workerProgressReported };
+		}
+
 		// Signal Decoration {
 		template<typename SignalType>
 		void attachSound(SignalType& signal, const std::string& path, const bool loop = false) {
 			signal.connect(
 				[this, path, loop](auto&&...) {
-					this->playSoundRequested.emit(path, loop);
+					this->playSoundRequested.post(path, loop);
 				},
 				"EventBus::attachSound"
 			);
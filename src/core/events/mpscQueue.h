@@ -0,0 +1,88 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+/*
+ * Bounded lock-free queue for many producer threads and one consumer thread (D. Vyukov's bounded queue, with a
+ * plain consumer index). Every cell carries a sequence number that tells producers and the consumer whose turn it
+ * is, so a push is one CAS on the tail plus two stores and a pop doesn't need any read-modify-write.
+ * Nothing allocates after construction; a push into a full queue fails instead of waiting.
+*/
+
+namespace df {
+	template<typename T>
+	class MpscQueue {
+	public:
+		// capacity is rounded up to a power of two
+		explicit MpscQueue(size_t capacity)
+			: mask(std::bit_ceil(std::max<size_t>(capacity, 2)) - 1), cells(std::make_unique<Cell[]>(this->mask + 1)) {
+			for (size_t i = 0; i <= this->mask; i++) {
+				this->cells[i].sequence.store(i, std::memory_order_relaxed);
+			}
+		}
+
+		MpscQueue(const MpscQueue&) = delete;
+		MpscQueue& operator=(const MpscQueue&) = delete;
+
+		// Any thread. Returns false if the queue is full.
+		template<typename... Arguments>
+		bool tryPush(Arguments&&... arguments) {
+			size_t position = this->tail.load(std::memory_order_relaxed);
+			while (true) {
+				Cell& cell = this->cells[position & this->mask];
+				const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+				const std::intptr_t difference = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+				if (difference == 0) {
+					// the cell is free for this position, claim it
+					if (this->tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+						cell.value = T(std::forward<Arguments>(arguments)...);
+						cell.sequence.store(position + 1, std::memory_order_release);
+						return true;
+					}
+				} else if (difference < 0) {
+					return false; // the consumer hasn't freed the cell of the previous lap yet
+				} else {
+					position = this->tail.load(std::memory_order_relaxed); // another producer was faster
+				}
+			}
+		}
+
+		// Consumer thread only. Returns false if the queue is empty (or the next event is still being written).
+		bool tryPop(T& value) {
+			Cell& cell = this->cells[this->head & this->mask];
+			if (cell.sequence.load(std::memory_order_acquire) != this->head + 1) {
+				return false;
+			}
+			value = std::move(cell.value);
+			cell.sequence.store(this->head + this->mask + 1, std::memory_order_release); // free for the next lap
+			this->head++;
+			return true;
+		}
+
+		// consumer thread, only a snapshot while producers are pushing
+		size_t getApproximateSize() const {
+			return this->tail.load(std::memory_order_relaxed) - this->head;
+		}
+
+		size_t getCapacity() const { return this->mask + 1; }
+
+	private:
+		// own cache lines, producers and the consumer don't invalidate each other's counters
+		static constexpr size_t CACHE_LINE = 64;
+
+		struct Cell {
+			std::atomic<size_t> sequence{ 0 };
+			T value{};
+		};
+
+		const size_t mask;
+		std::unique_ptr<Cell[]> cells;
+		alignas(CACHE_LINE) std::atomic<size_t> tail{ 0 };
+		alignas(CACHE_LINE) size_t head = 0;
+	};
+}
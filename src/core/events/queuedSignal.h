@@ -0,0 +1,95 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "signal.h"
+
+/*
+ * A signal whose events can also be queued: post() stores the arguments, dispatch() emits them later, at a fixed
+ * point of the frame (EventBus::dispatchQueued() in Application::run). Game logic that posts doesn't run the
+ * callbacks (e.g. loading a sound) in the middle of its own work.
+*/
+
+namespace df {
+	enum class QueuePolicy {
+		ALL, // every posted event is delivered, in post order
+		COALESCE, // events posted before the next dispatch() replace each other, only the latest is delivered
+	};
+
+
+	// The part of a queued signal that does not depend on its arguments, for EventBus::dispatchQueued().
+	class QueuedSignalBase {
+	public:
+		virtual ~QueuedSignalBase() = default;
+		// Emits up to `budget` queued events, returns how many. Events posted by the callbacks wait for the next call.
+		virtual size_t dispatch(size_t budget) = 0;
+		virtual size_t getQueuedCount() const = 0;
+		virtual size_t getFrameBudget() const = 0;
+	};
+
+
+	template<typename... Arguments>
+	class QueuedSignal : public Signal<Arguments...>, public QueuedSignalBase {
+	public:
+		static constexpr size_t DEFAULT_FRAME_BUDGET = 64;
+
+		// frameBudget: events delivered per EventBus::dispatchQueued(), the rest stays queued for the next frame
+		explicit QueuedSignal(std::string signalName, QueuePolicy policy = QueuePolicy::ALL, size_t frameBudget = DEFAULT_FRAME_BUDGET)
+			: Signal<Arguments...>(std::move(signalName)), policy(policy), frameBudget(frameBudget) {}
+
+		template<typename... Arguments2>
+		void post(Arguments2&&... arguments) {
+			if (this->policy == QueuePolicy::COALESCE && this->count > 0) {
+				this->events[this->indexOf(this->count - 1)] = Payload(std::forward<Arguments2>(arguments)...);
+				return;
+			}
+			if (this->count == this->events.size()) {
+				this->grow();
+			}
+			this->events[this->indexOf(this->count)] = Payload(std::forward<Arguments2>(arguments)...);
+			this->count++;
+		}
+
+		size_t dispatch(size_t budget) override {
+			const size_t delivered = std::min(budget, this->count);
+			for (size_t i = 0; i < delivered; i++) {
+				// out of the buffer first: a callback may post and move the buffer
+				Payload payload = std::move(this->events[this->head]);
+				this->head = this->indexOf(1);
+				this->count--;
+				std::apply([this](auto&... values) { this->emit(values...); }, payload);
+			}
+			return delivered;
+		}
+
+		size_t getQueuedCount() const override { return this->count; }
+		size_t getFrameBudget() const override { return this->frameBudget; }
+		void setFrameBudget(size_t budget) { this->frameBudget = budget; }
+
+	private:
+		using Payload = std::tuple<std::decay_t<Arguments>...>;
+
+		// ring buffer, the capacity is a power of two and only grows when a burst doesn't fit
+		std::vector<Payload> events = std::vector<Payload>(8);
+		size_t head = 0;
+		size_t count = 0;
+		QueuePolicy policy;
+		size_t frameBudget;
+
+		size_t indexOf(size_t offset) const { return (this->head + offset) & (this->events.size() - 1); }
+
+		void grow() {
+			std::vector<Payload> larger(this->events.size() * 2);
+			for (size_t i = 0; i < this->count; i++) {
+				larger[i] = std::move(this->events[this->indexOf(i)]);
+			}
+			this->events = std::move(larger);
+			this->head = 0;
+		}
+	};
+}
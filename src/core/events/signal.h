@@ -1,6 +1,14 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <string>
+#include <utility>
+#include <vector>
+
+#include <utils/log.h>
+
+#include "signalStats.h"
 
 /*
  * This idea is inspired from Signals in Godot engine and the event bus pattern.
@@ -9,42 +17,268 @@
 */
 
 namespace df {
+	// Handle of a connection, unique per signal. 0 = not connected.
+	using ConnectionId = std::uint32_t;
+
+
+	// The part of a signal that does not depend on its arguments, for ScopedConnection.
+	class SignalBase {
+	public:
+		virtual ~SignalBase() = default;
+		virtual void disconnect(ConnectionId connection) = 0;
+
+#ifdef DF_SIGNAL_INSTRUMENTATION
+		virtual SignalStats getStats() const = 0;
+		// starts the next frame of the per-frame emit counts, EventBus::endFrame()
+		virtual void endFrame() = 0;
+		virtual void resetStats() = 0;
+#endif
+	};
+
+
+	// Disconnects when it goes out of scope, so a callback capturing `this` can't outlive its object.
+	// The signal has to outlive the ScopedConnection (the EventBus signals live as long as the application).
+	class ScopedConnection {
+	public:
+		ScopedConnection() = default;
+		ScopedConnection(SignalBase& signal, ConnectionId connection) : signal(&signal), connection(connection) {}
+		~ScopedConnection() { this->reset(); }
+
+		ScopedConnection(const ScopedConnection&) = delete;
+		ScopedConnection& operator=(const ScopedConnection&) = delete;
+
+		ScopedConnection(ScopedConnection&& other) noexcept
+			: signal(std::exchange(other.signal, nullptr)), connection(std::exchange(other.connection, 0)) {}
+
+		ScopedConnection& operator=(ScopedConnection&& other) noexcept {
+			if (this != &other) {
+				this->reset();
+				this->signal = std::exchange(other.signal, nullptr);
+				this->connection = std::exchange(other.connection, 0);
+			}
+			return *this;
+		}
+
+		bool isConnected() const { return this->signal && this->connection != 0; }
+		ConnectionId get() const { return this->connection; }
+
+		void reset() {
+			if (this->isConnected()) {
+				this->signal->disconnect(this->connection);
+			}
+			this->signal = nullptr;
+			this->connection = 0;
+		}
+
+		// keeps the connection, the caller has to disconnect it
+		ConnectionId release() {
+			this->signal = nullptr;
+			return std::exchange(this->connection, 0);
+		}
+
+	private:
+		SignalBase* signal = nullptr;
+		ConnectionId connection = 0;
+	};
+
+
+	/*
+	 * Callbacks are stored contiguously in connection order and called in that order. emit() does not allocate:
+	 * callbacks connected during an emit are kept aside and take part from the next emit on, callbacks
+	 * disconnected during an emit are only marked (tombstone) and removed when the outermost emit returns.
+	 * Logging of connect/disconnect/emit is off unless setVerbose(true), then at debug/trace level of the EVENTS module.
+	 * With DF_SIGNAL_INSTRUMENTATION, emits are counted and every callback call is timed, see getStats().
+	 */
 	template<typename... Arguments>
-	class Signal {
+	class Signal : public SignalBase {
 	public:
 		Signal() = default;
 		explicit Signal(std::string signalName) : name(std::move(signalName)) {}
-		~Signal() = default;
+		~Signal() override = default;
+
+		// connections refer to the signal by address
+		Signal(const Signal&) = delete;
+		Signal& operator=(const Signal&) = delete;
 
 		using Callback = std::function<void(Arguments...)>;
 
-		void connect(Callback callback, const std::string& identifier) {
-			fmt::println("Connected callback {} to signal {}", identifier, name);
-			auto [iterator, inserted] = callbacks.emplace(identifier, callback);
-			if (!inserted) {
-				fmt::print("Callback {} is already connected to signal {}\n", identifier, name);
+		// Returns the handle for disconnect(), 0 if a callback with this identifier is already connected.
+		ConnectionId connect(Callback callback, const std::string& identifier) {
+			if (this->findSlot(this->slots, identifier) || this->findSlot(this->pendingSlots, identifier)) {
+				DF_LOG_WARNING(EVENTS, "Callback {} is already connected to signal {}", identifier, name);
+				return 0;
+			}
+			if (this->verbose) {
+				DF_LOG_DEBUG(EVENTS, "Connected callback {} to signal {}", identifier, name);
 			}
+
+			const ConnectionId connection = this->nextConnection++;
+			// a callback that connects must not move the slots an emit is iterating
+			std::vector<Slot>& target = (this->dispatchDepth > 0) ? this->pendingSlots : this->slots;
+			target.push_back(Slot{ connection, identifier, std::move(callback) });
+			return connection;
+		}
+
+		// Disconnects when the returned object goes out of scope.
+		[[nodiscard]] ScopedConnection connectScoped(Callback callback, const std::string& identifier) {
+			return ScopedConnection(*this, this->connect(std::move(callback), identifier));
 		}
 
 		// YOU HAVE TO DISCONNECT IF A CALLBACK CAPTURES A THIS-POINTER.
 		// (When the lifetime of an object is shorter than of the EventBus.
-		//  Do it in the destructor or deinit of the corresponding object)
+		//  Do it in the destructor or deinit of the corresponding object, or use connectScoped())
+		void disconnect(ConnectionId connection) override {
+			if (connection == 0) {
+				return;
+			}
+			this->removeSlot([connection](const Slot& slot) { return slot.connection == connection; });
+		}
+
 		void disconnect(const std::string& identifier) {
-			fmt::println("Disconnected callback {} from signal {}", identifier, name);
-			callbacks.erase(identifier);
+			this->removeSlot([&identifier](const Slot& slot) { return slot.connection != 0 && slot.identifier == identifier; });
 		}
 
 		template<typename... Arguments2>
 		void emit(Arguments2&&... arguments) {
-			fmt::println("Emitted signal {}", name);
-			const auto currentCallbacks = callbacks;
-			for (auto const& [identifier, callback] : currentCallbacks) {
-				callback(std::forward<Arguments>(arguments)...);
+			if (this->verbose) {
+				DF_LOG_TRACE(EVENTS, "Emitted signal {}", name);
+			}
+
+#ifdef DF_SIGNAL_INSTRUMENTATION
+			this->emitCounters.record();
+#endif
+
+			// slots neither move nor disappear until the outermost emit is over, see DispatchScope
+			DispatchScope scope(*this);
+			for (size_t i = 0; i < this->slots.size(); i++) {
+				Slot& slot = this->slots[i];
+				if (slot.connection != 0) {
+#ifdef DF_SIGNAL_INSTRUMENTATION
+					const SignalStatsClock::time_point begin = SignalStatsClock::now();
+					slot.callback(arguments...);
+					slot.counters.record(SignalStatsClock::now() - begin);
+#else
+					slot.callback(arguments...);
+#endif
+				}
+			}
+		}
+
+		size_t getConnectionCount() const {
+			size_t count = this->pendingSlots.size();
+			for (const Slot& slot : this->slots) count += (slot.connection != 0) ? 1 : 0;
+			return count;
+		}
+
+		void setVerbose(bool isVerbose) { this->verbose = isVerbose; }
+		bool isVerbose() const { return this->verbose; }
+
+#ifdef DF_SIGNAL_INSTRUMENTATION
+		// allocates, for queries and dumps, not for every frame
+		SignalStats getStats() const override {
+			SignalStats stats;
+			stats.name = this->name;
+			stats.emits = this->emitCounters.emits;
+			stats.frames = this->emitCounters.frames;
+			stats.currentFrameEmits = this->emitCounters.currentFrameEmits;
+			stats.lastFrameEmits = this->emitCounters.lastFrameEmits;
+			stats.maxFrameEmits = this->emitCounters.maxFrameEmits;
+			for (const std::vector<Slot>* in : { &this->slots, &this->pendingSlots }) {
+				for (const Slot& slot : *in) {
+					if (slot.connection == 0) continue;
+					stats.callbacks.push_back(CallbackStats{ slot.identifier, slot.counters.calls, slot.counters.total, slot.counters.max });
+				}
 			}
+			return stats;
 		}
 
+		void endFrame() override { this->emitCounters.endFrame(); }
+
+		void resetStats() override {
+			this->emitCounters = {};
+			for (Slot& slot : this->slots) slot.counters = {};
+			for (Slot& slot : this->pendingSlots) slot.counters = {};
+		}
+#endif
+
 		std::string name{};
 	private:
-		std::unordered_map<std::string, Callback> callbacks{};
+		struct Slot {
+			ConnectionId connection = 0; // 0 = disconnected during an emit, removed afterwards
+			std::string identifier;
+			Callback callback;
+#ifdef DF_SIGNAL_INSTRUMENTATION
+			CallbackCounters counters{};
+#endif
+		};
+
+		// counts nested emits, the outermost one cleans up when it ends (also if a callback throws)
+		struct DispatchScope {
+			Signal& signal;
+			explicit DispatchScope(Signal& signal) : signal(signal) { this->signal.dispatchDepth++; }
+			~DispatchScope() {
+				if (--this->signal.dispatchDepth == 0) {
+					this->signal.flushDeferred();
+				}
+			}
+		};
+
+		std::vector<Slot> slots{};
+		std::vector<Slot> pendingSlots{}; // connected during an emit
+		ConnectionId nextConnection = 1;
+		unsigned dispatchDepth = 0;
+		bool hasTombstones = false;
+		bool verbose = false;
+#ifdef DF_SIGNAL_INSTRUMENTATION
+		EmitCounters emitCounters{};
+#endif
+
+		static const Slot* findSlot(const std::vector<Slot>& in, const std::string& identifier) {
+			for (const Slot& slot : in) {
+				if (slot.connection != 0 && slot.identifier == identifier) return &slot;
+			}
+			return nullptr;
+		}
+
+		template<typename Predicate>
+		void removeSlot(Predicate matches) {
+			for (size_t i = 0; i < this->slots.size(); i++) {
+				Slot& slot = this->slots[i];
+				if (!matches(slot)) continue;
+
+				if (this->verbose) {
+					DF_LOG_DEBUG(EVENTS, "Disconnected callback {} from signal {}", slot.identifier, name);
+				}
+				if (this->dispatchDepth > 0) {
+					// the callback may be running right now, keep it alive until the emit is over
+					slot.connection = 0;
+					this->hasTombstones = true;
+				} else {
+					this->slots.erase(this->slots.begin() + static_cast<std::ptrdiff_t>(i));
+				}
+				return;
+			}
+
+			for (size_t i = 0; i < this->pendingSlots.size(); i++) {
+				if (matches(this->pendingSlots[i])) {
+					if (this->verbose) {
+						DF_LOG_DEBUG(EVENTS, "Disconnected callback {} from signal {}", this->pendingSlots[i].identifier, name);
+					}
+					this->pendingSlots.erase(this->pendingSlots.begin() + static_cast<std::ptrdiff_t>(i));
+					return;
+				}
+			}
+		}
+
+		void flushDeferred() {
+			if (this->hasTombstones) {
+				std::erase_if(this->slots, [](const Slot& slot) { return slot.connection == 0; });
+				this->hasTombstones = false;
+			}
+			if (!this->pendingSlots.empty()) {
+				for (Slot& slot : this->pendingSlots) this->slots.push_back(std::move(slot));
+				this->pendingSlots.clear();
+			}
+		}
 	};
 }
@@ -0,0 +1,84 @@
+#pragma once
+
+/*
+ * Emit counts and callback durations of signals, only with DF_SIGNAL_INSTRUMENTATION defined
+ * (cmake -DDF_SIGNAL_INSTRUMENTATION=ON). Without it none of this exists and Signal::emit() measures nothing.
+*/
+
+#ifdef DF_SIGNAL_INSTRUMENTATION
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace df {
+	using SignalStatsClock = std::chrono::steady_clock;
+
+
+	// What one connection's callback cost, since it was connected.
+	struct CallbackStats {
+		std::string identifier;
+		std::uint64_t calls = 0;
+		std::chrono::nanoseconds total{ 0 };
+		std::chrono::nanoseconds max{ 0 };
+
+		std::chrono::nanoseconds getAverage() const {
+			return (this->calls == 0) ? std::chrono::nanoseconds(0) : this->total / static_cast<std::int64_t>(this->calls);
+		}
+	};
+
+
+	struct SignalStats {
+		std::string name;
+		std::uint64_t emits = 0;
+		std::uint64_t frames = 0; // EventBus::endFrame() calls
+		std::uint64_t currentFrameEmits = 0;
+		std::uint64_t lastFrameEmits = 0;
+		std::uint64_t maxFrameEmits = 0;
+		std::vector<CallbackStats> callbacks; // connected callbacks, in call order
+
+		std::chrono::nanoseconds getTotalCallbackTime() const {
+			std::chrono::nanoseconds total{ 0 };
+			for (const CallbackStats& callback : this->callbacks) total += callback.total;
+			return total;
+		}
+	};
+
+
+	// Kept per connection by Signal, without the identifier (the connection has it) so emit() doesn't allocate.
+	struct CallbackCounters {
+		std::uint64_t calls = 0;
+		std::chrono::nanoseconds total{ 0 };
+		std::chrono::nanoseconds max{ 0 };
+
+		void record(const std::chrono::nanoseconds duration) {
+			this->calls++;
+			this->total += duration;
+			this->max = std::max(this->max, duration);
+		}
+	};
+
+
+	// Per signal, emits in total and per frame.
+	struct EmitCounters {
+		std::uint64_t emits = 0;
+		std::uint64_t frames = 0;
+		std::uint64_t currentFrameEmits = 0;
+		std::uint64_t lastFrameEmits = 0;
+		std::uint64_t maxFrameEmits = 0;
+
+		void record() {
+			this->emits++;
+			this->currentFrameEmits++;
+		}
+
+		void endFrame() {
+			this->frames++;
+			this->lastFrameEmits = this->currentFrameEmits;
+			this->maxFrameEmits = std::max(this->maxFrameEmits, this->currentFrameEmits);
+			this->currentFrameEmits = 0;
+		}
+	};
+}
+#endif
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "resourceBundle.h"
+#include "road.h"
+
+
+
+
+
+namespace df {
+
+    // One reversible change of the game state, recorded by the GameController for every mutation.
+    // Only the delta is stored (ids and amounts), so applying or reverting a command never copies any state
+    // and a history of them is cheap enough for search-based AIs that try out moves and take them back.
+    struct GameCommand {
+        enum class Type : std::uint8_t {
+            BUILD_SETTLEMENT, // settlement objectId of playerId at vertex targetId, charges resources
+            BUILD_ROAD,       // road objectId of playerId at edge targetId, charges resources
+            EXPLORE_TILE,     // tile targetId becomes explored/visible for playerId
+            ADD_RESOURCES,    // pays resources to playerId (production of a turn)
+            END_TURN,         // playerId ends the turn, endsRound if the next player starts a new round
+        };
+
+        Type type = Type::END_TURN;
+        size_t playerId = 0;
+        size_t targetId = 0;
+        size_t objectId = 0;
+        RoadLevel roadLevel = RoadLevel::Path;
+        bool endsRound = false;
+        ResourceBundle resources;
+    };
+
+    static_assert(std::is_trivially_copyable_v<GameCommand>);
+
+}
@@ -1,12 +1,11 @@
 #include "edge.h"
-#include "fmt/base.h"
-#include <map>
+#include "log.h"
 #include <optional>
 #include <stdexcept>
-#include <unordered_set>
 
 #include "gamecontroller.h"
 #include "hero.h"
+#include "replay.h"
 #include "tile.h"
 #include "vertex.h"
 
@@ -30,7 +29,8 @@ namespace df {
 			return;
 		}
 
-		this->giveResourcesTo(*player);
+		if (this->replay) this->replay->recordStartTurn();
+		this->distributeResources();
 		this->resetHeroMovement(*player);
 	}
 
@@ -41,45 +41,59 @@ namespace df {
 			return;
 		} // should not happen
 
-		// TODO: maybe add some "setNextTurn()" etc. functions
-		size_t nextPlayerId = (this->gameState.getCurrentPlayerId() + 1) % playerCount;
-		this->gameState.setCurrentPlayerId(nextPlayerId);
-		this->gameState.setTurnCount(this->gameState.getTurnCount() + 1);
+		GameCommand command;
+		command.type = GameCommand::Type::END_TURN;
+		command.playerId = this->gameState.getCurrentPlayerId();
+		command.endsRound = (command.playerId + 1) % playerCount == 0;
 
-		if (nextPlayerId == 0) {
-			this->gameState.setRoundNumber(this->gameState.getRoundNumber() + 1);
-		}
+		this->beginAction();
+		this->record(command);
+		this->trimHistory();
+		if (this->replay) this->replay->recordEndTurn(this->gameState);
 	}
 
 
-	void GameController::giveResourcesTo(Player& player) {
-		// resources are given to the player based on the settlements they have
-		// for testing purposes, players receive some resources every turn
-		bool test = true;
-		if (test) {
-			player.addResources(types::TileType::FOREST, 1);
-			player.addResources(types::TileType::CLAY, 1);
-			player.addResources(types::TileType::GRASS, 1);
-			player.addResources(types::TileType::FIELD, 1);
-			player.addResources(types::TileType::MOUNTAIN, 1);
+	void GameController::distributeResources() {
+		const Graph& map = this->gameState.getMap();
+		const auto producingTiles = this->gameState.getProduction().getTiles();
 
-			return;
+		// one batch of random numbers for all settled tiles up front, then compare against the tile probabilities
+		this->productionRolls.resize(producingTiles.size());
+		for (std::uint32_t& roll : this->productionRolls) {
+			roll = static_cast<std::uint32_t>(this->rng());
 		}
 
-		for (size_t settlementId : player.getSettlementIds()) {
-			const Settlement* settlement = this->findSettlementById(settlementId);
-			if (!settlement) {
+		this->productionIncome.assign(this->gameState.getPlayerCount(), ResourceBundle{});
+		for (size_t i = 0; i < producingTiles.size(); ++i) {
+			const TileHandle tile = map.findTileById(producingTiles[i].tileId);
+			if (!tile) {
+				continue;
+			}
+
+			// the expected yield is the chance to produce (0 for non-resource tiles) -> roll < p * 2^32 happens with probability p
+			const double threshold = static_cast<double>(tile->getExpectedYield()) * 4294967296.0;
+			if (static_cast<double>(this->productionRolls[i]) >= threshold) {
 				continue;
 			}
 
-			const auto tileIds = this->getSettlementTiles(*settlement);
-			for (size_t tileId : tileIds) {
-				const TileHandle tile = this->gameState.getMap().getTile(tileId);
-				if (tile->givesResourceThisTurn(this->rng)) {
-					player.addResources(tile->getType(), 1); // TODO: make amount configurable -> i.e. in settlers of catan a town gives 2 resources
+			for (const ProductionTable::Share& share : producingTiles[i].shares) {
+				if (share.playerId < this->productionIncome.size()) {
+					this->productionIncome[share.playerId][tile->getType()] += share.multiplier; // TODO: make amount configurable -> i.e. in settlers of catan a town gives 2 resources
 				}
 			}
 		}
+
+		this->beginAction();
+		for (size_t playerId = 0; playerId < this->productionIncome.size(); ++playerId) {
+			if (this->productionIncome[playerId].isEmpty()) {
+				continue;
+			}
+			GameCommand command;
+			command.type = GameCommand::Type::ADD_RESOURCES;
+			command.playerId = playerId;
+			command.resources = this->productionIncome[playerId];
+			this->record(command);
+		}
 	}
 
 
@@ -98,11 +112,14 @@ namespace df {
 		Graph& map = this->gameState.getMap();
 
 		try {
-			TileHandle tile = map.getTile(tileId);
+			map.getTile(tileId); // throws for invalid tiles
 
 			if (!player.isTileExplored(tileId)) {
-				tile->addVisibleForPlayers(player.getId());
-				player.exploreTile(tileId);
+				GameCommand command;
+				command.type = GameCommand::Type::EXPLORE_TILE;
+				command.playerId = player.getId();
+				command.targetId = tileId;
+				this->record(command);
 			}
 		} catch (const std::exception&) {
 		} // invalid tile -> ignore
@@ -149,7 +166,9 @@ namespace df {
 			return false;
 		}
 
+		this->beginAction();
 		this->exploreTile(*player, targetTileId);
+		if (this->replay) this->replay->recordMoveHero(playerId, targetTileId);
 
 		return true; // success
 	}
@@ -157,176 +176,46 @@ namespace df {
 
 	bool GameController::canBuildSettlement(size_t playerId, size_t vertexId) const {
 		(void)playerId; // unused for now - simplified building rules
-		const Graph& map = this->gameState.getMap();
-		try {
-			// Find vertex by ID (not index)
-			VertexHandle vertex = map.findVertexById(vertexId);
-			if (!vertex) {
-				return false;
-			}
-
-			// Only check if vertex already has a settlement
-			if (vertex->hasSettlement()) {
-				return false;
-			}
-
-			// CRITICAL FIX: Check ALL vertices that share the same physical location (same set of tiles)
-			// This prevents building multiple settlements on the same physical vertex due to duplicate vertex IDs
-			// Only perform this check if the vertex has multiple tiles (indicating it's a shared vertex)
-			const auto tilesOpt = map.getVertexTiles(vertex);
-			if (tilesOpt) {
-				// Get the set of tile IDs that this vertex is connected to
-				std::unordered_set<size_t> vertexTileIds;
-				for (const auto& tile : *tilesOpt) {
-					if (tile && tile->getId() != SIZE_MAX) {
-						vertexTileIds.insert(tile->getId());
-					}
-				}
-
-				// Only check for duplicates if this vertex has multiple tiles (shared vertex)
-				// Single-tile vertices are edge cases and don't need this check
-				if (vertexTileIds.size() > 1) {
-					// Only check vertices that already have settlements (optimization and safety)
-					// Check all vertices in the graph to see if any other vertex with a settlement shares the same tiles
-					for (size_t i = 0; i < map.getVertexCount(); ++i) {
-						VertexHandle otherVertex = map.getVertex(i);
-						if (!otherVertex || otherVertex->getId() == vertexId || !otherVertex->hasSettlement()) {
-							continue; // Skip if no settlement - no conflict possible
-						}
-
-						const auto otherTilesOpt = map.getVertexTiles(otherVertex);
-						if (!otherTilesOpt) continue;
-
-						// Check if this vertex shares the same set of tiles
-						std::unordered_set<size_t> otherTileIds;
-						for (const auto& tile : *otherTilesOpt) {
-							if (tile && tile->getId() != SIZE_MAX) {
-								otherTileIds.insert(tile->getId());
-							}
-						}
-
-						// If the tile sets match exactly (same size and same tiles), they're at the same physical location
-						if (otherTileIds.size() == vertexTileIds.size() && vertexTileIds == otherTileIds) {
-							fmt::println("[GameController] canBuildSettlement: vertex {} shares {} tiles with vertex {} which has a settlement", 
-								vertexId, vertexTileIds.size(), otherVertex->getId());
-							return false; // Another vertex at the same location already has a settlement
-						}
-					}
-				}
-			}
-
-			// Also check that no adjacent vertices have settlements (basic rule)
-			if (this->doesVertexHaveNeighborSettlements(vertexId)) {
-				return false;
-			}
-			return true;
-		} catch (const std::exception&) {
-			return false;
-		}
+		// the map tracks occupied vertices and their neighbours (distance rule) -> O(1), no search over the vertices
+		return this->gameState.getMap().isSettlementAllowed(vertexId);
 	}
 
 
-	bool GameController::buildSettlement(size_t playerId, size_t vertexId, const std::vector<int>& buildingCost) {
+	bool GameController::buildSettlement(size_t playerId, size_t vertexId, const ResourceBundle& buildingCost) {
 		if (!this->canBuildSettlement(playerId, vertexId)) {
-			fmt::println("[GameController] buildSettlement failed: canBuildSettlement returned false");
+			DF_LOG_DEBUG(GAME, "buildSettlement failed: canBuildSettlement returned false");
 			return false;
 		}
 
 		Player* player = this->getPlayerbyId(playerId);
 		if (!player) {
-			fmt::println("[GameController] buildSettlement failed: player {} not found", playerId);
+			DF_LOG_DEBUG(GAME, "buildSettlement failed: player {} not found", playerId);
 			return false;
 		}
-		if (!this->hasEnoughResources(*player, buildingCost)) {
-			fmt::println("[GameController] buildSettlement failed: player {} does not have enough resources", playerId);
+		if (!player->hasResources(buildingCost)) {
+			DF_LOG_DEBUG(GAME, "buildSettlement failed: player {} does not have enough resources", playerId);
 			return false;
 		}
 
-		Graph& map = this->gameState.getMap();
 		// Tutorial
 		auto* step = this->gameState.getCurrentTutorialStep();
 
 		try {
-			// Find vertex by ID (not index) - vertexId is the ID stored in the Vertex object
-			VertexHandle vertex = map.findVertexById(vertexId);
-
-			if (!vertex) {
-				fmt::println("[GameController] buildSettlement failed: vertex {} not found in map", vertexId);
-				return false; // Vertex with this ID not found
-			}
-
-			// Double-check vertex doesn't already have a settlement (race condition protection)
-			if (vertex->hasSettlement()) {
-				fmt::println("[GameController] buildSettlement failed: vertex {} already has a settlement", vertexId);
-				return false;
-			}
-
-			// CRITICAL FIX: Check ALL vertices that share the same physical location (same set of tiles)
-			// This prevents building multiple settlements on the same physical vertex due to duplicate vertex IDs
-			const auto tilesOpt = map.getVertexTiles(vertex);
-			if (tilesOpt) {
-				// Get the set of tile IDs that this vertex is connected to
-				std::unordered_set<size_t> vertexTileIds;
-				for (const auto& tile : *tilesOpt) {
-					if (tile && tile->getId() != SIZE_MAX) {
-						vertexTileIds.insert(tile->getId());
-					}
-				}
-
-				// Only check for duplicates if this vertex has multiple tiles (shared vertex)
-				// Single-tile vertices are edge cases and don't need this check
-				if (vertexTileIds.size() > 1) {
-					// Only check vertices that already have settlements (optimization and safety)
-					// Check all vertices in the graph to see if any other vertex with a settlement shares the same tiles
-					for (size_t i = 0; i < map.getVertexCount(); ++i) {
-						VertexHandle otherVertex = map.getVertex(i);
-						if (!otherVertex || otherVertex->getId() == vertexId || !otherVertex->hasSettlement()) {
-							continue; // Skip if no settlement - no conflict possible
-						}
-
-						const auto otherTilesOpt = map.getVertexTiles(otherVertex);
-						if (!otherTilesOpt) continue;
-
-						// Check if this vertex shares the same set of tiles
-						std::unordered_set<size_t> otherTileIds;
-						for (const auto& tile : *otherTilesOpt) {
-							if (tile && tile->getId() != SIZE_MAX) {
-								otherTileIds.insert(tile->getId());
-							}
-						}
-
-						// If the tile sets match exactly (same size and same tiles), they're at the same physical location
-						if (otherTileIds.size() == vertexTileIds.size() && vertexTileIds == otherTileIds) {
-							fmt::println("[GameController] buildSettlement failed: vertex {} shares {} tiles with vertex {} which has a settlement", 
-								vertexId, vertexTileIds.size(), otherVertex->getId());
-							return false;
-						}
-					}
-				}
-			}
-
-			size_t newSettlementId = 0;
-			const auto& existingSettlements = this->gameState.getSettlements();
-			if (!existingSettlements.empty()) {
-				size_t maxId = 0;
-				for (const auto& s : existingSettlements) {
-					if (s && s->getId() > maxId) {
-						maxId = s->getId();
-					}
-				}
-				newSettlementId = maxId + 1;
-			}
-
-			// TODO: rethink ownership of settlement
-			auto newSettlement = std::make_shared<Settlement>(newSettlementId, playerId, vertexId, buildingCost);
+			// canBuildSettlement() made sure the vertex exists and is free
+			const size_t newSettlementId = this->gameState.getNextSettlementId();
 
-			vertex->setSettlementId(newSettlementId);
-			this->gameState.addSettlement(newSettlement);
-			player->addSettlement(newSettlement->getId());
+			GameCommand command;
+			command.type = GameCommand::Type::BUILD_SETTLEMENT;
+			command.playerId = playerId;
+			command.targetId = vertexId;
+			command.objectId = newSettlementId;
+			command.resources = buildingCost;
 
-			this->chargeResourceCost(*player, buildingCost);
+			this->beginAction();
+			this->record(command);
+			if (this->replay) this->replay->recordBuildSettlement(playerId, vertexId, buildingCost);
 
-			fmt::println("[GameController] buildSettlement succeeded: settlement {} built at vertex {} for player {}", newSettlementId, vertexId, playerId);
+			DF_LOG_DEBUG(GAME, "buildSettlement succeeded: settlement {} built at vertex {} for player {}", newSettlementId, vertexId, playerId);
 			// Finish Tutorial if step is BUILD_SETTLEMENT
 			if (step && step->id == TutorialStepId::BUILD_SETTLEMENT) {
 				this->gameState.completeCurrentTutorialStep();
@@ -335,7 +224,7 @@ namespace df {
 			return true;
 
 		} catch (const std::exception& e) {
-			fmt::println("[GameController] buildSettlement failed: exception - {}", e.what());
+			DF_LOG_DEBUG(GAME, "buildSettlement failed: exception - {}", e.what());
 			return false;
 		}
 	}
@@ -344,187 +233,49 @@ namespace df {
 	// TODO: validate this in edge class
 	bool GameController::canBuildRoad(size_t playerId, size_t edgeId) const {
 		(void)playerId; // unused for now - simplified building rules
-		const Graph& map = this->gameState.getMap();
-
-		try {
-			// Find edge by ID (not index)
-			EdgeHandle edge = map.findEdgeById(edgeId);
-			if (!edge) {
-				return false;
-			}
-
-			// Only check if edge already has a road
-			if (edge->hasRoad()) {
-				return false;
-			}
-
-			// CRITICAL FIX: Check ALL edges that share the same physical location (same two vertices)
-			// This prevents building multiple roads on the same physical edge due to duplicate edge IDs
-			// This is a safeguard check - if it fails for any reason, we still allow building
-			try {
-				const auto verticesOpt = map.getEdgeVertices(edge);
-				if (verticesOpt) {
-					// Get the two vertex IDs that this edge connects
-					std::unordered_set<size_t> edgeVertexIds;
-					for (const auto& vertex : *verticesOpt) {
-						if (vertex && vertex->getId() != SIZE_MAX) {
-							edgeVertexIds.insert(vertex->getId());
-						}
-					}
-
-					// Only check for duplicates if this edge connects exactly two valid vertices (shared edge)
-					// If it doesn't have 2 vertices, we skip the duplicate check and allow building
-					if (edgeVertexIds.size() == 2) {
-						// Only check edges that already have roads (optimization and safety)
-						// This allows the first road to be built without any checks
-						for (size_t i = 0; i < map.getEdgeCount(); ++i) {
-							EdgeHandle otherEdge = map.getEdge(i);
-							if (!otherEdge || otherEdge->getId() == edgeId || !otherEdge->hasRoad()) {
-								continue; // Skip if no road - no conflict possible
-							}
-
-							const auto otherVerticesOpt = map.getEdgeVertices(otherEdge);
-							if (!otherVerticesOpt) continue;
-
-							// Check if this edge connects the same two vertices
-							std::unordered_set<size_t> otherVertexIds;
-							for (const auto& vertex : *otherVerticesOpt) {
-								if (vertex && vertex->getId() != SIZE_MAX) {
-									otherVertexIds.insert(vertex->getId());
-								}
-							}
-
-							// If the vertex sets match exactly (same two vertices), they're at the same physical location
-							if (otherVertexIds.size() == 2 && edgeVertexIds == otherVertexIds) {
-								fmt::println("[GameController] canBuildRoad: edge {} connects same vertices as edge {} which has a road", 
-									edgeId, otherEdge->getId());
-								return false; // Another edge at the same location already has a road
-							}
-						}
-					}
-					// If edgeVertexIds.size() != 2, we skip the duplicate check and allow building
-				}
-				// If verticesOpt is nullopt, we also allow building (edge case)
-			} catch (const std::exception& e) {
-				// If the duplicate check fails for any reason, we still allow building
-				// This is a safeguard check and shouldn't block legitimate road building
-				fmt::println("[GameController] canBuildRoad: duplicate check failed for edge {}: {}, allowing building", edgeId, e.what());
-			}
-
-			return true;
-		} catch (const std::exception&) {
-			return false;
-		}
+		const EdgeHandle edge = this->gameState.getMap().findEdgeById(edgeId);
+		return edge && !edge->hasRoad();
 	}
 
 
-	bool GameController::buildRoad(size_t playerId, size_t edgeId, RoadLevel level, const std::vector<int>& buildingCost) {
+	bool GameController::buildRoad(size_t playerId, size_t edgeId, RoadLevel level, const ResourceBundle& buildingCost) {
 		if (!this->canBuildRoad(playerId, edgeId)) {
-			fmt::println("[GameController] buildRoad failed: canBuildRoad returned false");
+			DF_LOG_DEBUG(GAME, "buildRoad failed: canBuildRoad returned false");
 			return false;
 		}
 
 		Player* player = this->getPlayerbyId(playerId);
 		if (!player) {
-			fmt::println("[GameController] buildRoad failed: player {} not found", playerId);
+			DF_LOG_DEBUG(GAME, "buildRoad failed: player {} not found", playerId);
 			return false;
 		}
 
-		if (!this->hasEnoughResources(*player, buildingCost)) {
-			fmt::println("[GameController] buildRoad failed: player {} does not have enough resources", playerId);
+		if (!player->hasResources(buildingCost)) {
+			DF_LOG_DEBUG(GAME, "buildRoad failed: player {} does not have enough resources", playerId);
 			return false;
 		}
 
-		Graph& map = this->gameState.getMap();
 		// Tutorial
 		auto* step = this->gameState.getCurrentTutorialStep();
 		try {
-			// Find edge by ID (not index)
-			EdgeHandle edge = map.findEdgeById(edgeId);
-			if (!edge) {
-				fmt::println("[GameController] buildRoad failed: edge {} not found in map", edgeId);
-				return false;
-			}
-
-			// Double-check edge doesn't already have a road
-			if (edge->hasRoad()) {
-				fmt::println("[GameController] buildRoad failed: edge {} already has a road", edgeId);
-				return false;
-			}
-
-			// CRITICAL FIX: Check ALL edges that share the same physical location (same two vertices)
-			// This prevents building multiple roads on the same physical edge due to duplicate edge IDs
-			// This is a safeguard check - if it fails for any reason, we still allow building
-			try {
-				const auto verticesOpt = map.getEdgeVertices(edge);
-				if (verticesOpt) {
-					// Get the two vertex IDs that this edge connects
-					std::unordered_set<size_t> edgeVertexIds;
-					for (const auto& vertex : *verticesOpt) {
-						if (vertex && vertex->getId() != SIZE_MAX) {
-							edgeVertexIds.insert(vertex->getId());
-						}
-					}
-
-					// Only check for duplicates if this edge connects exactly two valid vertices (shared edge)
-					// If it doesn't have 2 vertices, we skip the duplicate check and allow building
-					if (edgeVertexIds.size() == 2) {
-						// Only check edges that already have roads (optimization and safety)
-						// This allows the first road to be built without any checks
-						for (size_t i = 0; i < map.getEdgeCount(); ++i) {
-							EdgeHandle otherEdge = map.getEdge(i);
-							if (!otherEdge || otherEdge->getId() == edgeId || !otherEdge->hasRoad()) {
-								continue; // Skip if no road - no conflict possible
-							}
-
-							const auto otherVerticesOpt = map.getEdgeVertices(otherEdge);
-							if (!otherVerticesOpt) continue;
-
-							// Check if this edge connects the same two vertices
-							std::unordered_set<size_t> otherVertexIds;
-							for (const auto& vertex : *otherVerticesOpt) {
-								if (vertex && vertex->getId() != SIZE_MAX) {
-									otherVertexIds.insert(vertex->getId());
-								}
-							}
-
-							// If the vertex sets match exactly (same two vertices), they're at the same physical location
-							if (otherVertexIds.size() == 2 && edgeVertexIds == otherVertexIds) {
-								fmt::println("[GameController] buildRoad failed: edge {} connects same vertices as edge {} which has a road", 
-									edgeId, otherEdge->getId());
-								return false;
-							}
-						}
-					}
-					// If edgeVertexIds.size() != 2, we skip the duplicate check and allow building
-				}
-				// If verticesOpt is nullopt, we also allow building (edge case)
-			} catch (const std::exception& e) {
-				// If the duplicate check fails for any reason, we still allow building
-				// This is a safeguard check and shouldn't block legitimate road building
-				fmt::println("[GameController] buildRoad: duplicate check failed for edge {}: {}, allowing building", edgeId, e.what());
-			}
-
-			// generate unique road id -> use the max existing id + 1, or 0 if no roads exist
-			size_t roadId = 0;
-			const auto& existingRoads = this->gameState.getRoads();
-			if (!existingRoads.empty()) {
-				size_t maxId = 0;
-				for (const auto& r : existingRoads)
-					if (r && r->getId() > maxId)
-						maxId = r->getId();
-				roadId = maxId + 1;
-			}
+			// canBuildRoad() made sure the edge exists and is free
 
-			auto road = std::make_shared<Road>(roadId, playerId, edgeId, level, buildingCost);
+			// unique road id -> one past the largest id in use
+			const size_t roadId = this->gameState.getNextRoadId();
 
-			edge->setRoadId(roadId);
-			this->gameState.addRoad(road);
-			player->addRoad(road->getId());
+			GameCommand command;
+			command.type = GameCommand::Type::BUILD_ROAD;
+			command.playerId = playerId;
+			command.targetId = edgeId;
+			command.objectId = roadId;
+			command.roadLevel = level;
+			command.resources = buildingCost;
 
-			this->chargeResourceCost(*player, buildingCost);
+			this->beginAction();
+			this->record(command);
+			if (this->replay) this->replay->recordBuildRoad(playerId, edgeId, level, buildingCost);
 
-			fmt::println("[GameController] buildRoad succeeded: road {} built at edge {} for player {}", roadId, edgeId, playerId);
+			DF_LOG_DEBUG(GAME, "buildRoad succeeded: road {} built at edge {} for player {}", roadId, edgeId, playerId);
 			// Finish Tutorial if step is BUILD_ROAD
 			if (step && step->id == TutorialStepId::BUILD_ROAD) {
 				this->gameState.completeCurrentTutorialStep();
@@ -533,85 +284,310 @@ namespace df {
 			return true;
 
 		} catch (const std::exception& e) {
-			fmt::println("[GameController] buildRoad failed: exception - {}", e.what());
+			DF_LOG_DEBUG(GAME, "buildRoad failed: exception - {}", e.what());
 			return false;
 		}
 	}
 
 
-	// TODO: move this functionality to settlement class
-	std::vector<size_t> GameController::getSettlementTiles(const Settlement& settlement) const {
-		std::vector<size_t> tileIds;
-		const Graph& map = this->gameState.getMap();
-		try {
-			// Find vertex by ID (not index)
-			VertexHandle vertex = nullptr;
-			for (size_t i = 0; i < map.getVertexCount(); ++i) {
-				if (map.getVertex(i)->getId() == settlement.getVertexId()) {
-					vertex = map.getVertex(i);
-					break;
-				}
+	bool GameController::canUndo() const {
+		if (this->appliedActions == 0) {
+			return false;
+		}
+		// turn boundaries are final for players, only search (undoTo) goes back beyond them
+		const GameCommand::Type type = this->commands[this->actionStarts[this->appliedActions - 1]].type;
+		return type != GameCommand::Type::END_TURN && type != GameCommand::Type::ADD_RESOURCES;
+	}
+
+
+	bool GameController::undo() {
+		if (!this->canUndo()) {
+			return false;
+		}
+
+		const size_t actionStart = this->actionStarts[--this->appliedActions];
+		while (this->appliedCommands > actionStart) {
+			this->revert(this->commands[--this->appliedCommands]);
+		}
+		if (this->replay) this->replay->recordUndo();
+		return true;
+	}
+
+
+	bool GameController::canRedo() const {
+		return this->appliedActions < this->actionStarts.size();
+	}
+
+
+	bool GameController::redo() {
+		if (!this->canRedo()) {
+			return false;
+		}
+
+		this->appliedActions++;
+		const size_t actionEnd = this->appliedActions < this->actionStarts.size() ? this->actionStarts[this->appliedActions] : this->commands.size();
+		while (this->appliedCommands < actionEnd) {
+			this->apply(this->commands[this->appliedCommands++]);
+		}
+		if (this->replay) this->replay->recordRedo();
+		return true;
+	}
+
+
+	void GameController::clearHistory() {
+		this->commands.clear();
+		this->actionStarts.clear();
+		this->appliedCommands = 0;
+		this->appliedActions = 0;
+		this->actionPending = false;
+		this->droppedCommands = 0;
+	}
+
+
+	void GameController::undoTo(size_t mark) {
+		if (mark < this->droppedCommands) {
+			DF_LOG_WARNING(GAME, "undoTo({}): the history before command {} was trimmed", mark, this->droppedCommands);
+		}
+		const size_t target = mark > this->droppedCommands ? mark - this->droppedCommands : 0;
+		while (this->appliedCommands > target) {
+			this->revert(this->commands[--this->appliedCommands]);
+		}
+		while (this->appliedActions > 0 && this->actionStarts[this->appliedActions - 1] >= this->appliedCommands) {
+			this->appliedActions--;
+		}
+		if (this->replay) this->replay->recordUndoTo(mark);
+	}
+
+
+	void GameController::trimHistory() {
+		if (this->commands.size() <= 2 * MAX_HISTORY_COMMANDS) {
+			return;
+		}
+
+		// keep the newest MAX_HISTORY_COMMANDS commands, rounded back to the start of a turn so no turn is cut in half
+		const size_t keepFrom = this->commands.size() - MAX_HISTORY_COMMANDS;
+		size_t firstAction = 0;
+		for (size_t action = 0; action < this->actionStarts.size(); action++) {
+			const size_t start = this->actionStarts[action];
+			if (start > keepFrom) {
+				break;
 			}
-			if (!vertex) {
-				return tileIds;
+			if (start > 0 && this->commands[start - 1].type == GameCommand::Type::END_TURN) {
+				firstAction = action;
 			}
+		}
+		const size_t dropped = firstAction < this->actionStarts.size() ? this->actionStarts[firstAction] : 0;
+		if (dropped == 0) {
+			return;
+		}
 
-			const VertexHandle vh = vertex;
-			auto tilesOpt = map.getVertexTiles(vh);
-			if (!tilesOpt)
-				return tileIds; // std::nullopt
+		this->commands.erase(this->commands.begin(), this->commands.begin() + static_cast<std::ptrdiff_t>(dropped));
+		this->actionStarts.erase(this->actionStarts.begin(), this->actionStarts.begin() + static_cast<std::ptrdiff_t>(firstAction));
+		for (size_t& start : this->actionStarts) {
+			start -= dropped;
+		}
+		this->appliedCommands -= dropped;
+		this->appliedActions -= firstAction;
+		this->droppedCommands += dropped;
+	}
 
-			for (const auto& tile : *tilesOpt) {
-				if (tile->getId() != SIZE_MAX) {
-					tileIds.push_back(tile->getId());
-				}
-			}
-		} catch (const std::exception&) {
-		} // ignore invalid vertex
 
-		return tileIds;
+	void GameController::record(const GameCommand& command) {
+		// a new command makes the undone ones unreachable
+		this->commands.resize(this->appliedCommands);
+		this->actionStarts.resize(this->appliedActions);
+
+		this->apply(command);
+
+		if (this->actionPending) {
+			this->actionStarts.push_back(this->appliedCommands);
+			this->appliedActions++;
+			this->actionPending = false;
+		}
+		this->commands.push_back(command);
+		this->appliedCommands++;
 	}
 
 
-	// TODO: discuss where to put this...
-	// Put this into vertex class? -> or better in settlement class as "hasNeighbourSettlement()"?!
-	bool GameController::doesVertexHaveNeighborSettlements(size_t vertexId) const {
+	void GameController::apply(const GameCommand& command) {
+		Player* player = this->getPlayerbyId(command.playerId);
+		Graph& map = this->gameState.getMap();
+
+		switch (command.type) {
+		case GameCommand::Type::BUILD_SETTLEMENT: {
+			const std::uint64_t previousRevision = map.getOccupancyRevision();
+			this->gameState.addSettlement(Settlement(command.objectId, command.playerId, command.targetId, command.resources)); // also places it on the map
+			this->updateLegalMovesAroundVertex(command.targetId, previousRevision);
+			if (player) {
+				player->addSettlement(command.objectId);
+				player->removeResources(command.resources);
+			}
+		} break;
+		case GameCommand::Type::BUILD_ROAD: {
+			const std::uint64_t previousRevision = map.getOccupancyRevision();
+			this->gameState.addRoad(Road(command.objectId, command.playerId, command.targetId, command.roadLevel, command.resources)); // also places it on the map
+			this->updateLegalMovesAtEdge(command.targetId, previousRevision);
+			if (player) {
+				player->addRoad(command.objectId);
+				player->removeResources(command.resources);
+			}
+		} break;
+		case GameCommand::Type::EXPLORE_TILE:
+			map.getTile(command.targetId)->addVisibleForPlayers(command.playerId);
+			if (player) {
+				player->exploreTile(command.targetId);
+			}
+			break;
+		case GameCommand::Type::ADD_RESOURCES:
+			if (player) {
+				player->addResources(command.resources);
+			}
+			break;
+		case GameCommand::Type::END_TURN:
+			// TODO: maybe add some "setNextTurn()" etc. functions
+			this->gameState.setCurrentPlayerId((command.playerId + 1) % this->gameState.getPlayerCount());
+			this->gameState.setTurnCount(this->gameState.getTurnCount() + 1);
+			if (command.endsRound) {
+				this->gameState.setRoundNumber(this->gameState.getRoundNumber() + 1);
+			}
+			break;
+		}
+	}
+
+
+	void GameController::revert(const GameCommand& command) {
+		Player* player = this->getPlayerbyId(command.playerId);
+		Graph& map = this->gameState.getMap();
+
+		switch (command.type) {
+		case GameCommand::Type::BUILD_SETTLEMENT: {
+			const std::uint64_t previousRevision = map.getOccupancyRevision();
+			this->gameState.removeSettlement(command.objectId);
+			this->updateLegalMovesAroundVertex(command.targetId, previousRevision);
+			if (player) {
+				player->removeSettlement(command.objectId);
+				player->addResources(command.resources);
+			}
+		} break;
+		case GameCommand::Type::BUILD_ROAD: {
+			const std::uint64_t previousRevision = map.getOccupancyRevision();
+			this->gameState.removeRoad(command.objectId);
+			this->updateLegalMovesAtEdge(command.targetId, previousRevision);
+			if (player) {
+				player->removeRoad(command.objectId);
+				player->addResources(command.resources);
+			}
+		} break;
+		case GameCommand::Type::EXPLORE_TILE:
+			map.getTile(command.targetId)->removeVisibleForPlayers(command.playerId);
+			if (player) {
+				player->forgetTile(command.targetId);
+			}
+			break;
+		case GameCommand::Type::ADD_RESOURCES:
+			if (player) {
+				player->removeResources(command.resources);
+			}
+			break;
+		case GameCommand::Type::END_TURN:
+			this->gameState.setCurrentPlayerId(command.playerId);
+			this->gameState.setTurnCount(this->gameState.getTurnCount() - 1);
+			if (command.endsRound) {
+				this->gameState.setRoundNumber(this->gameState.getRoundNumber() - 1);
+			}
+			break;
+		}
+	}
+
+
+	const BitMask& GameController::getLegalSettlementVertices(size_t playerId) {
+		return this->getLegalMoves(playerId).settlementVertices;
+	}
+
+
+	const BitMask& GameController::getLegalRoadEdges(size_t playerId) {
+		return this->getLegalMoves(playerId).roadEdges;
+	}
+
+
+	GameController::LegalMoves& GameController::getLegalMoves(size_t playerId) {
+		if (playerId >= this->legalMoves.size()) {
+			this->legalMoves.resize(playerId + 1);
+		}
+
+		LegalMoves& moves = this->legalMoves[playerId];
 		const Graph& map = this->gameState.getMap();
+		if (moves.occupancyRevision == map.getOccupancyRevision()) {
+			return moves;
+		}
 
-		try {
-			// Find vertex by ID (not index)
-			VertexHandle vertex = map.findVertexById(vertexId);
-			if (!vertex) {
-				return true;
-			}
+		// one pass over vertices and edges
+		const auto& vertices = map.getVertices();
+		moves.settlementVertices.reset(vertices.size());
+		for (size_t i = 0; i < vertices.size(); ++i) {
+			moves.settlementVertices.set(i, this->canBuildSettlement(playerId, vertices[i]->getId()));
+		}
 
-			const auto edgesOpt = map.getVertexEdges(vertex);
-			if (!edgesOpt)
-				return false; // std::nullopt
+		const auto& edges = map.getEdges();
+		moves.roadEdges.reset(edges.size());
+		for (size_t i = 0; i < edges.size(); ++i) {
+			moves.roadEdges.set(i, this->canBuildRoad(playerId, edges[i]->getId()));
+		}
 
-			for (const auto& edge : *edgesOpt) {
-				if (!edge || edge->getId() == SIZE_MAX) {
-					continue;
-				}
+		moves.occupancyRevision = map.getOccupancyRevision();
+		return moves;
+	}
 
-				const auto verticesOpt = map.getEdgeVertices(edge);
-				if (!verticesOpt)
-					return false; // std::nullopt
 
-				for (const auto& neighbour : *verticesOpt) {
-					if (!neighbour || neighbour->getId() == SIZE_MAX || neighbour->getId() == vertexId) {
-						continue;
-					}
-					if (neighbour->hasSettlement()) {
-						return true;
+	void GameController::updateLegalMovesAroundVertex(size_t vertexId, std::uint64_t previousRevision) {
+		const Graph& map = this->gameState.getMap();
+		const VertexHandle vertex = map.findVertexById(vertexId);
+		if (!vertex) {
+			return;
+		}
+
+		// a settlement only changes the legality of its vertex and the neighbouring vertices (distance rule)
+		std::array<VertexHandle, 4> affected = { vertex, nullptr, nullptr, nullptr };
+		if (const auto edges = map.getVertexEdges(vertex)) {
+			size_t count = 1;
+			for (const auto& edge : *edges) {
+				if (!edge) continue;
+				const auto edgeVertices = map.getEdgeVertices(edge);
+				if (!edgeVertices) continue;
+				for (const auto& neighbour : *edgeVertices) {
+					if (neighbour && neighbour != vertex && count < affected.size()) {
+						affected[count++] = neighbour;
 					}
 				}
 			}
-		} catch (const std::exception&) {
-			return true;
 		}
 
-		return false;
+		for (size_t playerId = 0; playerId < this->legalMoves.size(); ++playerId) {
+			LegalMoves& moves = this->legalMoves[playerId];
+			if (moves.occupancyRevision != previousRevision) {
+				continue;
+			}
+			for (const VertexHandle affectedVertex : affected) {
+				if (!affectedVertex) continue;
+				moves.settlementVertices.set(map.indexOfVertex(affectedVertex->getId()), this->canBuildSettlement(playerId, affectedVertex->getId()));
+			}
+			moves.occupancyRevision = map.getOccupancyRevision();
+		}
+	}
+
+
+	void GameController::updateLegalMovesAtEdge(size_t edgeId, std::uint64_t previousRevision) {
+		const Graph& map = this->gameState.getMap();
+		const size_t edgeIndex = map.indexOfEdge(edgeId);
+
+		for (size_t playerId = 0; playerId < this->legalMoves.size(); ++playerId) {
+			LegalMoves& moves = this->legalMoves[playerId];
+			if (moves.occupancyRevision != previousRevision) {
+				continue;
+			}
+			moves.roadEdges.set(edgeIndex, this->canBuildRoad(playerId, edgeId));
+			moves.occupancyRevision = map.getOccupancyRevision();
+		}
 	}
 
 
@@ -623,13 +599,7 @@ namespace df {
 
 		try {
 			// Find edge by ID (not index)
-			EdgeHandle edge = nullptr;
-			for (size_t i = 0; i < map.getEdgeCount(); ++i) {
-				if (map.getEdge(i)->getId() == edgeId) {
-					edge = map.getEdge(i);
-					break;
-				}
-			}
+			EdgeHandle edge = map.findEdgeById(edgeId);
 			if (!edge) {
 				return false;
 			}
@@ -644,7 +614,7 @@ namespace df {
 					const auto settlementId = vertex->getSettlementId();
 					if (settlementId.has_value()) {
 
-						const Settlement* settlement = this->findSettlementById(settlementId.value());
+						const Settlement* settlement = this->gameState.findSettlement(settlementId.value());
 						if (settlement && settlement->getPlayerId() == playerId) {
 							return true;
 						}
@@ -664,7 +634,7 @@ namespace df {
 						continue;
 					}
 
-					const Road* road = this->findRoadById(roadId.value());
+					const Road* road = this->gameState.findRoad(roadId.value());
 					if (road && road->getPlayerId() == playerId) {
 						return true;
 					}
@@ -677,63 +647,4 @@ namespace df {
 		return false;
 	}
 
-
-	// TODO: changing buildingCost to a map (as is planned), would make this function rather obsolete
-	bool GameController::hasEnoughResources(Player& player, const std::vector<int>& buildingCost) {
-		if (buildingCost.empty()) {
-			return true;
-		} // building is free
-
-		std::map<types::TileType, int> requirements;
-		for (size_t i = 0; i < buildingCost.size() && i < static_cast<size_t>(types::TileType::COUNT); ++i) {
-			if (buildingCost[i] > 0) {
-				requirements[static_cast<types::TileType>(i)] = buildingCost[i];
-			}
-		}
-
-		return (requirements.empty() || player.hasResources(requirements));
-	}
-
-
-	// TODO: when buildingCost is a map, this function would not be necessary anymore
-	void GameController::chargeResourceCost(Player& player, const std::vector<int>& buildingCost) {
-		if (buildingCost.empty()) {
-			return;
-		} // building is free -> nothing charged
-
-		for (size_t i = 0; i < buildingCost.size() && i < static_cast<size_t>(types::TileType::COUNT); ++i) {
-			if (buildingCost[i] > 0) {
-				player.removeResources(static_cast<types::TileType>(i), buildingCost[i]);
-			}
-		}
-	}
-
-
-	// util functions
-	const Road* GameController::findRoadById(size_t roadId) const {
-		const auto& roads = this->gameState.getRoads();
-
-		for (const auto& road : roads) {
-			if (road && road->getId() == roadId) {
-				return road.get();
-			}
-		}
-
-		return nullptr;
-	}
-
-
-	// util functions
-	const Settlement* GameController::findSettlementById(size_t settlementId) const {
-		const auto& settlements = this->gameState.getSettlements();
-
-		for (const auto& settlement : settlements) {
-			if (settlement && settlement->getId() == settlementId) {
-				return settlement.get();
-			}
-		}
-
-		return nullptr;
-	}
-
 } // namespace df
@@ -1,10 +1,15 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <random>
+#include <span>
 #include <vector>
 
+#include "bitMask.h"
+#include "gameCommand.h"
 #include "gamestate.h"
+#include "resourceBundle.h"
 #include "road.h"
 
 
@@ -13,40 +18,120 @@
 
 namespace df {
 
+    class Replay;
+
+
     /*
      * The GameController manages the high-level game flwo / mechanics.
      * Component specific responsibilities are handled by the corresponding classes (Tile, Hero, ...).
      */
     class GameController {
     public:
+        // TODO: This is just temporary... -> indexed by TileType
+        // Settlement: 1 WOOD, 1 CLAY, 1 GRASS
+        static constexpr ResourceBundle SETTLEMENT_COST = {{ 0, 0, 1, 1, 0, 0, 1, 0 }};
+        // Road: 1 WOOD
+        static constexpr ResourceBundle ROAD_COST = {{ 0, 0, 1, 0, 0, 0, 0, 0 }};
+        // 100 wood, 10 grass, 100 stone, 50 grain, 10 clay
+        static constexpr ResourceBundle STARTING_RESOURCES = {{ 0, 0, 100, 10, 100, 50, 10, 0 }};
+
         GameController() = default;
         ~GameController() = default;
         explicit GameController(GameState& state)
             : gameState(state), rng(std::random_device{}()) {};
+        // fixed seed -> the same moves give the same game (headless runs, tournaments)
+        GameController(GameState& state, std::uint32_t seed)
+            : gameState(state), rng(seed) {};
 
         GameState& getState() { return this->gameState; }
         const GameState& getState() const { return this->gameState; }
 
+        // every successful player action and every turn (with the GameState hash) is appended to the replay;
+        // nullptr stops recording. The replay must outlive the recording.
+        void setReplay(Replay* replay) { this->replay = replay; }
+
         Player* getCurrentPlayer();
         const Player* getCurrentPlayer() const;
 
         void startTurn();
         void endTurn();
 
-        void giveResourcesTo(Player& player);
+        // Rolls every tile of the production table once and pays all players with settlements next to the
+        // producing tiles. Cost depends on the number of settled tiles, not on the map size.
+        void distributeResources();
 
         bool moveHeroToTile(size_t playerId, size_t targetTileId);
 
         bool canBuildSettlement(size_t playerId, size_t vertexId) const;
-        bool buildSettlement(size_t playerId, size_t vertexId, const std::vector<int>& buildingCost);
+        bool buildSettlement(size_t playerId, size_t vertexId, const ResourceBundle& buildingCost);
 
         bool canBuildRoad(size_t playerId, size_t edgeId) const;
-        bool buildRoad(size_t playerId, size_t edgeId, RoadLevel level, const std::vector<int>& buildingCost);
+        bool buildRoad(size_t playerId, size_t edgeId, RoadLevel level, const ResourceBundle& buildingCost);
+
+        // All legal building spots of a player as dense masks: bit i <-> map.getVertices()[i] / map.getEdges()[i].
+        // Built in one pass over the map on first use, then updated incrementally by buildSettlement()/buildRoad().
+        // Any other change of the map is detected via Graph::getOccupancyRevision() and triggers a rebuild.
+        // Meant to be polled every frame (building preview, AI).
+        const BitMask& getLegalSettlementVertices(size_t playerId);
+        const BitMask& getLegalRoadEdges(size_t playerId);
+
+        // Every mutation above is recorded as GameCommands that can be reverted exactly. The commands of one
+        // public call (a build, a hero move, endTurn(), the production of startTurn()) form one action.
+        // Player undo: undo() takes back the last action of the current turn, ending the turn and the production
+        // can't be undone. redo() re-applies the last undone action, any new action drops the undone ones.
+        // Tutorial progress is not part of the history.
+        bool canUndo() const;
+        bool undo();
+        bool canRedo() const;
+        bool redo();
+        void clearHistory();
+
+        // Search: remember getHistoryMark() between two actions, try out moves, undoTo(mark) restores the state.
+        // The dice are not part of the state -> production after undoTo() is rolled again.
+        // endTurn() drops whole turns from the front once the history holds more than MAX_HISTORY_COMMANDS commands,
+        // marks stay valid for the newest MAX_HISTORY_COMMANDS commands, undoTo() stops at the oldest one that is kept.
+        static constexpr size_t MAX_HISTORY_COMMANDS = 1 << 16;
+        size_t getHistoryMark() const { return this->droppedCommands + this->appliedCommands; }
+        void undoTo(size_t mark);
+        std::span<const GameCommand> getHistory() const { return std::span(this->commands).first(this->appliedCommands); }
 
 
     private:
         GameState& gameState;
         std::mt19937 rng;
+        Replay* replay = nullptr;
+
+        struct LegalMoves {
+            BitMask settlementVertices;
+            BitMask roadEdges;
+            std::uint64_t occupancyRevision = UINT64_MAX; // map revision the masks belong to
+        };
+        std::vector<LegalMoves> legalMoves; // index = player id
+
+        // scratch buffers of distributeResources(), kept to avoid allocations per turn
+        std::vector<std::uint32_t> productionRolls;
+        std::vector<ResourceBundle> productionIncome;
+
+        LegalMoves& getLegalMoves(size_t playerId);
+        // only touch masks that were up to date before the build, the others are rebuilt on their next use
+        void updateLegalMovesAroundVertex(size_t vertexId, std::uint64_t previousRevision);
+        void updateLegalMovesAtEdge(size_t edgeId, std::uint64_t previousRevision);
+
+        std::vector<GameCommand> commands; // applied commands first, then the undone ones (redo)
+        size_t appliedCommands = 0;
+        std::vector<size_t> actionStarts; // index of the first command of every action
+        size_t appliedActions = 0;
+        bool actionPending = false; // the next recorded command starts a new action
+        size_t droppedCommands = 0; // trimmed from the front of the history, keeps the marks absolute
+
+        // the next record() starts a new action -> actions without any command don't exist
+        void beginAction() { this->actionPending = true; }
+        // applies the command and appends it to the history, dropping the undone commands
+        void record(const GameCommand& command);
+        // drops the oldest turns once the history is twice MAX_HISTORY_COMMANDS long -> amortized O(1) per command
+        void trimHistory();
+        void apply(const GameCommand& command);
+        void revert(const GameCommand& command);
 
         Player* getPlayerbyId(size_t playerId);
         const Player* getPlayerById(size_t playerId) const;
@@ -54,17 +139,7 @@ namespace df {
         void resetHeroMovement(Player& player);
         void exploreTile(Player& player, size_t tileId);
 
-        bool doesVertexHaveNeighborSettlements(size_t vertexId) const;
         bool doesEdgeConnectToPlayer(size_t playerId, size_t edgeId) const;
-
-        // returns ids of tiles touching the settlement -> TODO: move to settlement class
-        std::vector<size_t> getSettlementTiles(const Settlement& settlement) const;
-
-        bool hasEnoughResources(Player& player, const std::vector<int>& buildingCost);
-        void chargeResourceCost(Player& player, const std::vector<int>& buildingCost);
-
-        const Road* findRoadById(size_t roadId) const;
-        const Settlement* findSettlementById(size_t settlementId) const;
     };
 
 }
@@ -1,7 +1,12 @@
 #include "gamestate.h"
+#include "saveJournal.h"
+#include "utils/byteStream.h"
 #include "utils/worldNodeMapper.h"
+#include <cstdint>
 #include <fstream>
+#include <optional>
 #include <stdexcept>
+#include <utility>
 
 
 
@@ -9,6 +14,61 @@
 
 namespace df {
 
+    namespace {
+        // order dependent 64 bit hash of a sequence of words (splitmix64 finalizer per word)
+        struct StateHasher {
+            std::uint64_t value = 0x9e3779b97f4a7c15ull;
+
+            void add(std::uint64_t word) {
+                word += 0x9e3779b97f4a7c15ull;
+                word = (word ^ (word >> 30)) * 0xbf58476d1ce4e5b9ull;
+                word = (word ^ (word >> 27)) * 0x94d049bb133111ebull;
+                word ^= word >> 31;
+                this->value = (this->value ^ word) * 0x100000001b3ull;
+            }
+
+            void add(const ResourceBundle& bundle) {
+                for (const int amount : bundle.amounts) this->add(static_cast<std::uint64_t>(static_cast<std::uint32_t>(amount)));
+            }
+        };
+
+        // The checks of addSettlement()/addRoad() for all buildings of a save at once, so a load can fail before it
+        // changes anything. The buildings are placed on the map (which must not have any) and taken off again, the
+        // map is unchanged afterwards, also when this throws.
+        void checkBuildings(Graph& map, size_t playerCount, std::span<const Settlement> settlements, std::span<const Road> roads, const std::string& format) {
+            size_t placedSettlements = 0;
+            size_t placedRoads = 0;
+            const auto invalid = [&](const std::string& what) {
+                for (size_t i = 0; i < placedSettlements; ++i) map.removeSettlement(map.findVertexById(settlements[i].getVertexId()));
+                for (size_t i = 0; i < placedRoads; ++i) map.removeRoad(map.findEdgeById(roads[i].getEdgeId()));
+                return std::runtime_error("Invalid " + format + " save: " + what);
+            };
+
+            std::vector<bool> usedIds(map.getVertexCount(), false);
+            for (const Settlement& settlement : settlements) {
+                if (settlement.getId() >= usedIds.size() || usedIds[settlement.getId()]) throw invalid("settlement id " + std::to_string(settlement.getId()));
+                if (settlement.getPlayerId() >= playerCount) throw invalid("settlement player " + std::to_string(settlement.getPlayerId()));
+                const VertexHandle vertex = map.findVertexById(settlement.getVertexId());
+                if (!map.isSettlementAllowed(vertex) || !map.placeSettlement(vertex, settlement.getId())) {
+                    throw invalid("settlement vertex " + std::to_string(settlement.getVertexId()));
+                }
+                usedIds[settlement.getId()] = true;
+                placedSettlements++;
+            }
+            usedIds.assign(map.getEdgeCount(), false);
+            for (const Road& road : roads) {
+                if (road.getId() >= usedIds.size() || usedIds[road.getId()]) throw invalid("road id " + std::to_string(road.getId()));
+                if (road.getPlayerId() >= playerCount) throw invalid("road player " + std::to_string(road.getPlayerId()));
+                if (!map.placeRoad(map.findEdgeById(road.getEdgeId()), road.getId())) throw invalid("road edge " + std::to_string(road.getEdgeId()));
+                usedIds[road.getId()] = true;
+                placedRoads++;
+            }
+            for (const Settlement& settlement : settlements) map.removeSettlement(map.findVertexById(settlement.getVertexId()));
+            for (const Road& road : roads) map.removeRoad(map.findEdgeById(road.getEdgeId()));
+        }
+    }
+
+
     /**
      * Returns a pointer to the player with the given id.
      * Returns nullptr if the player id is not found.
@@ -36,19 +96,6 @@ namespace df {
     json GameState::serialize() const {
         json j;
 
-        fmt::println("Serializing Game state");
-        fmt::println("---------");
-        fmt::println("Map: {}", this->map.serialize().dump());
-        fmt::println("---------");
-        fmt::println("Players: {}", this->players.size());
-        fmt::println("---------");
-        fmt::println("Settlements: {}", this->settlements.size());
-        fmt::println("---------");
-        fmt::println("Roads: {}", this->roads.size());
-        fmt::println("---------");
-        fmt::println("Current player id: {}", this->currentPlayerId);
-        fmt::println("---------");
-
         // map
         j["map"] = this->map.serialize();
 
@@ -62,19 +109,15 @@ namespace df {
 
         // settlements
         json settlementsJson = json::array();
-        for (const auto& settlement : this->settlements) {
-            if (settlement) {
-                settlementsJson.push_back(settlement->serialize());
-            }
+        for (const Settlement& settlement : this->settlements.getValues()) {
+            settlementsJson.push_back(settlement.serialize());
         }
         j["settlements"] = settlementsJson;
 
         // roads
         json roadsJson = json::array();
-        for (const auto& road : this->roads) {
-            if (road) {
-                roadsJson.push_back(road->serialize());
-            }
+        for (const Road& road : this->roads.getValues()) {
+            roadsJson.push_back(road.serialize());
         }
         j["roads"] = roadsJson;
 
@@ -90,18 +133,18 @@ namespace df {
 
     /**
      * Deserializes the game state from the provided json object. This can be used to load a saved game state from a file.
+     * Like restore(), everything is read and checked before the state is replaced -> unchanged if this throws.
      */
     void GameState::deserialize(const json &j) {
-        // clear current state
-        this->players.clear();
-
-        // map
+        // map, without one the buildings go onto the current map
+        std::optional<Graph> map;
         if (j.contains("map") && j["map"].is_object() && !j["map"].empty()) {
-            std::string mapData = j["map"].dump();
-            this->map.deserialize(mapData);
+            map.emplace();
+            map->deserialize(j["map"].dump());
         }
 
         // players
+        std::vector<Player> players;
         if (j.contains("players") && j["players"].is_array()) {
             for (const auto& playerJson : j["players"]) {
                 size_t playerId = 0;
@@ -111,56 +154,226 @@ namespace df {
 
                 Player player(playerId); // TODO
                 // player.deserialize(playerJson);
-                this->players.push_back(player);
+                players.push_back(player);
             }
         }
 
-        // settlements
+        // settlements and roads
+        std::vector<Settlement> settlements;
         if (j.contains("settlements") && j["settlements"].is_array()) {
             for (const auto& settlementJson : j["settlements"]) {
-                auto settlement = std::make_shared<Settlement>();
-                settlement->deserialize(settlementJson);
-                this->addSettlement(settlement);
+                settlements.emplace_back().deserialize(settlementJson);
             }
         }
-
-        // roads
+        std::vector<Road> roads;
         if (j.contains("roads") && j["roads"].is_array()) {
             for (const auto& roadJson : j["roads"]) {
-                auto road = std::make_shared<Road>();
-                road->deserialize(roadJson);
-                this->addRoad(road);
+                roads.emplace_back().deserialize(roadJson);
             }
         }
 
         // turns
-        if (j.contains("currentPlayerId")) { this->setCurrentPlayerId(j["currentPlayerId"].get<size_t>()); }
-        if (j.contains("turnCount")) { this->setTurnCount(j["turnCount"].get<size_t>()); }
-        if (j.contains("roundNumber")) { this->setRoundNumber(j["roundNumber"].get<size_t>()); }
-        if (j.contains("phase")) { this->setPhase(static_cast<types::GamePhase>(j["phase"].get<int>())); }
+        const size_t currentPlayerId = j.contains("currentPlayerId") ? j["currentPlayerId"].get<size_t>() : this->currentPlayerId;
+        const size_t turnCount = j.contains("turnCount") ? j["turnCount"].get<size_t>() : this->turnCount;
+        const size_t roundNumber = j.contains("roundNumber") ? j["roundNumber"].get<size_t>() : this->roundNumber;
+        const types::GamePhase phase = j.contains("phase") ? static_cast<types::GamePhase>(j["phase"].get<int>()) : this->phase;
+
+        if (map) {
+            checkBuildings(*map, players.size(), settlements, roads, "JSON");
+        } else {
+            // the old buildings are taken off the current map for the check and put back in any case
+            for (const Settlement& settlement : this->settlements.getValues()) this->map.removeSettlement(this->map.findVertexById(settlement.getVertexId()));
+            for (const Road& road : this->roads.getValues()) this->map.removeRoad(this->map.findEdgeById(road.getEdgeId()));
+            const auto putBack = [this]() {
+                for (const Settlement& settlement : this->settlements.getValues()) this->map.placeSettlement(this->map.findVertexById(settlement.getVertexId()), settlement.getId());
+                for (const Road& road : this->roads.getValues()) this->map.placeRoad(this->map.findEdgeById(road.getEdgeId()), road.getId());
+            };
+            try {
+                checkBuildings(this->map, players.size(), settlements, roads, "JSON");
+            } catch (...) {
+                putBack();
+                throw;
+            }
+            putBack();
+        }
+
+        // the old buildings have to leave the old map before it is replaced
+        this->clearSettlements();
+        this->clearRoads();
+        if (map) this->map = std::move(*map);
+        this->players = std::move(players);
+
+        // checked above, these can't fail anymore
+        for (const Settlement& settlement : settlements) this->addSettlement(settlement);
+        for (const Road& road : roads) this->addRoad(road);
+
+        this->setCurrentPlayerId(currentPlayerId);
+        this->setTurnCount(turnCount);
+        this->setRoundNumber(roundNumber);
+        this->setPhase(phase);
     }
 
 
     /**
-     * Serialize the game state and store in the passed filepaht.
+     * Immutable copy for saving, see SaveSnapshot. Only the chunks of tile records whose tiles changed are rebuilt,
+     * the others are shared with the previous snapshot.
      */
-    void GameState::save(const std::filesystem::path &filepath) const {
-        std::ofstream file(filepath);
+    SaveSnapshot GameState::snapshot() const {
+        const auto& tiles = this->map.getTiles();
+        const size_t chunkCount = this->map.getTileChunkCount();
+        const bool isShared = this->mapRecord && this->mapRecord->width == this->map.getMapWidth() && this->mapRecordChunkRevisions.size() == chunkCount;
+
+        // committed together once all chunks are copied, a throw leaves the previous record in place
+        std::shared_ptr<SaveSnapshot::MapRecord> record;
+        std::vector<size_t> chunkRevisions = isShared ? this->mapRecordChunkRevisions : std::vector<size_t>(chunkCount, 0);
+        if (!isShared) {
+            record = std::make_shared<SaveSnapshot::MapRecord>();
+            record->width = this->map.getMapWidth();
+            record->chunks.resize(chunkCount);
+        }
+        for (size_t chunk = 0; chunk < chunkCount; ++chunk) {
+            const size_t revision = this->map.getTileChunkRevision(chunk);
+            if (isShared && revision == chunkRevisions[chunk]) continue;
+            if (!record) record = std::make_shared<SaveSnapshot::MapRecord>(*this->mapRecord);
+
+            auto chunkRecord = std::make_shared<SaveSnapshot::MapRecord::Chunk>();
+            const size_t endIndex = std::min(tiles.size(), (chunk + 1) * Graph::TILE_CHUNK_SIZE);
+            chunkRecord->reserve(endIndex - chunk * Graph::TILE_CHUNK_SIZE);
+            for (size_t tileIndex = chunk * Graph::TILE_CHUNK_SIZE; tileIndex < endIndex; ++tileIndex) {
+                const Tile& tile = *tiles[tileIndex];
+                if (tile.getId() != tileIndex) {
+                    throw std::runtime_error("Binary saves need tile ids in map order (tile " + std::to_string(tile.getId()) + " at " + std::to_string(tileIndex) + ")");
+                }
+                chunkRecord->push_back({ tile.getType(), tile.getPotency(), tile.getRangeFactor(), tile.getBuildingId() });
+            }
+            record->chunks[chunk] = std::move(chunkRecord);
+            chunkRevisions[chunk] = revision;
+        }
+        if (record) {
+            this->mapRecord = std::move(record);
+            this->mapRecordChunkRevisions = std::move(chunkRevisions);
+        }
 
-        if (!file.is_open()) {
-            throw std::runtime_error("Failed to open file for writing: " + filepath.string());
+        SaveSnapshot snapshot;
+        snapshot.currentPlayerId = this->currentPlayerId;
+        snapshot.turnCount = this->turnCount;
+        snapshot.roundNumber = this->roundNumber;
+        snapshot.phase = this->phase;
+        snapshot.tutorialStep = this->currentTutorialStep;
+        snapshot.map = this->mapRecord;
+
+        snapshot.players.reserve(this->players.size());
+        for (const Player& player : this->players) {
+            SaveSnapshot::PlayerRecord& record = snapshot.players.emplace_back();
+            record.id = player.getId();
+            record.heroPoints = player.getHeroPoints();
+            record.resources = player.getResources();
+            record.settlementIds = player.getSettlementIds();
+            record.roadIds = player.getRoadIds();
+            record.exploredTileIds = player.getExploredTileIds();
+            if (const std::shared_ptr<Hero> hero = player.getHero()) {
+                record.hero = SaveSnapshot::HeroRecord{ hero->getTileID(), hero->getCoords(), hero->getTextureRef(), hero->getBaseRange() };
+            }
         }
 
-        file << this->serialize().dump(4);
-        file.close();
+        snapshot.settlements.assign(this->settlements.getValues().begin(), this->settlements.getValues().end());
+        snapshot.roads.assign(this->roads.getValues().begin(), this->roads.getValues().end());
+        return snapshot;
+    }
+
+
+    std::vector<std::uint8_t> GameState::serializeBinary() const {
+        return this->snapshot().serialize();
+    }
+
+
+    /**
+     * Restores the state from serializeBinary(). Throws on malformed data.
+     */
+    void GameState::deserializeBinary(std::span<const std::uint8_t> bytes) {
+        this->restore(SaveSnapshot::deserialize(bytes));
+    }
+
+
+    /**
+     * Replaces the whole state with the snapshot. Edges and vertices are rebuilt from the tiles like for a
+     * generated map. Throws if a building refers to a vertex/edge/player the map doesn't have or breaks the placement
+     * rules; the map, players and buildings are checked before anything is replaced, so the state is unchanged then.
+     */
+    void GameState::restore(const SaveSnapshot& snapshot) {
+        const auto invalid = [](const std::string& what) { return std::runtime_error("Invalid binary save: " + what); };
+        const SaveSnapshot::MapRecord emptyMap;
+        const SaveSnapshot::MapRecord& mapRecord = snapshot.map ? *snapshot.map : emptyMap;
+
+        const size_t tileCount = mapRecord.getTileCount();
+        std::vector<Tile> tiles;
+        tiles.reserve(tileCount);
+        mapRecord.forEachTile([&tiles](size_t tileIndex, const SaveSnapshot::TileRecord& record) {
+            tiles.emplace_back(tileIndex, record.type, record.potency);
+        });
+
+        // built next to the current map and players, *this is only touched once the snapshot checked out
+        Graph map;
+        map.rebuild(std::move(tiles), mapRecord.width);
+        mapRecord.forEachTile([&map](size_t tileIndex, const SaveSnapshot::TileRecord& record) {
+            const TileHandle tile = map.getTile(tileIndex);
+            tile->setRangeFactor(record.rangeFactor);
+            tile->setBuildingId(record.buildingId);
+        });
+
+        std::vector<Player> players;
+        players.reserve(snapshot.players.size());
+        for (const SaveSnapshot::PlayerRecord& record : snapshot.players) {
+            Player player(record.id);
+            player.setHeroPoints(record.heroPoints);
+            player.addResources(record.resources);
+            for (const size_t id : record.settlementIds) player.addSettlement(id);
+            for (const size_t id : record.roadIds) player.addRoad(id);
+            for (const size_t tileId : record.exploredTileIds) {
+                if (tileId >= tileCount) throw invalid("explored tile " + std::to_string(tileId));
+                player.exploreTile(tileId);
+                map.getTile(tileId)->addVisibleForPlayers(player.getId());
+            }
+            if (record.hero) {
+                player.setHero(std::make_shared<Hero>(record.hero->tileId, record.hero->coords, record.hero->textureRef, record.hero->baseRange));
+            }
+            players.push_back(std::move(player));
+        }
+
+        checkBuildings(map, players.size(), snapshot.settlements, snapshot.roads, "binary");
+
+        // the old buildings have to leave the old map before it is replaced
+        this->clearSettlements();
+        this->clearRoads();
+        this->map = std::move(map);
+        this->players = std::move(players);
+
+        // checked above, these can't fail anymore
+        for (const Settlement& settlement : snapshot.settlements) this->addSettlement(settlement);
+        for (const Road& road : snapshot.roads) this->addRoad(road);
+
+        this->setCurrentPlayerId(snapshot.currentPlayerId);
+        this->setTurnCount(snapshot.turnCount);
+        this->setRoundNumber(snapshot.roundNumber);
+        this->setPhase(snapshot.phase);
+        this->currentTutorialStep = snapshot.tutorialStep;
+    }
+
+
+    /**
+     * Stores the game state as a binary save (SaveSnapshot::writeFile(), compressed, with checksum) in the passed filepath.
+     */
+    void GameState::save(const std::filesystem::path &filepath) const {
+        this->snapshot().writeFile(filepath);
     }
 
 
     /**
      * Load the game state from the passed filepath and store it in the gamestate object.
+     * Accepts binary saves, save journals (SaveJournal) and the older JSON files (serialize()).
      */
     void GameState::load(const std::filesystem::path &filepath) {
-        std::ifstream file(filepath);
+        std::ifstream file(filepath, std::ios::binary);
 
         if (!file.is_open()) {
             throw std::runtime_error("Failed to open file for reading: " + filepath.string());
@@ -169,53 +382,194 @@ namespace df {
         std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
         file.close();
 
-        json j = json::parse(data);
-        this->deserialize(j);
+        const std::span<const std::uint8_t> bytes(reinterpret_cast<const std::uint8_t*>(data.data()), data.size());
+        ByteReader reader(bytes);
+        const std::uint64_t magic = reader.readFixed(4);
+        if (reader.isOk() && magic == SaveSnapshot::MAGIC) {
+            this->deserializeBinary(SaveSnapshot::decodeFile(bytes, filepath.string()));
+        } else if (reader.isOk() && magic == SaveJournal::MAGIC) {
+            this->restore(SaveJournal::decode(bytes, filepath.string()));
+        } else {
+            json j = json::parse(data);
+            this->deserialize(j);
+        }
     }
 
     // settlements
-    std::vector<std::shared_ptr<Settlement>> GameState::getSettlements() {
-        return settlements;
+    std::span<const size_t> GameState::getPlayerSettlementIds(size_t playerId) const {
+        if (playerId >= this->playerSettlementIds.size()) { return {}; }
+        return this->playerSettlementIds[playerId];
     }
 
-    void GameState::addSettlement(std::shared_ptr<Settlement> settlement) {
-        if (!settlement || !registry) { return; }
+    /**
+     * Places the settlement on the map and adds it. Returns false and changes nothing if the id is taken or the vertex
+     * doesn't exist, is occupied or next to a settlement. Throws on ids no map of this size can have (corrupt save).
+     */
+    bool GameState::addSettlement(const Settlement& settlement) {
+        // at most one settlement per vertex and the ids are handed out consecutively (getNextSettlementId())
+        if (settlement.getId() >= this->map.getVertexCount()) {
+            throw std::runtime_error("Settlement id " + std::to_string(settlement.getId()) + " out of range");
+        }
+        if (settlement.getPlayerId() >= this->getPlayerCount()) {
+            throw std::runtime_error("Settlement " + std::to_string(settlement.getId()) + " of unknown player " + std::to_string(settlement.getPlayerId()));
+        }
+        if (this->settlements.contains(settlement.getId())) { return false; } // ids are unique
+
+        // occupies the vertex and blocks its neighbours, see Graph::isSettlementAllowed()
+        const VertexHandle vertex = this->map.findVertexById(settlement.getVertexId());
+        if (!this->map.isSettlementAllowed(vertex) || !this->map.placeSettlement(vertex, settlement.getId())) { return false; }
+        this->settlements.insert(settlement.getId(), settlement);
+        if (settlement.getPlayerId() >= this->playerSettlementIds.size()) {
+            this->playerSettlementIds.resize(settlement.getPlayerId() + 1);
+        }
+        this->playerSettlementIds[settlement.getPlayerId()].push_back(settlement.getId());
+
+        // the settlement produces on every tile around its vertex
+        if (const auto tiles = this->map.getVertexTiles(vertex)) {
+            for (const TileHandle tile : *tiles) {
+                if (tile) { this->production.add(tile->getId(), settlement.getPlayerId()); }
+            }
+        }
+
+        if (!registry) { return true; } // headless, nothing to render
 
         // Also add to ECS registry for rendering/systems
         Entity e;
         Settlement& s = registry->settlements.emplace(e);
-        s = *settlement; // Copy data to ECS
+        s = settlement; // Copy data to ECS
 
         // Add position and scale components for rendering
-        registry->positions.emplace(e) = WorldNodeMapper::getWorldPositionForVertex(settlement->getVertexId(), this->map);
+        registry->positions.emplace(e) = WorldNodeMapper::getWorldPositionForVertex(settlement.getVertexId(), this->map);
         registry->scales.emplace(e) = glm::vec2(0.5f, 0.5f); // Scale to match hexagon size -> 1/2 hex radius
+        return true;
+    }
 
-        settlements.push_back(settlement);
+    void GameState::removeSettlement(size_t settlementId) {
+        const Settlement* settlement = this->settlements.find(settlementId);
+        if (!settlement) { return; }
+
+        const size_t playerId = settlement->getPlayerId();
+        const VertexHandle vertex = this->map.findVertexById(settlement->getVertexId());
+        this->map.removeSettlement(vertex);
+        if (const auto tiles = this->map.getVertexTiles(vertex)) {
+            for (const TileHandle tile : *tiles) {
+                if (tile) { this->production.remove(tile->getId(), playerId); }
+            }
+        }
+        std::erase(this->playerSettlementIds[playerId], settlementId);
+        this->settlements.erase(settlementId);
+
+        if (!registry) { return; }
+
+        // the entity is not tracked, search it (only rendered games, a handful of settlements)
+        for (const Entity e : registry->settlements.entities) {
+            if (registry->settlements.get(e).getId() == settlementId) {
+                // the components addSettlement() created
+                registry->settlements.remove(e);
+                registry->positions.remove(e);
+                registry->scales.remove(e);
+                break;
+            }
+        }
+    }
+
+    void GameState::clearSettlements() {
+        for (const Settlement& settlement : this->settlements.getValues()) {
+            this->map.removeSettlement(this->map.findVertexById(settlement.getVertexId()));
+        }
+        this->settlements.clear();
+        this->playerSettlementIds.clear();
+        this->production.clear();
+        if (!registry) { return; }
+
+        // every component addSettlement() created, like removeSettlement()
+        for (const Entity e : registry->settlements.entities) {
+            registry->positions.remove(e);
+            registry->scales.remove(e);
+        }
+        registry->settlements.clear();
     }
 
 
     // roads
-    void GameState::addRoad(std::shared_ptr<Road> road) {
-        if (!road || !registry) { return; }
+    std::span<const size_t> GameState::getPlayerRoadIds(size_t playerId) const {
+        if (playerId >= this->playerRoadIds.size()) { return {}; }
+        return this->playerRoadIds[playerId];
+    }
+
+    /**
+     * Same as addSettlement(): false if the id is taken or the edge doesn't exist or has a road, throws on impossible ids.
+     */
+    bool GameState::addRoad(const Road& road) {
+        // at most one road per edge
+        if (road.getId() >= this->map.getEdgeCount()) {
+            throw std::runtime_error("Road id " + std::to_string(road.getId()) + " out of range");
+        }
+        if (road.getPlayerId() >= this->getPlayerCount()) {
+            throw std::runtime_error("Road " + std::to_string(road.getId()) + " of unknown player " + std::to_string(road.getPlayerId()));
+        }
+        if (this->roads.contains(road.getId())) { return false; } // ids are unique
+
+        if (!this->map.placeRoad(this->map.findEdgeById(road.getEdgeId()), road.getId())) { return false; }
+        this->roads.insert(road.getId(), road);
+        if (road.getPlayerId() >= this->playerRoadIds.size()) {
+            this->playerRoadIds.resize(road.getPlayerId() + 1);
+        }
+        this->playerRoadIds[road.getPlayerId()].push_back(road.getId());
+
+        if (!registry) { return true; } // headless, nothing to render
 
         // Also add to ECS registry for rendering/systems
         Entity e;
         Road& r = registry->roads.emplace(e);
-        r = *road; // Copy data to ECS
+        r = road; // Copy data to ECS
 
         // Add position and scale components for rendering
-        registry->positions.emplace(e) = WorldNodeMapper::getWorldPositionForEdge(road->getEdgeId(), this->map);
+        registry->positions.emplace(e) = WorldNodeMapper::getWorldPositionForEdge(road.getEdgeId(), this->map);
         registry->scales.emplace(e) = glm::vec2(1.0f, 1.0f);
 
         // edge index is required for selecting the correcxt texture
-        int edgeIndex = this->map.getEdgeIndex(road->getEdgeId());
+        int edgeIndex = this->map.getEdgeIndex(road.getEdgeId());
         registry->roadEdgeIndices.emplace(e) = edgeIndex;
+        return true;
+    }
+
+    void GameState::removeRoad(size_t roadId) {
+        const Road* road = this->roads.find(roadId);
+        if (!road) { return; }
+
+        this->map.removeRoad(this->map.findEdgeById(road->getEdgeId()));
+        std::erase(this->playerRoadIds[road->getPlayerId()], roadId);
+        this->roads.erase(roadId);
+
+        if (!registry) { return; }
 
-        roads.push_back(road);
+        for (const Entity e : registry->roads.entities) {
+            if (registry->roads.get(e).getId() == roadId) {
+                registry->roads.remove(e);
+                registry->positions.remove(e);
+                registry->scales.remove(e);
+                registry->roadEdgeIndices.remove(e);
+                break;
+            }
+        }
     }
 
-    std::vector<std::shared_ptr<Road>> GameState::getRoads() {
-        return roads;
+    void GameState::clearRoads() {
+        for (const Road& road : this->roads.getValues()) {
+            this->map.removeRoad(this->map.findEdgeById(road.getEdgeId()));
+        }
+        this->roads.clear();
+        this->playerRoadIds.clear();
+        if (!registry) { return; }
+
+        // every component addRoad() created, like removeRoad()
+        for (const Entity e : registry->roads.entities) {
+            registry->positions.remove(e);
+            registry->scales.remove(e);
+            registry->roadEdgeIndices.remove(e);
+        }
+        registry->roads.clear();
     }
 
     // Tutorial
@@ -304,4 +658,37 @@ namespace df {
     }
 
 
+    std::uint64_t GameState::hash() const {
+        StateHasher hasher;
+        hasher.add(this->currentPlayerId);
+        hasher.add(this->turnCount);
+        hasher.add(this->roundNumber);
+        hasher.add(static_cast<std::uint64_t>(this->phase));
+
+        hasher.add(this->players.size());
+        for (const Player& player : this->players) {
+            hasher.add(player.getResources());
+            const std::vector<size_t>& exploredTileIds = player.getExploredTileIds();
+            hasher.add(exploredTileIds.size());
+            for (const size_t tileId : exploredTileIds) hasher.add(tileId);
+        }
+
+        // the dense order is the same for the same sequence of builds and undos
+        hasher.add(this->settlements.getValues().size());
+        for (const Settlement& settlement : this->settlements.getValues()) {
+            hasher.add(settlement.getId());
+            hasher.add(settlement.getPlayerId());
+            hasher.add(settlement.getVertexId());
+        }
+        hasher.add(this->roads.getValues().size());
+        for (const Road& road : this->roads.getValues()) {
+            hasher.add(road.getId());
+            hasher.add(road.getPlayerId());
+            hasher.add(road.getEdgeId());
+            hasher.add(static_cast<std::uint64_t>(road.getRoadLevel()));
+        }
+        return hasher.value;
+    }
+
+
 } // namespace df
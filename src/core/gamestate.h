@@ -1,8 +1,10 @@
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
-#include <vector>
 #include <memory>
+#include <span>
+#include <vector>
 #include "registry.h"
 
 #include <nlohmann/json.hpp>
@@ -10,8 +12,11 @@ using json = nlohmann::json;
 
 #include "graph.h"
 #include "player.h"
+#include "productionTable.h"
 #include "road.h"
+#include "saveSnapshot.h"
 #include "settlement.h"
+#include "slotMap.h"
 #include "types.h"
 #include "tutorial.h"
 
@@ -45,22 +50,28 @@ namespace df {
         void clearPlayers() { this->players.clear(); }
 
 
-        // settlements
-        std::vector<std::shared_ptr<Settlement>> getSettlements();
-        void addSettlement(std::shared_ptr<Settlement> settlement);
-        void clearSettlements() { 
-            settlements.clear(); 
-            registry->settlements.clear(); 
-        }
+        // settlements -> stored by id, lookups are O(1) and don't allocate
+        std::span<const Settlement> getSettlements() const { return this->settlements.getValues(); }
+        const Settlement* findSettlement(size_t settlementId) const { return this->settlements.find(settlementId); }
+        std::span<const size_t> getPlayerSettlementIds(size_t playerId) const;
+        size_t getNextSettlementId() const { return this->settlements.getNextId(); }
+        // false if the vertex is taken or violates the distance rule, throws on out of range (settlement or player) ids
+        bool addSettlement(const Settlement& settlement);
+        // exact inverse of addSettlement() (map, production, registry), used to undo a build
+        void removeSettlement(size_t settlementId);
+        void clearSettlements();
+        // tile -> players with settlements next to it, maintained by addSettlement()/removeSettlement()
+        const ProductionTable& getProduction() const { return this->production; }
 
 
-        // roads
-        std::vector<std::shared_ptr<Road>> getRoads();
-        void addRoad(std::shared_ptr<Road> road);
-        void clearRoads() { 
-            roads.clear(); 
-            registry->roads.clear(); 
-        }
+        // roads -> same as settlements
+        std::span<const Road> getRoads() const { return this->roads.getValues(); }
+        const Road* findRoad(size_t roadId) const { return this->roads.find(roadId); }
+        std::span<const size_t> getPlayerRoadIds(size_t playerId) const;
+        size_t getNextRoadId() const { return this->roads.getNextId(); }
+        bool addRoad(const Road& road);
+        void removeRoad(size_t roadId);
+        void clearRoads();
 
 
         // turns
@@ -74,14 +85,27 @@ namespace df {
         void setRoundNumber(size_t round) { this->roundNumber = round; }
 
         types::GamePhase getPhase() const { return this->phase; }
-        void setPhase(types::GamePhase newPhase) { this->phase = newPhase; fmt::println("Switched to game phase {}", (int)this->phase);}
+        void setPhase(types::GamePhase newPhase) { this->phase = newPhase; }
 
 
         // persistence
+        // JSON: readable, for debugging and the older save files; players are stored as ids only
         json serialize() const;
         void deserialize(const json &j);
+        // binary: the complete state (map, players with resources, exploration and heroes, buildings, turns)
+        std::vector<std::uint8_t> serializeBinary() const;
+        void deserializeBinary(std::span<const std::uint8_t> bytes);
+        // save() writes the binary format, compressed and with a checksum; load() reads it, save journals
+        // (SaveJournal) and the JSON format.
+        // Both throw std::runtime_error on failure (damaged file, unsupported version, ...).
         void save(const std::filesystem::path &filepath) const;
         void load(const std::filesystem::path &filepath);
+        // Everything save() writes, as an immutable copy that can be written on another thread (Autosave).
+        // Takes well under a millisecond: the tiles are shared with the previous snapshot while the map is unchanged.
+        // Not thread-safe, call it from the thread that changes the game.
+        SaveSnapshot snapshot() const;
+        // replaces the whole state, counterpart of snapshot(); throws std::runtime_error if the ids don't fit the map
+        void restore(const SaveSnapshot& snapshot);
 
         // Tutorial
         void initTutorial();
@@ -90,15 +114,26 @@ namespace df {
         bool isTutorialActive() const;
         bool isGameOver() const;
 
+        // 64 bit hash of everything a turn can change: turn counters, phase, resources, explored tiles, settlements
+        // and roads. The map itself is not hashed, it only changes through settlements and roads.
+        // Equal games give equal hashes on every platform -> replays compare it to detect desyncs.
+        std::uint64_t hash() const;
+
     private:
         // TODO: discuss ownership model for game...
         Graph map;
 
         std::vector<Player> players;
 
-        // Smart pointer storage for safe ownership
-        std::vector<std::shared_ptr<Settlement>> settlements;
-        std::vector<std::shared_ptr<Road>> roads;
+        SlotMap<Settlement> settlements;
+        SlotMap<Road> roads;
+        // secondary indices: player id -> ids of the player's settlements/roads
+        std::vector<std::vector<size_t>> playerSettlementIds;
+        std::vector<std::vector<size_t>> playerRoadIds;
+        ProductionTable production;
+        // copy-on-write tiles of snapshot(), a chunk is valid while the map's revision of that chunk is unchanged
+        mutable std::shared_ptr<const SaveSnapshot::MapRecord> mapRecord;
+        mutable std::vector<size_t> mapRecordChunkRevisions;
 
         // turns
         size_t currentPlayerId = 0;
@@ -1,73 +1,139 @@
 #include "graph.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <fstream>
 #include <iterator>
 #include <limits>
+#include <map>
 #include <queue>
+#include <set>
 #include <stdexcept>
 #include <string>
 #include <unordered_set>
 #include <utility>
 
-#include "fmt/base.h"
+#include "fmt/ostream.h"
+#include "log.h"
 #include "vertex.h"
 #include "worldGenerator.h"
 
 
 namespace df {
-	void Graph::addTile(std::unique_ptr<Tile> tile) {
-		if (!tile)
-			return;
+	namespace {
+		// position of the node with the given id inside `nodes`, SIZE_MAX if there is none
+		template <typename T, typename Range>
+		size_t findIndexById(const std::vector<T*>& nodes, const Range& range, size_t id) {
+			if (range.dense) {
+				if (id < range.first || id - range.first >= nodes.size())
+					return SIZE_MAX;
+				return id - range.first;
+			}
 
-		const size_t tileId = tile->getId();
-		if (this->doesTileExist(tile->getId()))
-			return;
+			auto it = std::find_if(
+				nodes.begin(),
+				nodes.end(),
+				[id](const T* n) { return n && n->getId() == id; });
+			return (it != nodes.end()) ? static_cast<size_t>(std::distance(nodes.begin(), it)) : SIZE_MAX;
+		}
+
+		// keep track of whether ids are still consecutive, call *before* pushing the node
+		template <typename T, typename Range>
+		void trackInsertedId(const std::vector<T*>& nodes, Range& range, size_t id) {
+			if (nodes.empty()) {
+				range.first = id;
+				range.dense = true;
+			} else if (range.dense && id != range.first + nodes.size()) {
+				range.dense = false;
+			}
+		}
+
+		// call *before* erasing the node at index
+		template <typename T, typename Range>
+		void trackErasedIndex(const std::vector<T*>& nodes, Range& range, size_t index) {
+			if (index + 1 != nodes.size())
+				range.dense = false;
+		}
+
+
+		// put `value` into the first free slot of `slots` (if it is not already in there)
+		template <typename Handle, size_t N>
+		void addToFirstFreeSlot(std::array<Handle, N>& slots, Handle value) {
+			for (auto& slot : slots) {
+				if (slot == value)
+					return;
+				if (!slot) {
+					slot = value;
+					return;
+				}
+			}
+		}
+
+		std::atomic<size_t> lastTileRevision{ 0 };
+
+		size_t nextTileRevision() {
+			return lastTileRevision.fetch_add(1, std::memory_order_relaxed) + 1;
+		}
 
-		this->tiles.push_back(std::move(tile));
+		std::atomic<std::uint64_t> lastGraph{ 0 };
+	} // namespace
 
-		this->tileEdges.emplace(tileId, std::array<EdgeHandle, 6>{});
-		this->tileVertices.emplace(tileId, std::array<VertexHandle, 6>{});
+
+	std::uint64_t Graph::firstOccupancyRevision() {
+		// 2^32 revisions apart, 64 bits even where size_t has only 32
+		return (lastGraph.fetch_add(1, std::memory_order_relaxed) + 1) << 32;
 	}
 
 
-	void Graph::addEdge(std::unique_ptr<Edge> edge) {
-		if (!edge)
+	void Graph::addTile(const Tile& tile) {
+		if (this->findTileById(tile.getId()) != nullptr)
 			return;
 
-		const size_t edgeId = edge->getId();
+		trackInsertedId(this->tiles, this->tileIds, tile.getId());
+		this->tiles.push_back(this->tilePool.emplace(tile));
+		this->markTileSetChanged();
+
+		this->tileEdges.emplace_back();
+		this->tileVertices.emplace_back();
+	}
+
+
+	void Graph::addEdge(const Edge& edge) {
+		const size_t edgeId = edge.getId();
 		if (this->findEdgeById(edgeId) != nullptr) {
-			fmt::println("[DEBUG].[addEdge] edge with ID {} already exists; returning...", edgeId);
+			DF_LOG_DEBUG(GRAPH, "addEdge: edge with ID {} already exists; returning...", edgeId);
 			return;
 		}
 
-		this->edges.push_back(std::move(edge));
+		trackInsertedId(this->edges, this->edgeIds, edgeId);
+		this->edges.push_back(this->edgePool.emplace(edge));
 
-		this->edgeVertices.emplace(edgeId, std::array<VertexHandle, 2>{});
+		this->edgeVertices.emplace_back();
+		this->occupancyRevision++;
 	}
 
 
-	void Graph::addVertex(std::unique_ptr<Vertex> vertex) {
-		if (!vertex) {
-			fmt::println("[DEBUG].[addVertex] vertex is null, returning");
-			return;
-		}
-
-		const size_t vertexId = vertex->getId();
-		fmt::println("[DEBUG].[addVertex] adding vertex with ID: {}", vertexId);
+	void Graph::addVertex(const Vertex& vertex) {
+		const size_t vertexId = vertex.getId();
 		if (this->findVertexById(vertexId) != nullptr) {
-			fmt::println("[DEBUG].[addVertex] vertex with ID {} already exists; returning...", vertexId);
+			DF_LOG_DEBUG(GRAPH, "addVertex: vertex with ID {} already exists; returning...", vertexId);
 			return;
 		}
 
-		fmt::println("[DEBUG].[addVertex] pushing vertex to vector");
-		this->vertices.push_back(std::move(vertex));
-		fmt::println("[DEBUG].[addVertex] vertex pushed, now emplace in maps");
+		trackInsertedId(this->vertices, this->vertexIds, vertexId);
+		this->vertices.push_back(this->vertexPool.emplace(vertex));
 
-		this->vertexEdges.emplace(vertexId, std::array<EdgeHandle, 3>{});
-		this->vertexTiles.emplace(vertexId, std::array<TileHandle, 3>{});
-		fmt::println("[DEBUG].[addVertex] vertex added successfully");
+		this->vertexEdges.emplace_back();
+		this->vertexTiles.emplace_back();
+		this->vertexExpectedYields.push_back(0.0f);
+		this->vertexOccupied.push_back(0);
+		this->vertexBlockedByNeighbours.push_back(0);
+		this->occupancyRevision++;
+
+		// a vertex added with a settlement (unusual, but possible)
+		if (this->vertices.back()->hasSettlement())
+			this->resetSettlementOccupancy();
 	}
 
 
@@ -78,65 +144,80 @@ namespace df {
 			throw std::out_of_range("Tile index out of range");
 		}
 
-		return this->tiles[index].get();
+		return this->tiles[index];
 	}
 
 
 	// Throws out_of_range if no edge with id
 	EdgeHandle Graph::getEdge(size_t index) const {
-		if (!this->doesEdgeExist(index)) {
+		if (index >= this->edges.size()) {
 			throw std::out_of_range("Edge index out of range");
 		}
 
-		return this->edges[index].get();
+		return this->edges[index];
 	}
 
 
 	// Throws out_of_range if no vertex with id
 	VertexHandle Graph::getVertex(size_t index) const {
-		if (!this->doesVertexExist(index)) {
+		if (index >= this->vertices.size()) {
 			throw std::out_of_range("Vertex index out of range");
 		}
 
-		return this->vertices[index].get();
+		return this->vertices[index];
+	}
+
+
+	size_t Graph::indexOfTile(size_t tileId) const {
+		return findIndexById(this->tiles, this->tileIds, tileId);
+	}
+
+
+	size_t Graph::indexOfEdge(size_t edgeId) const {
+		return findIndexById(this->edges, this->edgeIds, edgeId);
+	}
+
+
+	size_t Graph::indexOfVertex(size_t vertexId) const {
+		return findIndexById(this->vertices, this->vertexIds, vertexId);
+	}
+
+
+	size_t Graph::getTileChunkRevision(size_t chunk) const {
+		// revisions only grow, a later change of the tile set outranks the changes of single tiles before it
+		const size_t chunkRevision = (chunk < this->tileChunkRevisions.size()) ? this->tileChunkRevisions[chunk] : 0;
+		return std::max(chunkRevision, this->tileSetRevision);
 	}
 
+
+	void Graph::markTileSetChanged() {
+		this->tileRevision = nextTileRevision();
+		this->tileSetRevision = this->tileRevision;
+	}
+
+
 	// Helper function to find a tile by ID (not index)
 	TileHandle Graph::findTileById(size_t tileId) const {
-		auto it = std::find_if(
-			this->tiles.begin(),
-			this->tiles.end(),
-			[tileId](const std::unique_ptr<Tile>& t) { return t && t->getId() == tileId; });
-		return (it != this->tiles.end()) ? it->get() : nullptr;
+		const size_t index = this->indexOfTile(tileId);
+		return (index != SIZE_MAX) ? this->tiles[index] : nullptr;
 	}
 
 	// Helper function to find a vertex by ID (not index)
 	VertexHandle Graph::findVertexById(size_t vertexId) const {
-		auto it = std::find_if(
-			this->vertices.begin(),
-			this->vertices.end(),
-			[vertexId](const std::unique_ptr<Vertex>& v) { return v && v->getId() == vertexId; });
-		return (it != this->vertices.end()) ? it->get() : nullptr;
+		const size_t index = this->indexOfVertex(vertexId);
+		return (index != SIZE_MAX) ? this->vertices[index] : nullptr;
 	}
 
 	// Helper function to find an edge by ID (not index)
 	EdgeHandle Graph::findEdgeById(size_t edgeId) const {
-		auto it = std::find_if(
-			this->edges.begin(),
-			this->edges.end(),
-			[edgeId](const std::unique_ptr<Edge>& e) { return e && e->getId() == edgeId; });
-		return (it != this->edges.end()) ? it->get() : nullptr;
+		const size_t index = this->indexOfEdge(edgeId);
+		return (index != SIZE_MAX) ? this->edges[index] : nullptr;
 	}
 
 
+	// handles are only valid as long as the graph owns the node, so checking the id lookup is enough
 	bool Graph::doesTileExist(const TileHandle tile) const {
-		if (!tile)
-			return false;
-
-		return std::any_of(
-			this->tiles.begin(),
-			this->tiles.end(),
-			[&](const std::unique_ptr<Tile>& t) { return t.get() == tile; });
+		return tile && this->findTileById(tile->getId()) == tile;
 	}
 
 	bool Graph::doesTileExist(size_t tileId) const {
@@ -145,13 +226,7 @@ namespace df {
 
 
 	bool Graph::doesEdgeExist(const EdgeHandle edge) const {
-		if (!edge)
-			return false;
-
-		return std::any_of(
-			this->edges.begin(),
-			this->edges.end(),
-			[&](const std::unique_ptr<Edge>& e) { return e.get() == edge; });
+		return edge && this->findEdgeById(edge->getId()) == edge;
 	}
 
 
@@ -161,13 +236,7 @@ namespace df {
 
 
 	bool Graph::doesVertexExist(const VertexHandle vertex) const {
-		if (!vertex)
-			return false;
-
-		return std::any_of(
-			this->vertices.begin(),
-			this->vertices.end(),
-			[&](const std::unique_ptr<Vertex>& v) { return v.get() == vertex; });
+		return vertex && this->findVertexById(vertex->getId()) == vertex;
 	}
 
 
@@ -180,18 +249,26 @@ namespace df {
 		if (!this->doesTileExist(tile))
 			return;
 
-		auto it = std::find_if(
-			this->tiles.begin(),
-			this->tiles.end(),
-			[&](const std::unique_ptr<Tile>& t) { return t.get() == tile; });
-		if (it == this->tiles.end())
-			return;
+		const size_t index = this->indexOfTile(tile->getId());
+		this->markTileSetChanged();
 
-		const size_t tileId = it->get()->getId();
+		// the vertices must not point to the removed tile anymore
+		for (const VertexHandle vertex : this->tileVertices[index]) {
+			const size_t vertexIndex = vertex ? this->indexOfVertex(vertex->getId()) : SIZE_MAX;
+			if (vertexIndex == SIZE_MAX)
+				continue;
+			for (auto& slot : this->vertexTiles[vertexIndex]) {
+				if (slot == tile)
+					slot = nullptr;
+			}
+			this->updateExpectedYield(vertexIndex);
+		}
+
+		trackErasedIndex(this->tiles, this->tileIds, index);
 
-		this->tileEdges.erase(tileId);
-		this->tileVertices.erase(tileId);
-		this->tiles.erase(it);
+		this->tileEdges.erase(this->tileEdges.begin() + index);
+		this->tileVertices.erase(this->tileVertices.begin() + index);
+		this->tiles.erase(this->tiles.begin() + index);
 	}
 
 
@@ -199,17 +276,12 @@ namespace df {
 		if (!this->doesEdgeExist(edge))
 			return;
 
-		auto it = std::find_if(
-			this->edges.begin(),
-			this->edges.end(),
-			[&](const std::unique_ptr<Edge>& e) { return e.get() == edge; });
-		if (it == this->edges.end())
-			return;
-
-		size_t edgeId = it->get()->getId();
+		const size_t index = this->indexOfEdge(edge->getId());
+		trackErasedIndex(this->edges, this->edgeIds, index);
 
-		this->edgeVertices.erase(edgeId);
-		this->edges.erase(it);
+		this->edgeVertices.erase(this->edgeVertices.begin() + index);
+		this->edges.erase(this->edges.begin() + index);
+		this->occupancyRevision++;
 	}
 
 
@@ -217,18 +289,18 @@ namespace df {
 		if (!this->doesVertexExist(vertex))
 			return;
 
-		auto it = std::find_if(
-			this->vertices.begin(),
-			this->vertices.end(),
-			[&](const std::unique_ptr<Vertex>& v) { return v.get() == vertex; });
-		if (it == this->vertices.end())
-			return;
-
-		size_t vertexId = it->get()->getId();
-
-		this->vertexEdges.erase(vertexId);
-		this->vertexTiles.erase(vertexId);
-		this->vertices.erase(it);
+		const size_t index = this->indexOfVertex(vertex->getId());
+		if (this->vertexOccupied[index])
+			this->updateNeighbourBlocking(index, -1);
+		trackErasedIndex(this->vertices, this->vertexIds, index);
+
+		this->vertexEdges.erase(this->vertexEdges.begin() + index);
+		this->vertexTiles.erase(this->vertexTiles.begin() + index);
+		this->vertexExpectedYields.erase(this->vertexExpectedYields.begin() + index);
+		this->vertexOccupied.erase(this->vertexOccupied.begin() + index);
+		this->vertexBlockedByNeighbours.erase(this->vertexBlockedByNeighbours.begin() + index);
+		this->vertices.erase(this->vertices.begin() + index);
+		this->occupancyRevision++;
 	}
 
 
@@ -238,7 +310,7 @@ namespace df {
 		if (!this->doesEdgeExist(edge))
 			return;
 
-		auto& localEdges = this->tileEdges[tile->getId()];
+		auto& localEdges = this->tileEdges[this->indexOfTile(tile->getId())];
 		for (size_t i = 0; i < 6; ++i) {
 			if (!localEdges[i] || localEdges[i]->getId() == SIZE_MAX) {
 				localEdges[i] = edge;
@@ -254,7 +326,7 @@ namespace df {
 		if (!this->doesVertexExist(vertex))
 			return;
 
-		auto& localVertices = this->edgeVertices[edge->getId()];
+		auto& localVertices = this->edgeVertices[this->indexOfEdge(edge->getId())];
 		for (size_t i = 0; i < 2; ++i) {
 			if (!localVertices[i] || localVertices[i]->getId() == SIZE_MAX) {
 				localVertices[i] = vertex;
@@ -270,13 +342,17 @@ namespace df {
 		if (!this->doesTileExist(tile))
 			return;
 
-		auto& localVertices = this->tileVertices[tile->getId()];
+		auto& localVertices = this->tileVertices[this->indexOfTile(tile->getId())];
 		for (size_t i = 0; i < 6; ++i) {
 			if (!localVertices[i] || localVertices[i]->getId() == SIZE_MAX) {
 				localVertices[i] = vertex;
 				break;
 			}
 		}
+
+		const size_t vertexIndex = this->indexOfVertex(vertex->getId());
+		addToFirstFreeSlot(this->vertexTiles[vertexIndex], tile);
+		this->updateExpectedYield(vertexIndex);
 	}
 
 
@@ -287,11 +363,7 @@ namespace df {
 		if (!this->doesTileExist(tile))
 			return std::nullopt;
 
-		auto it = this->tileEdges.find(tile->getId());
-		if (it != this->tileEdges.end())
-			return it->second;
-
-		return std::nullopt;
+		return this->tileEdges[this->indexOfTile(tile->getId())];
 	}
 
 
@@ -302,11 +374,7 @@ namespace df {
 		if (!this->doesTileExist(tile))
 			return std::nullopt;
 
-		auto it = this->tileVertices.find(tile->getId());
-		if (it != this->tileVertices.end())
-			return it->second;
-
-		return std::nullopt;
+		return this->tileVertices[this->indexOfTile(tile->getId())];
 	}
 
 
@@ -317,11 +385,7 @@ namespace df {
 		if (!this->doesEdgeExist(edge))
 			return std::nullopt;
 
-		auto it = this->edgeVertices.find(edge->getId());
-		if (it != this->edgeVertices.end())
-			return it->second;
-
-		return std::nullopt;
+		return this->edgeVertices[this->indexOfEdge(edge->getId())];
 	}
 
 
@@ -332,11 +396,7 @@ namespace df {
 		if (!this->doesVertexExist(vertex))
 			return std::nullopt;
 
-		auto it = this->vertexEdges.find(vertex->getId());
-		if (it != this->vertexEdges.end())
-			return it->second;
-
-		return std::nullopt;
+		return this->vertexEdges[this->indexOfVertex(vertex->getId())];
 	}
 
 
@@ -347,54 +407,225 @@ namespace df {
 		if (!this->doesVertexExist(vertex))
 			return std::nullopt;
 
-		auto it = this->vertexTiles.find(vertex->getId());
-		if (it != this->vertexTiles.end())
-			return it->second;
-
-		return std::nullopt;
+		return this->vertexTiles[this->indexOfVertex(vertex->getId())];
 	}
 
 
-	// get the edge index (0-5) by the "global" edgeId
+	// get the edge index (0-5) by the "global" edgeId.
+	// Shared edges report the index inside the tile that comes first in the tile vector.
 	size_t Graph::getEdgeIndex(size_t edgeId) {
-		if (!this->doesEdgeExist(edgeId))
+		const size_t edgeIndex = this->indexOfEdge(edgeId);
+		if (edgeIndex == SIZE_MAX)
 			return SIZE_MAX;
 
-		for (const auto& tile : this->tiles) {
-			if (auto localTileEdgesOpt = this->getTileEdges(tile.get()); localTileEdgesOpt) {
-				auto& localTileEdges = *localTileEdgesOpt;
-				auto it = std::ranges::find_if(
-					localTileEdges,
-					[&](EdgeHandle e) { return e->getId() == edgeId; });
+		// only the (at most 2) tiles around one of the edge's vertices can contain the edge
+		const VertexHandle vertex = this->edgeVertices[edgeIndex][0];
+		if (!vertex)
+			return SIZE_MAX;
+
+		size_t bestTileIndex = SIZE_MAX;
+		size_t bestLocalIndex = SIZE_MAX;
+		for (const TileHandle tile : this->vertexTiles[this->indexOfVertex(vertex->getId())]) {
+			if (!tile)
+				continue;
+
+			const size_t tileIndex = this->indexOfTile(tile->getId());
+			if (tileIndex == SIZE_MAX || tileIndex >= bestTileIndex)
+				continue;
+
+			const auto& localTileEdges = this->tileEdges[tileIndex];
+			auto it = std::ranges::find_if(
+				localTileEdges,
+				[&](EdgeHandle e) { return e && e->getId() == edgeId; });
+
+			if (it != localTileEdges.end()) {
+				bestTileIndex = tileIndex;
+				bestLocalIndex = std::distance(localTileEdges.begin(), it);
+			}
+		}
+		return bestLocalIndex;
+	}
+
+
+	float Graph::getExpectedYield(const VertexHandle vertex) const {
+		if (!this->doesVertexExist(vertex))
+			return 0.0f;
+
+		return this->vertexExpectedYields[this->indexOfVertex(vertex->getId())];
+	}
+
+
+	float Graph::getExpectedYield(size_t vertexId) const {
+		const size_t index = this->indexOfVertex(vertexId);
+		return (index != SIZE_MAX) ? this->vertexExpectedYields[index] : 0.0f;
+	}
+
+
+	void Graph::setTileType(const TileHandle tile, types::TileType type) {
+		if (!this->doesTileExist(tile))
+			return;
+
+		tile->setType(type);
+		this->updateExpectedYields(tile);
+		this->renderUpdateRequested = true;
+	}
+
+
+	void Graph::setTilePotency(const TileHandle tile, types::TilePotency potency) {
+		if (!this->doesTileExist(tile))
+			return;
+
+		tile->setPotency(potency);
+		this->updateExpectedYields(tile);
+	}
+
+
+	void Graph::updateExpectedYields(const TileHandle tile) {
+		if (!this->doesTileExist(tile))
+			return;
+
+		const size_t index = this->indexOfTile(tile->getId());
+		this->tileRevision = nextTileRevision();
+		const size_t chunk = index / TILE_CHUNK_SIZE;
+		if (chunk >= this->tileChunkRevisions.size()) {
+			this->tileChunkRevisions.resize(chunk + 1, 0);
+		}
+		this->tileChunkRevisions[chunk] = this->tileRevision;
+		for (const VertexHandle vertex : this->tileVertices[index]) {
+			if (vertex)
+				this->updateExpectedYield(this->indexOfVertex(vertex->getId()));
+		}
+	}
+
+
+	void Graph::updateExpectedYield(size_t vertexIndex) {
+		if (vertexIndex >= this->vertexExpectedYields.size())
+			return;
+
+		float expectedYield = 0.0f;
+		for (const TileHandle tile : this->vertexTiles[vertexIndex]) {
+			if (tile)
+				expectedYield += tile->getExpectedYield();
+		}
+		this->vertexExpectedYields[vertexIndex] = expectedYield;
+	}
+
+
+	void Graph::updateAllExpectedYields() {
+		this->vertexExpectedYields.assign(this->vertices.size(), 0.0f);
+		for (size_t vertexIndex = 0; vertexIndex < this->vertices.size(); ++vertexIndex) {
+			this->updateExpectedYield(vertexIndex);
+		}
+	}
+
+
+	bool Graph::placeSettlement(const VertexHandle vertex, size_t settlementId) {
+		if (!this->doesVertexExist(vertex) || vertex->hasSettlement())
+			return false;
+
+		const size_t index = this->indexOfVertex(vertex->getId());
+		vertex->setSettlementId(settlementId);
+		this->vertexOccupied[index] = 1;
+		this->updateNeighbourBlocking(index, 1);
+		this->occupancyRevision++;
+		return true;
+	}
+
+
+	void Graph::removeSettlement(const VertexHandle vertex) {
+		if (!this->doesVertexExist(vertex) || !vertex->hasSettlement())
+			return;
+
+		const size_t index = this->indexOfVertex(vertex->getId());
+		vertex->setSettlementId(std::nullopt);
+		this->vertexOccupied[index] = 0;
+		this->updateNeighbourBlocking(index, -1);
+		this->occupancyRevision++;
+	}
+
+
+	bool Graph::isSettlementAllowed(const VertexHandle vertex) const {
+		return vertex && this->isSettlementAllowed(vertex->getId());
+	}
+
+
+	bool Graph::isSettlementAllowed(size_t vertexId) const {
+		const size_t index = this->indexOfVertex(vertexId);
+		return index != SIZE_MAX && !this->vertexOccupied[index] && this->vertexBlockedByNeighbours[index] == 0;
+	}
+
 
-				if (it != localTileEdges.end())
-					return std::distance(localTileEdges.begin(), it);
+	bool Graph::placeRoad(const EdgeHandle edge, size_t roadId) {
+		if (!this->doesEdgeExist(edge) || edge->hasRoad())
+			return false;
+
+		edge->setRoadId(roadId);
+		this->occupancyRevision++;
+		return true;
+	}
+
+
+	void Graph::removeRoad(const EdgeHandle edge) {
+		if (!this->doesEdgeExist(edge) || !edge->hasRoad())
+			return;
+
+		edge->setRoadId(std::nullopt);
+		this->occupancyRevision++;
+	}
+
+
+	void Graph::updateNeighbourBlocking(size_t vertexIndex, int delta) {
+		const VertexHandle vertex = this->vertices[vertexIndex];
+		for (const EdgeHandle edge : this->vertexEdges[vertexIndex]) {
+			if (!edge)
+				continue;
+
+			for (const VertexHandle neighbour : this->edgeVertices[this->indexOfEdge(edge->getId())]) {
+				if (!neighbour || neighbour == vertex)
+					continue;
+
+				auto& blocked = this->vertexBlockedByNeighbours[this->indexOfVertex(neighbour->getId())];
+				blocked = static_cast<std::uint8_t>(blocked + delta);
 			}
 		}
-		return SIZE_MAX;
+	}
+
+
+	void Graph::resetSettlementOccupancy() {
+		this->vertexOccupied.assign(this->vertices.size(), 0);
+		this->vertexBlockedByNeighbours.assign(this->vertices.size(), 0);
+		for (size_t vertexIndex = 0; vertexIndex < this->vertices.size(); ++vertexIndex) {
+			if (this->vertices[vertexIndex]->hasSettlement()) {
+				this->vertexOccupied[vertexIndex] = 1;
+				this->updateNeighbourBlocking(vertexIndex, 1);
+			}
+		}
+		this->occupancyRevision++;
 	}
 
 
 	json Graph::serialize() const {
 		json j;
 
-		for (const auto& tile : this->tiles) {
+		for (size_t tileIndex = 0; tileIndex < this->tiles.size(); ++tileIndex) {
+			const auto& tile = this->tiles[tileIndex];
 			json tileJson;
 			tileJson["id"] = tile->getId();
 			tileJson["meta"] = tile->serialize();
 
-			json edgesJson;
-			if (this->tileEdges.contains(tile->getId())) {
-				for (const auto& edge : this->tileEdges.at(tile->getId())) {
-					if (this->edgeVertices.contains(edge->getId())) {
-						const auto& v = this->edgeVertices.at(edge->getId());
-						edgesJson[std::to_string(edge->getId())] = {v.at(0)->getId(), v.at(1)->getId()};
-					} else {
-						fmt::println("Edge vertices not found for edge {}", edge->getId());
-					}
+			// array (instead of object) keeps the edge order -> the tile's vertex order can be restored
+			json edgesJson = json::array();
+			for (const auto& edge : this->tileEdges[tileIndex]) {
+				if (!edge) {
+					DF_LOG_WARNING(GRAPH, "Tile {} has missing edges", tile->getId());
+					continue;
+				}
+				const auto& v = this->edgeVertices[this->indexOfEdge(edge->getId())];
+				if (v[0] && v[1]) {
+					edgesJson.push_back({edge->getId(), v[0]->getId(), v[1]->getId()});
+				} else {
+					DF_LOG_WARNING(GRAPH, "Edge vertices not found for edge {}", edge->getId());
 				}
-			} else {
-				fmt::println("Tile edges not found for tile {}", tile->getId());
 			}
 
 			tileJson["edges"] = edgesJson;
@@ -405,74 +636,96 @@ namespace df {
 	}
 
 
-	// TODO: CHECK / FIX THIS
-	// also: add error handling + sanity checks
-	// -> currently assumes correct JSON structure
-	// can throw...
+	// Rebuilds tiles, edges and vertices from the format written by serialize().
+	// Nodes are created in id order, so a serialized populate()-map gets its O(1) lookups back.
+	// Throws on an invalid JSON structure.
 	void Graph::deserialize(const std::string& data) {
 		json j = json::parse(data);
 
-		auto& self = *this; // be able to modify members
-		self.tiles.clear();
-		self.edges.clear();
-		self.vertices.clear();
-		self.tileEdges.clear();
-		self.edgeVertices.clear();
+		this->tiles.clear();
+		this->markTileSetChanged();
+		this->edges.clear();
+		this->vertices.clear();
+		this->tilePool.clear();
+		this->edgePool.clear();
+		this->vertexPool.clear();
+		this->tileEdges.clear();
+		this->tileVertices.clear();
+		this->edgeVertices.clear();
+		this->vertexEdges.clear();
+		this->vertexTiles.clear();
+		this->vertexExpectedYields.clear();
+		this->vertexOccupied.clear();
+		this->vertexBlockedByNeighbours.clear();
 
-		std::unordered_map<size_t, VertexHandle> verticesMap;
-		std::unordered_map<size_t, EdgeHandle> edgesMap;
+		// json objects are ordered by (string) key -> collect + sort numerically
+		std::map<size_t, const json*> tilesJson;
+		std::map<size_t, std::array<size_t, 2>> edgeDefinitions;
+		std::set<size_t> vertexIdSet;
 
 		for (auto it = j.begin(); it != j.end(); ++it) {
-			size_t tileId = std::stoul(it.key());
 			const json& tileJson = it.value();
-
-			// TODO: add robust input validation
-			if (!tileJson.contains("edges") || !tileJson["edges"].is_object()) {
+			if (!tileJson.contains("edges") || !tileJson["edges"].is_array() || tileJson["edges"].size() != 6) {
 				throw std::runtime_error("Invalid JSON structure");
 			}
 
-			std::unique_ptr<Tile> tile = std::make_unique<Tile>();
-			tile->setId(tileId);
-			tile->deserialize(tileJson["meta"]);
-			self.addTile(std::move(tile));
-
-			const auto& edgesJson = tileJson["edges"];
-
-			std::array<EdgeHandle, 6> tileEdgesArray{};
-			size_t edgeIndex = 0;
-
-			for (auto edgeIt = edgesJson.begin(); edgeIt != edgesJson.end(); ++edgeIt) {
-				if (!edgeIt.value().is_array() || edgeIt.value().size() != 2) {
+			for (const auto& edgeJson : tileJson["edges"]) {
+				if (!edgeJson.is_array() || edgeJson.size() != 3) {
 					throw std::runtime_error("Invalid JSON structure");
 				}
+				const size_t vId0 = edgeJson.at(1).get<size_t>();
+				const size_t vId1 = edgeJson.at(2).get<size_t>();
+				edgeDefinitions.emplace(edgeJson.at(0).get<size_t>(), std::array<size_t, 2>{vId0, vId1});
+				vertexIdSet.insert(vId0);
+				vertexIdSet.insert(vId1);
+			}
+			tilesJson.emplace(std::stoul(it.key()), &tileJson);
+		}
 
-				size_t edgeId = std::stoul(edgeIt.key());
-				const json& verticesJson = edgeIt.value();
+		this->vertexPool.reserve(vertexIdSet.size());
+		this->edgePool.reserve(edgeDefinitions.size());
+		this->tilePool.reserve(tilesJson.size());
 
-				Edge edge;
-				edge.setId(edgeId);
-				edgesMap.emplace(edgeId, &edge);
+		for (const size_t vertexId : vertexIdSet) {
+			this->addVertex(Vertex(vertexId));
+		}
 
-				size_t vId0 = verticesJson.at(0).get<size_t>();
-				size_t vId1 = verticesJson.at(1).get<size_t>();
+		for (const auto& [edgeId, vertexIds] : edgeDefinitions) {
+			this->addEdge(Edge(edgeId));
 
-				Vertex v0(vId0);
-				Vertex v1(vId1);
+			const EdgeHandle edge = this->edges.back();
+			this->edgeVertices.back() = {this->findVertexById(vertexIds[0]), this->findVertexById(vertexIds[1])};
+			for (const VertexHandle vertex : this->edgeVertices.back()) {
+				addToFirstFreeSlot(this->vertexEdges[this->indexOfVertex(vertex->getId())], edge);
+			}
+		}
 
-				verticesMap.emplace(vId0, &v0);
-				verticesMap.emplace(vId1, &v1);
+		for (const auto& [tileId, tileJson] : tilesJson) {
+			Tile tile;
+			tile.setId(tileId);
+			tile.deserialize((*tileJson)["meta"]);
+			this->addTile(tile);
 
-				self.edgeVertices[edgeId] = {verticesMap[vId0], verticesMap[vId1]};
-				if (edgeIndex < 6) {
-					tileEdgesArray[edgeIndex++] = edgesMap.at(edgeId);
-				}
+			const TileHandle tileHandle = this->tiles.back();
+			auto& localEdges = this->tileEdges.back();
+			auto& localVertices = this->tileVertices.back();
+
+			const auto& edgesJson = (*tileJson)["edges"];
+			for (size_t i = 0; i < 6; ++i) {
+				localEdges[i] = this->findEdgeById(edgesJson.at(i).at(0).get<size_t>());
 			}
 
-			self.tileEdges[tileId] = tileEdgesArray;
+			// edge i connects vertex i and i + 1 -> vertex i is the one shared by edge i - 1 and edge i
+			for (size_t i = 0; i < 6; ++i) {
+				const auto& previous = this->edgeVertices[this->indexOfEdge(localEdges[(i + 5) % 6]->getId())];
+				const auto& current = this->edgeVertices[this->indexOfEdge(localEdges[i]->getId())];
+				localVertices[i] = (current[0] == previous[0] || current[0] == previous[1]) ? current[0] : current[1];
+				addToFirstFreeSlot(this->vertexTiles[this->indexOfVertex(localVertices[i]->getId())], tileHandle);
+			}
 		}
-		// TODO:
-		// for (auto& [id, vertex] : verticesMap) { self.vertices.push_back(vertex); }
-		// for (auto& [id, edge] : edgesMap) { self.edges.push_back(edge); }
+
+		this->updateAllExpectedYields();
+		this->resetSettlementOccupancy();
 	}
 
 
@@ -520,42 +773,37 @@ namespace df {
 		std::vector<size_t> neighbors;
 
 		// Check for id being of a Tile:
-		if (auto it = this->tileEdges.find(id); it != this->tileEdges.end()) {
-			for (const auto& edge : it->second) {
-				if (edge->getId() != SIZE_MAX) {
+		if (const size_t index = this->indexOfTile(id); index != SIZE_MAX) {
+			for (const auto& edge : this->tileEdges[index]) {
+				if (edge && edge->getId() != SIZE_MAX) {
 					neighbors.push_back(edge->getId());
 				}
 			}
-		}
-		if (auto it = this->tileVertices.find(id); it != this->tileVertices.end()) {
-			for (const auto& vertex : it->second) {
-				if (vertex->getId() != SIZE_MAX) {
+			for (const auto& vertex : this->tileVertices[index]) {
+				if (vertex && vertex->getId() != SIZE_MAX) {
 					neighbors.push_back(vertex->getId());
 				}
 			}
 		}
 
 		// Check for id being of an edge:
-		if (auto it = this->edgeVertices.find(id); it != this->edgeVertices.end()) {
-			for (const auto& vertex : it->second) {
-				if (vertex->getId() != SIZE_MAX) {
+		if (const size_t index = this->indexOfEdge(id); index != SIZE_MAX) {
+			for (const auto& vertex : this->edgeVertices[index]) {
+				if (vertex && vertex->getId() != SIZE_MAX) {
 					neighbors.push_back(vertex->getId());
 				}
 			}
 		}
 
 		// Check for id being of a vertex:
-		if (auto it = this->vertexEdges.find(id); it != this->vertexEdges.end()) {
-			for (const auto& edge : it->second) {
-				if (edge->getId() != SIZE_MAX) {
+		if (const size_t index = this->indexOfVertex(id); index != SIZE_MAX) {
+			for (const auto& edge : this->vertexEdges[index]) {
+				if (edge && edge->getId() != SIZE_MAX) {
 					neighbors.push_back(edge->getId());
 				}
 			}
-		}
-
-		if (auto it = this->vertexTiles.find(id); it != this->vertexTiles.end()) {
-			for (const auto& tile : it->second) {
-				if (tile->getId() != SIZE_MAX) {
+			for (const auto& tile : this->vertexTiles[index]) {
+				if (tile && tile->getId() != SIZE_MAX) {
 					neighbors.push_back(tile->getId());
 				}
 			}
@@ -743,550 +991,208 @@ namespace df {
 
 	// Map methods
 	void Graph::regenerate(const WorldGeneratorConfig& worldGeneratorConfig) {
-		if (const Result<std::vector<Tile>, ResultError> generatedTiles = WorldGenerator::generateTiles(worldGeneratorConfig); generatedTiles.isOk()) {
-			fmt::println("[DEBUG] generated tiles");
-			setMapWidth(worldGeneratorConfig.columns);
-			// tiles = generatedTiles.unwrap();
-			fmt::println("[DEBUG] start initializing tiles");
-			this->initializeTilesForGraph(generatedTiles.unwrap());
-			fmt::println("[DEBUG] finished initializing tiles, try populating graph");
-			try {
-				this->populate();
-			} catch (const std::exception& e) {
-				std::cerr << "Error populating graph: " << e.what() << std::endl;
-			}
-			fmt::println("[DEBUG] finished populating graph");
-			this->renderUpdateRequested = true;
+		// unwrap() would return a copy, the tiles are moved into the tile pool instead
+		if (Result<std::vector<Tile>, ResultError> generatedTiles = WorldGenerator::generateTiles(worldGeneratorConfig); generatedTiles.isOk()) {
+			this->rebuild(std::move(generatedTiles.storage().template get<std::vector<Tile>>()), worldGeneratorConfig.columns);
 		} else {
-			std::cerr << generatedTiles.unwrapErr() << std::endl;
+			DF_LOG_ERROR(WORLD, "{}", fmt::streamed(generatedTiles.unwrapErr()));
 		}
 	}
 
 
-	void Graph::initializeTilesForGraph(std::vector<Tile> newTiles) {
+	void Graph::rebuild(const std::vector<Tile>& newTiles, unsigned columns) {
+		this->setMapWidth(columns);
+		this->initializeTilesForGraph(newTiles);
+		try {
+			this->populate();
+		} catch (const std::exception& e) {
+			DF_LOG_ERROR(GRAPH, "Error populating graph: {}", e.what());
+		}
+		this->renderUpdateRequested = true;
+	}
+
+
+	void Graph::rebuild(std::vector<Tile>&& newTiles, unsigned columns) {
+		this->setMapWidth(columns);
+		this->initializeTilesForGraph(std::move(newTiles));
+		try {
+			this->populate();
+		} catch (const std::exception& e) {
+			DF_LOG_ERROR(GRAPH, "Error populating graph: {}", e.what());
+		}
+		this->renderUpdateRequested = true;
+	}
+
+
+	void Graph::clearTiles(size_t newTileCount) {
+		this->tiles.clear();
+		this->tilePool.clear();
+		this->tileEdges.clear();
+		this->tileVertices.clear();
+
+		this->tiles.reserve(newTileCount);
+		this->tileEdges.reserve(newTileCount);
+		this->tileVertices.reserve(newTileCount);
+	}
+
+
+	void Graph::initializeTilesForGraph(const std::vector<Tile>& newTiles) {
 		if (newTiles.empty())
 			return;
-		fmt::println("[DEBUG] start initializing tiles with a non-empty newTiles vector");
-		fmt::println("[DEBUG] clear existing tiles");
-		this->tiles.clear();
-		fmt::println("[DEBUG] iterating over tiles to create new ones");
 
-		for (auto newTile : newTiles) {
-			std::unique_ptr<Tile> tile = std::make_unique<Tile>(newTile.getId(), newTile.getType(), newTile.getPotency());
-			this->addTile(std::move(tile));
+		this->clearTiles(newTiles.size());
+		this->tilePool.reserve(newTiles.size());
+		for (const auto& newTile : newTiles) {
+			this->addTile(Tile(newTile.getId(), newTile.getType(), newTile.getPotency()));
 		}
-		fmt::println("[DEBUG] finished initializing tiles");
+	}
+
+
+	// the vector becomes the tile pool's block, the handles point right into it
+	void Graph::initializeTilesForGraph(std::vector<Tile>&& newTiles) {
+		if (newTiles.empty())
+			return;
+
+		const size_t tileCount = newTiles.size();
+		this->clearTiles(tileCount);
+		TileHandle tile = this->tilePool.adopt(std::move(newTiles));
+		for (size_t i = 0; i < tileCount; ++i, ++tile) {
+			if (this->findTileById(tile->getId()) != nullptr)
+				continue;
+
+			trackInsertedId(this->tiles, this->tileIds, tile->getId());
+			this->tiles.push_back(tile);
+		}
+		this->tileEdges.resize(this->tiles.size());
+		this->tileVertices.resize(this->tiles.size());
+		this->markTileSetChanged();
 	}
 
 
 	// populates the graph with edges and vertices for all tiles.
-	// this function also regards the fact that some tiles share edges and/or vertices
+	// this function also regards the fact that some tiles share edges and/or vertices.
+	//
+	// Layout: row r is at y = 1.5 * r (rows grow upwards), odd rows are shifted half a tile to the right.
+	// Vertex i of a tile: 0 top, 1 top-right, 2 bottom-right, 3 bottom, 4 bottom-left, 5 top-left.
+	// Edge i connects vertex i and vertex (i + 1) % 6.
+	//
+	// Tiles are visited in id order, so the left and the two lower neighbours already exist and own the shared
+	// nodes; only the remaining ones get created. This is O(n) and no lookup maps are needed.
+	// Ids: tiles keep theirs, vertices follow directly after the highest tile id, edges after the last vertex.
 	void Graph::populate() {
 		if (this->tiles.empty() || this->mapWidth == 0)
 			return;
 
 		this->edges.clear();
 		this->vertices.clear();
-		this->tileEdges.clear();
-		this->tileVertices.clear();
+		this->edgePool.clear();
+		this->vertexPool.clear();
 		this->edgeVertices.clear();
 		this->vertexEdges.clear();
 		this->vertexTiles.clear();
-
-		fmt::println("[DEBUG].[populate] cleared vectors");
+		this->vertexExpectedYields.clear();
+		this->vertexOccupied.clear();
+		this->vertexBlockedByNeighbours.clear();
 
 		const size_t columns = this->mapWidth;
-		const size_t rows = this->tiles.size() / columns;
-		fmt::println("[DEBUG].[populate] received map dimensions: columns={}, rows={}, tiles.size()={}", columns, rows, this->tiles.size());
+		size_t maxTileId = 0;
+		for (const auto& tile : this->tiles)
+			maxTileId = std::max(maxTileId, tile->getId());
+		const size_t rows = maxTileId / columns + 1;
 
-		if (columns == 0 || rows == 0 || this->tiles.empty()) {
-			fmt::println("[DEBUG].[populate] ERROR: Invalid map dimensions or empty tiles!");
-			return;
+		// tile index for every grid cell (tile id = row * columns + col), SIZE_MAX for holes
+		std::vector<size_t> cellToTile(rows * columns, SIZE_MAX);
+		for (size_t tileIndex = 0; tileIndex < this->tiles.size(); ++tileIndex) {
+			cellToTile[this->tiles[tileIndex]->getId()] = tileIndex;
 		}
 
-		// use hash as map key
-		struct PairHash {
-			size_t operator()(const std::pair<size_t, size_t>& p) const {
-				return std::hash<size_t>{}(p.first) ^ (std::hash<size_t>{}(p.second) << 1);
-			}
+		// tile index of the neighbour at (row + dRow, col + dCol), SIZE_MAX if there is none
+		auto neighbour = [&](size_t row, size_t col, int dRow, int dCol) -> size_t {
+			const long long newRow = static_cast<long long>(row) + dRow;
+			const long long newCol = static_cast<long long>(col) + dCol;
+			if (newRow < 0 || newRow >= static_cast<long long>(rows) || newCol < 0 || newCol >= static_cast<long long>(columns))
+				return SIZE_MAX;
+			return cellToTile[static_cast<size_t>(newRow) * columns + static_cast<size_t>(newCol)];
 		};
 
-		// track created edges/vertexes to avoid duplicates
-		// format: key=(canonical tile id, index), value=id for vertex/edge
-		// canonical tile id: smallest tile id that shares this element
-		std::unordered_map<std::pair<size_t, size_t>, size_t, PairHash> edgeIdMap;
-		std::unordered_map<std::pair<size_t, size_t>, size_t, PairHash> vertexIdMap;
-
-		fmt::println("[DEBUG].[populate] start defining some helpers: getNeighbor, getVertexKey, getEdgeKey");
-		// helper to get neighbouring tile id at some offset (dRow, dCol)
-		fmt::println("[DEBUG].[populate] defining getNeighbour lambda");
-		auto getNeighbour = [columns, rows](size_t tileId, int dRow, int dCol) -> std::optional<size_t> {
-			size_t row = tileId / columns;
-			size_t col = tileId % columns;
-			int newRow = static_cast<int>(row) + dRow;
-			int newCol = static_cast<int>(col) + dCol;
-
-			// Check bounds
-			if (newRow < 0 || newRow >= static_cast<int>(rows) || newCol < 0 || newCol >= static_cast<int>(columns))
-				return std::nullopt;
-
-			size_t neighbourId = static_cast<size_t>(newRow) * columns + static_cast<size_t>(newCol);
-			// Check if neighbourId is valid and within expected range
-			// Note: We can't directly check tiles[neighbourId] because tiles might not be indexed by ID
-			// Instead, we just verify the calculated ID is within the expected grid bounds
-			if (neighbourId >= rows * columns) {
-				return std::nullopt;
-			}
-			return std::optional<size_t>(neighbourId);
-		};
-		fmt::println("[DEBUG].[populate] finished defining getNeighbour");
-
-		// make sure shared vertices (by tiles) get same id -> no duplicats
-		// use "canonical key" for a vertex -> "refrence" tile with smallest id
-		fmt::println("[DEBUG].[populate] defining getVertexKey lambda");
-		auto getVertexKey = [&getNeighbour, columns](size_t tileId, size_t vertexIndex) -> std::pair<size_t, size_t> {
-			if (columns == 0) {
-				throw std::logic_error("getVertexKey: columns is zero!");
-			}
-			size_t row = tileId / columns;
-			bool isOdd = (row & 1) == 1; // odd rows have different neighbours -> hexagonal represented by row/col
-			size_t minTileId = tileId;
-			std::vector<size_t> sharingTiles = {tileId};
-
-			switch (vertexIndex) {
-			case 0: // Top
-				if (isOdd) {
-					// Odd row: top-left (row-1, col), top-right (row-1, col+1)
-					if (auto n = getNeighbour(tileId, -1, 0))
-						sharingTiles.push_back(*n);
-					if (auto n = getNeighbour(tileId, -1, 1))
-						sharingTiles.push_back(*n);
-				} else {
-					// Even row: top-left (row-1, col-1), top-right (row-1, col)
-					if (auto n = getNeighbour(tileId, -1, -1))
-						sharingTiles.push_back(*n);
-					if (auto n = getNeighbour(tileId, -1, 0))
-						sharingTiles.push_back(*n);
-				}
-				break;
-			case 1: // Top-right
-				if (auto n = getNeighbour(tileId, 0, 1))
-					sharingTiles.push_back(*n);
-				break;
-			case 2: // Bottom-right -> right flat edge (sharde with right neighbour)
-				if (auto n = getNeighbour(tileId, 0, 1))
-					sharingTiles.push_back(*n);
-				break;
-			case 3: // Bottom vertex
-				if (isOdd) {
-					// Odd row: bottom-left (row+1, col), bottom-right (row+1, col+1)
-					if (auto n = getNeighbour(tileId, 1, 0))
-						sharingTiles.push_back(*n);
-					if (auto n = getNeighbour(tileId, 1, 1))
-						sharingTiles.push_back(*n);
-				} else {
-					// Even row: bottom-left (row+1, col-1), bottom-right (row+1, col)
-					if (auto n = getNeighbour(tileId, 1, -1))
-						sharingTiles.push_back(*n);
-					if (auto n = getNeighbour(tileId, 1, 0))
-						sharingTiles.push_back(*n);
-				}
-				break;
-			case 4: // bottom-left -> shared with left neighbuor
-				if (auto n = getNeighbour(tileId, 0, -1))
-					sharingTiles.push_back(*n);
-				break;
-			case 5: // top-left vertex ->left neighboor
-				if (auto n = getNeighbour(tileId, 0, -1))
-					sharingTiles.push_back(*n);
-				break;
-			}
-
-			// get canconical tile
-			for (size_t tid : sharingTiles)
-				if (tid < minTileId)
-					minTileId = tid;
-
-			// Determine the vertex index in the canonical tile
-			// If the canonical tile is the current tile, use the current vertexIndex
-			// Otherwise, determine what index this vertex has in the canonical tile
-			size_t canonicalVertexIndex = vertexIndex;
-			if (minTileId != tileId) {
-				std::sort(sharingTiles.begin(), sharingTiles.end());
-				bool isCanonicalOdd = ((minTileId / columns) & 1) == 1;
-
-				// For vertices shared by 3 tiles, determine the canonical index
-				// by checking the relative positions of sharing tiles
-				if (sharingTiles.size() == 3) {
-
-					// Determine which vertex index in the canonical tile corresponds to this shared vertex
-					// by checking which neighbours the canonical tile has which match the sharing tiles
-					for (size_t vi = 0; vi < 6; ++vi) {
-						std::vector<size_t> canonicalSharingTiles = {minTileId};
-
-						switch (vi) {
-						case 0: // Top
-							if (isCanonicalOdd) {
-								if (auto n = getNeighbour(minTileId, -1, 0))
-									canonicalSharingTiles.push_back(*n);
-								if (auto n = getNeighbour(minTileId, -1, 1))
-									canonicalSharingTiles.push_back(*n);
-							} else {
-								if (auto n = getNeighbour(minTileId, -1, -1))
-									canonicalSharingTiles.push_back(*n);
-								if (auto n = getNeighbour(minTileId, -1, 0))
-									canonicalSharingTiles.push_back(*n);
-							}
-							break;
-						case 1: // Top-right
-							if (auto n = getNeighbour(minTileId, 0, 1))
-								canonicalSharingTiles.push_back(*n);
-							break;
-						case 2: // Bottom-right
-							if (auto n = getNeighbour(minTileId, 0, 1))
-								canonicalSharingTiles.push_back(*n);
-							break;
-						case 3: // Bottom
-							if (isCanonicalOdd) {
-								if (auto n = getNeighbour(minTileId, 1, 0))
-									canonicalSharingTiles.push_back(*n);
-								if (auto n = getNeighbour(minTileId, 1, 1))
-									canonicalSharingTiles.push_back(*n);
-							} else {
-								if (auto n = getNeighbour(minTileId, 1, -1))
-									canonicalSharingTiles.push_back(*n);
-								if (auto n = getNeighbour(minTileId, 1, 0))
-									canonicalSharingTiles.push_back(*n);
-							}
-							break;
-						case 4: // Bottom-left
-							if (auto n = getNeighbour(minTileId, 0, -1))
-								canonicalSharingTiles.push_back(*n);
-							break;
-						case 5: // Top-left
-							if (auto n = getNeighbour(minTileId, 0, -1))
-								canonicalSharingTiles.push_back(*n);
-							break;
-						}
-
-						std::sort(canonicalSharingTiles.begin(), canonicalSharingTiles.end());
-						if (canonicalSharingTiles == sharingTiles) {
-							canonicalVertexIndex = vi;
-							break;
-						}
-					}
-				}
-				// else {
-				// 	// For vertices shared by 2 tiles (edge vertices), we need to determine the vertex index in the canonical tile
-				// 	// Try to find which vertex index in the canonical tile corresponds to this shared vertex
-				// 	// size_t canonicalRow = minTileId / columns;
-				// 	// bool canonicalIsOdd = ((minTileId / columns) & 1) == 1;
-				//
-				// 	for (size_t vi = 0; vi < 6; ++vi) {
-				// 		std::vector<size_t> canonicalSharingTiles = {minTileId};
-				//
-				// 		switch (vi) {
-				// 		case 0: // Top
-				// 			if (isCanonicalOdd) {
-				// 				if (auto n = getNeighbour(minTileId, -1, 0))
-				// 					canonicalSharingTiles.push_back(*n);
-				// 				if (auto n = getNeighbour(minTileId, -1, 1))
-				// 					canonicalSharingTiles.push_back(*n);
-				// 			} else {
-				// 				if (auto n = getNeighbour(minTileId, -1, -1))
-				// 					canonicalSharingTiles.push_back(*n);
-				// 				if (auto n = getNeighbour(minTileId, -1, 0))
-				// 					canonicalSharingTiles.push_back(*n);
-				// 			}
-				// 			break;
-				// 		case 1: // Top-right
-				// 			if (auto n = getNeighbour(minTileId, 0, 1))
-				// 				canonicalSharingTiles.push_back(*n);
-				// 			break;
-				// 		case 2: // Bottom-right
-				// 			if (auto n = getNeighbour(minTileId, 0, 1))
-				// 				canonicalSharingTiles.push_back(*n);
-				// 			break;
-				// 		case 3: // Bottom
-				// 			if (isCanonicalOdd) {
-				// 				if (auto n = getNeighbour(minTileId, 1, 0))
-				// 					canonicalSharingTiles.push_back(*n);
-				// 				if (auto n = getNeighbour(minTileId, 1, 1))
-				// 					canonicalSharingTiles.push_back(*n);
-				// 			} else {
-				// 				if (auto n = getNeighbour(minTileId, 1, -1))
-				// 					canonicalSharingTiles.push_back(*n);
-				// 				if (auto n = getNeighbour(minTileId, 1, 0))
-				// 					canonicalSharingTiles.push_back(*n);
-				// 			}
-				// 			break;
-				// 		case 4: // Bottom-left
-				// 			if (auto n = getNeighbour(minTileId, 0, -1))
-				// 				canonicalSharingTiles.push_back(*n);
-				// 			break;
-				// 		case 5: // Top-left
-				// 			if (auto n = getNeighbour(minTileId, 0, -1))
-				// 				canonicalSharingTiles.push_back(*n);
-				// 			break;
-				// 		}
-				//
-				// 		std::sort(canonicalSharingTiles.begin(), canonicalSharingTiles.end());
-				// 		if (canonicalSharingTiles == sharingTiles) {
-				// 			canonicalVertexIndex = vi;
-				// 			break;
-				// 		}
-				// 	}
-				//
-				// 	// If we still couldn't find a match, use a hash of the sorted sharing tiles as a fallback
-				// 	// This ensures we still get a consistent key even if the matching logic fails
-				// 	if (canonicalVertexIndex == vertexIndex && minTileId != tileId) {
-				// 		// Use a simple hash of the sorted sharing tile IDs to create a unique but consistent key
-				// 		size_t hash = 0;
-				// 		for (size_t tid : sharingTiles) {
-				// 			hash = hash * 31 + tid; // Simple hash function
-				// 		}
-				// 		// Map hash to a vertex index (0-5) using modulo
-				// 		canonicalVertexIndex = hash % 6;
-				// 	}
-				// }
-			}
+		// upper bounds: every tile adds at most 2 new vertices + 3 new edges besides the map border
+		const size_t tileCount = this->tiles.size();
+		this->vertices.reserve(2 * tileCount + 2 * (rows + columns) + 2);
+		this->vertexEdges.reserve(this->vertices.capacity());
+		this->vertexTiles.reserve(this->vertices.capacity());
+		this->vertexPool.reserve(this->vertices.capacity());
+		this->edges.reserve(3 * tileCount + 2 * (rows + columns) + 2);
+		this->edgeVertices.reserve(this->edges.capacity());
+		this->edgePool.reserve(this->edges.capacity());
 
-			// (canonicalTileId, canonicalVertexIndex)
-			return {minTileId, canonicalVertexIndex};
+		size_t nextVertexId = maxTileId + 1;
+		auto createVertex = [&]() -> VertexHandle {
+			this->vertexTiles.emplace_back();
+			this->vertexEdges.emplace_back();
+			return this->vertices.emplace_back(this->vertexPool.emplace(nextVertexId++));
 		};
 
-		// similar to above, just for edges (shard among at most 2 tiles)
-		fmt::println("[DEBUG].[populate] defining getEdgeKey lambda");
-		auto getEdgeKey = [&getNeighbour, columns](size_t tileId, size_t edgeIndex) -> std::pair<size_t, size_t> {
-			size_t row = tileId / columns;
-			bool isOdd = (row & 1) == 1;
-			size_t minTileId = tileId;
-			std::optional<size_t> neighbour;
-
-			switch (edgeIndex) {
-			case 0:
-				neighbour = isOdd ? getNeighbour(tileId, -1, 1) : getNeighbour(tileId, -1, 0);
-				break;
-			case 1:
-				neighbour = getNeighbour(tileId, 0, 1);
-				break;
-			case 2:
-				neighbour = isOdd ? getNeighbour(tileId, 1, 1) : getNeighbour(tileId, 1, 0);
-				break;
-			case 3:
-				neighbour = isOdd ? getNeighbour(tileId, 1, 0) : getNeighbour(tileId, 1, -1);
-				break;
-			case 4:
-				neighbour = getNeighbour(tileId, 0, -1);
-				break;
-			case 5:
-				neighbour = isOdd ? getNeighbour(tileId, -1, 0) : getNeighbour(tileId, -1, -1);
-				break;
-			}
-
-			if (neighbour && *neighbour < minTileId)
-				minTileId = *neighbour;
-
-			size_t canonicalEdgeIndex = edgeIndex;
-			if (minTileId != tileId && neighbour.has_value()) {
-				bool isCanonicalOdd = ((minTileId / columns) & 1) == 1;
-
-				// Which edge index in the canonical tile corresponds to this edge
-				// checking which neighbour the canonical tile has which matches the current tile
-				for (size_t ei = 0; ei < 6; ++ei) {
-					std::optional<size_t> canonicalNeighbour;
-
-					switch (ei) {
-					case 0:
-						canonicalNeighbour = isCanonicalOdd ? getNeighbour(minTileId, -1, 1) : getNeighbour(minTileId, -1, 0);
-						break;
-					case 1:
-						canonicalNeighbour = getNeighbour(minTileId, 0, 1);
-						break;
-					case 2:
-						canonicalNeighbour = isCanonicalOdd ? getNeighbour(minTileId, 1, 1) : getNeighbour(minTileId, 1, 0);
-						break;
-					case 3:
-						canonicalNeighbour = isCanonicalOdd ? getNeighbour(minTileId, 1, 0) : getNeighbour(minTileId, 1, -1);
-						break;
-					case 4:
-						canonicalNeighbour = getNeighbour(minTileId, 0, -1);
-						break;
-					case 5:
-						canonicalNeighbour = isCanonicalOdd ? getNeighbour(minTileId, -1, 0) : getNeighbour(minTileId, -1, -1);
-						break;
-					}
-
-					// If the canonical tile's edge connects to the same neighbour (=current tile), that's the correct edge index
-					if (canonicalNeighbour.has_value() && *canonicalNeighbour == tileId) {
-						canonicalEdgeIndex = ei;
-						break;
-					}
-				}
-			}
-
-			return {minTileId, canonicalEdgeIndex};
+		// node owned by an already processed neighbour (nullptr if there is no such neighbour)
+		auto sharedVertex = [this](size_t owner, size_t slot) -> VertexHandle {
+			return (owner != SIZE_MAX) ? this->tileVertices[owner][slot] : nullptr;
+		};
+		auto sharedEdge = [this](size_t owner, size_t slot) -> EdgeHandle {
+			return (owner != SIZE_MAX) ? this->tileEdges[owner][slot] : nullptr;
 		};
 
-		// Calculate the maximum tile ID to avoid ID conflicts
-		// Vertex IDs will start at maxTileId + 1, edge IDs at maxTileId + 1000000 -> TODO: make more flexible (although this sould be enough)
-		size_t maxTileId = 0;
-		for (const auto& tile : this->tiles)
-			if (tile->getId() > maxTileId)
-				maxTileId = tile->getId();
-		fmt::print("[DEBUG].[populate] got max tile id: {} and start iterating over tiles", maxTileId);
-
-		size_t nextVertexId = maxTileId + 1;
-		size_t nextEdgeId = maxTileId + 1000000;
-		fmt::println("[DEBUG].[populate] got max tile id: {} and start iterating over tiles", maxTileId);
-		fmt::println("[DEBUG].[populate] about to iterate over {} tiles", this->tiles.size());
-
-		fmt::println("[DEBUG].[populate] starting tile iteration loop");
-		size_t tileIndex = 0;
-		for (const auto& tile : this->tiles) {
-			fmt::println("[DEBUG].[populate] processing tile index {}", tileIndex++);
-			if (!tile) {
-				fmt::println("[DEBUG].[populate] ERROR: Found null tile pointer!");
+		// cells are processed in id order, neighbours with a smaller id are done already.
+		// Edges are created in the same pass, numbered by creation order first and moved behind the vertex ids afterwards.
+		size_t nextEdgeIndex = 0;
+		for (size_t cell = 0; cell < rows * columns; ++cell) {
+			const size_t tileIndex = cellToTile[cell];
+			if (tileIndex == SIZE_MAX)
 				continue;
-			}
-			fmt::println("[DEBUG].[populate] got tile pointer, getting ID");
-			size_t tileId = tile->getId();
-			fmt::println("[DEBUG].[populate] tile ID: {}", tileId);
-			std::array<EdgeHandle, 6> tileEdgesArray{};
-			std::array<VertexHandle, 6> tileVerticesArray{};
-
-			fmt::println("[DEBUG].[populate] starting vertex loop for tile {}", tileId);
-			for (size_t vi = 0; vi < 6; ++vi) {
-				// canonical key for vertex
-				fmt::println("[DEBUG].[populate] calling getVertexKey for tile {}, vertex index {}", tileId, vi);
-				auto key = getVertexKey(tileId, vi);
-				fmt::println("[DEBUG].[populate] got vertex key: ({}, {})", key.first, key.second);
-				VertexHandle tmpVertex = nullptr;
-
-				// if already exists, use existing vertex, else add unique new one
-				fmt::println("[DEBUG].[populate] looking up key in vertexIdMap (size: {})", vertexIdMap.size());
-				try {
-					if (auto it = vertexIdMap.find(key); it != vertexIdMap.end()) {
-						fmt::println("[DEBUG].[populate] found existing vertex in map");
-						tmpVertex = this->findVertexById(it->second);
-						if (!tmpVertex) {
-							throw std::logic_error(fmt::format("Error while getting vertex. vertexIdMap out of sync: vertex {} missing", it->second));
-							// continue;
-						}
-					} else {
-						fmt::println("[DEBUG].[populate] creating new vertex");
-						size_t vertexId = nextVertexId++;
-						fmt::println("[DEBUG].[populate] new vertex ID: {}", vertexId);
-
-						auto vertex = std::make_unique<Vertex>(vertexId);
-						tmpVertex = vertex.get();
-						fmt::println("[DEBUG].[populate] created vertex unique_ptr, calling addVertex");
-						this->addVertex(std::move(vertex));
-						fmt::println("[DEBUG].[populate] added vertex, storing in map");
-
-						vertexIdMap[key] = vertexId;
-						fmt::println("[DEBUG].[populate] stored vertex in map");
-					}
-				} catch (const std::exception& e) {
-					fmt::println("[DEBUG].[populate] EXCEPTION in vertex handling: {}", e.what());
-					throw;
-				}
 
-				// store in tileVertices array and connect to tile
-				tileVerticesArray[vi] = tmpVertex;
-				this->connectVertexToTile(tmpVertex, tile.get());
+			const size_t row = cell / columns;
+			const size_t col = cell % columns;
+			const int shift = (row & 1) ? 0 : -1; // even rows are shifted left compared to odd rows
+			const size_t left = neighbour(row, col, 0, -1);
+			const size_t lowerLeft = neighbour(row, col, -1, shift);
+			const size_t lowerRight = neighbour(row, col, -1, shift + 1);
+
+			auto& localVertices = this->tileVertices[tileIndex];
+			localVertices = {nullptr, nullptr, sharedVertex(lowerRight, 0), sharedVertex(lowerRight, 5), sharedVertex(lowerLeft, 0), sharedVertex(left, 1)};
+			if (!localVertices[3])
+				localVertices[3] = sharedVertex(lowerLeft, 1);
+			if (!localVertices[4])
+				localVertices[4] = sharedVertex(left, 2);
+			for (auto& vertex : localVertices) {
+				if (!vertex)
+					vertex = createVertex();
+			}
 
-				// Build reverse lookup: add tile to vertexTiles
-				size_t vertexId = tmpVertex->getId();
-				if (!this->vertexTiles.contains(vertexId)) {
-					this->vertexTiles[vertexId] = std::array<TileHandle, 3>{};
-				}
-				auto& vertexTilesArray = this->vertexTiles[vertexId];
-				for (size_t i = 0; i < 3; ++i) {
-					if (!vertexTilesArray[i] || vertexTilesArray[i] == tile.get()) {
-						vertexTilesArray[i] = tile.get();
-						break;
-					}
-				}
+			// vertex ids are consecutive in creation order -> index = id - first id
+			for (const VertexHandle vertex : localVertices) {
+				addToFirstFreeSlot(this->vertexTiles[vertex->getId() - (maxTileId + 1)], this->tiles[tileIndex]);
 			}
-			fmt::println("[DEBUG].[populate] finished with vertices for tile with id: {}", tile->getId());
-
-			// simliar to above
-			for (size_t ei = 0; ei < 6; ++ei) {
-				auto key = getEdgeKey(tileId, ei);
-				EdgeHandle tmpEdge = nullptr;
-				size_t edgeId;
-
-				if (auto it = edgeIdMap.find(key); it != edgeIdMap.end()) {
-					edgeId = it->second;
-					tmpEdge = this->findEdgeById(edgeId);
-					if (!tmpEdge) {
-						throw std::logic_error(fmt::format("Error while getting edge. edgeIdMap out of sync: edge {} missing", edgeId));
-					}
-				} else {
-					edgeId = nextEdgeId++;
 
-					auto edge = std::make_unique<Edge>(edgeId);
-					tmpEdge = edge.get();
-					this->addEdge(std::move(edge));
+			auto& localEdges = this->tileEdges[tileIndex];
+			localEdges = {nullptr, nullptr, sharedEdge(lowerRight, 5), sharedEdge(lowerLeft, 0), sharedEdge(left, 1), nullptr};
+			for (size_t i = 0; i < 6; ++i) {
+				if (localEdges[i])
+					continue;
 
-					edgeIdMap[key] = edgeId;
-				}
+				localEdges[i] = this->edges.emplace_back(this->edgePool.emplace(nextEdgeIndex++));
 
-				tileEdgesArray[ei] = tmpEdge;
-				this->connectEdgeToTile(tile.get(), tmpEdge);
-
-				// connect edge to the 2 vertices
-				// Edge i connects vertex i to vertex (i+1) % 6
-				auto vertex1Key = getVertexKey(tileId, ei);
-				auto vertex2Key = getVertexKey(tileId, (ei + 1) % 6);
-				auto v1It = vertexIdMap.find(vertex1Key);
-				auto v2It = vertexIdMap.find(vertex2Key);
-				if (v1It != vertexIdMap.end() && v2It != vertexIdMap.end()) {
-					VertexHandle v1 = this->findVertexById(v1It->second);
-					VertexHandle v2 = this->findVertexById(v2It->second);
-					if (v1 && v2) {
-						this->connectVertexToEdge(tmpEdge, v1);
-						this->connectVertexToEdge(tmpEdge, v2);
-
-						// Build reverse lookup: add edge to vertexEdges for both vertices
-						size_t v1Id = v1->getId();
-						size_t v2Id = v2->getId();
-
-						if (!this->vertexEdges.contains(v1Id)) {
-							this->vertexEdges[v1Id] = std::array<EdgeHandle, 3>{};
-						}
-						auto& v1Edges = this->vertexEdges[v1Id];
-						for (size_t i = 0; i < 3; ++i) {
-							if (!v1Edges[i] || v1Edges[i] == tmpEdge) {
-								v1Edges[i] = tmpEdge;
-								break;
-							}
-						}
-
-						if (!this->vertexEdges.contains(v2Id)) {
-							this->vertexEdges[v2Id] = std::array<EdgeHandle, 3>{};
-						}
-						auto& v2Edges = this->vertexEdges[v2Id];
-						for (size_t i = 0; i < 3; ++i) {
-							if (!v2Edges[i] || v2Edges[i] == tmpEdge) {
-								v2Edges[i] = tmpEdge;
-								break;
-							}
-						}
-					}
-				}
+				const VertexHandle v1 = localVertices[i];
+				const VertexHandle v2 = localVertices[(i + 1) % 6];
+				this->edgeVertices.push_back({v1, v2});
+				addToFirstFreeSlot(this->vertexEdges[v1->getId() - (maxTileId + 1)], localEdges[i]);
+				addToFirstFreeSlot(this->vertexEdges[v2->getId() - (maxTileId + 1)], localEdges[i]);
 			}
-			fmt::println("[DEBUG].[populate] finished with edges");
-
-			// store for this tile
-			this->tileEdges[tileId] = tileEdgesArray;
-			this->tileVertices[tileId] = tileVerticesArray;
 		}
+		this->vertexIds = {maxTileId + 1, true};
+		for (const EdgeHandle edge : this->edges) {
+			edge->setId(edge->getId() + nextVertexId);
+		}
+		this->updateAllExpectedYields();
 
-		// Reverse lookup maps (vertexEdges and vertexTiles) are now built during the connection phase above
-		// No need for the slow O(V*E + V*T) pass anymore!
-		fmt::println("[DEBUG].[populate] finished with populating");
-		fmt::println("[DEBUG].[populate] finished wiht populating");
+		this->edgeIds = {nextVertexId, true};
+		this->resetSettlementOccupancy();
 	}
 } // namespace df
@@ -4,8 +4,8 @@
 #include <common.h>
 #include <concepts>
 #include <cstddef>
+#include <cstdint>
 #include <filesystem>
-#include <memory>
 #include <unordered_map>
 #include <vector>
 
@@ -13,6 +13,7 @@
 #include <nlohmann/json.hpp>
 using json = nlohmann::json;
 
+#include "nodePool.h"
 #include "worldGeneratorConfig.h"
 
 #include "edge.h"
@@ -45,7 +46,7 @@ namespace df {
 		Graph() = default;
 		~Graph() = default;
 
-		// Delete copy constructor and copy assignment operator because Graph contains unique_ptr vectors which are non-copyable
+		// Not copyable: the adjacency holds handles into this graph's node pools
 		Graph(const Graph&) = delete;
 		Graph& operator=(const Graph&) = delete;
 
@@ -53,9 +54,10 @@ namespace df {
 		Graph(Graph&&) = default;
 		Graph& operator=(Graph&&) = default;
 
-		void addTile(std::unique_ptr<Tile> tile);
-		void addEdge(std::unique_ptr<Edge> edge);
-		void addVertex(std::unique_ptr<Vertex> vertex);
+		// the graph stores a copy, get its handle with findTileById()/... (ignored if the id exists already)
+		void addTile(const Tile& tile);
+		void addEdge(const Edge& edge);
+		void addVertex(const Vertex& vertex);
 
 		TileHandle getTile(size_t index) const;
 		EdgeHandle getEdge(size_t index) const;
@@ -82,9 +84,49 @@ namespace df {
 
 		size_t getEdgeIndex(size_t edgeId);
 
-		const std::vector<std::unique_ptr<Tile>>& getTiles() const { return this->tiles; }
-		const std::vector<std::unique_ptr<Edge>>& getEdges() const { return this->edges; }
-		const std::vector<std::unique_ptr<Vertex>>& getVertices() const { return this->vertices; }
+		// index into getTiles()/getEdges()/getVertices() (and the adjacency), SIZE_MAX if there is no node with that id
+		size_t indexOfTile(size_t tileId) const;
+		size_t indexOfEdge(size_t edgeId) const;
+		size_t indexOfVertex(size_t vertexId) const;
+
+		// Expected resources per turn for a settlement on the vertex: the sum of getExpectedYield() of its (up to 3) tiles.
+		// Kept up to date by the graph, so settlement scoring and placement hints are O(1). 0 for unknown vertices.
+		float getExpectedYield(const VertexHandle vertex) const;
+		float getExpectedYield(size_t vertexId) const;
+
+		// Change a tile and update the expected yields of its vertices.
+		// Call updateExpectedYields() instead if a tile was modified through its own setters.
+		void setTileType(const TileHandle tile, types::TileType type);
+		void setTilePotency(const TileHandle tile, types::TilePotency potency);
+		void updateExpectedYields(const TileHandle tile);
+
+		// Settlements and the distance rule: a settlement occupies its vertex and blocks the neighbouring vertices.
+		// Both are tracked per vertex, so isSettlementAllowed() is O(1).
+		// Use these instead of Vertex::setSettlementId(), otherwise the occupancy gets out of sync.
+		bool placeSettlement(const VertexHandle vertex, size_t settlementId); // false if there is a settlement already
+		void removeSettlement(const VertexHandle vertex);
+		bool isSettlementAllowed(const VertexHandle vertex) const;
+		bool isSettlementAllowed(size_t vertexId) const;
+
+		// Same for roads, use these instead of Edge::setRoadId()
+		bool placeRoad(const EdgeHandle edge, size_t roadId); // false if there is a road already
+		void removeRoad(const EdgeHandle edge);
+
+		// Incremented whenever a settlement or road is placed/removed or nodes are added/removed.
+		// Lets caches of derived data (e.g. the legal moves in GameController) detect changes they did not see.
+		std::uint64_t getOccupancyRevision() const { return this->occupancyRevision; }
+		// Changes whenever tiles are added/removed or changed through setTileType()/setTilePotency()/updateExpectedYields().
+		// Unique across all graphs, so a cache keyed by it can't confuse a replaced map with the old one (save snapshots).
+		size_t getTileRevision() const { return this->tileRevision; }
+		// The same per chunk of TILE_CHUNK_SIZE tiles (by index in getTiles()): a tile change only moves the revision of
+		// its chunk, adding or removing tiles moves all of them. Copies of the tiles (save snapshots) refresh just those.
+		static constexpr size_t TILE_CHUNK_SIZE = 4096;
+		size_t getTileChunkCount() const { return (this->tiles.size() + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE; }
+		size_t getTileChunkRevision(size_t chunk) const;
+
+		const std::vector<TileHandle>& getTiles() const { return this->tiles; }
+		const std::vector<EdgeHandle>& getEdges() const { return this->edges; }
+		const std::vector<VertexHandle>& getVertices() const { return this->vertices; }
 
 		size_t getTileCount() const { return this->tiles.size(); }
 		size_t getEdgeCount() const { return this->edges.size(); }
@@ -112,6 +154,10 @@ namespace df {
 
 		// Methods for using the graph as a rectangular map
 		void regenerate(const WorldGeneratorConfig& worldGeneratorConfig = WorldGeneratorConfig());
+		// replace the map with already generated tiles (id = row * columns + col) and rebuild edges + vertices
+		void rebuild(const std::vector<Tile>& newTiles, unsigned columns);
+		// same, the graph keeps the tiles instead of copying them
+		void rebuild(std::vector<Tile>&& newTiles, unsigned columns);
 		unsigned getMapWidth() const { return this->mapWidth; }
 		void setMapWidth(const unsigned width) { this->mapWidth = width; }
 		bool isRenderUpdateRequested() const { return this->renderUpdateRequested; }
@@ -119,20 +165,52 @@ namespace df {
 
 
 	  private:
-		// nodes OWNED by the graph
-		std::vector<std::unique_ptr<Tile>> tiles;
-		std::vector<std::unique_ptr<Edge>> edges;
-		std::vector<std::unique_ptr<Vertex>> vertices;
+		// nodes OWNED by the graph. populate() reserves the pools up front, so a whole map is 3 allocations,
+		// not one per node. Removed nodes stay in their pool until the map is rebuilt.
+		NodePool<Tile> tilePool;
+		NodePool<Edge> edgePool;
+		NodePool<Vertex> vertexPool;
 
-		// size_t = ids
-		std::unordered_map<size_t, std::array<EdgeHandle, 6>> tileEdges;
-		std::unordered_map<size_t, std::array<VertexHandle, 6>> tileVertices;
+		// the nodes in graph order (index = position, see indexOfTile() ...)
+		std::vector<TileHandle> tiles;
+		std::vector<EdgeHandle> edges;
+		std::vector<VertexHandle> vertices;
 
-		// would it be worth it to add edgeTiles?!
-		std::unordered_map<size_t, std::array<VertexHandle, 2>> edgeVertices;
+		// adjacency, stored parallel to the node vectors above (tileEdges[i] belongs to tiles[i], ...)
+		std::vector<std::array<EdgeHandle, 6>> tileEdges;
+		std::vector<std::array<VertexHandle, 6>> tileVertices;
 
-		std::unordered_map<size_t, std::array<EdgeHandle, 3>> vertexEdges;
-		std::unordered_map<size_t, std::array<TileHandle, 3>> vertexTiles;
+		// would it be worth it to add edgeTiles?!
+		std::vector<std::array<VertexHandle, 2>> edgeVertices;
+
+		std::vector<std::array<EdgeHandle, 3>> vertexEdges;
+		std::vector<std::array<TileHandle, 3>> vertexTiles;
+
+		// parallel to vertices as well, see getExpectedYield()
+		std::vector<float> vertexExpectedYields;
+
+		// parallel to vertices as well: 1 if the vertex has a settlement, number of neighbouring vertices with a settlement
+		std::vector<std::uint8_t> vertexOccupied;
+		std::vector<std::uint8_t> vertexBlockedByNeighbours;
+		std::uint64_t occupancyRevision = firstOccupancyRevision();
+		size_t tileRevision = 0;
+		size_t tileSetRevision = 0; // tileRevision of the last time tiles were added or removed
+		std::vector<size_t> tileChunkRevisions; // tileRevision of the last change of a tile in the chunk, 0 = none
+		void markTileSetChanged();
+
+		// every graph counts from its own base, so a map moved into a GameState never repeats a revision of the old one
+		static std::uint64_t firstOccupancyRevision();
+
+		// populate() hands out consecutive ids per node type (tiles, then vertices, then edges).
+		// While a node vector keeps that order, the index of a node is (id - first) -> O(1) lookups.
+		// Adding/removing out of order clears `dense` and lookups fall back to a linear search.
+		struct IdRange {
+			size_t first = 0;
+			bool dense = true;
+		};
+		IdRange tileIds;
+		IdRange edgeIds;
+		IdRange vertexIds;
 
 		bool doesTileExist(const TileHandle tile) const;
 		bool doesTileExist(size_t tileId) const;
@@ -142,9 +220,19 @@ namespace df {
 		bool doesVertexExist(size_t vertexId) const;
 
 		// write tiles from vector into graph
-		void initializeTilesForGraph(std::vector<Tile> newTiles);
+		void initializeTilesForGraph(const std::vector<Tile>& newTiles);
+		void initializeTilesForGraph(std::vector<Tile>&& newTiles);
+		void clearTiles(size_t newTileCount);
 		void populate();
 
+		void updateExpectedYield(size_t vertexIndex);
+		void updateAllExpectedYields();
+
+		// +1/-1 on the blocked counters of all neighbours of the vertex
+		void updateNeighbourBlocking(size_t vertexIndex, int delta);
+		// rebuilds the occupancy from the settlement ids of the vertices
+		void resetSettlementOccupancy();
+
 		std::vector<size_t> getNeighborIds(size_t id) const;
 
 		// Methods for using the graph as a rectangular map
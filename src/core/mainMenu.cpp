@@ -1,5 +1,5 @@
 #include "mainMenu.h"
-#include <iostream>
+#include "log.h"
 
 namespace df {
 
@@ -146,11 +146,11 @@ namespace df {
         mouseY = static_cast<float>(extent.y) - mouseY;
 
         if (isCursorOnButton(mouseX, mouseY, startButton)) {
-            fmt::println("Entering configuration");
+            DF_LOG_DEBUG(MENU, "Entering configuration");
             onStartConfig();
         }
         else if (isCursorOnButton(mouseX, mouseY, exitButton)) {
-            fmt::println("Game exited");
+            DF_LOG_DEBUG(MENU, "Game exited");
             onExit();
         }
     }
@@ -0,0 +1,332 @@
+#include "mctsPlayer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include "gamecontroller.h"
+#include "gamestate.h"
+#include "graph.h"
+
+
+
+
+
+namespace df {
+
+    namespace {
+        constexpr std::uint32_t NONE = CompactBoard::NONE;
+        // random vertices the playout policy looks at per settlement, the best legal one is built
+        constexpr size_t POLICY_SAMPLES = 8;
+
+        struct TurnPlan {
+            std::uint32_t settlementVertex = NONE; // vertex index
+            bool buildRoad = false;
+        };
+
+        struct Node {
+            TurnPlan plan;
+            std::uint32_t firstChild = 0;
+            std::uint32_t childCount = 0;
+            bool expanded = false;
+            std::uint32_t visits = 0;
+            double wins = 0.0;
+        };
+
+        // everything a search thread only reads
+        struct Search {
+            const CompactBoard& board;
+            const CompactGameState& root;
+            const std::vector<TurnPlan>& rootPlans;
+            const MctsPlayer::Config& config;
+            size_t playerId;
+            size_t stopRound;
+            std::chrono::steady_clock::time_point deadline;
+        };
+
+
+        // plans for the current turn: no settlement or one of the best legal spots, each with and without a road
+        void collectPlans(const CompactGameState& state, const CompactBoard& board, size_t playerId, size_t candidates, std::vector<TurnPlan>& plans) {
+            plans.clear();
+            const bool road = state.canAfford(playerId, GameController::ROAD_COST);
+
+            if (state.canAfford(playerId, GameController::SETTLEMENT_COST) && candidates > 0) {
+                // partial selection of the best yields, candidates is small
+                std::vector<std::uint32_t> best;
+                best.reserve(candidates + 1);
+                for (std::uint32_t vertex = 0; vertex < board.getVertexCount(); ++vertex) {
+                    if (!state.isSettlementAllowed(vertex)) continue;
+                    if (best.size() == candidates && board.vertexYields[vertex] <= board.vertexYields[best.back()]) continue;
+
+                    auto position = std::upper_bound(best.begin(), best.end(), vertex,
+                        [&](std::uint32_t a, std::uint32_t b) { return board.vertexYields[a] > board.vertexYields[b]; });
+                    best.insert(position, vertex);
+                    if (best.size() > candidates) best.pop_back();
+                }
+                for (const std::uint32_t vertex : best) {
+                    plans.push_back({ vertex, false });
+                    if (road) plans.push_back({ vertex, true });
+                }
+            }
+
+            plans.push_back({ NONE, false });
+            if (road) plans.push_back({ NONE, true });
+        }
+
+
+        // the parts of the plan that are still possible in this state (open loop: the dice differ per iteration)
+        void applyPlan(CompactGameState& state, const CompactBoard& board, size_t playerId, const TurnPlan& plan) {
+            if (plan.settlementVertex != NONE && state.isSettlementAllowed(plan.settlementVertex)
+                && state.canAfford(playerId, GameController::SETTLEMENT_COST)) {
+                state.buildSettlement(board, playerId, plan.settlementVertex);
+            }
+            if (plan.buildRoad && state.canAfford(playerId, GameController::ROAD_COST)) {
+                if (const std::uint32_t edge = state.findRoadSpot(board, playerId); edge != NONE) {
+                    state.buildRoad(playerId, edge);
+                }
+            }
+        }
+
+
+        // greedy-random: the best of a few random legal spots, then a road, like the scripted players
+        void playPolicyTurn(CompactGameState& state, const CompactBoard& board, std::mt19937& rng) {
+            const size_t playerId = state.getCurrentPlayerId();
+            if (state.canAfford(playerId, GameController::SETTLEMENT_COST)) {
+                std::uint32_t best = NONE;
+                for (size_t sample = 0; sample < POLICY_SAMPLES; ++sample) {
+                    const auto vertex = static_cast<std::uint32_t>((static_cast<std::uint64_t>(rng()) * board.getVertexCount()) >> 32);
+                    if (state.isSettlementAllowed(vertex) && (best == NONE || board.vertexYields[vertex] > board.vertexYields[best])) {
+                        best = vertex;
+                    }
+                }
+                if (best != NONE) state.buildSettlement(board, playerId, best);
+            }
+            if (state.canAfford(playerId, GameController::ROAD_COST)) {
+                if (const std::uint32_t edge = state.findRoadSpot(board, playerId); edge != NONE) {
+                    state.buildRoad(playerId, edge);
+                }
+            }
+        }
+
+
+        // ends the AI's turn and plays the others until it is the AI's turn again (or the horizon is reached)
+        void playOpponents(CompactGameState& state, const Search& search, std::mt19937& rng) {
+            state.advanceTurn(search.board, rng);
+            while (state.getCurrentPlayerId() != search.playerId && state.getRoundNumber() < search.stopRound) {
+                playPolicyTurn(state, search.board, rng);
+                state.advanceTurn(search.board, rng);
+            }
+        }
+
+
+        std::uint32_t selectChild(const std::vector<Node>& tree, const Node& node, double exploration) {
+            std::uint32_t best = node.firstChild;
+            double bestScore = -1.0;
+            const double logVisits = std::log(static_cast<double>(std::max<std::uint32_t>(node.visits, 1)));
+            for (std::uint32_t child = node.firstChild; child < node.firstChild + node.childCount; ++child) {
+                const Node& candidate = tree[child];
+                if (candidate.visits == 0) return child; // try every plan once first
+
+                const double visits = static_cast<double>(candidate.visits);
+                const double score = candidate.wins / visits + exploration * std::sqrt(logVisits / visits);
+                if (score > bestScore) {
+                    bestScore = score;
+                    best = child;
+                }
+            }
+            return best;
+        }
+
+
+        // one search tree, writes the visits/wins of the root plans into the thread's own slots
+        size_t runSearchThread(const Search& search, std::atomic<size_t>& startedRollouts, std::uint32_t seed,
+                               std::uint32_t* rootVisits, double* rootWins) {
+            std::mt19937 rng(seed);
+            const MctsPlayer::Config& config = search.config;
+
+            std::vector<Node> tree;
+            tree.reserve(1 + search.rootPlans.size() * 64);
+            tree.push_back({ {}, 1, static_cast<std::uint32_t>(search.rootPlans.size()), true });
+            for (const TurnPlan& plan : search.rootPlans) tree.push_back({ plan });
+
+            CompactGameState state;
+            std::vector<TurnPlan> plans;
+            std::vector<std::uint32_t> path;
+            size_t rollouts = 0;
+
+            while (startedRollouts.fetch_add(1, std::memory_order_relaxed) < config.rollouts
+                   && std::chrono::steady_clock::now() < search.deadline) {
+                state.copyFrom(search.root);
+                path.assign(1, 0);
+
+                // selection + expansion: walk down the AI's plans, the opponents and the dice are sampled in between
+                std::uint32_t node = 0;
+                while (state.getRoundNumber() < search.stopRound) {
+                    if (!tree[node].expanded) {
+                        collectPlans(state, search.board, search.playerId, config.settlementCandidates, plans);
+                        tree[node].firstChild = static_cast<std::uint32_t>(tree.size());
+                        tree[node].childCount = static_cast<std::uint32_t>(plans.size());
+                        tree[node].expanded = true;
+                        for (const TurnPlan& plan : plans) tree.push_back({ plan });
+                    }
+
+                    const std::uint32_t child = selectChild(tree, tree[node], config.exploration);
+                    const bool isNew = tree[child].visits == 0;
+                    applyPlan(state, search.board, search.playerId, tree[child].plan);
+                    playOpponents(state, search, rng);
+                    path.push_back(child);
+                    node = child;
+                    if (isNew) break;
+                }
+
+                // playout
+                while (state.getRoundNumber() < search.stopRound) {
+                    playPolicyTurn(state, search.board, rng);
+                    state.advanceTurn(search.board, rng);
+                }
+
+                const double reward = state.isLeading(search.playerId) ? 1.0 : 0.0;
+                for (const std::uint32_t visited : path) {
+                    tree[visited].visits++;
+                    tree[visited].wins += reward;
+                }
+                rollouts++;
+            }
+
+            for (size_t i = 0; i < search.rootPlans.size(); ++i) {
+                rootVisits[i] = tree[1 + i].visits;
+                rootWins[i] = tree[1 + i].wins;
+            }
+            return rollouts;
+        }
+
+
+        // start + budget, without overflowing for NO_TIME_LIMIT
+        std::chrono::steady_clock::time_point getDeadline(const std::chrono::steady_clock::time_point start, const std::chrono::milliseconds budget) {
+            const auto latest = std::chrono::steady_clock::time_point::max();
+            if (budget >= std::chrono::duration_cast<std::chrono::milliseconds>(latest - start)) {
+                return latest;
+            }
+            return start + budget;
+        }
+    }
+
+
+    MctsPlayer::Config MctsPlayer::Config::forDifficulty(types::AiDifficulty difficulty) {
+        Config config;
+        switch (difficulty) {
+            case types::AiDifficulty::EASY:
+                config.rollouts = 200;
+                break;
+            case types::AiDifficulty::MEDIUM:
+                config.rollouts = 2000;
+                break;
+            case types::AiDifficulty::HARD:
+                config.rollouts = 10000;
+                break;
+        }
+        return config;
+    }
+
+
+    MctsPlayer::Decision MctsPlayer::decide(const GameState& state, size_t playerId) const {
+        const auto start = std::chrono::steady_clock::now();
+        Decision decision;
+        if (playerId != state.getCurrentPlayerId()) {
+            return decision;
+        }
+
+        const CompactBoard board = CompactBoard::fromGraph(state.getMap());
+        const CompactGameState root = CompactGameState::fromGameState(state, board);
+        if (root.getPlayerCount() == 0) {
+            return decision; // too many players for the compact state
+        }
+
+        std::vector<TurnPlan> rootPlans;
+        collectPlans(root, board, playerId, this->config.settlementCandidates, rootPlans);
+
+        // plans are sorted by yield -> without any rollout the first plan is the greedy choice
+        size_t chosen = 0;
+        if (rootPlans.size() > 1 && this->config.rollouts > 0) {
+            const Search search{
+                board, root, rootPlans, this->config, playerId,
+                root.getRoundNumber() + this->config.horizonRounds,
+                getDeadline(start, this->config.timeBudget),
+            };
+
+            const unsigned threadCount = std::max(1u, this->config.threads > 0 ? this->config.threads : std::thread::hardware_concurrency());
+            std::vector<std::uint32_t> visits(threadCount * rootPlans.size(), 0);
+            std::vector<double> wins(threadCount * rootPlans.size(), 0.0);
+            std::vector<size_t> rollouts(threadCount, 0);
+            std::atomic<size_t> startedRollouts = 0;
+
+            const auto run = [&](unsigned thread) {
+                const std::uint32_t seed = this->config.seed + static_cast<std::uint32_t>(root.getRoundNumber()) * 7919u + thread * 104729u;
+                rollouts[thread] = runSearchThread(search, startedRollouts, seed, &visits[thread * rootPlans.size()], &wins[thread * rootPlans.size()]);
+            };
+            if (threadCount == 1) {
+                run(0);
+            } else {
+                std::vector<std::thread> threads;
+                threads.reserve(threadCount);
+                for (unsigned thread = 0; thread < threadCount; ++thread) threads.emplace_back(run, thread);
+                for (std::thread& thread : threads) thread.join();
+            }
+
+            // most visited plan over all trees
+            std::uint32_t bestVisits = 0;
+            for (size_t plan = 0; plan < rootPlans.size(); ++plan) {
+                std::uint32_t planVisits = 0;
+                double planWins = 0.0;
+                for (unsigned thread = 0; thread < threadCount; ++thread) {
+                    planVisits += visits[thread * rootPlans.size() + plan];
+                    planWins += wins[thread * rootPlans.size() + plan];
+                }
+                if (planVisits > bestVisits) {
+                    bestVisits = planVisits;
+                    chosen = plan;
+                    decision.winRate = planWins / planVisits;
+                }
+            }
+            for (const size_t threadRollouts : rollouts) decision.rollouts += threadRollouts;
+        }
+
+        const TurnPlan& plan = rootPlans[chosen];
+        if (plan.settlementVertex != NONE) {
+            decision.settlementVertexId = state.getMap().getVertex(plan.settlementVertex)->getId();
+        }
+        decision.buildRoad = plan.buildRoad;
+        decision.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return decision;
+    }
+
+
+    MctsPlayer::Decision MctsPlayer::takeTurn(GameController& controller, size_t playerId) const {
+        GameState& state = controller.getState();
+        const Decision decision = this->decide(state, playerId);
+
+        if (decision.settlementVertexId) {
+            controller.buildSettlement(playerId, *decision.settlementVertexId, GameController::SETTLEMENT_COST);
+        }
+
+        // same spot as in the search: first free edge next to the latest settlement
+        const auto settlementIds = state.getPlayerSettlementIds(playerId);
+        if (decision.buildRoad && !settlementIds.empty()) {
+            const Graph& map = state.getMap();
+            const Settlement* settlement = state.findSettlement(settlementIds.back());
+            const auto edges = settlement ? map.getVertexEdges(map.findVertexById(settlement->getVertexId())) : std::nullopt;
+            if (edges) {
+                for (const EdgeHandle edge : *edges) {
+                    if (edge && controller.canBuildRoad(playerId, edge->getId())) {
+                        controller.buildRoad(playerId, edge->getId(), RoadLevel::Path, GameController::ROAD_COST);
+                        break;
+                    }
+                }
+            }
+        }
+        return decision;
+    }
+
+}
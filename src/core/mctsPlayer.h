@@ -0,0 +1,70 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include "compactGameState.h"
+#include "types.h"
+
+
+
+
+
+namespace df {
+
+    class GameController;
+    class GameState;
+
+
+    /*
+     * Computer player based on Monte-Carlo tree search.
+     * A decision is the plan for one turn: which settlement to build (one of the best legal spots by expected
+     * yield, or none) and whether to build a road. The search runs on CompactGameState clones only: it descends
+     * the tree of the AI's own turn plans (UCB1), plays the other players and the dice in between with a cheap
+     * greedy-random policy and finishes every iteration with a random playout to a fixed horizon. The reward is
+     * 1 if the AI leads at the horizon, 0 otherwise.
+     * Rollouts run on worker threads, each with its own tree (root parallelization), the root statistics are
+     * summed up. The search stops at the rollout budget or the time budget, whichever comes first.
+     */
+    class MctsPlayer {
+    public:
+        struct Config {
+            size_t rollouts = 2000; // per decision, all threads together
+            std::chrono::milliseconds timeBudget{ 500 }; // per decision, NO_TIME_LIMIT -> only the rollouts count
+            unsigned threads = 0; // 0 -> hardware concurrency
+            size_t horizonRounds = 8; // playout length
+            size_t settlementCandidates = 6; // best legal spots considered per plan
+            double exploration = 1.4; // UCB1 constant
+            std::uint32_t seed = 1; // combined with the round number, equal inputs give equal decisions on one thread
+
+            // stops on the rollout budget only -> the decisions don't depend on the speed of the machine
+            static constexpr std::chrono::milliseconds NO_TIME_LIMIT = std::chrono::milliseconds::max();
+
+            // the difficulty only changes the rollout budget
+            static Config forDifficulty(types::AiDifficulty difficulty);
+        };
+
+        struct Decision {
+            std::optional<size_t> settlementVertexId;
+            bool buildRoad = false;
+            size_t rollouts = 0;
+            double seconds = 0.0;
+            double winRate = 0.0; // of the chosen plan, as estimated by the search
+        };
+
+        explicit MctsPlayer(Config config) : config(config) {}
+
+        // search only, the state is not changed
+        Decision decide(const GameState& state, size_t playerId) const;
+        // decide() and carry out the builds through the controller, the caller ends the turn
+        Decision takeTurn(GameController& controller, size_t playerId) const;
+
+        const Config& getConfig() const { return this->config; }
+
+    private:
+        Config config;
+    };
+
+}
@@ -2,6 +2,7 @@
 #include "types.h"
 
 #include <algorithm>
+#include <iterator>
 
 
 namespace df{
@@ -54,24 +55,24 @@ namespace df{
         resources[type] -= amount;
     }
 
+    void Player::addResources(const ResourceBundle& amounts){
+        resources += amounts;
+    }
+
+    void Player::removeResources(const ResourceBundle& amounts){
+        // no check is we call first the hasResources function
+        resources -= amounts;
+    }
+
     int Player::getResources(types::TileType type) const{
-        auto it = resources.find(type);
-        if(it != resources.end()){
-            return it->second;
-        }
-        return 0;
+        return resources[type];
     }
 
-    bool Player::hasResources(const std::map<types::TileType, int>& amountRequired){
-        for(const auto& [type,amount ]: amountRequired){
-            if(getResources(type) < amount){
-                return false;
-            } 
-        }
-        return true;
+    bool Player::hasResources(const ResourceBundle& amountRequired) const{
+        return resources.covers(amountRequired);
     }
 
-    const std::map<types::TileType, int> &Player::getResources() const{
+    const ResourceBundle &Player::getResources() const{
         return resources;
     }
 
@@ -87,6 +88,10 @@ namespace df{
         roadIds.push_back(roadId);
     }
 
+    void Player::removeRoad(size_t roadId){
+        roadIds.erase(std::remove(roadIds.begin(), roadIds.end(), roadId), roadIds.end());
+    }
+
     const std::vector<size_t> &Player::getRoadIds() const{
         return roadIds;
     }
@@ -98,11 +103,22 @@ namespace df{
     void Player::exploreTile(size_t tileId){
         if(!isTileExplored(tileId)){
             exploredTileIds.push_back(tileId);
+            if (tileId >= exploredTileMask.size()) exploredTileMask.resize(tileId + 1, false);
+            exploredTileMask[tileId] = true;
+        }
+    }
+
+    void Player::forgetTile(size_t tileId){
+        if(isTileExplored(tileId)){
+            // usually the most recently explored tile (undo) -> search from the back
+            const auto it = std::find(exploredTileIds.rbegin(), exploredTileIds.rend(), tileId);
+            exploredTileIds.erase(std::next(it).base());
+            exploredTileMask[tileId] = false;
         }
     }
 
     bool Player::isTileExplored(size_t tileId) const{ 
-        return std::find(exploredTileIds.begin(), exploredTileIds.end(), tileId) != exploredTileIds.end();
+        return tileId < exploredTileMask.size() && exploredTileMask[tileId];
     }
 
     const std::vector<size_t> &Player::getExploredTileIds() const{
@@ -111,15 +127,17 @@ namespace df{
 
     void Player::forgetExploredTiles() {
         this->exploredTileIds.clear();
+        this->exploredTileMask.clear();
     }
 
     void Player::reset(){
         heroPoints = 0;
         settlementIds.clear();
-        resources.clear();
+        resources = ResourceBundle{};
         heroReference = nullptr;
         roadIds.clear();
         exploredTileIds.clear();
+        exploredTileMask.clear();
     }
 
     size_t Player::getPlayerId() const { return playerId; }
@@ -136,12 +154,7 @@ namespace df{
         j["roadIds"] = roadIds;
         j["exploredTileIds"] = exploredTileIds;
         
-        // Resources
-        json resourcesJson;
-        for(const auto& [type, amount] : resources) {
-            resourcesJson[std::to_string(static_cast<int>(type))] = amount;
-        }
-        j["resources"] = resourcesJson;
+        j["resources"] = resources;
 
         if (heroReference) {
             // Uncomment this when hero serialization is implemented
@@ -158,14 +171,12 @@ namespace df{
         
         if(j.contains("settlementIds")) settlementIds = j["settlementIds"].get<std::vector<size_t>>();
         if(j.contains("roadIds")) roadIds = j["roadIds"].get<std::vector<size_t>>();
-        if(j.contains("exploredTileIds")) exploredTileIds = j["exploredTileIds"].get<std::vector<size_t>>();
-        
-        if(j.contains("resources")) {
-            for(const auto& item : j["resources"].items()) {
-                types::TileType type = static_cast<types::TileType>(std::stoi(item.key()));
-                resources[type] = item.value().get<int>();
-            }
+        if(j.contains("exploredTileIds")) {
+            forgetExploredTiles();
+            for (const size_t tileId : j["exploredTileIds"].get<std::vector<size_t>>()) exploreTile(tileId);
         }
+        
+        if(j.contains("resources")) resources = j["resources"].get<ResourceBundle>();
 
         if (j.contains("hero")) {
             auto hero = std::make_shared<Hero>();
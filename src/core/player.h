@@ -2,7 +2,6 @@
 
 
 #include <vector>
-#include <map>
 #include <memory>
 
 #include "tile.h"
@@ -11,6 +10,7 @@
 #include <nlohmann/json.hpp>
 using json = nlohmann::json;
 #include "hero.h"
+#include "resourceBundle.h"
 #include "road.h"
 
 
@@ -24,10 +24,11 @@ namespace df{
             size_t playerId;
             int heroPoints;
             std::vector<size_t> settlementIds;
-            std::map<types::TileType, int> resources;
+            ResourceBundle resources;
             std::shared_ptr<Hero> heroReference;
             std::vector<size_t> roadIds;
             std::vector<size_t> exploredTileIds;
+            std::vector<bool> exploredTileMask; // indexed by tile id, keeps isTileExplored O(1) on big maps
         
         
         public:
@@ -46,18 +47,22 @@ namespace df{
 
             void addResources(types::TileType , int );
             void removeResources(types::TileType , int );
+            void addResources(const ResourceBundle& );
+            void removeResources(const ResourceBundle& );
             int getResources(types::TileType type) const;            
-            bool hasResources(const std::map<types::TileType, int>& );
-            const std::map<types::TileType, int>& getResources() const;
+            bool hasResources(const ResourceBundle& ) const;
+            const ResourceBundle& getResources() const;
 
             void setHero(std::shared_ptr<Hero> hero);
             std::shared_ptr<Hero> getHero() const;
 
             void addRoad(size_t roadId);
+            void removeRoad(size_t roadId);
             const std::vector<size_t>& getRoadIds() const;
             int getRoadCount() const;
 
             void exploreTile(size_t tileId);
+            void forgetTile(size_t tileId);
             bool isTileExplored(size_t tileId) const;
             const std::vector<size_t>& getExploredTileIds() const;
             void forgetExploredTiles();
@@ -0,0 +1,46 @@
+#include "productionTable.h"
+
+#include <algorithm>
+
+
+
+
+
+namespace df {
+
+    void ProductionTable::add(size_t tileId, size_t playerId, int multiplier) {
+        TileProduction* production = this->tiles.find(tileId);
+        if (!production) {
+            production = &this->tiles.insert(tileId, TileProduction{ tileId, {} });
+        }
+
+        for (Share& share : production->shares) {
+            if (share.playerId == playerId) {
+                share.multiplier += multiplier;
+                return;
+            }
+        }
+        production->shares.push_back({ playerId, multiplier });
+    }
+
+
+    void ProductionTable::remove(size_t tileId, size_t playerId, int multiplier) {
+        TileProduction* production = this->tiles.find(tileId);
+        if (!production) {
+            return;
+        }
+
+        auto& shares = production->shares;
+        for (Share& share : shares) {
+            if (share.playerId == playerId) {
+                share.multiplier -= multiplier;
+            }
+        }
+        shares.erase(std::remove_if(shares.begin(), shares.end(), [](const Share& share) { return share.multiplier <= 0; }), shares.end());
+
+        if (shares.empty()) {
+            this->tiles.erase(tileId);
+        }
+    }
+
+}
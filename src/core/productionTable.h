@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "slotMap.h"
+
+
+
+
+
+namespace df {
+
+    // Which players profit from a tile: tile -> list of (player, multiplier).
+    // Kept up to date when settlements are added/removed (see GameState), so distributing the resources of a
+    // turn only touches tiles that actually have settlements next to them, independent of the map size.
+    class ProductionTable {
+    public:
+        struct Share {
+            size_t playerId = 0;
+            int multiplier = 0; // resources per produced unit, e.g. 1 per adjacent settlement
+        };
+
+        struct TileProduction {
+            size_t tileId = 0;
+            std::vector<Share> shares;
+        };
+
+        void add(size_t tileId, size_t playerId, int multiplier = 1);
+        // drops the share once its multiplier reaches 0 and the tile once it has no shares left
+        void remove(size_t tileId, size_t playerId, int multiplier = 1);
+        void clear() { this->tiles.clear(); }
+
+        std::span<const TileProduction> getTiles() const { return this->tiles.getValues(); }
+        const TileProduction* find(size_t tileId) const { return this->tiles.find(tileId); }
+
+    private:
+        SlotMap<TileProduction> tiles;
+    };
+
+}
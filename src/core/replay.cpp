@@ -0,0 +1,282 @@
+#include "replay.h"
+
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "byteStream.h"
+#include "gamecontroller.h"
+#include "gamestate.h"
+
+
+
+
+
+namespace df {
+
+    Replay::Replay(const WorldGeneratorConfig& worldConfig, std::uint32_t seed, std::vector<ResourceBundle> startingResources)
+        : worldConfig(worldConfig), seed(seed), startingResources(std::move(startingResources)) {}
+
+
+    void Replay::setUp(GameState& state) const {
+        state.getMap().regenerate(this->worldConfig);
+        state.clearPlayers();
+        for (size_t playerId = 0; playerId < this->startingResources.size(); ++playerId) {
+            Player player(playerId);
+            player.addResources(this->startingResources[playerId]);
+            state.addPlayer(player);
+        }
+        state.setPhase(types::GamePhase::PLAY);
+    }
+
+
+    void Replay::writeAction(Action action) {
+        this->actions.push_back(static_cast<std::uint8_t>(action));
+        this->actionCount++;
+    }
+
+    void Replay::writeVarint(std::uint64_t value) { ByteWriter(this->actions).writeVarint(value); }
+    void Replay::writeCost(const ResourceBundle& cost) {
+        ByteWriter writer(this->actions);
+        writeResources(writer, cost);
+    }
+
+
+    void Replay::recordStartTurn() {
+        this->writeAction(Action::START_TURN);
+    }
+
+
+    void Replay::recordEndTurn(const GameState& state) {
+        this->writeAction(Action::END_TURN);
+        this->rollingHash = rollHash(this->rollingHash, state.hash());
+        ByteWriter(this->actions).writeFixed(this->rollingHash, 8);
+        this->turnCount++;
+    }
+
+
+    void Replay::recordBuildSettlement(size_t playerId, size_t vertexId, const ResourceBundle& cost) {
+        this->writeAction(Action::BUILD_SETTLEMENT);
+        this->writeVarint(playerId);
+        this->writeVarint(vertexId);
+        this->writeCost(cost);
+    }
+
+
+    void Replay::recordBuildRoad(size_t playerId, size_t edgeId, RoadLevel level, const ResourceBundle& cost) {
+        this->writeAction(Action::BUILD_ROAD);
+        this->writeVarint(playerId);
+        this->writeVarint(edgeId);
+        this->writeVarint(static_cast<std::uint64_t>(level));
+        this->writeCost(cost);
+    }
+
+
+    void Replay::recordMoveHero(size_t playerId, size_t tileId) {
+        this->writeAction(Action::MOVE_HERO);
+        this->writeVarint(playerId);
+        this->writeVarint(tileId);
+    }
+
+
+    void Replay::recordUndo() { this->writeAction(Action::UNDO); }
+    void Replay::recordRedo() { this->writeAction(Action::REDO); }
+
+
+    void Replay::recordUndoTo(size_t mark) {
+        this->writeAction(Action::UNDO_TO);
+        this->writeVarint(mark);
+    }
+
+
+    Replay::Playback Replay::play(GameController& controller) const {
+        const GameState& state = controller.getState();
+        Playback playback;
+        ByteReader reader(this->actions);
+        std::uint64_t rolling = 0;
+
+        const auto start = std::chrono::steady_clock::now();
+        while (!reader.atEnd()) {
+            const size_t turn = playback.turns;
+            bool reproduced = true;
+
+            // decode() validated the stream -> no error checks here
+            switch (static_cast<Action>(reader.readByte())) {
+            case Action::START_TURN:
+                controller.startTurn();
+                break;
+            case Action::END_TURN: {
+                const std::uint64_t expected = reader.readFixed(8);
+                controller.endTurn();
+                rolling = rollHash(rolling, state.hash());
+                reproduced = rolling == expected;
+                playback.turns++;
+                break;
+            }
+            case Action::BUILD_SETTLEMENT: {
+                const size_t playerId = reader.readVarint();
+                const size_t vertexId = reader.readVarint();
+                reproduced = controller.buildSettlement(playerId, vertexId, readResources(reader));
+                break;
+            }
+            case Action::BUILD_ROAD: {
+                const size_t playerId = reader.readVarint();
+                const size_t edgeId = reader.readVarint();
+                const RoadLevel level = static_cast<RoadLevel>(reader.readVarint());
+                reproduced = controller.buildRoad(playerId, edgeId, level, readResources(reader));
+                break;
+            }
+            case Action::MOVE_HERO: {
+                const size_t playerId = reader.readVarint();
+                reproduced = controller.moveHeroToTile(playerId, reader.readVarint());
+                break;
+            }
+            case Action::UNDO:
+                reproduced = controller.undo();
+                break;
+            case Action::REDO:
+                reproduced = controller.redo();
+                break;
+            case Action::UNDO_TO:
+                controller.undoTo(reader.readVarint());
+                break;
+            case Action::COUNT:
+                break;
+            }
+
+            playback.actions++;
+            if (!reproduced) {
+                playback.desyncTurn = turn;
+                break;
+            }
+        }
+        playback.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return playback;
+    }
+
+
+    /*
+     * Layout, integers little endian, varints LEB128:
+     *   u32 magic, u16 version, varint seed,
+     *   varint length + world generator config as JSON (the config has its own version),
+     *   varint player count + starting resources (zigzag varint per resource),
+     *   varint length + action stream
+     */
+    std::vector<std::uint8_t> Replay::encode() const {
+        std::vector<std::uint8_t> bytes;
+        ByteWriter writer(bytes);
+        writer.writeFixed(MAGIC, 4);
+        writer.writeFixed(VERSION, 2);
+        writer.writeVarint(this->seed);
+        writer.writeString(this->worldConfig.serialize().dump());
+
+        writer.writeVarint(this->startingResources.size());
+        for (const ResourceBundle& resources : this->startingResources) writeResources(writer, resources);
+
+        writer.writeVarint(this->actions.size());
+        writer.writeBytes(this->actions);
+        return bytes;
+    }
+
+
+    Result<Replay, ResultError> Replay::decode(std::span<const std::uint8_t> bytes) {
+        ByteReader reader(bytes);
+        if (reader.readFixed(4) != MAGIC || !reader.isOk()) {
+            return Err(ResultError(ResultError::Kind::InvalidArgument, "Replay: not a replay file"));
+        }
+        if (const std::uint64_t version = reader.readFixed(2); version != VERSION) {
+            return Err(ResultError(ResultError::Kind::InvalidArgument, "Replay: unsupported version " + std::to_string(version)));
+        }
+
+        Replay replay;
+        replay.seed = static_cast<std::uint32_t>(reader.readVarint());
+
+        try {
+            replay.worldConfig = WorldGeneratorConfig::deserialize(json::parse(reader.readString()));
+        } catch (const std::exception& e) {
+            return Err(ResultError(ResultError::Kind::JsonParseError, std::string("Replay: world generator config: ") + e.what()));
+        }
+
+        const size_t playerCount = reader.readCount(ResourceBundle::SIZE);
+        for (size_t i = 0; i < playerCount; ++i) replay.startingResources.push_back(readResources(reader));
+
+        const std::span<const std::uint8_t> actions = reader.readBytes(reader.readVarint());
+        if (!reader.isOk()) {
+            return Err(ResultError(ResultError::Kind::InvalidArgument, "Replay: truncated"));
+        }
+
+        // validate once, play() trusts the stream
+        ByteReader actionReader(actions);
+        while (!actionReader.atEnd()) {
+            const std::uint8_t action = actionReader.readByte();
+            switch (static_cast<Action>(action)) {
+            case Action::START_TURN:
+            case Action::UNDO:
+            case Action::REDO:
+                break;
+            case Action::END_TURN:
+                replay.rollingHash = actionReader.readFixed(8);
+                replay.turnCount++;
+                break;
+            case Action::BUILD_SETTLEMENT:
+                actionReader.readVarint();
+                actionReader.readVarint();
+                readResources(actionReader);
+                break;
+            case Action::BUILD_ROAD:
+                actionReader.readVarint();
+                actionReader.readVarint();
+                actionReader.readVarint();
+                readResources(actionReader);
+                break;
+            case Action::MOVE_HERO:
+                actionReader.readVarint();
+                actionReader.readVarint();
+                break;
+            case Action::UNDO_TO:
+                actionReader.readVarint();
+                break;
+            case Action::COUNT:
+            default:
+                return Err(ResultError(ResultError::Kind::InvalidArgument, "Replay: unknown action " + std::to_string(action)));
+            }
+            replay.actionCount++;
+        }
+        if (!actionReader.isOk()) {
+            return Err(ResultError(ResultError::Kind::InvalidArgument, "Replay: truncated action"));
+        }
+
+        replay.actions.assign(actions.begin(), actions.end());
+        return Ok(std::move(replay));
+    }
+
+
+    Result<void, ResultError> Replay::save(const std::filesystem::path& filepath) const {
+        const std::vector<std::uint8_t> bytes = this->encode();
+        std::ofstream file(filepath, std::ios::binary);
+        if (!file.is_open() || !file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()))) {
+            return Err(ResultError(ResultError::Kind::IOError, "Replay: could not write " + filepath.string()));
+        }
+        return Ok();
+    }
+
+
+    Result<Replay, ResultError> Replay::load(const std::filesystem::path& filepath) {
+        std::ifstream file(filepath, std::ios::binary);
+        if (!file.is_open()) {
+            return Err(ResultError(ResultError::Kind::IOError, "Replay: could not open " + filepath.string()));
+        }
+        const std::vector<std::uint8_t> bytes{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+        return decode(bytes);
+    }
+
+
+    std::uint64_t Replay::rollHash(std::uint64_t rolling, std::uint64_t stateHash) {
+        std::uint64_t value = (rolling ^ stateHash) + 0x9e3779b97f4a7c15ull;
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+        return value ^ (value >> 31);
+    }
+
+}
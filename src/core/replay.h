@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "resourceBundle.h"
+#include "resultError.h"
+#include "road.h"
+#include "worldGeneratorConfig.h"
+
+
+
+
+
+namespace df {
+
+    class GameController;
+    class GameState;
+
+
+    /*
+     * Reproducible recording of a game: the setup (world generator config, starting resources, dice seed of the
+     * GameController) and every player action, encoded as a compact byte stream (one type byte + varints).
+     * The GameController appends to it while it is attached via GameController::setReplay(); every END_TURN
+     * carries the rolling hash of the GameState after the turn.
+     * play() re-executes the actions through a GameController as fast as possible and compares the hashes,
+     * so a replay is a desync check and a turn throughput benchmark at the same time.
+     * Only the headless game is fully reproducible, the dice of the interactive game are not seeded.
+     */
+    class Replay {
+    public:
+        static constexpr std::uint32_t MAGIC = 0x50524644; // "DFRP"
+        static constexpr std::uint16_t VERSION = 1;
+
+        enum class Action : std::uint8_t {
+            START_TURN,       // production of the current player's turn
+            END_TURN,         // + rolling hash after the turn
+            BUILD_SETTLEMENT, // player, vertex id, cost
+            BUILD_ROAD,       // player, edge id, road level, cost
+            MOVE_HERO,        // player, tile id
+            UNDO,
+            REDO,
+            UNDO_TO,          // history mark
+            COUNT,
+        };
+
+        struct Playback {
+            size_t turns = 0;
+            size_t actions = 0;
+            double seconds = 0.0;
+            std::optional<size_t> desyncTurn; // first turn that didn't reproduce (hash mismatch or failed action)
+
+            bool isInSync() const { return !this->desyncTurn; }
+            double getTurnsPerSecond() const { return this->seconds > 0.0 ? static_cast<double>(this->turns) / this->seconds : 0.0; }
+        };
+
+        Replay() = default;
+        Replay(const WorldGeneratorConfig& worldConfig, std::uint32_t seed, std::vector<ResourceBundle> startingResources);
+
+        // a fresh game as it was recorded: map, one player per starting bundle, PLAY phase.
+        // The GameController for it needs getSeed().
+        void setUp(GameState& state) const;
+        std::uint32_t getSeed() const { return this->seed; }
+        const WorldGeneratorConfig& getWorldConfig() const { return this->worldConfig; }
+        size_t getPlayerCount() const { return this->startingResources.size(); }
+
+        // recording, called by the GameController for successful actions only
+        void recordStartTurn();
+        void recordEndTurn(const GameState& state);
+        void recordBuildSettlement(size_t playerId, size_t vertexId, const ResourceBundle& cost);
+        void recordBuildRoad(size_t playerId, size_t edgeId, RoadLevel level, const ResourceBundle& cost);
+        void recordMoveHero(size_t playerId, size_t tileId);
+        void recordUndo();
+        void recordRedo();
+        void recordUndoTo(size_t mark);
+
+        size_t getTurnCount() const { return this->turnCount; }
+        size_t getActionCount() const { return this->actionCount; }
+        size_t getActionBytes() const { return this->actions.size(); }
+
+        // controller: on a state from setUp(), seeded with getSeed(), no replay attached.
+        // Stops at the first turn that doesn't reproduce.
+        Playback play(GameController& controller) const;
+
+        std::vector<std::uint8_t> encode() const;
+        static Result<Replay, ResultError> decode(std::span<const std::uint8_t> bytes);
+        Result<void, ResultError> save(const std::filesystem::path& filepath) const;
+        static Result<Replay, ResultError> load(const std::filesystem::path& filepath);
+
+        // hash chain over the turns: a mismatch in one turn changes all later hashes as well
+        static std::uint64_t rollHash(std::uint64_t rolling, std::uint64_t stateHash);
+
+    private:
+        WorldGeneratorConfig worldConfig;
+        std::uint32_t seed = 0;
+        std::vector<ResourceBundle> startingResources;
+
+        std::vector<std::uint8_t> actions; // encoded actions, same format in memory and on disk
+        size_t actionCount = 0;
+        size_t turnCount = 0;
+        std::uint64_t rollingHash = 0;
+
+        void writeAction(Action action);
+        void writeVarint(std::uint64_t value);
+        void writeCost(const ResourceBundle& cost);
+    };
+
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <type_traits>
+
+#include <nlohmann/json.hpp>
+using json = nlohmann::json;
+
+#include "byteStream.h"
+#include "types.h"
+
+
+
+
+
+namespace df {
+
+	// Amount per resource, indexed by TileType (only some tile types are resources, the others stay 0).
+	// Used for inventories and building costs. A plain array, so it is trivially copyable and the element-wise
+	// operations are short fixed-length loops the compiler can vectorize, no lookups and no allocation.
+	struct ResourceBundle {
+		static constexpr size_t SIZE = static_cast<size_t>(types::TileType::COUNT);
+
+		std::array<int, SIZE> amounts{};
+
+		constexpr int& operator[](types::TileType type) { return this->amounts[static_cast<size_t>(type)]; }
+		constexpr int operator[](types::TileType type) const { return this->amounts[static_cast<size_t>(type)]; }
+
+		constexpr ResourceBundle& operator+=(const ResourceBundle& other) {
+			for (size_t i = 0; i < SIZE; i++) this->amounts[i] += other.amounts[i];
+			return *this;
+		}
+
+		constexpr ResourceBundle& operator-=(const ResourceBundle& other) {
+			for (size_t i = 0; i < SIZE; i++) this->amounts[i] -= other.amounts[i];
+			return *this;
+		}
+
+		friend constexpr ResourceBundle operator+(ResourceBundle lhs, const ResourceBundle& rhs) { return lhs += rhs; }
+		friend constexpr ResourceBundle operator-(ResourceBundle lhs, const ResourceBundle& rhs) { return lhs -= rhs; }
+		friend constexpr bool operator==(const ResourceBundle&, const ResourceBundle&) = default;
+
+		// true if there is at least `cost` of every resource; no early exit -> branch free
+		constexpr bool covers(const ResourceBundle& cost) const {
+			bool enough = true;
+			for (size_t i = 0; i < SIZE; i++) enough &= this->amounts[i] >= cost.amounts[i];
+			return enough;
+		}
+
+		constexpr bool isEmpty() const {
+			bool empty = true;
+			for (size_t i = 0; i < SIZE; i++) empty &= this->amounts[i] == 0;
+			return empty;
+		}
+
+		constexpr int getTotal() const {
+			int total = 0;
+			for (size_t i = 0; i < SIZE; i++) total += this->amounts[i];
+			return total;
+		}
+	};
+
+	static_assert(std::is_trivially_copyable_v<ResourceBundle>);
+
+
+	// stored as an array indexed by TileType, like the building costs always were
+	inline void to_json(json& j, const ResourceBundle& bundle) {
+		j = bundle.amounts;
+	}
+
+	// also accepts the older {"<TileType>": amount} objects of the player resources
+	inline void from_json(const json& j, ResourceBundle& bundle) {
+		bundle = ResourceBundle{};
+		if (j.is_array()) {
+			for (size_t i = 0; i < j.size() && i < ResourceBundle::SIZE; i++) bundle.amounts[i] = j[i].get<int>();
+		} else if (j.is_object()) {
+			for (const auto& item : j.items()) {
+				const size_t index = static_cast<size_t>(std::stoul(item.key()));
+				if (index < ResourceBundle::SIZE) bundle.amounts[index] = item.value().get<int>();
+			}
+		}
+	}
+
+	// binary formats: one zigzag varint per resource, one byte each for the usual amounts
+	inline void writeResources(ByteWriter& writer, const ResourceBundle& bundle) {
+		for (const int amount : bundle.amounts) writer.writeSigned(amount);
+	}
+
+	inline ResourceBundle readResources(ByteReader& reader) {
+		ResourceBundle bundle;
+		for (int& amount : bundle.amounts) amount = static_cast<int>(reader.readSigned());
+		return bundle;
+	}
+
+} // namespace df
@@ -3,7 +3,7 @@
 namespace df {
 
     Road::Road() = default;
-    Road::Road(size_t id, size_t playerId, size_t edgeId, RoadLevel roadLevel, std::vector<int> buildingCost)
+    Road::Road(size_t id, size_t playerId, size_t edgeId, RoadLevel roadLevel, const ResourceBundle& buildingCost)
         : id(id), playerId(playerId), edgeId(edgeId), roadLevel(roadLevel), buildingCost(buildingCost) {
     }
 
@@ -21,8 +21,8 @@ namespace df {
     RoadLevel Road::getRoadLevel() const { return roadLevel; }
     void Road::setRoadLevel(RoadLevel newLevel) { roadLevel = newLevel; }
 
-    const std::vector<int>& Road::getBuildingCost() const { return buildingCost; }
-    void Road::setBuildingCost(std::vector<int> newBuildingCost) { buildingCost = newBuildingCost; }
+    const ResourceBundle& Road::getBuildingCost() const { return buildingCost; }
+    void Road::setBuildingCost(const ResourceBundle& newBuildingCost) { buildingCost = newBuildingCost; }
 
     // Upgrade roads to next higher tier
     void Road::upgrade() {
@@ -64,6 +64,6 @@ namespace df {
         this->setPlayerId(j.at("playerId").get<size_t>());
         this->setEdgeId(j.at("edgeId").get<size_t>());
         this->setRoadLevel(static_cast<RoadLevel>(j.at("roadLevel").get<size_t>()));
-        this->setBuildingCost(j.at("buildingCost").get<std::vector<int>>());
+        this->setBuildingCost(j.at("buildingCost").get<ResourceBundle>());
     }
 }
@@ -1,10 +1,12 @@
 #pragma once
 
-#include <vector>
+#include <cstddef>
 
 #include <nlohmann/json.hpp>
 using json = nlohmann::json;
 
+#include "resourceBundle.h"
+
 namespace df {
     enum class RoadLevel : size_t {
         Path = 0,
@@ -16,7 +18,7 @@ namespace df {
     class Road {
     public:
         Road();
-        Road(size_t newId, size_t newPlayerId, size_t newEdgeId, RoadLevel newLevel, std::vector<int> newBuildingCost);
+        Road(size_t newId, size_t newPlayerId, size_t newEdgeId, RoadLevel newLevel, const ResourceBundle& newBuildingCost);
 
         ~Road();
 
@@ -35,8 +37,8 @@ namespace df {
         int getTradingBonus() const;
         void upgrade();
 
-        const std::vector<int>& getBuildingCost() const;
-        void setBuildingCost(std::vector<int> newBuildingCost);
+        const ResourceBundle& getBuildingCost() const;
+        void setBuildingCost(const ResourceBundle& newBuildingCost);
 
         const json serialize() const;
 
@@ -47,7 +49,7 @@ namespace df {
         size_t playerId{ 0 };   // owned by player
         size_t edgeId{ 0 };     // placed on edge
         RoadLevel roadLevel{ RoadLevel::Path };
-        std::vector<int> buildingCost{};
+        ResourceBundle buildingCost{};
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,291 @@
+#include "saveJournal.h"
+
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "byteStream.h"
+#include "compression.h"
+
+
+
+
+
+namespace df {
+
+    namespace {
+        // what a player delta contains besides the id lists
+        enum PlayerChange : std::uint8_t {
+            RESOURCES = 1 << 0,
+            HERO_POINTS = 1 << 1,
+            HERO = 1 << 2,
+        };
+
+
+        bool isSameSettlement(const Settlement& a, const Settlement& b) {
+            return a.getId() == b.getId() && a.getPlayerId() == b.getPlayerId() && a.getVertexId() == b.getVertexId()
+                && a.getBuildingCost() == b.getBuildingCost();
+        }
+
+        bool isSameRoad(const Road& a, const Road& b) {
+            return a.getId() == b.getId() && a.getPlayerId() == b.getPlayerId() && a.getEdgeId() == b.getEdgeId()
+                && a.getRoadLevel() == b.getRoadLevel() && a.getBuildingCost() == b.getBuildingCost();
+        }
+
+
+        // A list as the length of the prefix it shares with the old one plus the elements after it. Lists that only
+        // grew (the usual turn) cost their new elements; an undo or a swap-and-pop removal costs the tail behind it.
+        template <typename T, typename Equal, typename Write>
+        void writeListDelta(ByteWriter& writer, const std::vector<T>& from, const std::vector<T>& to, Equal isEqual, Write write) {
+            size_t kept = 0;
+            while (kept < from.size() && kept < to.size() && isEqual(from[kept], to[kept])) kept++;
+            writer.writeVarint(kept);
+            writer.writeVarint(to.size() - kept);
+            for (size_t i = kept; i < to.size(); i++) write(to[i]);
+        }
+
+        template <typename T, typename Read>
+        void readListDelta(ByteReader& reader, std::vector<T>& list, Read read) {
+            const std::uint64_t kept = reader.readVarint();
+            if (kept > list.size()) {
+                reader.fail();
+                return;
+            }
+            list.erase(list.begin() + static_cast<std::ptrdiff_t>(kept), list.end());
+            for (size_t count = reader.readCount(); count > 0 && reader.isOk(); --count) list.push_back(read());
+        }
+
+
+        void writeIds(ByteWriter& writer, const std::vector<size_t>& from, const std::vector<size_t>& to) {
+            writeListDelta(writer, from, to, std::equal_to<size_t>(), [&](const size_t id) { writer.writeVarint(id); });
+        }
+
+        void readIds(ByteReader& reader, std::vector<size_t>& ids) {
+            readListDelta(reader, ids, [&] { return static_cast<size_t>(reader.readVarint()); });
+        }
+
+
+        /*
+         * Delta payload, ByteWriter encoding like the base:
+         *   turns: current player, turn count, round number, phase, tutorial step
+         *   per player (same players as the base): change flags, resource difference, hero points, hero
+         *     (each only if flagged), settlement ids, road ids, explored tile ids (as list deltas)
+         *   settlements, roads: list deltas of the records
+         */
+        std::vector<std::uint8_t> encodeDelta(const SaveSnapshot& from, const SaveSnapshot& to) {
+            std::vector<std::uint8_t> bytes;
+            ByteWriter writer(bytes);
+
+            writer.writeVarint(to.currentPlayerId);
+            writer.writeVarint(to.turnCount);
+            writer.writeVarint(to.roundNumber);
+            writer.writeVarint(static_cast<std::uint64_t>(to.phase));
+            writer.writeVarint(to.tutorialStep);
+
+            for (size_t i = 0; i < to.players.size(); i++) {
+                const SaveSnapshot::PlayerRecord& old = from.players[i];
+                const SaveSnapshot::PlayerRecord& player = to.players[i];
+
+                std::uint8_t changes = 0;
+                if (player.resources != old.resources) changes |= RESOURCES;
+                if (player.heroPoints != old.heroPoints) changes |= HERO_POINTS;
+                if (player.hero != old.hero) changes |= HERO;
+                writer.writeByte(changes);
+
+                if (changes & RESOURCES) writeResources(writer, player.resources - old.resources);
+                if (changes & HERO_POINTS) writer.writeSigned(player.heroPoints);
+                if (changes & HERO) {
+                    writer.writeByte(player.hero ? 1 : 0);
+                    if (player.hero) {
+                        writer.writeSigned(player.hero->tileId);
+                        writer.writeFloat(player.hero->coords.x);
+                        writer.writeFloat(player.hero->coords.y);
+                        writer.writeString(player.hero->textureRef);
+                        writer.writeSigned(player.hero->baseRange);
+                    }
+                }
+
+                writeIds(writer, old.settlementIds, player.settlementIds);
+                writeIds(writer, old.roadIds, player.roadIds);
+                writeIds(writer, old.exploredTileIds, player.exploredTileIds);
+            }
+
+            writeListDelta(writer, from.settlements, to.settlements, isSameSettlement, [&](const Settlement& settlement) {
+                writer.writeVarint(settlement.getId());
+                writer.writeVarint(settlement.getPlayerId());
+                writer.writeVarint(settlement.getVertexId());
+                writeResources(writer, settlement.getBuildingCost());
+            });
+            writeListDelta(writer, from.roads, to.roads, isSameRoad, [&](const Road& road) {
+                writer.writeVarint(road.getId());
+                writer.writeVarint(road.getPlayerId());
+                writer.writeVarint(road.getEdgeId());
+                writer.writeVarint(static_cast<std::uint64_t>(road.getRoadLevel()));
+                writeResources(writer, road.getBuildingCost());
+            });
+
+            return bytes;
+        }
+
+
+        // counterpart of encodeDelta(), false if the payload doesn't fit the snapshot
+        bool applyDelta(SaveSnapshot& snapshot, std::span<const std::uint8_t> delta) {
+            ByteReader reader(delta);
+
+            snapshot.currentPlayerId = reader.readVarint();
+            snapshot.turnCount = reader.readVarint();
+            snapshot.roundNumber = reader.readVarint();
+            snapshot.phase = static_cast<types::GamePhase>(reader.readVarint());
+            snapshot.tutorialStep = reader.readVarint();
+
+            for (SaveSnapshot::PlayerRecord& player : snapshot.players) {
+                const std::uint8_t changes = reader.readByte();
+                if (changes & RESOURCES) player.resources += readResources(reader);
+                if (changes & HERO_POINTS) player.heroPoints = static_cast<int>(reader.readSigned());
+                if (changes & HERO) {
+                    player.hero.reset();
+                    if (reader.readByte() != 0) {
+                        SaveSnapshot::HeroRecord& hero = player.hero.emplace();
+                        hero.tileId = static_cast<int>(reader.readSigned());
+                        hero.coords.x = reader.readFloat();
+                        hero.coords.y = reader.readFloat();
+                        hero.textureRef = reader.readString();
+                        hero.baseRange = static_cast<int>(reader.readSigned());
+                    }
+                }
+
+                readIds(reader, player.settlementIds);
+                readIds(reader, player.roadIds);
+                readIds(reader, player.exploredTileIds);
+            }
+
+            readListDelta(reader, snapshot.settlements, [&] {
+                const size_t id = reader.readVarint();
+                const size_t playerId = reader.readVarint();
+                const size_t vertexId = reader.readVarint();
+                return Settlement(id, playerId, vertexId, readResources(reader));
+            });
+            readListDelta(reader, snapshot.roads, [&] {
+                const size_t id = reader.readVarint();
+                const size_t playerId = reader.readVarint();
+                const size_t edgeId = reader.readVarint();
+                const RoadLevel level = static_cast<RoadLevel>(reader.readVarint());
+                return Road(id, playerId, edgeId, level, readResources(reader));
+            });
+
+            return reader.isOk() && reader.atEnd();
+        }
+    } // namespace
+
+
+    SaveJournal::SaveJournal(std::filesystem::path filepath, size_t compactInterval)
+        : filepath(std::move(filepath)), compactInterval(compactInterval) {}
+
+
+    void SaveJournal::append(const SaveSnapshot& snapshot) {
+        try {
+            if (this->needsBase(snapshot)) {
+                this->writeBase(snapshot);
+            } else {
+                this->appendDelta(encodeDelta(*this->previous, snapshot));
+            }
+        } catch (...) {
+            this->previous.reset(); // the file may end anywhere now, start over
+            throw;
+        }
+        this->previous = snapshot;
+    }
+
+
+    bool SaveJournal::needsBase(const SaveSnapshot& snapshot) const {
+        if (!this->previous || this->deltaCount >= this->compactInterval || this->deltaBytes > this->baseBytes) {
+            return true;
+        }
+        // deltas don't contain tiles or player additions; the map record is shared while the tiles are unchanged
+        if (snapshot.map != this->previous->map || snapshot.players.size() != this->previous->players.size()) {
+            return true;
+        }
+        for (size_t i = 0; i < snapshot.players.size(); i++) {
+            if (snapshot.players[i].id != this->previous->players[i].id) return true;
+        }
+        return false;
+    }
+
+
+    void SaveJournal::writeBase(const SaveSnapshot& snapshot) {
+        const std::vector<std::uint8_t> base = snapshot.encodeFile();
+
+        std::vector<std::uint8_t> bytes;
+        bytes.reserve(base.size() + 16);
+        ByteWriter writer(bytes);
+        writer.writeFixed(MAGIC, 4);
+        writer.writeFixed(VERSION, 2);
+        writer.writeVarint(base.size());
+        writer.writeBytes(base);
+        replaceFile(this->filepath, bytes);
+
+        this->baseBytes = base.size();
+        this->deltaBytes = 0;
+        this->deltaCount = 0;
+        this->stats.bases++;
+        this->stats.lastAppendBytes = bytes.size();
+        this->stats.fileBytes = bytes.size();
+    }
+
+
+    void SaveJournal::appendDelta(std::span<const std::uint8_t> delta) {
+        std::vector<std::uint8_t> bytes;
+        ByteWriter writer(bytes);
+        writer.writeVarint(delta.size());
+        writer.writeFixed(compression::crc32(delta), 4);
+        writer.writeBytes(delta);
+
+        std::ofstream file(this->filepath, std::ios::binary | std::ios::app);
+        if (!file.is_open()) {
+            throw std::runtime_error("Failed to open file for appending: " + this->filepath.string());
+        }
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        file.flush();
+        if (!file) {
+            throw std::runtime_error("Failed to append to: " + this->filepath.string());
+        }
+
+        this->deltaBytes += bytes.size();
+        this->deltaCount++;
+        this->stats.deltas++;
+        this->stats.lastAppendBytes = bytes.size();
+        this->stats.fileBytes += bytes.size();
+    }
+
+
+    SaveSnapshot SaveJournal::decode(std::span<const std::uint8_t> bytes, const std::string& source) {
+        ByteReader reader(bytes);
+        if (reader.readFixed(4) != MAGIC || !reader.isOk()) {
+            throw std::runtime_error("Not a save journal: " + source);
+        }
+        if (const std::uint64_t version = reader.readFixed(2); version != VERSION) {
+            throw std::runtime_error("Unsupported save journal version " + std::to_string(version) + ": " + source);
+        }
+        const std::span<const std::uint8_t> base = reader.readBytes(reader.readVarint());
+        if (!reader.isOk()) {
+            throw std::runtime_error("Damaged save file: " + source);
+        }
+        SaveSnapshot snapshot = SaveSnapshot::deserialize(SaveSnapshot::decodeFile(base, source));
+
+        while (!reader.atEnd()) {
+            const std::uint64_t size = reader.readVarint();
+            const std::uint32_t checksum = static_cast<std::uint32_t>(reader.readFixed(4));
+            const std::span<const std::uint8_t> delta = reader.readBytes(size);
+            if (!reader.isOk() || compression::crc32(delta) != checksum) {
+                break; // cut off while appending, the deltas before it are the last complete state
+            }
+            if (!applyDelta(snapshot, delta)) {
+                throw std::runtime_error("Invalid save journal delta: " + source);
+            }
+        }
+        return snapshot;
+    }
+
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+
+#include "saveSnapshot.h"
+
+
+
+
+
+namespace df {
+
+    /*
+     * Save file for long games: one complete base save, then one small delta record per append() with only what
+     * changed since the previous append (turn counters, resource differences, new settlements, roads and explored
+     * tiles, ...). A turn writes a few dozen bytes instead of the whole map.
+     * The journal is compacted (rewritten as a new base) every compactInterval deltas, when the deltas got larger
+     * than the base, or when the map itself changed (tile revision, see GameState::snapshot()).
+     *
+     * File: u32 magic, u16 version, varint base size, base (SaveSnapshot::encodeFile()), then per delta:
+     *   varint payload size, u32 CRC-32 of the payload, payload.
+     * A delta that was cut off by a crash fails its checksum and is dropped on load, together with everything after it.
+     */
+    class SaveJournal {
+    public:
+        static constexpr std::uint32_t MAGIC = 0x4c4a4644; // "DFJL"
+        static constexpr std::uint16_t VERSION = 1;
+        static constexpr size_t DEFAULT_COMPACT_INTERVAL = 32;
+
+        struct Stats {
+            size_t bases = 0;
+            size_t deltas = 0;
+            size_t lastAppendBytes = 0; // written by the last append(), base or delta
+            size_t fileBytes = 0;
+        };
+
+        explicit SaveJournal(std::filesystem::path filepath, size_t compactInterval = DEFAULT_COMPACT_INTERVAL);
+
+        // The first append() writes a base, an existing file is replaced and never continued.
+        // Throws std::runtime_error on failure; the append after a failure writes a new base.
+        void append(const SaveSnapshot& snapshot);
+        // the next append() writes a new base
+        void compact() { this->previous.reset(); }
+
+        const std::filesystem::path& getPath() const { return this->filepath; }
+        const Stats& getStats() const { return this->stats; }
+
+        // The base with every complete delta applied, see GameState::load().
+        // Throws std::runtime_error naming `source` if the base or a delta with a valid checksum is malformed.
+        static SaveSnapshot decode(std::span<const std::uint8_t> bytes, const std::string& source);
+
+    private:
+        std::filesystem::path filepath;
+        size_t compactInterval;
+        std::optional<SaveSnapshot> previous; // the last appended state, the next delta is relative to it
+        size_t baseBytes = 0;
+        size_t deltaBytes = 0; // since the base
+        size_t deltaCount = 0;
+        Stats stats;
+
+        bool needsBase(const SaveSnapshot& snapshot) const;
+        void writeBase(const SaveSnapshot& snapshot);
+        void appendDelta(std::span<const std::uint8_t> delta);
+    };
+
+}
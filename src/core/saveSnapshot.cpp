@@ -0,0 +1,289 @@
+#include "saveSnapshot.h"
+
+#include <fstream>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include "byteStream.h"
+#include "compression.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+
+
+
+namespace df {
+
+    size_t SaveSnapshot::MapRecord::getTileCount() const {
+        size_t count = 0;
+        for (const std::shared_ptr<const Chunk>& chunk : this->chunks) count += chunk->size();
+        return count;
+    }
+
+
+    /*
+     * Binary payload, see ByteWriter (varints, zigzag for signed values):
+     *   turns: current player, turn count, round number, phase, tutorial step
+     *   map: width, tile count, per tile type, potency, range factor, building id + 1 (0 = none)
+     *   players: id, hero points, resources, settlement ids, road ids, explored tile ids, hero (flag + fields)
+     *   settlements: id, player, vertex id, building cost
+     *   roads: id, player, edge id, level, building cost
+     */
+    std::vector<std::uint8_t> SaveSnapshot::serialize() const {
+        std::vector<std::uint8_t> bytes;
+        ByteWriter writer(bytes);
+
+        writer.writeVarint(this->currentPlayerId);
+        writer.writeVarint(this->turnCount);
+        writer.writeVarint(this->roundNumber);
+        writer.writeVarint(static_cast<std::uint64_t>(this->phase));
+        writer.writeVarint(this->tutorialStep);
+
+        const MapRecord emptyMap;
+        const MapRecord& map = this->map ? *this->map : emptyMap;
+        writer.writeVarint(map.width);
+        writer.writeVarint(map.getTileCount());
+        map.forEachTile([&writer](size_t, const TileRecord& tile) {
+            writer.writeByte(static_cast<std::uint8_t>(tile.type));
+            writer.writeByte(static_cast<std::uint8_t>(tile.potency));
+            writer.writeFloat(tile.rangeFactor);
+            writer.writeVarint(tile.buildingId ? *tile.buildingId + 1 : 0);
+        });
+
+        writer.writeVarint(this->players.size());
+        for (const PlayerRecord& player : this->players) {
+            writer.writeVarint(player.id);
+            writer.writeSigned(player.heroPoints);
+            writeResources(writer, player.resources);
+            for (const std::vector<size_t>* ids : { &player.settlementIds, &player.roadIds, &player.exploredTileIds }) {
+                writer.writeVarint(ids->size());
+                for (const size_t id : *ids) writer.writeVarint(id);
+            }
+
+            writer.writeByte(player.hero ? 1 : 0);
+            if (player.hero) {
+                writer.writeSigned(player.hero->tileId);
+                writer.writeFloat(player.hero->coords.x);
+                writer.writeFloat(player.hero->coords.y);
+                writer.writeString(player.hero->textureRef);
+                writer.writeSigned(player.hero->baseRange);
+            }
+        }
+
+        writer.writeVarint(this->settlements.size());
+        for (const Settlement& settlement : this->settlements) {
+            writer.writeVarint(settlement.getId());
+            writer.writeVarint(settlement.getPlayerId());
+            writer.writeVarint(settlement.getVertexId());
+            writeResources(writer, settlement.getBuildingCost());
+        }
+
+        writer.writeVarint(this->roads.size());
+        for (const Road& road : this->roads) {
+            writer.writeVarint(road.getId());
+            writer.writeVarint(road.getPlayerId());
+            writer.writeVarint(road.getEdgeId());
+            writer.writeVarint(static_cast<std::uint64_t>(road.getRoadLevel()));
+            writeResources(writer, road.getBuildingCost());
+        }
+
+        return bytes;
+    }
+
+
+    SaveSnapshot SaveSnapshot::deserialize(std::span<const std::uint8_t> payload) {
+        ByteReader reader(payload);
+        const auto invalid = [](const std::string& what) { return std::runtime_error("Invalid binary save: " + what); };
+
+        SaveSnapshot snapshot;
+        snapshot.currentPlayerId = reader.readVarint();
+        snapshot.turnCount = reader.readVarint();
+        snapshot.roundNumber = reader.readVarint();
+        snapshot.phase = static_cast<types::GamePhase>(reader.readVarint());
+        snapshot.tutorialStep = reader.readVarint();
+
+        auto map = std::make_shared<MapRecord>();
+        map->width = static_cast<unsigned>(reader.readVarint());
+        const size_t tileCount = reader.readCount(7);
+        // one chunk, a loaded snapshot isn't shared with later ones
+        auto tiles = std::make_shared<MapRecord::Chunk>();
+        tiles->reserve(tileCount);
+        for (size_t tileIndex = 0; tileIndex < tileCount; ++tileIndex) {
+            const std::uint8_t type = reader.readByte();
+            const std::uint8_t potency = reader.readByte();
+            if (type >= static_cast<std::uint8_t>(types::TileType::COUNT) || potency > static_cast<std::uint8_t>(types::TilePotency::HIGH)) {
+                throw invalid("tile " + std::to_string(tileIndex));
+            }
+            TileRecord& tile = tiles->emplace_back();
+            tile.type = static_cast<types::TileType>(type);
+            tile.potency = static_cast<types::TilePotency>(potency);
+            tile.rangeFactor = reader.readFloat();
+            if (const std::uint64_t buildingId = reader.readVarint(); buildingId > 0) {
+                tile.buildingId = buildingId - 1;
+            }
+        }
+        if (!reader.isOk() || map->width == 0 || tileCount % map->width != 0) {
+            throw invalid("map");
+        }
+        map->chunks.push_back(std::move(tiles));
+        snapshot.map = std::move(map);
+
+        const size_t playerCount = reader.readCount(ResourceBundle::SIZE + 5);
+        snapshot.players.reserve(playerCount);
+        for (size_t i = 0; i < playerCount && reader.isOk(); ++i) {
+            PlayerRecord& player = snapshot.players.emplace_back();
+            player.id = reader.readVarint();
+            player.heroPoints = static_cast<int>(reader.readSigned());
+            player.resources = readResources(reader);
+            for (std::vector<size_t>* ids : { &player.settlementIds, &player.roadIds, &player.exploredTileIds }) {
+                for (size_t count = reader.readCount(); count > 0; --count) ids->push_back(reader.readVarint());
+            }
+            for (const size_t tileId : player.exploredTileIds) {
+                if (tileId >= tileCount) throw invalid("explored tile " + std::to_string(tileId));
+            }
+
+            if (reader.readByte() != 0) {
+                HeroRecord& hero = player.hero.emplace();
+                hero.tileId = static_cast<int>(reader.readSigned());
+                hero.coords.x = reader.readFloat();
+                hero.coords.y = reader.readFloat();
+                hero.textureRef = reader.readString();
+                hero.baseRange = static_cast<int>(reader.readSigned());
+            }
+        }
+
+        for (size_t count = reader.readCount(ResourceBundle::SIZE + 3); count > 0 && reader.isOk(); --count) {
+            const size_t id = reader.readVarint();
+            const size_t playerId = reader.readVarint();
+            const size_t vertexId = reader.readVarint();
+            snapshot.settlements.emplace_back(id, playerId, vertexId, readResources(reader));
+        }
+
+        for (size_t count = reader.readCount(ResourceBundle::SIZE + 4); count > 0 && reader.isOk(); --count) {
+            const size_t id = reader.readVarint();
+            const size_t playerId = reader.readVarint();
+            const size_t edgeId = reader.readVarint();
+            const RoadLevel level = static_cast<RoadLevel>(reader.readVarint());
+            snapshot.roads.emplace_back(id, playerId, edgeId, level, readResources(reader));
+        }
+
+        if (!reader.isOk() || !reader.atEnd()) {
+            throw invalid("truncated or trailing data");
+        }
+        return snapshot;
+    }
+
+
+    std::vector<std::uint8_t> SaveSnapshot::encodeFile() const {
+        const std::vector<std::uint8_t> payload = this->serialize();
+
+        std::vector<std::uint8_t> bytes;
+        ByteWriter writer(bytes);
+        writer.writeFixed(MAGIC, 4);
+        writer.writeFixed(VERSION, 2);
+        writer.writeVarint(payload.size());
+        writer.writeFixed(compression::crc32(payload), 4);
+        writer.writeBytes(compression::compress(payload));
+        return bytes;
+    }
+
+
+    std::vector<std::uint8_t> SaveSnapshot::decodeFile(std::span<const std::uint8_t> bytes, const std::string& source) {
+        ByteReader reader(bytes);
+        if (reader.readFixed(4) != MAGIC || !reader.isOk()) {
+            throw std::runtime_error("Not a binary save: " + source);
+        }
+        if (const std::uint64_t version = reader.readFixed(2); version != VERSION) {
+            throw std::runtime_error("Unsupported save version " + std::to_string(version) + ": " + source);
+        }
+        const std::uint64_t size = reader.readVarint();
+        const std::uint32_t checksum = static_cast<std::uint32_t>(reader.readFixed(4));
+        std::optional<std::vector<std::uint8_t>> payload = reader.isOk() && size <= MAX_PAYLOAD_SIZE
+            ? compression::decompress(reader.readBytes(reader.getRemaining()), size)
+            : std::nullopt;
+        if (!payload || compression::crc32(*payload) != checksum) {
+            throw std::runtime_error("Damaged save file: " + source);
+        }
+        return std::move(*payload);
+    }
+
+
+    void SaveSnapshot::writeFile(const std::filesystem::path& filepath) const {
+        replaceFile(filepath, this->encodeFile());
+    }
+
+
+    namespace {
+        // Forces the file's data (or a directory's entries) out of the OS cache onto the disk, so a crash after
+        // the rename can't leave the target pointing at a file whose content was never written.
+        void syncToDisk(const std::filesystem::path& path, bool isDirectory) {
+#if defined(_WIN32)
+            // directories can't be flushed on Windows, the rename is journaled by NTFS
+            if (isDirectory) {
+                return;
+            }
+            HANDLE handle = CreateFileW(path.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                        FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (handle == INVALID_HANDLE_VALUE) {
+                throw std::runtime_error("Failed to open for syncing: " + path.string());
+            }
+            const bool flushed = FlushFileBuffers(handle) != 0;
+            CloseHandle(handle);
+            if (!flushed) {
+                throw std::runtime_error("Failed to sync: " + path.string());
+            }
+#else
+            const int descriptor = open(path.c_str(), isDirectory ? O_RDONLY | O_DIRECTORY : O_WRONLY);
+            if (descriptor < 0) {
+                throw std::runtime_error("Failed to open for syncing: " + path.string());
+            }
+            // some file systems don't support syncing a directory (EINVAL), there is nothing more to do then
+            const bool synced = fsync(descriptor) == 0 || (isDirectory && errno == EINVAL);
+            close(descriptor);
+            if (!synced) {
+                throw std::runtime_error("Failed to sync: " + path.string());
+            }
+#endif
+        }
+    } // namespace
+
+
+    void replaceFile(const std::filesystem::path& filepath, std::span<const std::uint8_t> bytes) {
+        std::filesystem::path temporaryPath = filepath;
+        temporaryPath += ".tmp";
+        {
+            std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                throw std::runtime_error("Failed to open file for writing: " + temporaryPath.string());
+            }
+            file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+            file.flush();
+            if (!file) {
+                throw std::runtime_error("Failed to write: " + temporaryPath.string());
+            }
+        }
+        // flush() only hands the bytes to the OS, the rename must not reach the disk before them
+        syncToDisk(temporaryPath, false);
+
+        // replaces the old file in one step (also on Windows), readers see either the old or the new file
+        std::error_code error;
+        std::filesystem::rename(temporaryPath, filepath, error);
+        if (error) {
+            const std::string reason = error.message();
+            std::filesystem::remove(temporaryPath, error);
+            throw std::runtime_error("Failed to replace " + filepath.string() + ": " + reason);
+        }
+        // makes the rename itself durable
+        const std::filesystem::path directory = filepath.parent_path();
+        syncToDisk(directory.empty() ? std::filesystem::path(".") : directory, true);
+    }
+
+}
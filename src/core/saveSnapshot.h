@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <glm/vec2.hpp>
+
+#include "resourceBundle.h"
+#include "road.h"
+#include "settlement.h"
+#include "types.h"
+
+
+
+
+
+namespace df {
+
+    /*
+     * Immutable copy of everything a save contains, taken by GameState::snapshot().
+     * Cheap to take: the tiles are shared between snapshots in chunks, a chunk is only copied again after one of its
+     * tiles changed (copy-on-write, see Graph::getTileChunkRevision()), the rest are flat copies of small tables. Owns all its data, so it can be
+     * serialized on another thread while the game goes on.
+     */
+    struct SaveSnapshot {
+        static constexpr std::uint32_t MAGIC = 0x56534644; // "DFSV"
+        static constexpr std::uint16_t VERSION = 1;
+        static constexpr std::uint64_t MAX_PAYLOAD_SIZE = std::uint64_t{1} << 31; // rejects corrupt sizes before allocating
+
+        struct TileRecord {
+            types::TileType type = types::TileType::EMPTY;
+            types::TilePotency potency = types::TilePotency::LOW;
+            float rangeFactor = 1.0f;
+            std::optional<size_t> buildingId;
+        };
+
+        // tile id = index, edges and vertices follow from the tiles like for a generated map.
+        // The tiles are split into chunks (Graph::TILE_CHUNK_SIZE tiles each for GameState::snapshot()), each one shared
+        // with the other snapshots that have the same tiles in it.
+        struct MapRecord {
+            using Chunk = std::vector<TileRecord>;
+
+            unsigned width = 0;
+            std::vector<std::shared_ptr<const Chunk>> chunks;
+
+            size_t getTileCount() const;
+            // calls visit(tileIndex, tile) in tile order
+            template<typename Visit>
+            void forEachTile(Visit&& visit) const {
+                size_t tileIndex = 0;
+                for (const std::shared_ptr<const Chunk>& chunk : this->chunks) {
+                    for (const TileRecord& tile : *chunk) visit(tileIndex++, tile);
+                }
+            }
+        };
+
+        struct HeroRecord {
+            int tileId = -1;
+            glm::vec2 coords{ 0.0f, 0.0f };
+            std::string textureRef;
+            int baseRange = 0;
+
+            friend bool operator==(const HeroRecord&, const HeroRecord&) = default;
+        };
+
+        struct PlayerRecord {
+            size_t id = 0;
+            int heroPoints = 0;
+            ResourceBundle resources;
+            std::vector<size_t> settlementIds;
+            std::vector<size_t> roadIds;
+            std::vector<size_t> exploredTileIds;
+            std::optional<HeroRecord> hero;
+        };
+
+        size_t currentPlayerId = 0;
+        size_t turnCount = 0;
+        size_t roundNumber = 0;
+        types::GamePhase phase = types::GamePhase::START;
+        size_t tutorialStep = 0;
+        std::shared_ptr<const MapRecord> map;
+        std::vector<PlayerRecord> players;
+        std::vector<Settlement> settlements; // in GameState::getSettlements() order
+        std::vector<Road> roads;
+
+        // uncompressed payload, read by GameState::deserializeBinary()
+        std::vector<std::uint8_t> serialize() const;
+        // Counterpart of serialize(). Only checks the format, GameState::restore() checks the ids against the map.
+        // Throws std::runtime_error on malformed data.
+        static SaveSnapshot deserialize(std::span<const std::uint8_t> payload);
+        // complete save file: header (magic, version, payload size, CRC-32 of the payload) + compressed payload
+        std::vector<std::uint8_t> encodeFile() const;
+        // Checks the header and the checksum of encodeFile() bytes and returns the uncompressed payload.
+        // Throws std::runtime_error naming `source` if the data is damaged or has another version.
+        static std::vector<std::uint8_t> decodeFile(std::span<const std::uint8_t> bytes, const std::string& source);
+        // Writes encodeFile() next to the target and renames it over the target. A crash while writing leaves
+        // the previous save untouched. Throws std::runtime_error on failure.
+        void writeFile(const std::filesystem::path& filepath) const;
+    };
+
+
+    // Writes the bytes to a temporary file next to the target, syncs it to disk and renames it over the target
+    // (then syncs the directory), so even after a crash the target is either the old or the complete new file.
+    // Throws std::runtime_error on failure.
+    void replaceFile(const std::filesystem::path& filepath, std::span<const std::uint8_t> bytes);
+
+}
@@ -4,7 +4,7 @@ namespace df {
 
     Settlement::Settlement() = default;
 
-    Settlement::Settlement(size_t id, size_t playerId, size_t vertexId, std::vector<int> buildingCost)
+    Settlement::Settlement(size_t id, size_t playerId, size_t vertexId, const ResourceBundle& buildingCost)
         : id(id), playerId(playerId), vertexId(vertexId), buildingCost(buildingCost) {
     }
 
@@ -19,8 +19,8 @@ namespace df {
     size_t Settlement::getVertexId() const { return vertexId; }
     void Settlement::setVertexId(size_t newVertexId) { vertexId = newVertexId; }
 
-    const std::vector<int>& Settlement::getBuildingCost() const { return buildingCost; }
-    void Settlement::setBuildingCost(std::vector<int> newBuildingCost) { buildingCost = newBuildingCost; }
+    const ResourceBundle& Settlement::getBuildingCost() const { return buildingCost; }
+    void Settlement::setBuildingCost(const ResourceBundle& newBuildingCost) { buildingCost = newBuildingCost; }
 
 
 	const json Settlement::serialize() const {
@@ -38,7 +38,7 @@ namespace df {
         this->setId(j.at("id").get<size_t>());
         this->setPlayerId(j.at("playerId").get<size_t>());
         this->setVertexId(j.at("vertexId").get<size_t>());
-        this->setBuildingCost(j.at("buildingCost").get<std::vector<int>>());
+        this->setBuildingCost(j.at("buildingCost").get<ResourceBundle>());
     }
 
 }
@@ -1,16 +1,18 @@
 #pragma once
 
-#include <vector>
+#include <cstddef>
 
 #include <nlohmann/json.hpp>
 using json = nlohmann::json;
 
+#include "resourceBundle.h"
+
 namespace df {
 
     class Settlement {
     public:
         Settlement();
-        Settlement(size_t newId, size_t newPlayerId, size_t vertexId, std::vector<int> newBuildingCost);
+        Settlement(size_t newId, size_t newPlayerId, size_t vertexId, const ResourceBundle& newBuildingCost);
 
         ~Settlement();
 
@@ -23,8 +25,8 @@ namespace df {
         size_t getVertexId() const;
         void setVertexId(size_t newVertexId);
 
-        const std::vector<int>& getBuildingCost() const;
-        void setBuildingCost(std::vector<int> newBuildingCost);
+        const ResourceBundle& getBuildingCost() const;
+        void setBuildingCost(const ResourceBundle& newBuildingCost);
 
         const json serialize() const;
 
@@ -34,7 +36,7 @@ namespace df {
         size_t id{0};
         size_t playerId{0};
         size_t vertexId{ 0 };
-        std::vector<int> buildingCost{};
+        ResourceBundle buildingCost{};
     };
 
 }
\ No newline at end of file
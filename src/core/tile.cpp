@@ -38,7 +38,7 @@ namespace df {
 		float newRange = j["rangeFactor"];
 		this->setRangeFactor(newRange);
 
-		if (!j["id"].is_null()) {
+		if (!j["buildingId"].is_null()) {
 			std::optional<size_t> newBuildingId = j["buildingId"];
 			this->setBuildingId(newBuildingId);
 		}
@@ -81,4 +81,11 @@ namespace df {
 		std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
 		return distribution(rng) <= this->getPotencyProbability(this->potency);
 	}
+
+
+	float Tile::getExpectedYield() const {
+		if (!this->isResourceTile()) { return 0.0f; }
+
+		return this->getPotencyProbability(this->potency);
+	}
 }
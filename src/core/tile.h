@@ -38,6 +38,7 @@ namespace df {
 			const std::vector<size_t>& getVisibleForPlayers() const { return this->visibleForPlayers; }
 			void setVisibleForPlayers(const std::vector<size_t>& playerIds) { this->visibleForPlayers = playerIds; }
 			void addVisibleForPlayers(size_t playerId) { this->visibleForPlayers.push_back(playerId); }
+			void removeVisibleForPlayers(size_t playerId) { std::erase(this->visibleForPlayers, playerId); }
 
 			float getRangeFactor() const { return this->rangeFactor; }
 			void setRangeFactor(float range) { this->rangeFactor = range; }
@@ -45,6 +46,9 @@ namespace df {
 			// Determines if this tile gives a resource this turn, based on the tile's type and potency.
 			bool givesResourceThisTurn(std::mt19937& rng) const;
 
+			// Expected resources per turn, i.e. the probability of givesResourceThisTurn (0 for non-resource tiles).
+			float getExpectedYield() const;
+
 			bool operator==(const Tile& other) const { return this->id == other.id; }
 
 
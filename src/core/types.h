@@ -65,4 +65,12 @@ namespace df::types {
         PLAY,
         END
     };
+
+
+	// strength of computer players, see MctsPlayer::Config::forDifficulty()
+	enum class AiDifficulty {
+		EASY,
+		MEDIUM,
+		HARD
+	};
 }
@@ -1,10 +1,15 @@
 #include "worldGenerator.h"
 #include "perlinNoise.h"
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <thread>
+
 namespace df {
     Result<std::vector<Tile>, ResultError> WorldGenerator::generateTiles(WorldGeneratorConfig config) noexcept {
-        if (config.columns > 100) return Err(ResultError(ResultError::Kind::DomainError, "generateTiles: columns should not exceed 100"));
-        if (config.rows > 100) return Err(ResultError(ResultError::Kind::DomainError, "generateTiles: rows should not exceed 100"));
+        if (config.columns > MAX_MAP_DIMENSION) return Err(ResultError(ResultError::Kind::DomainError, fmt::format("generateTiles: columns should not exceed {}", MAX_MAP_DIMENSION)));
+        if (config.rows > MAX_MAP_DIMENSION) return Err(ResultError(ResultError::Kind::DomainError, fmt::format("generateTiles: rows should not exceed {}", MAX_MAP_DIMENSION)));
         if (config.seed == 0) {
             auto randomEngine = std::default_random_engine(std::random_device()());
             config.seed = std::uniform_int_distribution()(randomEngine);
@@ -20,206 +25,373 @@ namespace df {
     }
 
 
+    namespace {
+        // Maps a 32 bit random number into [0, bound) without a distribution object.
+        // std::uniform_int_distribution is implementation defined, this is not -> same seed, same map on every platform.
+        size_t boundedRandom(std::mt19937& randomEngine, const size_t bound) noexcept {
+            return static_cast<size_t>((static_cast<std::uint64_t>(randomEngine()) * bound) >> 32);
+        }
+
+
+        // Resolves the configured quotas into the exact number of tiles per type for a given amount of interior tiles.
+        // Non-negative quotas are served first (in type order), the rest is shared evenly by the negative quotas.
+        // If there are no negative quotas, the tiles left over become water (lakes).
+        std::array<size_t, static_cast<size_t>(types::TileType::COUNT)> resolveInsularTileCounts(const WorldGeneratorConfig& config, const size_t interiorCount) noexcept {
+            constexpr size_t typeCount = static_cast<size_t>(types::TileType::COUNT);
+            std::array<size_t, typeCount> counts{};
+
+            size_t remaining = interiorCount;
+            size_t sharingTypes = 0;
+            for (size_t type = 0; type < typeCount; type++) {
+                const int quota = config.insularTileQuotas[type];
+                if (quota < 0) {
+                    sharingTypes++;
+                    continue;
+                }
+                counts[type] = std::min(static_cast<size_t>(quota), remaining);
+                remaining -= counts[type];
+            }
+
+            if (sharingTypes == 0) {
+                counts[static_cast<size_t>(types::TileType::WATER)] += remaining;
+                return counts;
+            }
+
+            const size_t share = remaining / sharingTypes;
+            size_t leftover = remaining % sharingTypes;
+            for (size_t type = 0; type < typeCount; type++) {
+                if (config.insularTileQuotas[type] >= 0) continue;
+                counts[type] = share;
+                if (leftover > 0) {
+                    counts[type]++;
+                    leftover--;
+                }
+            }
+
+            return counts;
+        }
+    } // namespace
+
+
     std::vector<Tile> WorldGenerator::generateTilesInsular(const WorldGeneratorConfig& config) noexcept {
-        std::vector<Tile> tiles;
+        const size_t columns = config.columns;
+        const size_t rows = config.rows;
 
-        const int columns = static_cast<int>(config.columns);
-        const int rows = static_cast<int>(config.rows);
+        std::vector<Tile> tiles;
+        tiles.reserve(columns * rows);
 
-        auto randomEngine = std::default_random_engine(std::random_device()());
-        auto uniformTileTypeDistribution = std::uniform_int_distribution(2, static_cast<int>(types::TileType::COUNT) - 1);
+        // Creating an island with a one tile wide water border.
+        // The interior works like the tile bag of the board game: all tiles are laid out by quota first
+        // and shuffled afterwards. So the amount of every type is exact and there is no re-rolling.
+        const size_t interiorColumns = columns > 2 ? columns - 2 : 0;
+        const size_t interiorRows = rows > 2 ? rows - 2 : 0;
+        const size_t interiorCount = interiorColumns * interiorRows;
 
-        // Only one ice-desert tile -> like in catan game
-        std::unordered_map<int, int> tileCount;
-        std::unordered_map<int, int> tileMax = {{ static_cast<int>(types::TileType::ICE),    1 }};
+        auto counts = resolveInsularTileCounts(config, interiorCount);
+        size_t bagType = 0;
 
-        for (int row = rows - 1; row >= 0; row--) {
-            for (int column = 0; column < columns; column++) {
-                // Creating an island with two water wide borders
-                if(row<1 || column <1 || row > rows -2 || column > columns -2){
+        for (size_t row = 0; row < rows; row++) {
+            for (size_t column = 0; column < columns; column++) {
+                const size_t id = row * columns + column;
+                if (row < 1 || column < 1 || row > rows - 2 || column > columns - 2) {
                     // make border tiles water
-                    size_t id = row * columns + column;
                     tiles.emplace_back(id, types::TileType::WATER, types::TilePotency::MEDIUM);
                     continue;
                 }
-                int type = uniformTileTypeDistribution(randomEngine);
 
-                if(tileMax.contains(type)){
-                    if(tileCount[type] >= tileMax[type]){
-                        do {
-                            type = uniformTileTypeDistribution(randomEngine); // TODO: look for a more optimal solution
-                        } while (type == static_cast<int>(types::TileType::ICE));
-                    } else {
-                        tileCount[type]++;
-                    }
-                }
-
-                size_t id = row * columns + column;
-                tiles.emplace_back(id, static_cast<types::TileType>(type), types::TilePotency::MEDIUM);
+                while (counts[bagType] == 0) bagType++;
+                counts[bagType]--;
+                tiles.emplace_back(id, static_cast<types::TileType>(bagType), types::TilePotency::MEDIUM);
             }
         }
+
+        // Fisher-Yates shuffle of the interior, in place
+        auto interiorIndex = [columns, interiorColumns](const size_t i) {
+            return (1 + i / interiorColumns) * columns + 1 + i % interiorColumns;
+        };
+
+        std::mt19937 randomEngine(config.seed);
+        for (size_t i = interiorCount; i > 1; i--) {
+            Tile& a = tiles[interiorIndex(i - 1)];
+            Tile& b = tiles[interiorIndex(boundedRandom(randomEngine, i))];
+            const types::TileType type = a.getType();
+            a.setType(b.getType());
+            b.setType(type);
+        }
+
         return tiles;
     }
 
 
-    enum class WhittakerBiome {
-        TUNDRA,
-        BOREAL_FOREST,
-        TEMPERATE_GRASSLAND,
-        SHRUBLAND,
-        TEMPERATE_SEASONAL_FOREST,
-        TEMPERATE_RAINFOREST,
-        SUBTROPICAL_DESERT,
-        SAVANNA,
-        TROPICAL_RAINFOREST
-    };
+    namespace {
+        enum class WhittakerBiome {
+            TUNDRA,
+            BOREAL_FOREST,
+            TEMPERATE_GRASSLAND,
+            SHRUBLAND,
+            TEMPERATE_SEASONAL_FOREST,
+            TEMPERATE_RAINFOREST,
+            SUBTROPICAL_DESERT,
+            SAVANNA,
+            TROPICAL_RAINFOREST
+        };
 
 
-    WhittakerBiome calculateBiome(const double temperature, const double precipitation) noexcept {
-        // Biomes are based on https://commons.wikimedia.org/wiki/File:Climate_influence_on_terrestrial_biome.svg
+        WhittakerBiome calculateBiome(const double temperature, const double precipitation) noexcept {
+            // Biomes are based on https://commons.wikimedia.org/wiki/File:Climate_influence_on_terrestrial_biome.svg
 
-        const double celsius = temperature * 40.0 - 10.0;
-        const double precipCm = precipitation * 400.0;
+            const double celsius = temperature * 40.0 - 10.0;
+            const double precipCm = precipitation * 400.0;
 
-        if (celsius > 20) {
-            if (precipCm > 250) {
-                return WhittakerBiome::TROPICAL_RAINFOREST;
-            } else if (precipCm > 100) {
-                return WhittakerBiome::SAVANNA;
+            if (celsius > 20) {
+                if (precipCm > 250) {
+                    return WhittakerBiome::TROPICAL_RAINFOREST;
+                } else if (precipCm > 100) {
+                    return WhittakerBiome::SAVANNA;
+                } else {
+                    return WhittakerBiome::SUBTROPICAL_DESERT;
+                }
+            } else if (celsius > 8) {
+                if (precipCm > 200) {
+                    return WhittakerBiome::TEMPERATE_RAINFOREST;
+                } else if (precipCm > 100) {
+                    return WhittakerBiome::TEMPERATE_SEASONAL_FOREST;
+                } else if (precipCm > 50) {
+                    return WhittakerBiome::SHRUBLAND;
+                } else {
+                    return WhittakerBiome::TEMPERATE_GRASSLAND;
+                }
+            } else if (celsius > 0) {
+                if (precipCm > 30) {
+                    return WhittakerBiome::BOREAL_FOREST;
+                } else if (precipCm > 15) {
+                    return WhittakerBiome::SHRUBLAND;
+                } else {
+                    return WhittakerBiome::TEMPERATE_GRASSLAND;
+                }
             } else {
-                return WhittakerBiome::SUBTROPICAL_DESERT;
+                return WhittakerBiome::TUNDRA;
             }
-        } else if (celsius > 8) {
-            if (precipCm > 200) {
-                return WhittakerBiome::TEMPERATE_RAINFOREST;
-            } else if (precipCm > 100) {
-                return WhittakerBiome::TEMPERATE_SEASONAL_FOREST;
-            } else if (precipCm > 50) {
-                return WhittakerBiome::SHRUBLAND;
-            } else {
-                return WhittakerBiome::TEMPERATE_GRASSLAND;
+        }
+
+
+        // Potency follows the altitude that shaped the tile: the higher a mountain rises, the richer its ore,
+        // the lower the land (closer to rivers and coasts), the more fertile it is.
+        // The thresholds split the altitude bands into roughly 25% LOW, 50% MEDIUM and 25% HIGH tiles.
+        types::TilePotency derivePotency(const types::TileType type, const double altitude) noexcept {
+            switch (type) {
+                case types::TileType::EMPTY:
+                case types::TileType::WATER:
+                case types::TileType::ICE:
+                case types::TileType::COUNT:
+                    return types::TilePotency::MEDIUM; // no resources anyway
+                case types::TileType::MOUNTAIN:
+                    if (altitude > 0.650) return types::TilePotency::HIGH;
+                    if (altitude > 0.6125) return types::TilePotency::MEDIUM;
+                    return types::TilePotency::LOW;
+                default:
+                    if (altitude < 0.465) return types::TilePotency::HIGH;
+                    if (altitude < 0.545) return types::TilePotency::MEDIUM;
+                    return types::TilePotency::LOW;
             }
-        } else if (celsius > 0) {
-            if (precipCm > 30) {
-                return WhittakerBiome::BOREAL_FOREST;
-            } else if (precipCm > 15) {
-                return WhittakerBiome::SHRUBLAND;
-            } else {
-                return WhittakerBiome::TEMPERATE_GRASSLAND;
+        }
+
+
+        // a thread per this many rows at least, smaller maps aren't worth starting threads for
+        constexpr int MIN_ROWS_PER_THREAD = 64;
+
+        // Calls generateRows(firstRow, endRow) for consecutive row ranges, one range per hardware thread.
+        // Rows don't depend on each other, so the map is the same for any number of threads.
+        // A range whose thread can't be started is generated on the calling thread.
+        template <typename GenerateRows>
+        void forEachRowRange(const int rows, const GenerateRows& generateRows) noexcept {
+            const int hardwareThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+            const int threadCount = std::clamp(rows / MIN_ROWS_PER_THREAD, 1, hardwareThreads);
+
+            std::vector<std::thread> threads;
+            int firstRow = 0;
+            for (int thread = 1; thread < threadCount; thread++) {
+                const int endRow = rows * thread / threadCount;
+                try {
+                    threads.reserve(threadCount - 1);
+                    threads.emplace_back([&generateRows, firstRow, endRow] { generateRows(firstRow, endRow); });
+                } catch (...) {
+                    generateRows(firstRow, endRow);
+                }
+                firstRow = endRow;
+            }
+            generateRows(firstRow, rows);
+
+            for (std::thread& thread : threads) {
+                thread.join();
             }
-        } else {
-            return WhittakerBiome::TUNDRA;
         }
-    }
+    } // namespace
 
 
     std::vector<Tile> WorldGenerator::generateTilesPerlin(const WorldGeneratorConfig& config) noexcept {
-        std::vector<Tile> tiles;
-
         const int columns = static_cast<int>(config.columns);
         const int rows = static_cast<int>(config.rows);
+        const size_t tileCount = static_cast<size_t>(columns) * static_cast<size_t>(rows);
+        std::vector<Tile> tiles(tileCount);
 
         auto randomEngine = std::default_random_engine(config.seed);
 
-        const siv::PerlinNoise altitudePerlin{ config.seed };
-        const siv::PerlinNoise temperaturePerlin{ randomEngine() };
-        const siv::PerlinNoise precipitationPerlin{ randomEngine() };
+        const siv::PerlinNoiseF altitudePerlin{ config.seed };
+        const siv::PerlinNoiseF temperaturePerlin{ randomEngine() };
+        const siv::PerlinNoiseF precipitationPerlin{ randomEngine() };
 
         auto uniformTileTypeDistribution = std::uniform_int_distribution(2, static_cast<int>(types::TileType::COUNT) - 1);
 
-        for (int row = 0; row < rows; row++) {
+        // The noise is sampled in float a whole row at a time (see BasicFusedPerlinNoise). If all three fields use
+        // the same frequency and octaves (the default), the climate is sampled together with the altitude in one
+        // fused pass, otherwise every field gets a row pass of its own. Both give the same values.
+        const bool fuseClimateNoise = config.useWhittakerBiomes
+            && config.temperatureNoise.frequency == config.altitudeNoise.frequency
+            && config.precipitationNoise.frequency == config.altitudeNoise.frequency
+            && config.temperatureNoise.octaves == config.altitudeNoise.octaves
+            && config.precipitationNoise.octaves == config.altitudeNoise.octaves;
+        const bool separateClimateNoise = config.useWhittakerBiomes && !fuseClimateNoise;
+
+        const siv::FusedPerlinNoise3F climatePerlin{ { altitudePerlin.serialize(), temperaturePerlin.serialize(), precipitationPerlin.serialize() } };
+        const siv::BasicFusedPerlinNoise<float, 1> altitudeOnlyPerlin{ { altitudePerlin.serialize() } };
+        const siv::BasicFusedPerlinNoise<float, 1> temperatureOnlyPerlin{ { temperaturePerlin.serialize() } };
+        const siv::BasicFusedPerlinNoise<float, 1> precipitationOnlyPerlin{ { precipitationPerlin.serialize() } };
+
+        const auto coordinates = [columns](const float frequency) {
+            std::vector<float> result(static_cast<size_t>(columns));
             for (int column = 0; column < columns; column++) {
-                double altitude = altitudePerlin.normalizedOctave2D_01(
-                    static_cast<float>(row) * config.altitudeNoise.frequency,
-                    static_cast<float>(column) * config.altitudeNoise.frequency,
-                    static_cast<int>(config.altitudeNoise.octaves),
-                    config.altitudeNoise.persistence
-                );
-                // Bigger exponents make the map more flat, less mountainous
-                //altitude = pow(altitude, 1.0);
-
-                types::TileType type;
-                if (config.useWhittakerBiomes) {
-                    // This uses Whittakers simplification of Holdridge's life zones.
-                    // See https://en.wikipedia.org/wiki/Holdridge_life_zones
-                    // and https://en.wikipedia.org/wiki/Biome#Whittaker_(1962,_1970,_1975)_biome-types
-                    // and https://commons.wikimedia.org/wiki/File:Climate_influence_on_terrestrial_biome.svg
-
-                    const double temperature = temperaturePerlin.normalizedOctave2D_01(
-                        static_cast<float>(row) * config.temperatureNoise.frequency,
-                        static_cast<float>(column) * config.temperatureNoise.frequency,
-                        static_cast<int>(config.temperatureNoise.octaves),
-                        config.temperatureNoise.persistence
-                    );
-                    double precipitation = precipitationPerlin.normalizedOctave2D_01(
-                        static_cast<float>(row) * config.precipitationNoise.frequency,
-                        static_cast<float>(column) * config.precipitationNoise.frequency,
-                        static_cast<int>(config.precipitationNoise.octaves),
-                        config.precipitationNoise.persistence
-                    );
-
-                    // Make it a triangle
-                    // See why: https://commons.wikimedia.org/wiki/File:Climate_influence_on_terrestrial_biome.svg
-                    // Also the humidity air can transport is determined by its temperature.
-                    // This makes downfall/precipitation in cold regions (Arctic) less likely,
-                    // and more likely in tropical regions (Monsoon)
-                    precipitation *= temperature;
-
-                    if (altitude > 0.60f) {
-                        type = types::TileType::MOUNTAIN;
-                    } else if (altitude > 0.42) {
-                        switch (calculateBiome(temperature, precipitation)) {
-                            case WhittakerBiome::TUNDRA:
+                result[column] = static_cast<float>(column) * frequency;
+            }
+            return result;
+        };
+        const std::vector<float> columnCoordinates = coordinates(config.altitudeNoise.frequency);
+        const std::vector<float> temperatureCoordinates = separateClimateNoise ? coordinates(config.temperatureNoise.frequency) : std::vector<float>();
+        const std::vector<float> precipitationCoordinates = separateClimateNoise ? coordinates(config.precipitationNoise.frequency) : std::vector<float>();
+
+        // Without the Whittaker biomes the middle altitudes get a random type, drawn in tile order. The rows leave
+        // those tiles EMPTY and keep their altitude, the types are drawn after all rows are done.
+        std::vector<float> randomTypeAltitudes(config.useWhittakerBiomes ? 0 : tileCount);
+
+        const auto generateRows = [&](const int firstRow, const int endRow) {
+            std::vector<std::array<float, 3>> climateRow(fuseClimateNoise ? columns : 0);
+            std::vector<std::array<float, 1>> altitudeRow(fuseClimateNoise ? 0 : columns);
+            std::vector<std::array<float, 1>> temperatureRow(separateClimateNoise ? columns : 0);
+            std::vector<std::array<float, 1>> precipitationRow(separateClimateNoise ? columns : 0);
+
+            for (int row = firstRow; row < endRow; row++) {
+                const float rowCoordinate = static_cast<float>(row) * config.altitudeNoise.frequency;
+                const int octaves = static_cast<int>(config.altitudeNoise.octaves);
+                if (fuseClimateNoise) {
+                    climatePerlin.normalizedOctave2D_01(rowCoordinate, columnCoordinates.data(), columnCoordinates.size(), octaves,
+                        { config.altitudeNoise.persistence, config.temperatureNoise.persistence, config.precipitationNoise.persistence }, climateRow.data());
+                } else {
+                    altitudeOnlyPerlin.normalizedOctave2D_01(rowCoordinate, columnCoordinates.data(), columnCoordinates.size(), octaves,
+                        { config.altitudeNoise.persistence }, altitudeRow.data());
+                }
+                if (separateClimateNoise) {
+                    temperatureOnlyPerlin.normalizedOctave2D_01(static_cast<float>(row) * config.temperatureNoise.frequency,
+                        temperatureCoordinates.data(), temperatureCoordinates.size(), static_cast<int>(config.temperatureNoise.octaves),
+                        { config.temperatureNoise.persistence }, temperatureRow.data());
+                    precipitationOnlyPerlin.normalizedOctave2D_01(static_cast<float>(row) * config.precipitationNoise.frequency,
+                        precipitationCoordinates.data(), precipitationCoordinates.size(), static_cast<int>(config.precipitationNoise.octaves),
+                        { config.precipitationNoise.persistence }, precipitationRow.data());
+                }
+
+                for (int column = 0; column < columns; column++) {
+                    float altitude = fuseClimateNoise ? climateRow[column][0] : altitudeRow[column][0];
+                    // Bigger exponents make the map more flat, less mountainous
+                    //altitude = pow(altitude, 1.0);
+
+                    types::TileType type = types::TileType::WATER;
+                    if (config.useWhittakerBiomes) {
+                        // This uses Whittakers simplification of Holdridge's life zones.
+                        // See https://en.wikipedia.org/wiki/Holdridge_life_zones
+                        // and https://en.wikipedia.org/wiki/Biome#Whittaker_(1962,_1970,_1975)_biome-types
+                        // and https://commons.wikimedia.org/wiki/File:Climate_influence_on_terrestrial_biome.svg
+
+                        auto sampleTemperature = [&]() -> double {
+                            return fuseClimateNoise ? climateRow[column][1] : temperatureRow[column][0];
+                        };
+                        auto samplePrecipitation = [&](const double temperature) {
+                            const double precipitation = fuseClimateNoise ? climateRow[column][2] : precipitationRow[column][0];
+
+                            // Make it a triangle
+                            // See why: https://commons.wikimedia.org/wiki/File:Climate_influence_on_terrestrial_biome.svg
+                            // Also the humidity air can transport is determined by its temperature.
+                            // This makes downfall/precipitation in cold regions (Arctic) less likely,
+                            // and more likely in tropical regions (Monsoon)
+                            return precipitation * temperature;
+                        };
+
+                        if (altitude > 0.60f) {
+                            type = types::TileType::MOUNTAIN;
+                        } else if (altitude > 0.42) {
+                            const double temperature = sampleTemperature();
+                            switch (calculateBiome(temperature, samplePrecipitation(temperature))) {
+                                case WhittakerBiome::TUNDRA:
+                                    type = types::TileType::ICE;
+                                    break;
+                                case WhittakerBiome::BOREAL_FOREST:
+                                    type = types::TileType::FOREST;
+                                    break;
+                                case WhittakerBiome::TEMPERATE_GRASSLAND:
+                                    type = types::TileType::GRASS;
+                                    break;
+                                case WhittakerBiome::SHRUBLAND:
+                                    type = types::TileType::GRASS;
+                                    break;
+                                case WhittakerBiome::TEMPERATE_SEASONAL_FOREST:
+                                    type = types::TileType::FOREST;
+                                    break;
+                                case WhittakerBiome::TEMPERATE_RAINFOREST:
+                                    type = types::TileType::FOREST;
+                                    break;
+                                case WhittakerBiome::SUBTROPICAL_DESERT:
+                                    type = types::TileType::FIELD;
+                                    break;
+                                case WhittakerBiome::SAVANNA:
+                                    type = types::TileType::CLAY;
+                                    break;
+                                case WhittakerBiome::TROPICAL_RAINFOREST:
+                                    type = types::TileType::FOREST;
+                                    break;
+                            }
+                        } else {
+                            if ((sampleTemperature() * 40.0 - 10.0) < 0) {
                                 type = types::TileType::ICE;
-                                break;
-                            case WhittakerBiome::BOREAL_FOREST:
-                                type = types::TileType::FOREST;
-                                break;
-                            case WhittakerBiome::TEMPERATE_GRASSLAND:
-                                type = types::TileType::GRASS;
-                                break;
-                            case WhittakerBiome::SHRUBLAND:
-                                type = types::TileType::GRASS;
-                                break;
-                            case WhittakerBiome::TEMPERATE_SEASONAL_FOREST:
-                                type = types::TileType::FOREST;
-                                break;
-                            case WhittakerBiome::TEMPERATE_RAINFOREST:
-                                type = types::TileType::FOREST;
-                                break;
-                            case WhittakerBiome::SUBTROPICAL_DESERT:
-                                type = types::TileType::FIELD;
-                                break;
-                            case WhittakerBiome::SAVANNA:
-                                type = types::TileType::CLAY;
-                                break;
-                            case WhittakerBiome::TROPICAL_RAINFOREST:
-                                type = types::TileType::FOREST;
-                                break;
+                            } else {
+                                type = types::TileType::WATER;
+                            }
                         }
                     } else {
-                        if ((temperature * 40.0 - 10.0) < 0) {
-                            type = types::TileType::ICE;
+                        // TODO: Add altitudes to world generation configuration
+                        // TODO: Add variation chances to world generation configuration
+                        if (altitude > 0.60f) {
+                            type = types::TileType::MOUNTAIN;
+                        } else if (altitude > 0.58) {
+                            type = types::TileType::FOREST;
+                        } else if (altitude > 0.42) {
+                            type = types::TileType::EMPTY;
+                            randomTypeAltitudes[static_cast<size_t>(row) * columns + column] = altitude;
                         } else {
                             type = types::TileType::WATER;
                         }
                     }
-                } else {
-                    // TODO: Add altitudes to world generation configuration
-                    // TODO: Add variation chances to world generation configuration
-                    if (altitude > 0.60f) {
-                        type = types::TileType::MOUNTAIN;
-                    } else if (altitude > 0.58) {
-                        type = types::TileType::FOREST;
-                    } else if (altitude > 0.42) {
-                        type = static_cast<types::TileType>(uniformTileTypeDistribution(randomEngine));
-                    } else {
-                        type = types::TileType::WATER;
-                    }
+
+                    const size_t id = static_cast<size_t>(row) * columns + column;
+                    tiles[id] = Tile(id, type, derivePotency(type, altitude));
                 }
+            }
+        };
+        forEachRowRange(rows, generateRows);
 
-                size_t id = row * columns + column;
-                tiles.emplace_back(id, type, types::TilePotency::MEDIUM);
+        if (!config.useWhittakerBiomes) {
+            for (size_t id = 0; id < tileCount; id++) {
+                if (tiles[id].getType() != types::TileType::EMPTY) continue;
+                const auto type = static_cast<types::TileType>(uniformTileTypeDistribution(randomEngine));
+                tiles[id].setType(type);
+                tiles[id].setPotency(derivePotency(type, randomTypeAltitudes[id]));
             }
         }
 
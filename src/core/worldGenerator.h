@@ -8,6 +8,9 @@ namespace df {
     public:
         WorldGenerator() = default;
 
+        // upper bound for columns and rows of a generated map
+        static constexpr unsigned MAX_MAP_DIMENSION = 1000;
+
         static Result<std::vector<Tile>, ResultError> generateTiles(WorldGeneratorConfig config) noexcept;
     private:
         static std::vector<Tile> generateTilesInsular(const WorldGeneratorConfig& config) noexcept;
@@ -13,6 +13,7 @@ namespace df {
             {"columns", columns},
             {"rows", rows},
             {"generationMode", generationMode},
+            {"insularTileQuotas", insularTileQuotas},
             {"seed", seed},
             {"altitudeNoise", {
                 {"frequency", altitudeNoise.frequency},
@@ -45,6 +46,7 @@ namespace df {
         overwrite(j, "columns", self.columns);
         overwrite(j, "rows", self.rows);
         overwrite(j, "generationMode", self.generationMode);
+        overwrite(j, "insularTileQuotas", self.insularTileQuotas);
         overwrite(j, "seed", self.seed);
         overwrite(j, "useWhittakerBiomes", self.useWhittakerBiomes);
 
@@ -1,8 +1,10 @@
 #pragma once
+#include <array>
 #include <nlohmann/json.hpp>
 
 #include "assets.h"
 #include "resultError.h"
+#include "types.h"
 
 namespace df {
     // This is intended to be used like a plain old data structure with serialization. Nothing more.
@@ -21,6 +23,21 @@ namespace df {
         };
         GenerationMode generationMode = GenerationMode::PERLIN;
 
+        // Insular
+        // Number of interior tiles per type, indexed by the ordinal of types::TileType.
+        // A negative quota means "share the remaining interior tiles evenly with the other negative quotas".
+        // Only one ice-desert tile by default -> like in catan game
+        std::array<int, static_cast<size_t>(types::TileType::COUNT)> insularTileQuotas = {
+            0,  // EMPTY
+            0,  // WATER
+            -1, // FOREST
+            -1, // GRASS
+            -1, // MOUNTAIN
+            -1, // FIELD
+            -1, // CLAY
+            1,  // ICE
+        };
+
         // General
         unsigned seed = 0; // The same seed creates the same world. 0 for random seed.
         // Noise
@@ -0,0 +1,158 @@
+#include "headless.h"
+
+#include <chrono>
+
+#include <fmt/ostream.h>
+
+#include "core/mctsPlayer.h"
+#include "utils/log.h"
+
+
+
+namespace df {
+
+	HeadlessSimulation::Config HeadlessSimulation::configFrom(const CommandLineOptions& options) noexcept {
+		Config config;
+		config.rounds = options.getRounds();
+		config.seed = options.getSeed();
+		config.aiDifficulty = options.getAiDifficulty();
+		config.recordPath = options.getRecordPath();
+		return config;
+	}
+
+
+	HeadlessSimulation::Report HeadlessSimulation::run(const Config& config) noexcept {
+		WorldGeneratorConfig worldConfig;
+		worldConfig.columns = config.mapSize;
+		worldConfig.rows = config.mapSize;
+		worldConfig.seed = config.seed;
+
+		// the same setup for recorded and not recorded games
+		Replay replay(worldConfig, config.seed, std::vector<ResourceBundle>(config.playerCount, GameController::STARTING_RESOURCES));
+		GameState state; // no registry -> nothing is rendered
+		replay.setUp(state);
+
+		GameController controller(state, replay.getSeed());
+		if (config.recordPath) {
+			controller.setReplay(&replay);
+		}
+
+		std::optional<MctsPlayer> ai;
+		if (config.aiDifficulty) {
+			MctsPlayer::Config aiConfig = MctsPlayer::Config::forDifficulty(*config.aiDifficulty);
+			aiConfig.threads = config.aiThreads;
+			// a seeded game has to play the same on every machine (tournament CSV, replays): stop on rollouts, not time
+			aiConfig.timeBudget = MctsPlayer::Config::NO_TIME_LIMIT;
+			aiConfig.seed = config.seed;
+			ai.emplace(aiConfig);
+		}
+
+		Report report;
+		const auto start = std::chrono::steady_clock::now();
+		while (state.getRoundNumber() < config.rounds) {
+			controller.startTurn();
+			if (ai && state.getCurrentPlayerId() == 0) {
+				const MctsPlayer::Decision decision = ai->takeTurn(controller, 0);
+				report.aiRollouts += decision.rollouts;
+				report.aiSeconds += decision.seconds;
+			} else {
+				takeScriptedTurn(controller, state.getCurrentPlayerId());
+			}
+			controller.endTurn();
+			report.turns++;
+		}
+		report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		for (const Player& player : state.getPlayers()) {
+			report.players.push_back({
+				state.getPlayerSettlementIds(player.getId()).size(),
+				state.getPlayerRoadIds(player.getId()).size(),
+				player.getResources(),
+			});
+		}
+
+		if (config.recordPath) {
+			if (const Result<void, ResultError> result = replay.save(*config.recordPath); result.isErr()) {
+				DF_LOG_ERROR(SAVE, "{}", fmt::streamed(result.unwrapErr()));
+			} else {
+				report.replayBytes = replay.encode().size();
+			}
+		}
+		return report;
+	}
+
+
+	void HeadlessSimulation::print(const Config& config, const Report& report) noexcept {
+		fmt::println("[Headless] {} rounds, {} players, {}x{} map, seed {}", config.rounds, config.playerCount, config.mapSize, config.mapSize, config.seed);
+		fmt::println("[Headless] {} turns in {:.3f} s -> {:.0f} turns/s", report.turns, report.seconds, report.getTurnsPerSecond());
+		if (config.aiDifficulty) {
+			fmt::println("[Headless] player 0 is an AI: {} rollouts in {:.3f} s", report.aiRollouts, report.aiSeconds);
+		}
+		for (size_t playerId = 0; playerId < report.players.size(); ++playerId) {
+			const PlayerReport& player = report.players[playerId];
+			fmt::println("[Headless] player {}: {} settlements, {} roads, {} resources", playerId, player.settlements, player.roads, player.resources.getTotal());
+		}
+		if (config.recordPath && report.replayBytes > 0) {
+			fmt::println("[Headless] replay written to {} ({} bytes)", *config.recordPath, report.replayBytes);
+		}
+	}
+
+
+	Replay::Playback HeadlessSimulation::play(const Replay& replay) noexcept {
+		GameState state;
+		replay.setUp(state);
+		GameController controller(state, replay.getSeed());
+		return replay.play(controller);
+	}
+
+
+	void HeadlessSimulation::print(const Replay& replay, const Replay::Playback& playback) noexcept {
+		fmt::println("[Replay] {} players, {}x{} map, seed {}, {} turns, {} actions ({} bytes)", replay.getPlayerCount(), replay.getWorldConfig().columns,
+			replay.getWorldConfig().rows, replay.getSeed(), replay.getTurnCount(), replay.getActionCount(), replay.getActionBytes());
+		fmt::println("[Replay] {} turns, {} actions in {:.3f} s -> {:.0f} turns/s", playback.turns, playback.actions, playback.seconds, playback.getTurnsPerSecond());
+		if (playback.isInSync()) {
+			fmt::println("[Replay] state hash matched every turn");
+		} else {
+			fmt::println("[Replay] DESYNC in turn {}", *playback.desyncTurn);
+		}
+	}
+
+
+	void HeadlessSimulation::takeScriptedTurn(GameController& controller, size_t playerId) noexcept {
+		GameState& state = controller.getState();
+		const Graph& map = state.getMap();
+		const Player* player = state.getPlayer(playerId);
+		if (!player) return;
+
+		if (player->hasResources(GameController::SETTLEMENT_COST)) {
+			size_t bestIndex = SIZE_MAX;
+			float bestYield = 0.0f;
+			controller.getLegalSettlementVertices(playerId).forEachSet([&](size_t vertexIndex) {
+				const float yield = map.getExpectedYield(map.getVertex(vertexIndex));
+				if (yield > bestYield) {
+					bestYield = yield;
+					bestIndex = vertexIndex;
+				}
+			});
+			if (bestIndex != SIZE_MAX)
+				controller.buildSettlement(playerId, map.getVertex(bestIndex)->getId(), GameController::SETTLEMENT_COST);
+		}
+
+		if (player->hasResources(GameController::ROAD_COST)) {
+			// first free edge around one of the player's settlements
+			for (const size_t settlementId : state.getPlayerSettlementIds(playerId)) {
+				const Settlement* settlement = state.findSettlement(settlementId);
+				const auto edges = settlement ? map.getVertexEdges(map.findVertexById(settlement->getVertexId())) : std::nullopt;
+				if (!edges) continue;
+
+				for (const EdgeHandle edge : *edges) {
+					if (edge && controller.canBuildRoad(playerId, edge->getId())) {
+						controller.buildRoad(playerId, edge->getId(), RoadLevel::Path, GameController::ROAD_COST);
+						return;
+					}
+				}
+			}
+		}
+	}
+
+} // namespace df
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "core/gamecontroller.h"
+#include "core/gamestate.h"
+#include "core/replay.h"
+#include "core/types.h"
+#include <utils/commandLineOptions.h>
+
+
+
+namespace df {
+
+	// Runs a game without window, audio or rendering: GameState + GameController only (no registry),
+	// scripted players take their turns as fast as possible. Used for balancing runs and performance tracking.
+	class HeadlessSimulation {
+	  public:
+		struct Config {
+			size_t rounds = 100;
+			size_t playerCount = 4;
+			unsigned seed = 42;
+			unsigned mapSize = 100;
+			std::optional<types::AiDifficulty> aiDifficulty; // player 0 is an MctsPlayer, the others stay scripted
+			// search threads per decision, 0 -> hardware concurrency. Only 1 plays a seeded game the same on every machine:
+			// with more threads the rollouts each thread gets depend on scheduling
+			unsigned aiThreads = 1;
+			std::optional<std::string> recordPath; // write a replay of the game
+		};
+
+		struct PlayerReport {
+			size_t settlements = 0;
+			size_t roads = 0;
+			ResourceBundle resources;
+		};
+
+		struct Report {
+			size_t turns = 0;
+			double seconds = 0.0;
+			std::vector<PlayerReport> players;
+			size_t aiRollouts = 0;
+			double aiSeconds = 0.0; // part of seconds spent in the search
+			size_t replayBytes = 0; // 0 if not recorded
+
+			double getTurnsPerSecond() const { return this->seconds > 0.0 ? static_cast<double>(this->turns) / this->seconds : 0.0; }
+		};
+
+		static Config configFrom(const CommandLineOptions& options) noexcept;
+		// Uses no global mutable state: map and dice are seeded from config.seed, so the same config gives the
+		// same game and several games can run on different threads at the same time.
+		static Report run(const Config& config) noexcept;
+		static void print(const Config& config, const Report& report) noexcept;
+
+		// re-executes a recorded game on a fresh state, see Replay::play()
+		static Replay::Playback play(const Replay& replay) noexcept;
+		static void print(const Replay& replay, const Replay::Playback& playback) noexcept;
+
+	  private:
+		// simple greedy script: best affordable settlement spot by expected yield, then a road next to own buildings
+		// (also the model of the opponents in the MctsPlayer playouts)
+		static void takeScriptedTurn(GameController& controller, size_t playerId) noexcept;
+	};
+
+} // namespace df
@@ -0,0 +1,152 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <tiny_ecs.hpp>
+
+/*
+ * tinyECS' ComponentContainer finds the component of an entity through an unordered_map. IndexedContainer is the same
+ * container (components and entities stay dense in insertion order, remove() moves the last one into the gap) plus an
+ * array indexed by entity id, so get(), has() and find() are a single array read instead of a hash lookup.
+ * ComponentView joins several containers through these arrays, see Registry::view().
+ *
+ * Add and remove components through the IndexedContainer (or ContainerInterface), a ComponentContainer& would bypass
+ * the index.
+*/
+
+namespace df {
+	template<typename Component>
+	class IndexedContainer : public ComponentContainer<Component> {
+		using Base = ComponentContainer<Component>;
+
+	public:
+		Component& insert(Entity entity, Component component, bool checkForDuplicates = true) {
+			const std::uint32_t index = static_cast<std::uint32_t>(this->entities.size());
+			Component& inserted = Base::insert(entity, std::move(component), checkForDuplicates);
+			this->setIndex(entity, index);
+			return inserted;
+		}
+
+		template<typename... Arguments>
+		Component& emplace(Entity entity, Arguments&&... arguments) {
+			return this->insert(entity, Component(std::forward<Arguments>(arguments)...));
+		}
+
+		template<typename... Arguments>
+		Component& emplace_with_duplicates(Entity entity, Arguments&&... arguments) {
+			return this->insert(entity, Component(std::forward<Arguments>(arguments)...), false);
+		}
+
+		Component& get(Entity entity) {
+			assert(this->has(entity) && "Entity not contained in ECS registry");
+			return this->components[this->indexOf(entity)];
+		}
+
+		// nullptr if the entity has no such component
+		Component* find(Entity entity) {
+			const std::uint32_t index = this->indexOf(entity);
+			return (index == NONE) ? nullptr : &this->components[index];
+		}
+
+		bool has(Entity entity) override { return this->indexOf(entity) != NONE; }
+
+		void remove(Entity entity) override {
+			const std::uint32_t index = this->indexOf(entity);
+			if (index == NONE) return;
+
+			Base::remove(entity);
+			if (index < this->entities.size()) {
+				this->setIndex(this->entities[index], index); // the former last one
+			}
+			this->resetIndex(entity);
+		}
+
+		void clear() override {
+			Base::clear();
+			this->indices.clear();
+		}
+
+		template<class Compare>
+		void sort(Compare comparator) {
+			Base::sort(comparator);
+			this->indices.clear();
+			for (std::uint32_t i = 0; i < this->entities.size(); i++) {
+				this->setIndex(this->entities[i], i);
+			}
+		}
+
+	private:
+		static constexpr std::uint32_t NONE = std::numeric_limits<std::uint32_t>::max();
+
+		// component index by entity id, NONE = no component. Entity ids are a global counter, so this is as long as
+		// the highest id that ever had a component here (4 bytes per entity of the game).
+		std::vector<std::uint32_t> indices;
+
+		static size_t idOf(Entity entity) { return static_cast<unsigned int>(entity); }
+
+		std::uint32_t indexOf(Entity entity) const {
+			const size_t id = idOf(entity);
+			return (id < this->indices.size()) ? this->indices[id] : NONE;
+		}
+
+		void setIndex(Entity entity, const std::uint32_t index) {
+			const size_t id = idOf(entity);
+			if (id >= this->indices.size()) {
+				this->indices.resize(id + 1, NONE);
+			}
+			this->indices[id] = index;
+		}
+
+		void resetIndex(Entity entity) {
+			if (const size_t id = idOf(entity); id < this->indices.size()) {
+				this->indices[id] = NONE;
+			}
+		}
+	};
+
+
+	// The entities that have a component in each of the containers, with these components. Walks the entity list of
+	// the smallest container and resolves every component through the containers' index arrays.
+	template<typename... Components>
+	class ComponentView {
+		static_assert(sizeof...(Components) > 0, "a view needs at least one container");
+
+	public:
+		explicit ComponentView(IndexedContainer<Components>&... containers) : containers(&containers...) {}
+
+		// callback(Entity, Components&...) in the order of the smallest container.
+		// The callback must not add or remove components of the viewed containers.
+		template<typename Callback>
+		void each(Callback&& callback) {
+			std::apply([&](IndexedContainer<Components>*... container) {
+				const std::vector<Entity>* smallest = nullptr;
+				((smallest = (!smallest || container->entities.size() < smallest->size()) ? &container->entities : smallest), ...);
+
+				for (size_t i = 0; i < smallest->size(); i++) {
+					Entity entity = (*smallest)[i];
+					const std::tuple<Components*...> found{ container->find(entity)... };
+					std::apply([&](Components*... component) {
+						if ((... && (component != nullptr))) {
+							callback(entity, *component...);
+						}
+					}, found);
+				}
+			}, this->containers);
+		}
+
+		// number of entities each() visits
+		size_t count() {
+			size_t visited = 0;
+			this->each([&visited](Entity, Components&...) { visited++; });
+			return visited;
+		}
+
+	private:
+		std::tuple<IndexedContainer<Components>*...> containers;
+	};
+}
@@ -1,33 +1,50 @@
 #include <application.h>
+#include <headless.h>
 #include <utils/commandLineOptions.h>
+#include <utils/log.h>
 
-#include <iostream>
-
-
-void print(std::string s) {
-	std::cout << s << std::endl;
-}
+#include <fmt/ostream.h>
 
 
 int main(int argc, char** argv) {
-	print("Starting and trying to initialize app...");
-
 	df::CommandLineOptions options = df::CommandLineOptions::parse(argc, argv);
+	if (options.getLogLevels() && !df::log::configure(*options.getLogLevels())) {
+		fmt::println(stderr, "\"--log\" expects <level> or <module>=<level>,... See --help.");
+	}
+
+	DF_LOG_INFO(APPLICATION, "Starting and trying to initialize app...");
+
+	// no window, audio or rendering -> play the replay / run the simulation and exit
+	if (options.getReplayPath() && !options.hasHelp()) {
+		const auto loaded = df::Replay::load(*options.getReplayPath());
+		if (loaded.isErr()) {
+			DF_LOG_ERROR(SAVE, "{}", fmt::streamed(loaded.unwrapErr()));
+			return EXIT_FAILURE;
+		}
+		const df::Replay replay = loaded.unwrap<>();
+		const df::Replay::Playback playback = df::HeadlessSimulation::play(replay);
+		df::HeadlessSimulation::print(replay, playback);
+		return playback.isInSync() ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+	if (options.hasHeadless() && !options.hasHelp()) {
+		const df::HeadlessSimulation::Config config = df::HeadlessSimulation::configFrom(options);
+		df::HeadlessSimulation::print(config, df::HeadlessSimulation::run(config));
+		return EXIT_SUCCESS;
+	}
+
 	std::optional<df::Application> app = df::Application::init(options);
 
 
 	if (!app) {
 		return EXIT_FAILURE;
 	}
-	std::cout << "Test0!" << std::endl;
-	print("Try running app...");
+	DF_LOG_INFO(APPLICATION, "Try running app...");
 	app->run();
-	std::cout << "Test1" << std::endl;
 
-	print("Try deinitialize app...");
+	DF_LOG_INFO(APPLICATION, "Try deinitialize app...");
 	app->deinit();
 
-	print("Done.");
+	DF_LOG_INFO(APPLICATION, "Done.");
 
 	return EXIT_SUCCESS;
 }
@@ -52,4 +52,18 @@ namespace df {
 			container->remove(entity);
 		}
 	}
+
+
+	void Registry::nextFrame() noexcept {
+		this->version++;
+		if (this->version > CHANGE_HISTORY_FRAMES) {
+			const std::uint64_t oldest = this->version - CHANGE_HISTORY_FRAMES;
+			this->positions.forgetChangesBefore(oldest);
+			this->scales.forgetChangesBefore(oldest);
+			this->roads.forgetChangesBefore(oldest);
+			this->roadEdgeIndices.forgetChangesBefore(oldest);
+			this->settlements.forgetChangesBefore(oldest);
+			this->animations.forgetChangesBefore(oldest);
+		}
+	}
 } // namespace df
@@ -2,6 +2,8 @@
 
 #include <common.h>
 #include <tiny_ecs.hpp>
+#include "indexedContainer.h"
+#include "trackedContainer.h"
 #include <core/road.h>
 #include <core/settlement.h>
 #include "components.h"
@@ -28,24 +30,45 @@ namespace df {
         void clear() noexcept;
         void clear(Entity e) noexcept;
 
-			ComponentContainer<glm::vec2> positions;
-			ComponentContainer<glm::vec2> velocities;
-			ComponentContainer<glm::vec2> scales;
-			ComponentContainer<float> angles;
+			// frame version the tracked containers stamp their changes with, see trackedContainer.h
+			inline std::uint64_t getVersion() const noexcept { return version; }
+			// once per frame, after the frame's systems ran
+			void nextFrame() noexcept;
 
-			ComponentContainer<Player> players;
+		private:
+			std::uint64_t version = 1; // before the containers, the tracked ones keep a reference
+
+		public:
+			// changes older than this many frames are forgotten, a system that didn't run for longer starts over
+			static constexpr std::uint64_t CHANGE_HISTORY_FRAMES = 120;
+
+			TrackedContainer<glm::vec2> positions{ this->version };
+			IndexedContainer<glm::vec2> velocities;
+			TrackedContainer<glm::vec2> scales{ this->version };
+			IndexedContainer<float> angles;
+
+			IndexedContainer<Player> players;
 
-			ComponentContainer<float> collisionRadius;
+			IndexedContainer<float> collisionRadius;
 
-			ComponentContainer<glm::vec3> colors;
-			ComponentContainer<Road> roads;
-			ComponentContainer<int> roadEdgeIndices; // autoselect correct road-texture for edge angle
-			ComponentContainer<Settlement> settlements;
-			ComponentContainer<BuildingPreviewComponent> buildingPreviews;
+			IndexedContainer<glm::vec3> colors;
+			TrackedContainer<Road> roads{ this->version };
+			TrackedContainer<int> roadEdgeIndices{ this->version }; // autoselect correct road-texture for edge angle
+			TrackedContainer<Settlement> settlements{ this->version };
+			IndexedContainer<BuildingPreviewComponent> buildingPreviews;
 
-			ComponentContainer<Camera> cameras;
-			ComponentContainer<CameraInput> cameraInputs;
-			ComponentContainer<AnimationComponent> animations;
+			IndexedContainer<Camera> cameras;
+			IndexedContainer<CameraInput> cameraInputs;
+			TrackedContainer<AnimationComponent> animations{ this->version };
+
+
+			// Joins containers by entity, e.g.
+			//     registry->view(registry->settlements, registry->positions, registry->scales).each(
+			//         [](Entity e, Settlement& settlement, glm::vec2& position, glm::vec2& scale) { ... });
+			template<typename... Components>
+			ComponentView<Components...> view(IndexedContainer<Components>&... viewed) noexcept {
+				return ComponentView<Components...>(viewed...);
+			}
 
 
 			inline Entity getPlayer() noexcept { return player; }
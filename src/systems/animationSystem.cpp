@@ -4,7 +4,7 @@ namespace df {
 
     void AnimationSystem::update(Registry* registry, float deltaTime) {
         for (std::size_t i = 0; i < registry->animations.size(); ++i) {
-            AnimationComponent& animComp = registry->animations.components[i];
+            AnimationComponent& animComp = registry->animations.modify(registry->animations.entities[i]);
             animComp.anim.step(deltaTime);
         }
     }
@@ -1,17 +1,16 @@
 #include "audio.h"
 
-#include <iostream>
-#include <ostream>
 #include <utility>
 
 #include "events/eventBus.h"
+#include "log.h"
 
 
 namespace df {
 	AudioSystem::Sound::Sound(ma_engine* pEngine, const std::string& path) {
 		ma_sound* newSound = new ma_sound();
 		if (ma_result result; (result = ma_sound_init_from_file(pEngine, path.c_str(), 0, nullptr, nullptr, newSound)) != MA_SUCCESS) {
-			fmt::println(stderr, "Failed to load \"{}\": {}", path, ma_result_description(result));
+			DF_LOG_ERROR(AUDIO, "Failed to load \"{}\": {}", path, ma_result_description(result));
 			delete newSound;
 			newSound = nullptr;
 		}
@@ -23,10 +22,10 @@ namespace df {
 	AudioSystem::AudioSystem(std::shared_ptr<EventBus> bus) : eventBus(bus) {
 		this->engine.reset(new ma_engine);
 		if (ma_result result; (result = ma_engine_init(nullptr, this->engine.get())) != MA_SUCCESS) {
-			fmt::println(stderr, "Failed to initialize ma_engine: {}", ma_result_description(result));
+			DF_LOG_ERROR(AUDIO, "Failed to initialize ma_engine: {}", ma_result_description(result));
 		}
 
-		eventBus->playSoundRequested.connect(
+		this->playSoundConnection = eventBus->playSoundRequested.connectScoped(
 			[this](const std::string& path, const bool loop) {
 				this->onPlaySoundRequested(path, loop);
 			},
@@ -34,9 +33,7 @@ namespace df {
 		);
 	}
 
-	AudioSystem::~AudioSystem() noexcept {
-		eventBus->playSoundRequested.disconnect("AudioSystem::onPlaySoundRequested");
-	}
+	AudioSystem::~AudioSystem() noexcept = default; // playSoundConnection disconnects
 
 
 	bool AudioSystem::loadSound(const std::string& path) {
@@ -54,7 +51,7 @@ namespace df {
 
 
 	void AudioSystem::onPlaySoundRequested(const std::string& path, const bool loop) {
-		fmt::println("Playing sound requested: {}\n", path);
+		DF_LOG_DEBUG(AUDIO, "Playing sound requested: {}", path);
 
 		if (!isSoundLoaded(path)) {
 			if (!loadSound(path)) {
@@ -4,6 +4,8 @@
 #include <memory>
 #include <miniaudio.h>
 
+#include "events/signal.h"
+
 
 namespace df {
 	class EventBus;
@@ -40,6 +42,8 @@ namespace df {
 			std::shared_ptr<EventBus> eventBus;
 			std::unique_ptr<ma_engine, EngineDestructor> engine;
 			std::unordered_map<std::string, std::unique_ptr<Sound>> sounds;
+			// after eventBus -> disconnects before the bus is released
+			ScopedConnection playSoundConnection;
 
 			bool loadSound(const std::string& path);
 			bool isSoundLoaded(const std::string& path) const;
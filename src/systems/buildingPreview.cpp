@@ -1,6 +1,7 @@
 #include "buildingPreview.h"
 #include "core/camera.h"
 #include "systems/renderCommon.h"
+#include "utils/worldNodeMapper.h"
 
 
 
@@ -8,11 +9,12 @@
 
 namespace df {
 
-	BuildingPreviewSystem BuildingPreviewSystem::init(Window* window, Registry* registry, GameState& gameState) noexcept {
+	BuildingPreviewSystem BuildingPreviewSystem::init(Window* window, Registry* registry, GameState& gameState, GameController& gameController) noexcept {
 		BuildingPreviewSystem self;
 		self.window = window;
 		self.registry = registry;
 		self.gamestate = &gameState;
+		self.gameController = &gameController;
 		self.previewEntity = Entity();
 		self.hasPreviewEntity = false;
 
@@ -36,7 +38,7 @@ namespace df {
 
 
 	void BuildingPreviewSystem::updatePreviewPosition() noexcept {
-		if (!hasPreviewEntity || !registry || !window || !gamestate) return;
+		if (!hasPreviewEntity || !registry || !window || !gamestate || !gameController) return;
 
 		Camera& cam = registry->cameras.get(registry->getCamera());
 
@@ -53,10 +55,28 @@ namespace df {
 
 		// savee position relative to camera
 		if (registry->positions.has(previewEntity)) {
-			registry->positions.get(previewEntity) = cursorWorldOffset;
+			registry->positions.modify(previewEntity) = cursorWorldOffset;
 		} else {
 			registry->positions.emplace(previewEntity) = cursorWorldOffset;
 		}
+
+		// every frame -> look the spot up in the legal-move masks of the GameController (kept up to date
+		// incrementally) instead of running the placement rules again
+		if (!registry->buildingPreviews.has(previewEntity)) return;
+		BuildingPreviewComponent& preview = registry->buildingPreviews.get(previewEntity);
+		const Graph& map = gamestate->getMap();
+		const glm::vec2 worldPos = cam.position + cursorWorldOffset;
+		const size_t playerId = gamestate->getCurrentPlayerId();
+
+		if (preview.type == BuildingPreviewType::Settlement) {
+			const auto vertexId = WorldNodeMapper::findClosestVertexToWorldPos(worldPos, map);
+			const size_t index = vertexId ? map.indexOfVertex(*vertexId) : SIZE_MAX;
+			preview.legal = index != SIZE_MAX && gameController->getLegalSettlementVertices(playerId).test(index);
+		} else {
+			const auto edgeId = WorldNodeMapper::findClosestEdgeToWorldPos(worldPos, map);
+			const size_t index = edgeId ? map.indexOfEdge(*edgeId) : SIZE_MAX;
+			preview.legal = index != SIZE_MAX && gameController->getLegalRoadEdges(playerId).test(index);
+		}
 	}
 
 
@@ -79,7 +99,7 @@ namespace df {
 					registry->buildingPreviews.get(previewEntity).type = BuildingPreviewType::Settlement;
 				}
 				if (registry->scales.has(previewEntity)) {
-					registry->scales.get(previewEntity) = glm::vec2(0.5f, 0.5f);
+					registry->scales.modify(previewEntity) = glm::vec2(0.5f, 0.5f);
 				}
 			}
 		} else {
@@ -114,7 +134,7 @@ namespace df {
 					registry->buildingPreviews.get(previewEntity).type = BuildingPreviewType::Road;
 				}
 				if (registry->scales.has(previewEntity)) {
-					registry->scales.get(previewEntity) = glm::vec2(1.0f, 1.0f);
+					registry->scales.modify(previewEntity) = glm::vec2(1.0f, 1.0f);
 				}
 			}
 		} else {
@@ -2,6 +2,7 @@
 
 #include "registry.h"
 #include "window.h"
+#include "gamecontroller.h"
 #include "gamestate.h"
 
 
@@ -14,11 +15,11 @@ namespace df {
 		BuildingPreviewSystem() = default;
 		~BuildingPreviewSystem() = default;
 
-		static BuildingPreviewSystem init(Window* window, Registry* registry, GameState& gameState) noexcept;
+		static BuildingPreviewSystem init(Window* window, Registry* registry, GameState& gameState, GameController& gameController) noexcept;
 		void deinit() noexcept;
 		void step(float dt) noexcept;
 
-		// Update preview entity position based on cursor position
+		// Update preview entity position based on cursor position and whether the spot under it is legal
 		void updatePreviewPosition() noexcept;
 
 		// Create or update the preview entity for settlements
@@ -35,6 +36,7 @@ namespace df {
 		Registry* registry = nullptr;
 		Window* window = nullptr;
 		GameState* gamestate = nullptr;
+		GameController* gameController = nullptr;
 		Entity previewEntity;
 		bool hasPreviewEntity = false;
 	};
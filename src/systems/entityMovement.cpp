@@ -13,8 +13,8 @@ namespace df {
 	void EntityMovementSystem::moveEntityTo(Entity entity, const glm::vec2& targetPos, float deltaTime) noexcept {
 		if (!registry) return;
 
-		auto& animComp = registry->animations.get(entity);
-		glm::vec2& currentPos = registry->positions.get(entity);
+		const auto& animComp = registry->animations.get(entity);
+		const glm::vec2 currentPos = registry->positions.get(entity);
 
 		glm::vec2 direction = targetPos - currentPos;
 		float distance = glm::length(direction);
@@ -33,19 +33,21 @@ namespace df {
 		moving = true;
 			
 		if (glm::length(movement) >= distance) {
-			currentPos = targetPos;
+			registry->positions.modify(entity) = targetPos;
 			
-			animComp.currentType = Hero::AnimationType::Idle;
-			animComp.anim.setCurrentFrameIndex(0);
+			auto& idleAnimComp = registry->animations.modify(entity);
+			idleAnimComp.currentType = Hero::AnimationType::Idle;
+			idleAnimComp.anim.setCurrentFrameIndex(0);
 			moving = false;
 			movementState = false;
 		}
 		else {
 			if (animComp.currentType == Hero::AnimationType::Idle) {
-			animComp.currentType = Hero::AnimationType::Run;
-			animComp.anim.setCurrentFrameIndex(0);
+			auto& runAnimComp = registry->animations.modify(entity);
+			runAnimComp.currentType = Hero::AnimationType::Run;
+			runAnimComp.anim.setCurrentFrameIndex(0);
 			}
-			currentPos += movement;
+			registry->positions.modify(entity) = currentPos + movement;
 		}
 	}
 
@@ -120,6 +120,8 @@ namespace df {
 			const BuildingPreviewComponent& preview = registry->buildingPreviews.get(e);
 			const glm::vec2& scale = registry->scales.get(e);
 			const glm::vec2& pos = registry->positions.get(e);
+			// tinted red where the current player can't build
+			const glm::vec3 color = preview.legal ? glm::vec3(1.0f) : glm::vec3(1.0f, 0.35f, 0.35f);
 
 			if (preview.type == BuildingPreviewType::Settlement) { // settlement
 				const float shadowOffsetY = -0.15f;
@@ -155,7 +157,7 @@ namespace df {
 					.setMat4("projection", projection)
 					.setMat4("model[0]", model)
 					.setSampler("sprite", 0)
-					.setVec3("fcolor", glm::vec3(1.0f, 1.0f, 1.0f))
+					.setVec3("fcolor", color)
 					.setFloat("time", time);
 				glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
 
@@ -188,7 +190,7 @@ namespace df {
 					.setMat4("projection", projection)
 					.setMat4("model[0]", model)
 					.setSampler("sprite", 0)
-					.setVec3("fcolor", glm::vec3(1.0f))
+					.setVec3("fcolor", color)
 					.setFloat("time", time);
 
 				glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
@@ -105,6 +105,86 @@ namespace df {
 	}
 
 
+	// Only the settlements and roads whose components changed since the last frame get their sprite recomputed.
+	void RenderBuildingsSystem::updateSprites() noexcept {
+		const std::uint64_t since = this->spritesVersion;
+		this->spritesVersion = registry->getVersion();
+
+		if (!registry->settlements.isTrackedSince(since) || !registry->roads.isTrackedSince(since) || !registry->positions.isTrackedSince(since)
+			|| !registry->scales.isTrackedSince(since) || !registry->roadEdgeIndices.isTrackedSince(since)) {
+			// first frame, or not rendered for too long
+			this->settlementSprites.clear();
+			this->roadSprites.clear();
+			for (Entity e : registry->settlements.entities) this->updateSettlementSprite(e);
+			for (Entity e : registry->roads.entities) this->updateRoadSprite(e);
+			return;
+		}
+
+		for (const auto& change : registry->settlements.getChangesSince(since)) {
+			this->updateSettlementSprite(change.entity);
+		}
+		for (const auto& change : registry->roads.getChangesSince(since)) {
+			this->updateRoadSprite(change.entity);
+		}
+		// the sprite model also depends on the position and scale, a road's texture on its edge index
+		auto updateSpritesOf = [this](const Entity entity) {
+			// mostly the hero and the building preview, neither has a sprite here
+			if (this->settlementSprites.has(entity) || registry->settlements.has(entity)) this->updateSettlementSprite(entity);
+			if (this->roadSprites.has(entity) || registry->roads.has(entity)) this->updateRoadSprite(entity);
+		};
+		for (const auto& change : registry->positions.getChangesSince(since)) updateSpritesOf(change.entity);
+		for (const auto& change : registry->scales.getChangesSince(since)) updateSpritesOf(change.entity);
+		for (const auto& change : registry->roadEdgeIndices.getChangesSince(since)) updateSpritesOf(change.entity);
+	}
+
+
+	static glm::mat4 getSpriteModel(const glm::vec2& worldPos, const glm::vec2& scale) {
+		glm::mat4 model = glm::identity<glm::mat4>();
+		model = glm::translate(model, glm::vec3(worldPos, 0.0f));
+		return glm::scale(model, glm::vec3(scale, 1.0f));
+	}
+
+
+	void RenderBuildingsSystem::updateSettlementSprite(Entity entity) noexcept {
+		const glm::vec2* worldPos = registry->positions.find(entity);
+		const glm::vec2* scale = registry->scales.find(entity);
+		if (!registry->settlements.has(entity) || !worldPos || !scale) {
+			this->settlementSprites.remove(entity);
+			return;
+		}
+
+		BuildingSprite* sprite = this->settlementSprites.find(entity);
+		if (!sprite) sprite = &this->settlementSprites.emplace(entity);
+		sprite->model = getSpriteModel(*worldPos, *scale);
+	}
+
+
+	void RenderBuildingsSystem::updateRoadSprite(Entity entity) noexcept {
+		const glm::vec2* worldPos = registry->positions.find(entity);
+		const glm::vec2* scale = registry->scales.find(entity);
+		if (!registry->roads.has(entity) || !worldPos || !scale) {
+			this->roadSprites.remove(entity);
+			return;
+		}
+
+		BuildingSprite* sprite = this->roadSprites.find(entity);
+		if (!sprite) sprite = &this->roadSprites.emplace(entity);
+		sprite->model = getSpriteModel(*worldPos, *scale);
+		const int* edgeIndex = registry->roadEdgeIndices.find(entity);
+		sprite->edgeIndex = edgeIndex ? *edgeIndex : -1;
+	}
+
+
+	Texture& RenderBuildingsSystem::getRoadTexture(const int edgeIndex) noexcept {
+		if (edgeIndex == 0 || edgeIndex == 3)
+			return roadTextureDiagonalDown;
+		else if (edgeIndex == 2 || edgeIndex == 5)
+			return roadTextureDiagonalUp;
+		else
+			return roadTextureVertical; // 1, 4 and unknown
+	}
+
+
 	void RenderBuildingsSystem::renderBuildings(float time) noexcept {
 		if (!registry || !gamestate)
 			return;
@@ -120,24 +200,15 @@ namespace df {
 		constexpr int numFrames = 5;		   // how many frames per animation run
 		int textureIndex = static_cast<int>(time * animationSpeed) % numFrames;
 
-		// Render settlements from ECS
-		for (Entity e : registry->settlements.entities) {
-			if (!registry->positions.has(e) || !registry->scales.has(e))
-				continue;
-
-			// const Settlement& settlement = registry->settlements.get(e);
-			const glm::vec2& worldPos = registry->positions.get(e);
-			const glm::vec2& scale = registry->scales.get(e);
-
-			glm::mat4 model = glm::identity<glm::mat4>();
-			model = glm::translate(model, glm::vec3(worldPos, 0.0f));
-			model = glm::scale(model, glm::vec3(scale, 1.0f));
+		this->updateSprites();
 
+		// settlements
+		for (const BuildingSprite& sprite : this->settlementSprites.components) {
 			// Use animated settlement texture
 			settlementTextures[textureIndex].bind(0);
 			spriteShader.use()
 				.setMat4("view", view)
-				.setMat4("model[0]", model)
+				.setMat4("model[0]", sprite.model)
 				.setMat4("projection", projection)
 				.setSampler("sprite", 0)
 				.setVec3("fcolor", glm::vec3(1.0f));
@@ -145,34 +216,11 @@ namespace df {
 			glDrawArrays(GL_TRIANGLE_FAN, 0, 4);
 		}
 
-		// Render roads from ECS
-		for (Entity e : registry->roads.entities) {
-			if (!registry->positions.has(e) || !registry->scales.has(e))
-				continue;
-
-			const glm::vec2& worldPos = registry->positions.get(e);
-			const glm::vec2& scale = registry->scales.get(e);
-
-			int edgeIndex = this->registry->roadEdgeIndices.has(e) ? this->registry->roadEdgeIndices.get(e) : -1;
-
-			Texture* roadTexture = nullptr;
-			if (edgeIndex == 0 || edgeIndex == 3)
-				roadTexture = &roadTextureDiagonalDown;
-			else if (edgeIndex == 2 || edgeIndex == 5)
-				roadTexture = &roadTextureDiagonalUp;
-			else if (edgeIndex == 1 || edgeIndex == 4)
-				roadTexture = &roadTextureVertical;
-			else
-				roadTexture = &roadTextureVertical;
-
-			glm::mat4 model = glm::identity<glm::mat4>();
-			model = glm::translate(model, glm::vec3(worldPos, 0.0f));
-			model = glm::scale(model, glm::vec3(scale, 1.0f));
-
-			assert(roadTexture != nullptr); // should not fail
-			roadTexture->bind(0);
+		// roads
+		for (const BuildingSprite& sprite : this->roadSprites.components) {
+			this->getRoadTexture(sprite.edgeIndex).bind(0);
 			spriteShader.use()
-				.setMat4("model[0]", model)
+				.setMat4("model[0]", sprite.model)
 				.setMat4("view", view)
 				.setMat4("projection", projection)
 				.setSampler("sprite", 0)
@@ -33,8 +33,19 @@ namespace df {
 
 
 		private:
+		// model matrix of a placed building, kept up to date from the registry's change log
+		struct BuildingSprite {
+			glm::mat4 model;
+			int edgeIndex = -1; // roads only, selects the texture
+		};
+
 		const glm::mat4 calculateProjection(const Camera& cam) const;
 
+			void updateSprites() noexcept;
+			void updateSettlementSprite(Entity entity) noexcept;
+			void updateRoadSprite(Entity entity) noexcept;
+			Texture& getRoadTexture(int edgeIndex) noexcept;
+
 			Registry* registry;
 			Window* window;
 			std::shared_ptr<GameState> gamestate;
@@ -52,5 +63,9 @@ namespace df {
 			GLuint m_quad_ebo;
 
 			Viewport viewport;
+
+			IndexedContainer<BuildingSprite> settlementSprites;
+			IndexedContainer<BuildingSprite> roadSprites;
+			std::uint64_t spritesVersion = 0; // registry version of the last updateSprites(), 0 = never
 	};
 }
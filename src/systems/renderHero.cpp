@@ -2,6 +2,7 @@
 #include "../core/tile.h"
 #include "common.h"
 #include "hero.h"
+#include "log.h"
 #include "utils/textureArray.h"
 
 namespace df {
@@ -122,7 +123,7 @@ namespace df {
 
 		this->columns = mapColumns;
 		this->rows = tileCount / mapColumns;
-		fmt::println("INIT ERFOLGREICH");
+		DF_LOG_DEBUG(RENDER, "RenderHeroSystem: init erfolgreich");
 	}
 
 	void RenderHeroSystem::deinit() noexcept {
@@ -187,8 +188,9 @@ namespace df {
 
 		glBindVertexArray(m_quad_vao);
 
-		for (Entity e : registry->animations.entities) {
-			auto& animComp = registry->animations.get(e);
+		registry->view(registry->animations, registry->positions, registry->scales).each(
+			[&](Entity entity, AnimationComponent& animComp, const glm::vec2& heroPos, const glm::vec2& worldScale) {
+			registry->animations.markModified(entity); // stepped below, the view hands out the component for writing
 			std::vector<int> animationOrder = getHeroAnimationSequence(animComp.currentType);
 			animComp.anim.setFrames(animationOrder);
 			animComp.anim.step(deltaTime);
@@ -199,9 +201,6 @@ namespace df {
 
 			// glm::vec2 screenPos = glm::vec2(0.5f, 0.5f) * glm::vec2(window->getWindowExtent());
 
-			glm::vec2 heroPos = registry->positions.get(e);
-			glm::vec2 worldScale = registry->scales.get(e);
-
 			glm::mat4 model = glm::translate(glm::mat4(1.f), glm::vec3(heroPos, 0.f));
 			model = glm::scale(model, glm::vec3(worldScale, 1.f));
 
@@ -211,7 +210,7 @@ namespace df {
 				.setMat4("view", view)
 				.setMat4("projection", projection)
 				.setVec3("fcolor", glm::vec3(1.0f));
-		}
+		});
 
 		glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
 	}
@@ -96,7 +96,7 @@ namespace df {
             // Render HUD
             // TODO: update for multiple player if we do multiplayer
             Player& player = *gameState->getPlayer(0);
-            std::map<types::TileType, int> resources = player.getResources();
+            const ResourceBundle& resources = player.getResources();
             std::string hudTextToPrint = "Wood: " + std::to_string(resources[types::TileType::FOREST]) +
                 "; Stone: " + std::to_string(resources[types::TileType::MOUNTAIN]) +
                 "; Clay: " + std::to_string(resources[types::TileType::CLAY]) +
@@ -2,7 +2,7 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <algorithm>
 #include "../core/camera.h"
-#include <iostream>
+#include "log.h"
 
 /*
 *   Used the OPENGL particle system tutorial :
@@ -47,6 +47,10 @@ namespace df {
         return self;
     }
 
+    int RenderSnowSystem::randomBelow(const int bound) noexcept {
+        return static_cast<int>(this->randomEngine() % static_cast<unsigned>(bound));
+    }
+
     void RenderSnowSystem::initBuffers() noexcept {
         // Create VAO
         glGenVertexArrays(1, &vao);
@@ -122,15 +126,15 @@ namespace df {
             int particleIndex = findUnusedParticle();
             Particle& p = particlesContainer[particleIndex];
             
-            p.life = (50.0f + (rand() % 20)); 
+            p.life = (50.0f + randomBelow(20)); 
             p.pos = glm::vec3(
-                cameraPos.x + (rand() %  200 ) - 20.0f,
+                cameraPos.x + randomBelow(200) - 20.0f,
                 spawnY,
                 0.0f
             );
             
             p.speed = glm::vec3(
-                (rand() % 60 - 30.0f) / 500.0f,
+                (randomBelow(60) - 30.0f) / 500.0f,
                 -1.0f,
                 0.0f
             );
@@ -138,7 +142,7 @@ namespace df {
             p.r = 255;
             p.g = 255;
             p.b = 255;
-            p.a = 160 + (rand() % 75);
+            p.a = 160 + randomBelow(75);
             
             p.size = 0.10f;
         }
@@ -182,8 +186,7 @@ namespace df {
         
         glm::mat4 view = glm::mat4(1.0f); // View matrix but fot  2D
         
-        //debugging
-        //std::cout << "Rendering snow with " << particlesCount << " particles." << std::endl;
+        DF_LOG_TRACE(RENDER, "Rendering snow with {} particles", particlesCount);
         render(view, projection);
     }
 
@@ -6,6 +6,7 @@
 #include <utils/shader.h>
 #include <utils/framebuffer.h>
 #include <glm/glm.hpp>
+#include <random>
 #include <vector>
 
 namespace df {
@@ -44,6 +45,8 @@ private:
     };
     
     std::vector<Particle> particlesContainer;
+    // own engine instead of rand(): no shared global state
+    std::default_random_engine randomEngine;
     
     // CPU buffers that will be sent to GPU
     std::vector<GLfloat> g_particule_position_size_data;
@@ -51,6 +54,7 @@ private:
     
     // Helper methods
     int findUnusedParticle() noexcept;
+    int randomBelow(int bound) noexcept; // [0, bound)
     void initBuffers() noexcept;
 };
 
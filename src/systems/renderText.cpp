@@ -1,7 +1,7 @@
 #include "renderText.h"
 #include <ft2build.h>
 #include FT_FREETYPE_H
-#include <iostream>
+#include "log.h"
 
 namespace df {
 
@@ -18,14 +18,14 @@ namespace df {
         // FreeType init
         FT_Library ft;
         if (FT_Init_FreeType(&ft)) {
-            std::cout << "ERROR::FREETYPE: Could not init FreeType Library" << std::endl;
+            DF_LOG_ERROR(RENDER, "FreeType: Could not init FreeType Library");
             return self;
         }
 
         std::string fontPath = getBasePath() + "/assets/fonts/static/Roboto-Regular.ttf";
         FT_Face face;
         if (FT_New_Face(ft, fontPath.c_str(), 0, &face)) {
-            std::cout << "ERROR::FREETYPE: Failed to load font" << std::endl;
+            DF_LOG_ERROR(RENDER, "FreeType: Failed to load font {}", fontPath);
             FT_Done_FreeType(ft);
             return self;
         }
@@ -36,7 +36,7 @@ namespace df {
         for (unsigned char c = 0; c < 128; c++) {
             // load character glyph 
             if (FT_Load_Char(face, c, FT_LOAD_RENDER)) {
-                std::cout << "ERROR::FREETYTPE: Failed to load Glyph" << std::endl;
+                DF_LOG_ERROR(RENDER, "FreeType: Failed to load Glyph");
                 continue;
             }
 
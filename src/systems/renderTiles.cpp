@@ -1,12 +1,21 @@
 #include "renderTiles.h"
-#include <iostream>
+#include <fmt/ostream.h>
+#include "log.h"
 #include "../core/player.h"
 #include "../core/tile.h"
 #include "utils/textureArray.h"
 #include "common.h"
 #include "worldGenerator.h"
 
+#include <algorithm>
+#include <cstddef>
+
 namespace df {
+	constexpr unsigned MAX_MAP_WIDTH = WorldGenerator::MAX_MAP_DIMENSION;
+	constexpr size_t MAX_TILE_COUNT = static_cast<size_t>(WorldGenerator::MAX_MAP_DIMENSION) * WorldGenerator::MAX_MAP_DIMENSION;
+	constexpr size_t INSTANCE_UPLOAD_CHUNK_SIZE = 1 << 20; // bytes per glBufferSubData call
+
+
 	RenderTilesSystem RenderTilesSystem::init(Window& window, Registry& registry, std::shared_ptr<GameState> gameState) noexcept {
 		RenderTilesSystem self;
 
@@ -94,11 +103,11 @@ namespace df {
 		const unsigned width = map.getMapWidth();
 		const size_t tileCount = map.getTileCount();
 
-		if (width == 0 or width > 100) {
-			return Err(ResultError(ResultError::Kind::DomainError, fmt::format("RenderTilesSystem::updateMap() width={} of map({}) is not in [1, 100]. Cannot allocate render buffer.", width, reinterpret_cast<uintptr_t>(&map))));
+		if (width == 0 or width > MAX_MAP_WIDTH) {
+			return Err(ResultError(ResultError::Kind::DomainError, fmt::format("RenderTilesSystem::updateMap() width={} of map({}) is not in [1, {}]. Cannot allocate render buffer.", width, reinterpret_cast<uintptr_t>(&map), MAX_MAP_WIDTH)));
 		}
-		if (tileCount == 0 or tileCount > 10000) {
-			return Err(ResultError(ResultError::Kind::DomainError, fmt::format("RenderTilesSystem::updateMap() tileCount={} of map({}) is not in [1, 10'000]. Cannot allocate render buffer.", tileCount, reinterpret_cast<uintptr_t>(&map))));
+		if (tileCount == 0 or tileCount > MAX_TILE_COUNT) {
+			return Err(ResultError(ResultError::Kind::DomainError, fmt::format("RenderTilesSystem::updateMap() tileCount={} of map({}) is not in [1, {}]. Cannot allocate render buffer.", tileCount, reinterpret_cast<uintptr_t>(&map), MAX_TILE_COUNT)));
 		}
 		if (tileCount < width || tileCount % width != 0) {
 			return Err(ResultError(ResultError::Kind::DomainError, fmt::format("RenderTilesSystem::updateMap() width and tileCount are inconsistent. Cannot allocate render buffer.")));
@@ -113,13 +122,17 @@ namespace df {
 			return Err(tileInstanceResult.unwrapErr());
 		}
 
+		// Stream the instances in fixed size chunks instead of one huge copy (a 1000x1000 map is ~24 MB).
+		// The buffer is orphaned first, so the upload does not have to wait for frames still reading the old data.
 		const size_t newTileInstancesBufferSize = this->tileInstances.size() * sizeof(TileInstance);
 		glBindBuffer(GL_ARRAY_BUFFER, this->tileInstanceVbo);
-		if (newTileInstancesBufferSize > this->tileInstancesBufferSize) {
-			glBufferData(GL_ARRAY_BUFFER, newTileInstancesBufferSize, this->tileInstances.data(), GL_DYNAMIC_DRAW);
-			this->tileInstancesBufferSize = newTileInstancesBufferSize;
-		} else {
-			glBufferSubData(GL_ARRAY_BUFFER, 0, newTileInstancesBufferSize, this->tileInstances.data());
+		this->tileInstancesBufferSize = std::max(this->tileInstancesBufferSize, newTileInstancesBufferSize);
+		glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(this->tileInstancesBufferSize), nullptr, GL_DYNAMIC_DRAW);
+
+		const auto* instanceBytes = reinterpret_cast<const std::byte*>(this->tileInstances.data());
+		for (size_t offset = 0; offset < newTileInstancesBufferSize; offset += INSTANCE_UPLOAD_CHUNK_SIZE) {
+			const size_t chunkSize = std::min(INSTANCE_UPLOAD_CHUNK_SIZE, newTileInstancesBufferSize - offset);
+			glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(chunkSize), instanceBytes + offset);
 		}
 
 
@@ -134,12 +147,12 @@ namespace df {
 					case GLFW_KEY_F: {
 						this->renderFogOfWar ^= true;
 						this->updateRequired = true;
-						fmt::println("Set fow rendering to {}", this->renderFogOfWar ? "true" : "false");
+						DF_LOG_DEBUG(RENDER, "Set fow rendering to {}", this->renderFogOfWar ? "true" : "false");
 					} break;
 					/*case GLFW_KEY_H: {
 						this->useHex ^= true;
 						this->updateRequired = true;
-						fmt::println("Set hex rendering to {}", this->useHex ? "true" : "false");
+						DF_LOG_DEBUG(RENDER, "Set hex rendering to {}", this->useHex ? "true" : "false");
 					} break;*/
 					case GLFW_KEY_P: {
 						double xpos, ypos;
@@ -149,7 +162,7 @@ namespace df {
 						auto tileId = getTileIdAtPosition(xpos, extent.y - ypos);
 						this->selectedTile = tileId;
 						auto mapId = tileIdToMapId(tileId);
-						fmt::println("Picked: TileId {} / MapId {} at mouse ({}, {})", tileId, mapId, xpos, ypos);
+						DF_LOG_INFO(RENDER, "Picked: TileId {} / MapId {} at mouse ({}, {})", tileId, mapId, xpos, ypos);
 					} break;
 				}
 			}
@@ -203,20 +216,19 @@ namespace df {
 	}
 
 
-	float accumulator = 0.0f;
 	void RenderTilesSystem::step(const float delta) noexcept {
-		accumulator += delta;
-		if (accumulator > 1.0) {
-			accumulator = 0.0f;
+		this->animationTime += delta;
+		if (this->animationTime > 1.0) {
+			this->animationTime = 0.0f;
 		}
 		if (Graph& map = this->gameState->getMap(); map.isRenderUpdateRequested() or this->updateRequired) {
 			if (const Result<void, ResultError> result = updateMap(); result.isErr()) {
-				std::cerr << result.unwrapErr() << std::endl;
+				DF_LOG_ERROR(RENDER, "{}", fmt::streamed(result.unwrapErr()));
 			}
 			map.setRenderUpdateRequested(false);
 			this->updateRequired = false;
 		}
-		renderMap(accumulator);
+		renderMap(this->animationTime);
 		//renderPickerMap(true);
 	}
 
@@ -294,7 +306,7 @@ namespace df {
 
 		glm::uvec2 extent = this->intermediateFramebuffer.getExtent();
 		if (static_cast<unsigned>(x) >= extent.x || static_cast<unsigned>(y) >= extent.y) {
-			std::cerr << "Tile picker coordinates are out of bounds: " << "x: " << x << ", y: " << y;
+			DF_LOG_WARNING(RENDER, "Tile picker coordinates are out of bounds: x: {}, y: {}", x, y);
 			return 0;
 		}
 		glViewport(0, 0, extent.x, extent.y);
@@ -383,13 +395,14 @@ namespace df {
 	}
 
 
-	Result<std::vector<RenderTilesSystem::TileInstance>, ResultError> RenderTilesSystem::makeTileInstances(const std::vector<std::unique_ptr<Tile>>& tiles, const int columns, const Player* player) const noexcept {
+	Result<std::vector<RenderTilesSystem::TileInstance>, ResultError> RenderTilesSystem::makeTileInstances(const std::vector<TileHandle>& tiles, const int columns, const Player* player) const noexcept {
 		if (!this->renderFogOfWar) {
 			player = nullptr;
 		}
 
 		const int rows = static_cast<int>(tiles.size()) / columns;
 		std::vector<TileInstance> instances;
+		instances.reserve(tiles.size());
 
 		// For tile picking. 0 = None
 		std::uint32_t index = 1;
@@ -397,7 +410,7 @@ namespace df {
 		for (int row = rows - 1; row >= 0; row--) {
 			for (int column = 0; column < columns; column++) {
 				const glm::vec2 position = RenderCommon::rowColToWorldCoordinates(column, row);
-				const TileHandle tile = tiles[row * columns + column].get();
+				const TileHandle tile = tiles[row * columns + column];
 				instances.push_back({position, static_cast<int>(tile->getType()), 0, player == nullptr, index});
 				index++;
 			}
@@ -69,6 +69,7 @@ namespace df {
         size_t tileInstancesBufferSize = 0;
         unsigned tileColumns = 0;
         unsigned tileRows = 0;
+        float animationTime = 0.0f; // seconds, wraps around every second
 
         static std::vector<TileVertex> createHexagonalTileMesh() noexcept;
         static std::vector<TileVertex> createRectangularTileMesh() noexcept;
@@ -77,7 +78,7 @@ namespace df {
         void renderMap(float timeInSeconds = 0.0) const noexcept;
         void renderPickerMap(bool blend = false) const noexcept;
 
-        Result<std::vector<TileInstance>, ResultError> makeTileInstances(const std::vector<std::unique_ptr<Tile>>& tiles, int columns, const Player* player = nullptr) const noexcept;
+        Result<std::vector<TileInstance>, ResultError> makeTileInstances(const std::vector<TileHandle>& tiles, int columns, const Player* player = nullptr) const noexcept;
 
         bool renderFogOfWar = true;
         bool updateRequired = false;
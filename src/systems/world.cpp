@@ -1,7 +1,7 @@
 #include "world.h"
 #include "hero.h"
-#include <iostream>
-#include "fmt/base.h"
+#include "fmt/ostream.h"
+#include "log.h"
 
 namespace df {
 	WorldSystem WorldSystem::init(Window* window, Registry *registry, AudioSystem *audioEngine, GameState& gameState) noexcept {
@@ -16,7 +16,7 @@ namespace df {
 		self.randomEngine = std::default_random_engine(std::random_device()());
 
 		self.m_reset = true;
-		std::cout << "[Debug] WorldSystem::init aufgerufen\n";
+		DF_LOG_DEBUG(WORLD, "WorldSystem::init aufgerufen");
 		
 
 		return self;
@@ -74,7 +74,12 @@ namespace df {
 	void WorldSystem::onKeyCallback(GLFWwindow* /* window */, int key, int /* scancode */, int action, int /* mods */) noexcept {
 		CameraInput& input = registry->cameraInputs.get(registry->getCamera());
 		Entity hero = registry->animations.entities.front();
-		auto& animComp = registry->animations.get(hero);
+		// the hero's animation starts over with the new type
+		auto playAnimation = [this, hero](const Hero::AnimationType type) {
+			AnimationComponent& animComp = registry->animations.modify(hero);
+			animComp.currentType = type;
+			animComp.anim.setCurrentFrameIndex(0);
+		};
 		auto* step = this->gameState->getCurrentTutorialStep();
 		switch (action) {
 			case GLFW_PRESS:
@@ -82,35 +87,30 @@ namespace df {
 
 					// ----------------------currently only here for testing until we have a triggerpoint--------------------------------------
 				case GLFW_KEY_F7:
-					animComp.currentType = Hero::AnimationType::Idle;
-					animComp.anim.setCurrentFrameIndex(0);
-					fmt::println("Debug: Idle animation activated");
+					playAnimation(Hero::AnimationType::Idle);
+					DF_LOG_DEBUG(WORLD, "Idle animation activated");
 					break;
 				case GLFW_KEY_F8:
-					animComp.currentType = Hero::AnimationType::Swim;
-					animComp.anim.setCurrentFrameIndex(0);
-					fmt::println("Debug: Swim animation activated");
+					playAnimation(Hero::AnimationType::Swim);
+					DF_LOG_DEBUG(WORLD, "Swim animation activated");
 					break;
 				case GLFW_KEY_F9:
-					animComp.currentType = Hero::AnimationType::Attack;
-					animComp.anim.setCurrentFrameIndex(0);
-					fmt::println("Debug: Attack animation activated");
+					playAnimation(Hero::AnimationType::Attack);
+					DF_LOG_DEBUG(WORLD, "Attack animation activated");
 					break;
 
 				case GLFW_KEY_F10:
-					animComp.currentType = Hero::AnimationType::Jump;
-					animComp.anim.setCurrentFrameIndex(0);
-					fmt::println("Debug: Jump animation activated");
+					playAnimation(Hero::AnimationType::Jump);
+					DF_LOG_DEBUG(WORLD, "Jump animation activated");
 					break;
 				case GLFW_KEY_F11:
 				
-					animComp.currentType = Hero::AnimationType::Run;
-					animComp.anim.setCurrentFrameIndex(0);
-					fmt::println("Debug: Run animation activated");
+					playAnimation(Hero::AnimationType::Run);
+					DF_LOG_DEBUG(WORLD, "Run animation activated");
 					break;
 				case GLFW_KEY_H:
 					heroMovementState = !heroMovementState;
-					fmt::println("Hero movement mode toggled: {}", heroMovementState ? "ON" : "OFF");
+					DF_LOG_INFO(WORLD, "Hero movement mode toggled: {}", heroMovementState ? "ON" : "OFF");
 					break;
 					// ------------------------------------------------------------
 
@@ -118,24 +118,24 @@ namespace df {
 						m_reset = true;
 						break;
 					case GLFW_KEY_W:
-						fmt::println("W pressed");
+						DF_LOG_TRACE(WORLD, "W pressed");
 						input.up = true;
 						break;
 					case GLFW_KEY_A:
-						fmt::println("A pressed");
+						DF_LOG_TRACE(WORLD, "A pressed");
 						input.left = true;
 						break;
 					case GLFW_KEY_S:
-						fmt::println("S pressed");
+						DF_LOG_TRACE(WORLD, "S pressed");
 						input.down = true;
 						break;
 					case GLFW_KEY_D:
-						fmt::println("D pressed");
+						DF_LOG_TRACE(WORLD, "D pressed");
 						input.right = true;
 						break;
 					case GLFW_KEY_N:
     					this->isSettlementPreviewActive = !this->isSettlementPreviewActive;
-                        fmt::println("Toggled Settlement Preview: {}", this->isSettlementPreviewActive);
+                        DF_LOG_DEBUG(WORLD, "Toggled Settlement Preview: {}", this->isSettlementPreviewActive);
     					if (this->isSettlementPreviewActive) {
     						this->isRoadPreviewActive = false;
     					}
@@ -146,7 +146,7 @@ namespace df {
     					break;
     				case GLFW_KEY_B:
     					this->isRoadPreviewActive = !this->isRoadPreviewActive;
-                        fmt::println("Toggled Road Preview: {}", this->isRoadPreviewActive);
+                        DF_LOG_DEBUG(WORLD, "Toggled Road Preview: {}", this->isRoadPreviewActive);
     					if (this->isRoadPreviewActive) {
     						this->isSettlementPreviewActive = false;
     					}
@@ -158,7 +158,7 @@ namespace df {
 					case GLFW_KEY_G: {
 						Graph& map = this->gameState->getMap();
 						if (const auto worldGenConfResult = WorldGeneratorConfig::deserialize(); worldGenConfResult.isErr()) {
-							std::cerr << worldGenConfResult.unwrapErr() << std::endl;
+							DF_LOG_ERROR(WORLD, "{}", fmt::streamed(worldGenConfResult.unwrapErr()));
 							break;
 						} else {
 							map.regenerate(worldGenConfResult.unwrap<>());
@@ -251,7 +251,7 @@ namespace df {
 		if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS) {
 			// LMB gedrückt
 			glfwGetCursorPos(this->window->getHandle(), &mouseX, &mouseY);
-			fmt::println("LMB pressed at screen coordinates: ({}, {})", mouseX, mouseY);
+			DF_LOG_TRACE(WORLD, "LMB pressed at screen coordinates: ({}, {})", mouseX, mouseY);
 
 			// Update Tutorial if finished
 			if ((step && step->id == TutorialStepId::END) || (step && step->id == TutorialStepId::WELCOME)) {
@@ -261,12 +261,12 @@ namespace df {
 		else if (button == GLFW_MOUSE_BUTTON_RIGHT && action == GLFW_PRESS) {
 			// RMB gedrückt
 			glfwGetCursorPos(windowParam, &mouseX, &mouseY);
-			fmt::println("RMB pressed at screen coordinates: ({}, {})", mouseX, mouseY);
+			DF_LOG_TRACE(WORLD, "RMB pressed at screen coordinates: ({}, {})", mouseX, mouseY);
 		}
 	}
 
 	void WorldSystem::onScrollCallback(GLFWwindow*, double /* xoffset */, double yoffset) noexcept {
-		fmt::println("Scrolled: {}", yoffset);
+		DF_LOG_TRACE(WORLD, "Scrolled: {}", yoffset);
 		calcNewCameraZoom(yoffset);
 		// if current step is ZOOM_CAMERA -> complete step
 		auto* step = this->gameState->getCurrentTutorialStep();
@@ -283,7 +283,7 @@ namespace df {
 		cam.zoom += yoffset * 0.1f;
 		if (cam.zoom > cam.zoomMaxValue)	cam.zoom = cam.zoomMaxValue;
 		if (cam.zoom < cam.zoomMinValue)	cam.zoom = cam.zoomMinValue;
-		fmt::println("Zoom now: {}", cam.zoom);
+		DF_LOG_TRACE(WORLD, "Zoom now: {}", cam.zoom);
 	}
 
 
@@ -0,0 +1,440 @@
+// Event system benchmark and consistency check.
+//
+// Measures the cost of Signal::emit for typical connection counts (also against the previous implementation,
+// which copied its callback map on every emit) and counts the heap allocations emit() makes, which have to be 0.
+// Also checks the dispatch rules: callbacks connected or disconnected during an emit, scoped connections,
+// and the queued signals: post order, coalescing, frame budgets, cost of post() + dispatch().
+// The channel stress test posts from several producer threads while the main thread drains, every event has to
+// arrive exactly once and in the order of its producer.
+
+#include "events/channelSignal.h"
+#include "events/queuedSignal.h"
+#include "events/signal.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fmt/base.h>
+
+
+// allocations of the calling thread, to check that emit() doesn't allocate; other threads (the log writer,
+// the channel producers) allocate whenever they like and must not show up in the measurements
+namespace {
+	thread_local size_t allocationCount = 0;
+}
+
+void* operator new(std::size_t size) {
+	allocationCount++;
+	if (void* pointer = std::malloc(size == 0 ? 1 : size)) return pointer;
+	throw std::bad_alloc();
+}
+
+// GCC pairs the inlined free() with the operator new above and reports a mismatch, but both are replaced here
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+
+namespace {
+	using namespace df;
+
+	constexpr size_t DEFAULT_EMITS = 2'000'000;
+	constexpr std::array<size_t, 4> CONNECTION_COUNTS = { 0, 1, 4, 16 };
+	// events posted per simulated frame in the queued measurement, a burst larger than the initial ring buffer
+	constexpr size_t EVENTS_PER_FRAME = 100;
+	// small on purpose, the producers have to run into a full channel now and then
+	constexpr size_t CHANNEL_CAPACITY = 256;
+	// below the capacity, a full channel takes CHANNEL_CAPACITY / CHANNEL_FRAME_BUDGET dispatches to drain
+	constexpr size_t CHANNEL_FRAME_BUDGET = 64;
+
+
+	struct BenchmarkOptions {
+		size_t emits = DEFAULT_EMITS;
+		size_t producers = std::clamp<size_t>(std::thread::hardware_concurrency(), 3, 9) - 1;
+	};
+
+
+	// Signal before the redesign: callbacks in a map by identifier, copied on every emit.
+	template<typename... Arguments>
+	class MapCopySignal {
+	public:
+		using Callback = std::function<void(Arguments...)>;
+
+		void connect(Callback callback, const std::string& identifier) { this->callbacks.emplace(identifier, std::move(callback)); }
+
+		void emit(Arguments... arguments) {
+			const auto currentCallbacks = this->callbacks;
+			for (auto const& [identifier, callback] : currentCallbacks) callback(arguments...);
+		}
+
+	private:
+		std::unordered_map<std::string, Callback> callbacks;
+	};
+
+
+	struct EmitResult {
+		double nanoseconds = 0.0;
+		size_t allocations = 0;
+	};
+
+
+	template<typename SignalType>
+	EmitResult measureEmits(SignalType& signal, const size_t emits) {
+		using clock = std::chrono::steady_clock;
+		const size_t allocationsBefore = allocationCount;
+		const auto start = clock::now();
+		for (size_t i = 0; i < emits; i++) {
+			signal.emit(static_cast<int>(i));
+		}
+		const double seconds = std::chrono::duration<double>(clock::now() - start).count();
+		return { seconds * 1e9 / static_cast<double>(emits), allocationCount - allocationsBefore };
+	}
+
+
+	bool runEmit(const size_t emits) {
+		fmt::println("Signal<int>::emit, {} emits per measurement", emits);
+		fmt::println("  {:<12} {:>12} {:>14} {:>14} {:>16}", "connections", "ns/emit", "allocations", "map copy ns", "map copy allocs");
+
+		bool allocationFree = true;
+		for (const size_t connections : CONNECTION_COUNTS) {
+			long long sum = 0;
+			Signal<int> signal("benchmark");
+			MapCopySignal<int> reference;
+			for (size_t i = 0; i < connections; i++) {
+				signal.connect([&sum](int value) { sum += value; }, "callback" + std::to_string(i));
+				reference.connect([&sum](int value) { sum += value; }, "callback" + std::to_string(i));
+			}
+
+			const EmitResult result = measureEmits(signal, emits);
+			// the copy is slow, fewer emits are enough
+			const EmitResult referenceResult = measureEmits(reference, emits / 20);
+			fmt::println("  {:<12} {:>12.2f} {:>14} {:>14.2f} {:>16}", connections, result.nanoseconds, result.allocations,
+				referenceResult.nanoseconds, referenceResult.allocations);
+			allocationFree &= result.allocations == 0;
+			if (sum == 42) fmt::println(""); // keeps the callbacks from being optimized away
+		}
+
+		if (!allocationFree) {
+			std::cerr << "Signal::emit allocated" << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+
+	// The dispatch rules of Signal, see its comment.
+	bool runDispatchRules() {
+		std::vector<std::string> calls;
+		Signal<int> signal("rules");
+		ConnectionId second = 0;
+
+		// disconnects the next callback and itself, connects a new one: this emit still calls neither the
+		// disconnected nor the new callback, the next emit calls the new one only
+		const ConnectionId first = signal.connect([&](int) {
+			calls.push_back("first");
+			signal.disconnect(second);
+			signal.disconnect("first");
+			signal.connect([&](int) { calls.push_back("late"); }, "late");
+		}, "first");
+		second = signal.connect([&](int) { calls.push_back("second"); }, "second");
+		signal.connect([&](int) { calls.push_back("third"); }, "third");
+
+		const bool duplicateRejected = signal.connect([](int) {}, "third") == 0;
+		signal.emit(1);
+		signal.emit(2);
+		const std::vector<std::string> expected = { "first", "third", "third", "late" };
+		const bool rulesKept = calls == expected;
+
+		// a scoped connection disconnects at the end of its scope, a moved one only once
+		bool scopedCalled = false;
+		{
+			ScopedConnection scoped = signal.connectScoped([&](int) { scopedCalled = true; }, "scoped");
+			ScopedConnection moved = std::move(scoped);
+			signal.emit(3);
+		}
+		const bool scopedWorks = scopedCalled && signal.getConnectionCount() == 2;
+		scopedCalled = false;
+		signal.emit(4);
+
+		fmt::println("dispatch rules: {} calls, {} connections left", calls.size(), signal.getConnectionCount());
+		if (first == 0 || !duplicateRejected) {
+			std::cerr << "connect() returned a wrong handle" << std::endl;
+			return false;
+		}
+		if (!rulesKept) {
+			std::cerr << "callbacks connected/disconnected during an emit were called in the wrong emits" << std::endl;
+			return false;
+		}
+		if (!scopedWorks || scopedCalled) {
+			std::cerr << "the scoped connection was not disconnected at the end of its scope" << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+
+	// Queued signals: post order, the frame budget, coalescing, events posted by a callback wait for the next
+	// dispatch. Then the cost of post() + dispatch() per event; after the first burst the ring buffer is large
+	// enough and nothing allocates.
+	bool runQueued(const size_t emits) {
+		using clock = std::chrono::steady_clock;
+
+		std::vector<int> received;
+		QueuedSignal<int> signal("queued", QueuePolicy::ALL, 3);
+		signal.connect([&](int value) {
+			received.push_back(value);
+			if (value == 2) signal.post(100); // waits for the next dispatch
+		}, "receiver");
+		for (int value = 0; value < 5; value++) signal.post(value);
+		const bool nothingYet = received.empty();
+		const size_t firstFrame = signal.dispatch(signal.getFrameBudget());
+		const size_t secondFrame = signal.dispatch(signal.getFrameBudget());
+		const bool budgetKept = firstFrame == 3 && secondFrame == 3 && signal.getQueuedCount() == 0;
+		const bool orderKept = received == std::vector<int>{ 0, 1, 2, 3, 4, 100 };
+
+		std::vector<std::string> coalesced;
+		QueuedSignal<const std::string&> coalescing("coalescing", QueuePolicy::COALESCE);
+		coalescing.connect([&](const std::string& value) { coalesced.push_back(value); }, "receiver");
+		for (const char* value : { "first", "second", "latest" }) coalescing.post(value);
+		coalescing.dispatch(coalescing.getFrameBudget());
+		const bool coalescedToLatest = coalesced == std::vector<std::string>{ "latest" };
+
+		long long sum = 0;
+		QueuedSignal<int> frameSignal("frame", QueuePolicy::ALL, EVENTS_PER_FRAME);
+		frameSignal.connect([&sum](int value) { sum += value; }, "receiver");
+		const size_t frames = std::max<size_t>(emits / EVENTS_PER_FRAME, 1);
+		const size_t allocationsBefore = allocationCount;
+		size_t steadyAllocations = 0;
+		const auto start = clock::now();
+		for (size_t frame = 0; frame < frames; frame++) {
+			if (frame == 1) steadyAllocations = allocationCount; // the first burst grows the ring buffer
+			for (size_t i = 0; i < EVENTS_PER_FRAME; i++) frameSignal.post(static_cast<int>(i));
+			frameSignal.dispatch(frameSignal.getFrameBudget());
+		}
+		const double seconds = std::chrono::duration<double>(clock::now() - start).count();
+		const size_t growAllocations = steadyAllocations - allocationsBefore;
+		steadyAllocations = allocationCount - steadyAllocations;
+
+		fmt::println("queued signal: {} frames with {} events", frames, EVENTS_PER_FRAME);
+		fmt::println("  {:<28} {:>10.2f} ns/event", "post() + dispatch()", seconds * 1e9 / static_cast<double>(frames * EVENTS_PER_FRAME));
+		fmt::println("  {:<28} {:>10} (first burst {})", "allocations", steadyAllocations, growAllocations);
+		if (sum == 42) fmt::println("");
+
+		if (!nothingYet || !orderKept) {
+			std::cerr << "queued events were delivered early or out of order" << std::endl;
+			return false;
+		}
+		if (!budgetKept) {
+			std::cerr << "dispatch() did not keep the frame budget" << std::endl;
+			return false;
+		}
+		if (!coalescedToLatest) {
+			std::cerr << "a coalescing signal delivered more than the latest event" << std::endl;
+			return false;
+		}
+		if (steadyAllocations != 0) {
+			std::cerr << "post()/dispatch() allocated after the first burst" << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+
+	// Channel: the producers post (producer, sequence, post time) as fast as they can and retry when the channel
+	// is full, the main thread drains it with the frame budget like EventBus::dispatchQueued().
+	// Every event has to arrive within getMaxLatencyFrames() frames after its post() returned. A dispatch that is held
+	// back by a post() still in progress (it stops early with events waiting) doesn't count as a frame.
+	bool runChannel(const BenchmarkOptions& options) {
+		using clock = std::chrono::steady_clock;
+		const size_t eventsPerProducer = options.emits / options.producers;
+		const auto epoch = clock::now();
+		const auto nanosecondsSinceEpoch = [epoch] { return std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - epoch).count(); };
+
+		ChannelSignal<std::uint32_t, std::uint32_t, std::int64_t> channel("stress", CHANNEL_CAPACITY, CHANNEL_FRAME_BUDGET);
+		std::vector<std::uint32_t> nextSequence(options.producers, 0);
+		size_t received = 0;
+		size_t outOfOrder = 0;
+		std::int64_t maxLatency = 0;
+		// frame counter when an event was posted (read after post() returned) and when it was delivered
+		std::atomic<std::uint32_t> frame = 0;
+		std::vector<std::vector<std::uint32_t>> postedFrames(options.producers, std::vector<std::uint32_t>(eventsPerProducer));
+		std::vector<std::vector<std::uint32_t>> deliveredFrames(options.producers, std::vector<std::uint32_t>(eventsPerProducer));
+		channel.connect([&](std::uint32_t producer, std::uint32_t sequence, std::int64_t postedAt) {
+			if (producer >= nextSequence.size() || sequence != nextSequence[producer]) {
+				outOfOrder++;
+			} else {
+				nextSequence[producer]++;
+				deliveredFrames[producer][sequence] = frame.load(std::memory_order_relaxed);
+			}
+			received++;
+			maxLatency = std::max(maxLatency, nanosecondsSinceEpoch() - postedAt);
+		}, "consumer");
+
+		std::atomic<size_t> retries = 0;
+		const auto start = clock::now();
+		std::vector<std::thread> producers;
+		for (size_t producer = 0; producer < options.producers; producer++) {
+			producers.emplace_back([&, producer] {
+				size_t fullCount = 0;
+				for (size_t sequence = 0; sequence < eventsPerProducer; sequence++) {
+					const std::int64_t postedAt = nanosecondsSinceEpoch();
+					while (!channel.post(static_cast<std::uint32_t>(producer), static_cast<std::uint32_t>(sequence), postedAt)) {
+						fullCount++;
+						std::this_thread::yield();
+					}
+					postedFrames[producer][sequence] = frame.load(std::memory_order_relaxed);
+				}
+				retries.fetch_add(fullCount, std::memory_order_relaxed);
+			});
+		}
+
+		size_t frames = 0;
+		size_t heldBack = 0;
+		const size_t expected = eventsPerProducer * options.producers;
+		while (received < expected && outOfOrder == 0) {
+			const size_t delivered = channel.dispatch(channel.getFrameBudget());
+			if (delivered < channel.getFrameBudget() && channel.getQueuedCount() > 0) {
+				heldBack++;
+			} else {
+				frame.fetch_add(1, std::memory_order_relaxed);
+			}
+			if (delivered == 0) {
+				std::this_thread::yield();
+			}
+			frames++;
+		}
+		for (std::thread& producer : producers) producer.join();
+		const double seconds = std::chrono::duration<double>(clock::now() - start).count();
+
+		std::uint32_t maxLatencyFrames = 0;
+		for (size_t producer = 0; producer < options.producers && outOfOrder == 0; producer++) {
+			for (size_t sequence = 0; sequence < eventsPerProducer; sequence++) {
+				// the frame counter is read after post() returned, the event may already be delivered by then
+				if (deliveredFrames[producer][sequence] > postedFrames[producer][sequence]) {
+					maxLatencyFrames = std::max(maxLatencyFrames, deliveredFrames[producer][sequence] - postedFrames[producer][sequence]);
+				}
+			}
+		}
+
+		// a full channel drops what doesn't fit
+		ChannelSignal<int> overflow("overflow", 16);
+		for (int value = 0; value < 26; value++) overflow.post(value);
+		const bool overflowDropped = overflow.getDroppedCount() == 10 && overflow.getQueuedCount() == 16;
+
+		fmt::println("channel: {} producers x {} events, capacity {}, budget {}/dispatch", options.producers, eventsPerProducer, channel.getCapacity(), channel.getFrameBudget());
+		fmt::println("  {:<28} {:>10.2f} M events/s", "throughput", static_cast<double>(received) / seconds * 1e-6);
+		fmt::println("  {:<28} {:>10.2f} us", "max post -> delivery", static_cast<double>(maxLatency) * 1e-3);
+		fmt::println("  {:<28} {:>10} (bound {})", "max post -> delivery frames", maxLatencyFrames, channel.getMaxLatencyFrames());
+		fmt::println("  {:<28} {:>10} ({} dispatches, {} held back by a post in progress)", "posts into a full channel", retries.load(), frames, heldBack);
+
+		if (outOfOrder > 0 || received != expected || channel.getDroppedCount() != retries.load()) {
+			std::cerr << "the channel lost, duplicated or reordered events (" << received << " of " << expected << ", " << outOfOrder << " out of order)" << std::endl;
+			return false;
+		}
+		if (maxLatencyFrames > channel.getMaxLatencyFrames()) {
+			std::cerr << "an event waited " << maxLatencyFrames << " frames, more than the bound of " << channel.getMaxLatencyFrames() << std::endl;
+			return false;
+		}
+		if (!overflowDropped) {
+			std::cerr << "a full channel did not drop the overflowing events" << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+
+#ifdef DF_SIGNAL_INSTRUMENTATION
+	// emit counts per frame and callback times of an instrumented build
+	bool runStats() {
+		Signal<int> signal("stats");
+		signal.connect([](int) {}, "fast");
+		signal.connect([](int) {
+			const auto until = SignalStatsClock::now() + std::chrono::microseconds(50);
+			while (SignalStatsClock::now() < until) {}
+		}, "slow");
+
+		constexpr std::array<size_t, 3> EMITS_PER_FRAME = { 5, 2, 7 };
+		for (const size_t emits : EMITS_PER_FRAME) {
+			for (size_t i = 0; i < emits; i++) signal.emit(static_cast<int>(i));
+			signal.endFrame();
+		}
+		signal.emit(0); // in the frame that is still open
+
+		const SignalStats stats = signal.getStats();
+		fmt::println("signal stats: {} emits in {} frames, {} last frame, max {} per frame", stats.emits, stats.frames, stats.lastFrameEmits, stats.maxFrameEmits);
+		for (const CallbackStats& callback : stats.callbacks) {
+			fmt::println("  {:<8} {:>4} calls {:>10.2f} us avg {:>10.2f} us max", callback.identifier, callback.calls,
+				std::chrono::duration<double, std::micro>(callback.getAverage()).count(), std::chrono::duration<double, std::micro>(callback.max).count());
+		}
+
+		const bool isCounted = stats.emits == 15 && stats.frames == 3 && stats.currentFrameEmits == 1 && stats.lastFrameEmits == 7
+			&& stats.maxFrameEmits == 7 && stats.callbacks.size() == 2 && stats.callbacks[0].calls == 15 && stats.callbacks[1].calls == 15;
+		if (!isCounted || stats.callbacks[1].max < std::chrono::microseconds(50) || stats.callbacks[1].total < stats.callbacks[0].total) {
+			std::cerr << "the signal stats don't match the emits and callbacks" << std::endl;
+			return false;
+		}
+		signal.resetStats();
+		return signal.getStats().emits == 0;
+	}
+#endif
+
+
+	void printUsage() {
+		fmt::println("Usage: events-benchmark [options]");
+		fmt::println("  --emits <n>       emits per measurement, events in the channel test (default: {})", DEFAULT_EMITS);
+		fmt::println("  --producers <n>   producer threads in the channel test (default: cores - 1, 2 to 8)");
+		fmt::println("  --help            show this help");
+	}
+} // namespace
+
+
+int main(int argc, char** argv) {
+	BenchmarkOptions options;
+
+	for (int i = 1; i < argc; i++) {
+		const std::string_view argument = argv[i];
+		if (argument == "--emits" && i + 1 < argc) {
+			options.emits = std::strtoull(argv[++i], nullptr, 10);
+		} else if (argument == "--producers" && i + 1 < argc) {
+			options.producers = std::strtoull(argv[++i], nullptr, 10);
+		} else if (argument == "--help" || argument == "-h") {
+			printUsage();
+			return EXIT_SUCCESS;
+		} else {
+			std::cerr << "Unknown argument: " << argument << std::endl;
+			printUsage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (options.emits < 20 || options.producers == 0 || options.producers > options.emits) {
+		std::cerr << "--emits has to be at least 20 and --producers between 1 and --emits" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	bool isOk = runDispatchRules() && runEmit(options.emits) && runQueued(options.emits) && runChannel(options);
+#ifdef DF_SIGNAL_INSTRUMENTATION
+	isOk = isOk && runStats();
+#endif
+	return isOk ? EXIT_SUCCESS : EXIT_FAILURE;
+}
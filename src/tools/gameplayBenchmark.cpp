@@ -0,0 +1,873 @@
+// Headless gameplay benchmark.
+//
+// Builds a game on a generated map without window, audio or rendering and measures the rule checks the
+// game (and the AI) calls per frame / per move. Every optimized check is compared against a straightforward
+// reference implementation on the same state, so the tool doubles as a consistency check.
+
+#include "autosave.h"
+#include "compactGameState.h"
+#include "gamecontroller.h"
+#include "gamestate.h"
+#include "graph.h"
+#include "hero.h"
+#include "mctsPlayer.h"
+#include "replay.h"
+#include "saveJournal.h"
+#include "worldGenerator.h"
+#include "worldGeneratorConfig.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+
+namespace {
+	using namespace df;
+
+	constexpr unsigned DEFAULT_MAP_SIZE = 100;
+	constexpr unsigned DEFAULT_SEED = 42;
+	constexpr size_t PLAYER_COUNT = 4;
+	// fraction of the vertices that is tried for a settlement, the distance rule rejects most of them
+	constexpr double SETTLEMENT_ATTEMPT_RATIO = 0.25;
+	// builds through the GameController for the incremental legal move update
+	constexpr size_t LEGAL_MOVE_BUILDS = 32;
+	// turns played (build, road, end turn, production) before the undo check takes them back
+	constexpr size_t UNDO_TURNS = 64;
+	// autosaves requested back to back, most of them are replaced by the next one before they are written
+	constexpr size_t AUTOSAVE_REQUESTS = 50;
+	// map size the autosave is measured on in addition to --size
+	constexpr unsigned LARGE_AUTOSAVE_MAP_SIZE = 1000;
+	// turns appended to a save journal, one delta each
+	constexpr size_t JOURNAL_TURNS = 48;
+	// turns recorded into a replay and played back
+	constexpr size_t REPLAY_TURNS = 400;
+
+
+	struct BenchmarkOptions {
+		unsigned mapSize = DEFAULT_MAP_SIZE;
+		unsigned seed = DEFAULT_SEED;
+		unsigned repetitions = 20;
+	};
+
+
+	// The distance rule the way it was checked before the map tracked the occupancy: walk the neighbours.
+	bool isSettlementAllowedReference(const Graph& map, const VertexHandle vertex) {
+		if (!vertex || vertex->hasSettlement())
+			return false;
+
+		const auto edges = map.getVertexEdges(vertex);
+		if (!edges)
+			return true;
+
+		for (const EdgeHandle edge : *edges) {
+			if (!edge)
+				continue;
+			const auto neighbours = map.getEdgeVertices(edge);
+			if (!neighbours)
+				continue;
+			for (const VertexHandle neighbour : *neighbours) {
+				if (neighbour && neighbour != vertex && neighbour->hasSettlement())
+					return false;
+			}
+		}
+		return true;
+	}
+
+
+	// Distributes settlements of PLAYER_COUNT players over random vertices, as far as the rules allow.
+	size_t placeSettlements(GameState& state, GameController& controller, const unsigned seed) {
+		const Graph& map = state.getMap();
+		std::mt19937 rng(seed);
+		std::uniform_int_distribution<size_t> vertexDistribution(0, map.getVertexCount() - 1);
+
+		const auto attempts = static_cast<size_t>(static_cast<double>(map.getVertexCount()) * SETTLEMENT_ATTEMPT_RATIO);
+		size_t placed = 0;
+		for (size_t attempt = 0; attempt < attempts; attempt++) {
+			const size_t vertexId = map.getVertex(vertexDistribution(rng))->getId();
+			if (!controller.canBuildSettlement(attempt % PLAYER_COUNT, vertexId))
+				continue;
+
+			state.addSettlement(Settlement(placed, attempt % PLAYER_COUNT, vertexId, {}));
+			placed++;
+		}
+		return placed;
+	}
+
+
+	template <typename Check>
+	double measureNanosecondsPerCheck(const Graph& map, const unsigned repetitions, size_t& allowedCount, Check check) {
+		using clock = std::chrono::steady_clock;
+
+		allowedCount = 0;
+		const auto start = clock::now();
+		for (unsigned repetition = 0; repetition < repetitions; repetition++) {
+			size_t allowed = 0;
+			for (const auto& vertex : map.getVertices()) {
+				allowed += check(vertex) ? 1 : 0;
+			}
+			allowedCount = allowed;
+		}
+		const double seconds = std::chrono::duration<double>(clock::now() - start).count();
+		return seconds * 1e9 / static_cast<double>(map.getVertexCount() * repetitions);
+	}
+
+
+	// Compares the legal move masks of all players against canBuildSettlement()/canBuildRoad() for every vertex and edge.
+	size_t countLegalMoveMismatches(GameController& controller, const Graph& map) {
+		size_t mismatches = 0;
+		for (size_t playerId = 0; playerId < PLAYER_COUNT; playerId++) {
+			const BitMask& settlementVertices = controller.getLegalSettlementVertices(playerId);
+			for (size_t i = 0; i < map.getVertexCount(); i++) {
+				mismatches += settlementVertices.test(i) != controller.canBuildSettlement(playerId, map.getVertex(i)->getId()) ? 1 : 0;
+			}
+			const BitMask& roadEdges = controller.getLegalRoadEdges(playerId);
+			for (size_t i = 0; i < map.getEdgeCount(); i++) {
+				mismatches += roadEdges.test(i) != controller.canBuildRoad(playerId, map.getEdge(i)->getId()) ? 1 : 0;
+			}
+		}
+		return mismatches;
+	}
+
+
+	// Settlement lookups by id and per player, checked against the settlement data itself.
+	bool runStoreLookups(const BenchmarkOptions& options, const GameState& state) {
+		using clock = std::chrono::steady_clock;
+
+		const std::span<const Settlement> settlements = state.getSettlements();
+		size_t found = 0;
+		const auto start = clock::now();
+		for (unsigned repetition = 0; repetition < options.repetitions; repetition++) {
+			for (size_t settlementId = 0; settlementId < state.getNextSettlementId(); settlementId++) {
+				found += state.findSettlement(settlementId) ? 1 : 0;
+			}
+		}
+		const double seconds = std::chrono::duration<double>(clock::now() - start).count();
+
+		size_t mismatches = found != settlements.size() * options.repetitions ? 1 : 0;
+		size_t indexed = 0;
+		for (size_t playerId = 0; playerId < PLAYER_COUNT; playerId++) {
+			for (const size_t settlementId : state.getPlayerSettlementIds(playerId)) {
+				const Settlement* settlement = state.findSettlement(settlementId);
+				mismatches += (!settlement || settlement->getPlayerId() != playerId) ? 1 : 0;
+				indexed++;
+			}
+		}
+		mismatches += indexed != settlements.size() ? 1 : 0;
+
+		fmt::println("settlement store: {} settlements", settlements.size());
+		fmt::println("  {:<28} {:>10.2f} ns/lookup", "findSettlement(id)",
+			seconds * 1e9 / static_cast<double>(state.getNextSettlementId() * options.repetitions));
+
+		if (mismatches > 0) {
+			std::cerr << "settlement store and per-player index are inconsistent" << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+
+	// Resource distribution per turn from the production table. The table is checked against the settlements,
+	// the paid resources against the expected yield of the settled tiles.
+	bool runResourceDistribution(const BenchmarkOptions& options, GameState& state, GameController& controller) {
+		using clock = std::chrono::steady_clock;
+		const Graph& map = state.getMap();
+
+		// reference: count the settlements around every tile directly
+		std::unordered_map<size_t, int> settlementsPerTile;
+		for (const Settlement& settlement : state.getSettlements()) {
+			if (const auto tiles = map.getVertexTiles(map.findVertexById(settlement.getVertexId()))) {
+				for (const TileHandle tile : *tiles) {
+					if (tile) settlementsPerTile[tile->getId()]++;
+				}
+			}
+		}
+
+		size_t mismatches = 0;
+		double expectedPerTurn = 0.0;
+		const auto producingTiles = state.getProduction().getTiles();
+		for (const ProductionTable::TileProduction& production : producingTiles) {
+			int multipliers = 0;
+			for (const ProductionTable::Share& share : production.shares) multipliers += share.multiplier;
+			mismatches += settlementsPerTile[production.tileId] != multipliers ? 1 : 0;
+			expectedPerTurn += map.findTileById(production.tileId)->getExpectedYield() * multipliers;
+		}
+		mismatches += settlementsPerTile.size() != producingTiles.size() ? 1 : 0;
+
+		auto totalResources = [&]() {
+			long long total = 0;
+			for (const Player& player : state.getPlayers()) total += player.getResources().getTotal();
+			return total;
+		};
+
+		const size_t turns = static_cast<size_t>(options.repetitions) * 10;
+		const long long resourcesBefore = totalResources();
+		const auto start = clock::now();
+		for (size_t turn = 0; turn < turns; turn++) {
+			controller.distributeResources();
+		}
+		const double seconds = std::chrono::duration<double>(clock::now() - start).count();
+		const double paidPerTurn = static_cast<double>(totalResources() - resourcesBefore) / static_cast<double>(turns);
+
+		fmt::println("resource distribution: {} settled tiles", producingTiles.size());
+		fmt::println("  {:<28} {:>10.2f} us/turn", "distributeResources()", seconds * 1e6 / static_cast<double>(turns));
+		fmt::println("  {:<28} {:>10.1f} paid/turn, {:.1f} expected", "resources", paidPerTurn, expectedPerTurn);
+
+		if (mismatches > 0) {
+			std::cerr << "production table differs from the settlements on " << mismatches << " tiles" << std::endl;
+			return false;
+		}
+		// thousands of independent rolls per turn -> the average is well within a few percent of the expectation
+		if (expectedPerTurn > 0.0 && std::abs(paidPerTurn - expectedPerTurn) > expectedPerTurn * 0.05) {
+			std::cerr << "paid resources deviate from the expected yield" << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+
+	// Legal move masks: full rebuild vs. the incremental update after a build, then polling as the preview would.
+	bool runLegalMoves(const BenchmarkOptions& options, GameState& state, GameController& controller) {
+		using clock = std::chrono::steady_clock;
+		const Graph& map = state.getMap();
+
+		// a fresh controller has no masks yet -> the first poll builds them in one pass over the map
+		double rebuildSeconds = 0.0;
+		for (unsigned repetition = 0; repetition < options.repetitions; repetition++) {
+			GameController freshController(state);
+			const auto start = clock::now();
+			for (size_t playerId = 0; playerId < PLAYER_COUNT; playerId++) {
+				(void)freshController.getLegalSettlementVertices(playerId);
+			}
+			rebuildSeconds += std::chrono::duration<double>(clock::now() - start).count();
+		}
+
+		// incremental: builds through the controller keep the masks of all players up to date
+		std::mt19937 rng(options.seed);
+		std::uniform_int_distribution<size_t> vertexDistribution(0, map.getVertexCount() - 1);
+		std::uniform_int_distribution<size_t> edgeDistribution(0, map.getEdgeCount() - 1);
+		size_t builds = 0;
+		double incrementalSeconds = 0.0;
+		for (size_t playerId = 0; playerId < PLAYER_COUNT; playerId++) {
+			(void)controller.getLegalSettlementVertices(playerId);
+		}
+		for (size_t attempt = 0; attempt < LEGAL_MOVE_BUILDS; attempt++) {
+			const size_t playerId = attempt % PLAYER_COUNT;
+			// most random vertices are taken or blocked -> use the next legal one, as the AI would
+			const BitMask& legalVertices = controller.getLegalSettlementVertices(playerId);
+			size_t vertexIndex = vertexDistribution(rng);
+			for (size_t step = 0; step < legalVertices.getSize() && !legalVertices.test(vertexIndex); step++) {
+				vertexIndex = (vertexIndex + 1) % legalVertices.getSize();
+			}
+			const size_t vertexId = map.getVertex(vertexIndex)->getId();
+			const size_t edgeId = map.getEdge(edgeDistribution(rng))->getId();
+
+			const auto start = clock::now();
+			builds += controller.buildSettlement(playerId, vertexId, {}) ? 1 : 0;
+			builds += controller.buildRoad(playerId, edgeId, RoadLevel::Path, {}) ? 1 : 0;
+			for (size_t player = 0; player < PLAYER_COUNT; player++) {
+				(void)controller.getLegalSettlementVertices(player);
+				(void)controller.getLegalRoadEdges(player);
+			}
+			incrementalSeconds += std::chrono::duration<double>(clock::now() - start).count();
+		}
+
+		const size_t mismatches = countLegalMoveMismatches(controller, map);
+
+		fmt::println("legal move masks for {} players: {} vertices, {} edges", PLAYER_COUNT, map.getVertexCount(), map.getEdgeCount());
+		fmt::println("  {:<28} {:>10.2f} us", "rebuild (all players)", rebuildSeconds * 1e6 / options.repetitions);
+		fmt::println("  {:<28} {:>10.2f} us  ({} builds)", "build + incremental update", incrementalSeconds * 1e6 / LEGAL_MOVE_BUILDS, builds);
+		fmt::println("  {:<28} {:>10} settlements, {} roads", "legal for player 0",
+			controller.getLegalSettlementVertices(0).countSet(), controller.getLegalRoadEdges(0).countSet());
+
+		if (mismatches > 0) {
+			std::cerr << mismatches << " mask bits differ from canBuildSettlement/canBuildRoad" << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+
+	// Everything undo has to restore, in storage order: undoing in reverse has to give back the exact same layout.
+	std::vector<size_t> fingerprint(const GameState& state, GameController& controller) {
+		std::vector<size_t> values = { state.getCurrentPlayerId(), state.getTurnCount(), state.getRoundNumber() };
+		for (const Player& player : state.getPlayers()) {
+			for (const int amount : player.getResources().amounts) values.push_back(static_cast<size_t>(amount));
+			values.push_back(player.getSettlementIds().size());
+			values.push_back(player.getRoadIds().size());
+			values.push_back(player.getExploredTileIds().size());
+		}
+		for (const Settlement& settlement : state.getSettlements()) values.insert(values.end(), { settlement.getId(), settlement.getVertexId() });
+		for (const Road& road : state.getRoads()) values.insert(values.end(), { road.getId(), road.getEdgeId() });
+		for (const ProductionTable::TileProduction& production : state.getProduction().getTiles()) {
+			values.push_back(production.tileId);
+			for (const ProductionTable::Share& share : production.shares) values.insert(values.end(), { share.playerId, static_cast<size_t>(share.multiplier) });
+		}
+		for (size_t playerId = 0; playerId < state.getPlayerCount(); playerId++) {
+			for (const std::uint64_t word : controller.getLegalSettlementVertices(playerId).getWords()) values.push_back(word);
+			for (const std::uint64_t word : controller.getLegalRoadEdges(playerId).getWords()) values.push_back(word);
+		}
+		values.push_back(state.getNextSettlementId());
+		values.push_back(state.getNextRoadId());
+		return values;
+	}
+
+
+	// Undo: play whole turns, take them back with undoTo() and compare the state with the one before.
+	// Also player undo/redo of a single build.
+	bool runUndo(GameState& state, GameController& controller) {
+		using clock = std::chrono::steady_clock;
+		const Graph& map = state.getMap();
+
+		const std::vector<size_t> before = fingerprint(state, controller);
+		const size_t mark = controller.getHistoryMark();
+
+		size_t builds = 0;
+		const auto start = clock::now();
+		for (size_t turn = 0; turn < UNDO_TURNS; turn++) {
+			const size_t playerId = state.getCurrentPlayerId();
+			controller.startTurn();
+
+			size_t vertexIndex = SIZE_MAX;
+			controller.getLegalSettlementVertices(playerId).forEachSet([&](size_t index) { if (vertexIndex == SIZE_MAX) vertexIndex = index; });
+			if (vertexIndex != SIZE_MAX)
+				builds += controller.buildSettlement(playerId, map.getVertex(vertexIndex)->getId(), {}) ? 1 : 0;
+
+			size_t edgeIndex = SIZE_MAX;
+			controller.getLegalRoadEdges(playerId).forEachSet([&](size_t index) { if (edgeIndex == SIZE_MAX) edgeIndex = index; });
+			if (edgeIndex != SIZE_MAX)
+				builds += controller.buildRoad(playerId, map.getEdge(edgeIndex)->getId(), RoadLevel::Path, {}) ? 1 : 0;
+
+			controller.endTurn();
+		}
+		const double playSeconds = std::chrono::duration<double>(clock::now() - start).count();
+		const size_t commandCount = controller.getHistoryMark() - mark;
+
+		const auto undoStart = clock::now();
+		controller.undoTo(mark);
+		const double undoSeconds = std::chrono::duration<double>(clock::now() - undoStart).count();
+		const bool restored = fingerprint(state, controller) == before;
+
+		// player undo/redo of one build
+		bool undoRedo = false;
+		const size_t playerId = state.getCurrentPlayerId();
+		size_t vertexIndex = SIZE_MAX;
+		controller.getLegalSettlementVertices(playerId).forEachSet([&](size_t index) { if (vertexIndex == SIZE_MAX) vertexIndex = index; });
+		if (vertexIndex != SIZE_MAX && controller.buildSettlement(playerId, map.getVertex(vertexIndex)->getId(), {})) {
+			const std::vector<size_t> built = fingerprint(state, controller);
+			undoRedo = controller.undo() && fingerprint(state, controller) == before && controller.redo()
+				&& fingerprint(state, controller) == built && controller.undo();
+		}
+
+		fmt::println("undo: {} turns, {} builds, {} commands", UNDO_TURNS, builds, commandCount);
+		fmt::println("  {:<28} {:>10.2f} us/command", "play", playSeconds * 1e6 / static_cast<double>(commandCount));
+		fmt::println("  {:<28} {:>10.2f} us/command", "undoTo()", undoSeconds * 1e6 / static_cast<double>(commandCount));
+
+		if (!restored) {
+			std::cerr << "undoTo() did not restore the state" << std::endl;
+			return false;
+		}
+		if (!undoRedo) {
+			std::cerr << "undo()/redo() of a settlement did not restore the state" << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+
+	// AI: the compact clone has to agree with the map on every legal spot, then clone and search speed.
+	bool runCompactState(const BenchmarkOptions& options, const GameState& state) {
+		using clock = std::chrono::steady_clock;
+		const Graph& map = state.getMap();
+
+		auto start = clock::now();
+		const CompactBoard board = CompactBoard::fromGraph(map);
+		const CompactGameState compact = CompactGameState::fromGameState(state, board);
+		const double buildSeconds = std::chrono::duration<double>(clock::now() - start).count();
+
+		size_t mismatches = 0;
+		for (size_t vertexIndex = 0; vertexIndex < map.getVertexCount(); vertexIndex++) {
+			mismatches += compact.isSettlementAllowed(static_cast<std::uint32_t>(vertexIndex)) != map.isSettlementAllowed(map.getVertex(vertexIndex)) ? 1 : 0;
+		}
+		for (size_t playerId = 0; playerId < state.getPlayerCount(); playerId++) {
+			mismatches += compact.getSettlementCount(playerId) != state.getPlayerSettlementIds(playerId).size() ? 1 : 0;
+			mismatches += compact.getRoadCount(playerId) != state.getPlayerRoadIds(playerId).size() ? 1 : 0;
+		}
+
+		CompactGameState clone;
+		clone.copyFrom(compact);
+		start = clock::now();
+		for (unsigned repetition = 0; repetition < options.repetitions * 100; repetition++) {
+			clone.copyFrom(compact);
+		}
+		const double cloneSeconds = std::chrono::duration<double>(clock::now() - start).count();
+
+		MctsPlayer::Config config = MctsPlayer::Config::forDifficulty(df::types::AiDifficulty::MEDIUM);
+		config.threads = 1;
+		config.timeBudget = std::chrono::seconds(60);
+		const MctsPlayer::Decision decision = MctsPlayer(config).decide(state, state.getCurrentPlayerId());
+
+		fmt::println("compact state for the AI: {} settled vertices", state.getSettlements().size());
+		fmt::println("  {:<28} {:>10.2f} ms", "board + state from the map", buildSeconds * 1e3);
+		fmt::println("  {:<28} {:>10.2f} us", "clone", cloneSeconds * 1e6 / (options.repetitions * 100.0));
+		fmt::println("  {:<28} {:>10.2f} us/rollout  ({} rollouts, win rate {:.2f})", "MCTS decision (1 thread)",
+			decision.seconds * 1e6 / static_cast<double>(std::max<size_t>(decision.rollouts, 1)), decision.rollouts, decision.winRate);
+
+		if (mismatches > 0) {
+			std::cerr << mismatches << " differences between the compact state and the game state" << std::endl;
+			return false;
+		}
+		if (decision.rollouts != config.rollouts) {
+			std::cerr << "the search stopped before its rollout budget" << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+
+	// Records a game (builds, player undo/redo, production) into a replay, plays the decoded replay on a fresh
+	// state and compares the state hashes turn by turn. A controller with other dice has to be detected.
+	bool runReplay(const BenchmarkOptions& options) {
+		WorldGeneratorConfig config;
+		config.columns = options.mapSize;
+		config.rows = options.mapSize;
+		config.seed = options.seed;
+		Replay recording(config, options.seed, std::vector<ResourceBundle>(PLAYER_COUNT, GameController::STARTING_RESOURCES));
+
+		GameState state;
+		recording.setUp(state);
+		GameController controller(state, recording.getSeed());
+		controller.setReplay(&recording);
+		const Graph& map = state.getMap();
+
+		for (size_t turn = 0; turn < REPLAY_TURNS; turn++) {
+			const size_t playerId = state.getCurrentPlayerId();
+			controller.startTurn();
+
+			size_t vertexIndex = SIZE_MAX;
+			controller.getLegalSettlementVertices(playerId).forEachSet([&](size_t index) { if (vertexIndex == SIZE_MAX) vertexIndex = index; });
+			if (vertexIndex != SIZE_MAX && controller.buildSettlement(playerId, map.getVertex(vertexIndex)->getId(), GameController::SETTLEMENT_COST) && turn % 3 == 0) {
+				controller.undo();
+				if (turn % 2 == 0) controller.redo();
+			}
+
+			size_t edgeIndex = SIZE_MAX;
+			controller.getLegalRoadEdges(playerId).forEachSet([&](size_t index) { if (edgeIndex == SIZE_MAX) edgeIndex = index; });
+			if (edgeIndex != SIZE_MAX)
+				controller.buildRoad(playerId, map.getEdge(edgeIndex)->getId(), RoadLevel::Path, GameController::ROAD_COST);
+
+			controller.endTurn();
+		}
+		controller.setReplay(nullptr);
+
+		const std::vector<std::uint8_t> bytes = recording.encode();
+		const auto decoded = Replay::decode(bytes);
+		if (decoded.isErr()) {
+			std::cerr << decoded.unwrapErr() << std::endl;
+			return false;
+		}
+		const Replay replay = decoded.unwrap<>();
+
+		GameState playbackState;
+		replay.setUp(playbackState);
+		GameController playbackController(playbackState, replay.getSeed());
+		const Replay::Playback playback = replay.play(playbackController);
+
+		GameState otherDiceState;
+		replay.setUp(otherDiceState);
+		GameController otherDiceController(otherDiceState, replay.getSeed() + 1);
+		const Replay::Playback otherDice = replay.play(otherDiceController);
+
+		fmt::println("replay: {} turns, {} actions, {} bytes ({:.1f} bytes/turn)", replay.getTurnCount(), replay.getActionCount(), bytes.size(),
+			static_cast<double>(bytes.size()) / static_cast<double>(REPLAY_TURNS));
+		fmt::println("  {:<28} {:>10.0f} turns/s", "playback with hash checks", playback.getTurnsPerSecond());
+
+		if (replay.getTurnCount() != REPLAY_TURNS || replay.getActionCount() != recording.getActionCount()) {
+			std::cerr << "the decoded replay differs from the recording" << std::endl;
+			return false;
+		}
+		if (!playback.isInSync() || playback.turns != REPLAY_TURNS || playbackState.hash() != state.hash()) {
+			std::cerr << "the replay did not reproduce the game (desync in turn " << playback.desyncTurn.value_or(playback.turns) << ")" << std::endl;
+			return false;
+		}
+		if (otherDice.isInSync()) {
+			std::cerr << "playback with other dice was not detected" << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+
+	// Binary save vs. the JSON format: size, save and load time. The loaded game has to hash like the saved one
+	// and a damaged file has to be rejected.
+	bool runSaveGame(GameState& state) {
+		using clock = std::chrono::steady_clock;
+		// exploration and heroes are part of the binary save, give the players some
+		for (Player& player : state.getPlayers()) {
+			player.setHero(std::make_shared<Hero>(static_cast<int>(player.getId()), glm::vec2(1.0f, 2.0f), "hero", 3));
+			for (size_t tileId = player.getId(); tileId < state.getMap().getTiles().size(); tileId += 7) {
+				if (!player.isTileExplored(tileId)) {
+					player.exploreTile(tileId);
+					state.getMap().getTile(tileId)->addVisibleForPlayers(player.getId());
+				}
+			}
+		}
+
+		const std::filesystem::path binaryPath = std::filesystem::temp_directory_path() / "gameplay-benchmark.dfsave";
+		const std::filesystem::path jsonPath = std::filesystem::temp_directory_path() / "gameplay-benchmark.json";
+
+		auto start = clock::now();
+		state.save(binaryPath);
+		const double binarySaveSeconds = std::chrono::duration<double>(clock::now() - start).count();
+		start = clock::now();
+		{
+			std::ofstream file(jsonPath);
+			file << state.serialize().dump(4); // the format save() wrote before
+		}
+		const double jsonSaveSeconds = std::chrono::duration<double>(clock::now() - start).count();
+
+		GameState loaded;
+		start = clock::now();
+		loaded.load(binaryPath);
+		const double binaryLoadSeconds = std::chrono::duration<double>(clock::now() - start).count();
+		GameState loadedJson;
+		start = clock::now();
+		loadedJson.load(jsonPath);
+		const double jsonLoadSeconds = std::chrono::duration<double>(clock::now() - start).count();
+
+		const auto binaryBytes = std::filesystem::file_size(binaryPath);
+		const auto jsonBytes = std::filesystem::file_size(jsonPath);
+		fmt::println("save game: {} tiles, {} settlements, {} roads", state.getMap().getTiles().size(), state.getSettlements().size(), state.getRoads().size());
+		fmt::println("  {:<28} {:>10} bytes  save {:>8.2f} ms  load {:>8.2f} ms", "binary (compressed)", binaryBytes, binarySaveSeconds * 1e3, binaryLoadSeconds * 1e3);
+		fmt::println("  {:<28} {:>10} bytes  save {:>8.2f} ms  load {:>8.2f} ms", "JSON (dump(4))", jsonBytes, jsonSaveSeconds * 1e3, jsonLoadSeconds * 1e3);
+		fmt::println("  {:<28} {:>10.1f}x", "size reduction", static_cast<double>(jsonBytes) / static_cast<double>(binaryBytes));
+
+		bool sameMap = loaded.getMap().getVertexCount() == state.getMap().getVertexCount();
+		for (size_t vertexIndex = 0; sameMap && vertexIndex < state.getMap().getVertexCount(); vertexIndex++) {
+			sameMap = loaded.getMap().isSettlementAllowed(loaded.getMap().getVertex(vertexIndex)) == state.getMap().isSettlementAllowed(state.getMap().getVertex(vertexIndex));
+		}
+		const Hero* hero = loaded.getPlayerCount() > 0 ? loaded.getPlayers()[0].getHero().get() : nullptr;
+
+		// flip one byte in the middle of the compressed payload
+		bool damagedRejected = false;
+		{
+			std::fstream file(binaryPath, std::ios::in | std::ios::out | std::ios::binary);
+			file.seekg(static_cast<std::streamoff>(binaryBytes / 2));
+			const char byte = static_cast<char>(file.get());
+			file.seekp(static_cast<std::streamoff>(binaryBytes / 2));
+			file.put(static_cast<char>(byte ^ 0x5a));
+		}
+		try {
+			GameState damaged;
+			damaged.load(binaryPath);
+		} catch (const std::exception&) {
+			damagedRejected = true;
+		}
+		std::filesystem::remove(binaryPath);
+		std::filesystem::remove(jsonPath);
+
+		if (loaded.hash() != state.hash() || !sameMap) {
+			std::cerr << "the loaded binary save differs from the saved game" << std::endl;
+			return false;
+		}
+		if (!hero || hero->getTextureRef() != "hero" || hero->getBaseRange() != 3) {
+			std::cerr << "the heroes were not restored" << std::endl;
+			return false;
+		}
+		if (!damagedRejected) {
+			std::cerr << "a damaged save file was loaded" << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+
+	// Save journal: one base, then one delta per turn that has to stay small next to a full save. Loading has to
+	// give the saved state, also after an undo (buildings removed) and with the last delta cut off by a "crash".
+	bool runSaveJournal(GameState& state, GameController& controller) {
+		using clock = std::chrono::steady_clock;
+		const Graph& map = state.getMap();
+		const std::filesystem::path path = std::filesystem::temp_directory_path() / "gameplay-benchmark.dfjournal";
+
+		SaveJournal journal(path, JOURNAL_TURNS + 1); // no compaction, every turn is a delta
+		journal.append(state.snapshot());
+		const size_t baseBytes = journal.getStats().fileBytes;
+
+		const size_t mark = controller.getHistoryMark();
+		size_t maxDeltaBytes = 0;
+		double appendSeconds = 0.0;
+		for (size_t turn = 0; turn < JOURNAL_TURNS; turn++) {
+			const size_t playerId = state.getCurrentPlayerId();
+			controller.startTurn();
+
+			size_t vertexIndex = SIZE_MAX;
+			controller.getLegalSettlementVertices(playerId).forEachSet([&](size_t index) { if (vertexIndex == SIZE_MAX) vertexIndex = index; });
+			if (vertexIndex != SIZE_MAX)
+				controller.buildSettlement(playerId, map.getVertex(vertexIndex)->getId(), {});
+
+			size_t edgeIndex = SIZE_MAX;
+			controller.getLegalRoadEdges(playerId).forEachSet([&](size_t index) { if (edgeIndex == SIZE_MAX) edgeIndex = index; });
+			if (edgeIndex != SIZE_MAX)
+				controller.buildRoad(playerId, map.getEdge(edgeIndex)->getId(), RoadLevel::Path, {});
+
+			Player& player = state.getPlayers()[playerId];
+			const size_t tileId = (turn * 37 + playerId) % map.getTiles().size();
+			if (!player.isTileExplored(tileId)) {
+				player.exploreTile(tileId);
+				state.getMap().getTile(tileId)->addVisibleForPlayers(playerId);
+			}
+			controller.endTurn();
+
+			const auto start = clock::now();
+			journal.append(state.snapshot());
+			appendSeconds += std::chrono::duration<double>(clock::now() - start).count();
+			maxDeltaBytes = std::max(maxDeltaBytes, journal.getStats().lastAppendBytes);
+		}
+		const size_t deltaBytes = journal.getStats().fileBytes - baseBytes;
+
+		GameState loaded;
+		const auto loadStart = clock::now();
+		loaded.load(path);
+		const double loadSeconds = std::chrono::duration<double>(clock::now() - loadStart).count();
+		const bool loadedSame = loaded.hash() == state.hash();
+
+		// the buildings of all turns go again, the delta replaces the tails of the lists
+		const std::uint64_t playedHash = state.hash();
+		controller.undoTo(mark);
+		journal.append(state.snapshot());
+		GameState undone;
+		undone.load(path);
+		const bool undoneSame = undone.hash() == state.hash();
+
+		// a crash in the middle of the last append -> the state of the delta before it
+		std::filesystem::resize_file(path, std::filesystem::file_size(path) - journal.getStats().lastAppendBytes / 2);
+		GameState torn;
+		torn.load(path);
+		const bool tornSame = torn.hash() == playedHash;
+		std::filesystem::remove(path);
+
+		const size_t fullBytes = state.snapshot().encodeFile().size();
+		fmt::println("save journal: {} turns, base {} bytes, full save {} bytes", JOURNAL_TURNS, baseBytes, fullBytes);
+		fmt::println("  {:<28} {:>10.1f} bytes/turn  (max {})", "delta", static_cast<double>(deltaBytes) / static_cast<double>(JOURNAL_TURNS), maxDeltaBytes);
+		fmt::println("  {:<28} {:>10.2f} us/turn", "append (diff + write)", appendSeconds * 1e6 / static_cast<double>(JOURNAL_TURNS));
+		fmt::println("  {:<28} {:>10.2f} ms", "load (base + deltas)", loadSeconds * 1e3);
+
+		if (!loadedSame || !undoneSame) {
+			std::cerr << "the loaded save journal differs from the saved game" << std::endl;
+			return false;
+		}
+		if (!tornSame) {
+			std::cerr << "the save journal with a cut off delta did not load the previous turn" << std::endl;
+			return false;
+		}
+		if (maxDeltaBytes >= fullBytes) {
+			std::cerr << "a journal delta is as large as a full save" << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+
+	// Autosave: the caller only pays for the snapshot, the worker writes the latest one. The first request copies all
+	// tiles, the next ones share them, then every request follows a tile change and copies only that tile's chunk.
+	// The file on disk has to be the last requested state and no temporary file may be left behind.
+	bool runAutosave(GameState& state) {
+		using clock = std::chrono::steady_clock;
+		const std::filesystem::path path = std::filesystem::temp_directory_path() / "gameplay-benchmark-autosave.dfsave";
+		std::filesystem::path temporaryPath = path;
+		temporaryPath += ".tmp";
+		Graph& map = state.getMap();
+
+		double firstSnapshotSeconds = 0.0;
+		double maxSnapshotSeconds = 0.0;
+		double totalSnapshotSeconds = 0.0;
+		double maxChangedSnapshotSeconds = 0.0;
+		double totalChangedSnapshotSeconds = 0.0;
+		Autosave::Stats stats;
+		{
+			Autosave autosave(path);
+			for (size_t i = 0; i < AUTOSAVE_REQUESTS; i++) {
+				const auto start = clock::now();
+				autosave.request(state);
+				const double seconds = std::chrono::duration<double>(clock::now() - start).count();
+				if (i == 0) {
+					firstSnapshotSeconds = seconds; // builds the tile records, later snapshots share them
+				} else {
+					maxSnapshotSeconds = std::max(maxSnapshotSeconds, seconds);
+					totalSnapshotSeconds += seconds;
+				}
+			}
+			// spread over the map, each request finds another chunk changed
+			for (size_t i = 0; i < AUTOSAVE_REQUESTS; i++) {
+				const TileHandle tile = map.getTiles()[(i * 7919) % map.getTileCount()];
+				map.setTilePotency(tile, (tile->getPotency() == df::types::TilePotency::HIGH) ? df::types::TilePotency::LOW : df::types::TilePotency::HIGH);
+				const auto start = clock::now();
+				autosave.request(state);
+				const double seconds = std::chrono::duration<double>(clock::now() - start).count();
+				maxChangedSnapshotSeconds = std::max(maxChangedSnapshotSeconds, seconds);
+				totalChangedSnapshotSeconds += seconds;
+			}
+			autosave.flush();
+			stats = autosave.getStats();
+		}
+
+		const auto start = clock::now();
+		state.save(path.string() + ".sync");
+		const double syncSeconds = std::chrono::duration<double>(clock::now() - start).count();
+		std::filesystem::remove(path.string() + ".sync");
+
+		GameState loaded;
+		loaded.load(path);
+		const bool temporaryLeft = std::filesystem::exists(temporaryPath);
+		std::filesystem::remove(path);
+
+		// GameState::hash() leaves out the tiles, the changed potencies are compared here
+		bool tilesMatch = loaded.getMap().getTileCount() == map.getTileCount();
+		for (size_t tileIndex = 0; tilesMatch && tileIndex < map.getTileCount(); tileIndex++) {
+			tilesMatch = loaded.getMap().getTiles()[tileIndex]->getPotency() == map.getTiles()[tileIndex]->getPotency()
+				&& loaded.getMap().getTiles()[tileIndex]->getType() == map.getTiles()[tileIndex]->getType();
+		}
+
+		fmt::println("autosave on {}x{}: {} requests, {} written, {} replaced by a newer one",
+			map.getMapWidth(), map.getTileCount() / std::max(map.getMapWidth(), 1u), stats.requested, stats.written, stats.replaced);
+		fmt::println("  {:<28} {:>10.2f} us", "first snapshot (tiles)", firstSnapshotSeconds * 1e6);
+		fmt::println("  {:<28} {:>10.2f} us  (max {:.2f} us)", "snapshot (shared tiles)", totalSnapshotSeconds * 1e6 / static_cast<double>(AUTOSAVE_REQUESTS - 1), maxSnapshotSeconds * 1e6);
+		fmt::println("  {:<28} {:>10.2f} us  (max {:.2f} us, {} tiles per chunk)", "snapshot (one tile changed)", totalChangedSnapshotSeconds * 1e6 / static_cast<double>(AUTOSAVE_REQUESTS), maxChangedSnapshotSeconds * 1e6, Graph::TILE_CHUNK_SIZE);
+		fmt::println("  {:<28} {:>10.2f} ms", "background write", stats.lastWriteSeconds * 1e3);
+		fmt::println("  {:<28} {:>10.2f} ms", "blocking save() for comparison", syncSeconds * 1e3);
+
+		if (stats.failed > 0) {
+			std::cerr << "autosave failed: " << stats.lastError << std::endl;
+			return false;
+		}
+		if (stats.written + stats.replaced != stats.requested || loaded.hash() != state.hash() || !tilesMatch) {
+			std::cerr << "the autosave does not contain the last requested state" << std::endl;
+			return false;
+		}
+		if (temporaryLeft) {
+			std::cerr << "the autosave left its temporary file behind" << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+
+	// The autosave again on a LARGE_AUTOSAVE_MAP_SIZE map, unless --size is that large already
+	bool runLargeAutosave(const BenchmarkOptions& options) {
+		if (options.mapSize >= LARGE_AUTOSAVE_MAP_SIZE) return true;
+
+		WorldGeneratorConfig config;
+		config.columns = LARGE_AUTOSAVE_MAP_SIZE;
+		config.rows = LARGE_AUTOSAVE_MAP_SIZE;
+		config.seed = options.seed;
+
+		GameState state; // no registry -> headless
+		state.getMap().regenerate(config);
+		for (size_t playerId = 0; playerId < PLAYER_COUNT; playerId++) {
+			state.addPlayer(Player(playerId));
+		}
+		return runAutosave(state);
+	}
+
+
+	// Checks settlement legality for every vertex of the map, optimized and reference, and compares the results.
+	bool runSettlementPlacement(const BenchmarkOptions& options) {
+		WorldGeneratorConfig config;
+		config.columns = options.mapSize;
+		config.rows = options.mapSize;
+		config.seed = options.seed;
+
+		GameState state; // no registry -> headless
+		state.getMap().regenerate(config);
+		for (size_t playerId = 0; playerId < PLAYER_COUNT; playerId++) {
+			state.addPlayer(Player(playerId));
+		}
+		GameController controller(state);
+		const Graph& map = state.getMap();
+
+		const size_t settlementCount = placeSettlements(state, controller, options.seed);
+
+		size_t allowedLookup = 0;
+		size_t allowedReference = 0;
+		const double lookupNs = measureNanosecondsPerCheck(map, options.repetitions, allowedLookup,
+			[&](const VertexHandle vertex) { return controller.canBuildSettlement(0, vertex->getId()); });
+		const double referenceNs = measureNanosecondsPerCheck(map, options.repetitions, allowedReference,
+			[&](const VertexHandle vertex) { return isSettlementAllowedReference(map, vertex); });
+
+		fmt::println("settlement placement on {}x{} (seed {}): {} vertices, {} settlements",
+			options.mapSize, options.mapSize, options.seed, map.getVertexCount(), settlementCount);
+		fmt::println("  {:<28} {:>10.2f} ns/check  {:>8} legal", "GameController (occupancy)", lookupNs, allowedLookup);
+		fmt::println("  {:<28} {:>10.2f} ns/check  {:>8} legal", "neighbour walk (reference)", referenceNs, allowedReference);
+
+		// compare vertex by vertex, the counts alone could hide two compensating errors
+		size_t mismatches = 0;
+		for (const auto& vertex : map.getVertices()) {
+			if (controller.canBuildSettlement(0, vertex->getId()) != isSettlementAllowedReference(map, vertex)) {
+				if (mismatches < 10)
+					std::cerr << "MISMATCH vertex " << vertex->getId() << std::endl;
+				mismatches++;
+			}
+		}
+		if (mismatches > 0) {
+			std::cerr << mismatches << " vertices differ from the reference" << std::endl;
+			return false;
+		}
+
+		return runStoreLookups(options, state) && runResourceDistribution(options, state, controller)
+			&& runLegalMoves(options, state, controller) && runUndo(state, controller) && runCompactState(options, state) && runSaveGame(state)
+			&& runSaveJournal(state, controller) && runAutosave(state) && runLargeAutosave(options);
+	}
+
+
+	void printUsage() {
+		fmt::println("Usage: gameplay-benchmark [options]");
+		fmt::println("  --size <n>          map columns and rows (default: {})", DEFAULT_MAP_SIZE);
+		fmt::println("  --seed <n>          world and placement seed, not 0 (default: {})", DEFAULT_SEED);
+		fmt::println("  --repetitions <n>   passes over all vertices per measurement (default: 20)");
+		fmt::println("  --help              show this help");
+	}
+} // namespace
+
+
+int main(int argc, char** argv) {
+	BenchmarkOptions options;
+
+	for (int i = 1; i < argc; i++) {
+		const std::string_view argument = argv[i];
+		if (argument == "--size" && i + 1 < argc) {
+			options.mapSize = static_cast<unsigned>(std::stoul(argv[++i]));
+		} else if (argument == "--seed" && i + 1 < argc) {
+			options.seed = static_cast<unsigned>(std::stoul(argv[++i]));
+		} else if (argument == "--repetitions" && i + 1 < argc) {
+			options.repetitions = static_cast<unsigned>(std::stoul(argv[++i]));
+		} else if (argument == "--help" || argument == "-h") {
+			printUsage();
+			return EXIT_SUCCESS;
+		} else {
+			std::cerr << "Unknown argument: " << argument << std::endl;
+			printUsage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (options.mapSize == 0 || options.mapSize > WorldGenerator::MAX_MAP_DIMENSION || options.seed == 0 || options.repetitions == 0) {
+		std::cerr << "Invalid options" << std::endl;
+		printUsage();
+		return EXIT_FAILURE;
+	}
+
+	if (!runSettlementPlacement(options) || !runReplay(options))
+		return EXIT_FAILURE;
+
+	return EXIT_SUCCESS;
+}
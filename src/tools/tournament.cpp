@@ -0,0 +1,247 @@
+// Headless tournament runner.
+//
+// Plays many scripted games (see HeadlessSimulation) with consecutive seeds on all cores and writes one CSV row
+// per game, e.g. for balancing statistics over thousands of maps. Games share no mutable state, every worker
+// thread takes the next game index from an atomic counter and writes only its own result slot.
+
+#include "headless.h"
+#include "worldGenerator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+namespace {
+	using namespace df;
+
+	constexpr unsigned DEFAULT_GAMES = 256;
+	constexpr unsigned DEFAULT_ROUNDS = 100;
+	constexpr unsigned DEFAULT_MAP_SIZE = 100;
+	constexpr unsigned DEFAULT_SEED = 1;
+
+
+	struct TournamentOptions {
+		unsigned games = DEFAULT_GAMES;
+		unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+		unsigned rounds = DEFAULT_ROUNDS;
+		unsigned mapSize = DEFAULT_MAP_SIZE;
+		unsigned seed = DEFAULT_SEED; // game i uses seed + i
+		std::string outputPath; // empty -> stdout
+		std::optional<df::types::AiDifficulty> aiDifficulty; // player 0 is an MctsPlayer
+	};
+
+
+	std::string_view toString(const std::optional<df::types::AiDifficulty> difficulty) {
+		if (!difficulty) return "none";
+		switch (*difficulty) {
+			case df::types::AiDifficulty::EASY: return "easy";
+			case df::types::AiDifficulty::MEDIUM: return "medium";
+			case df::types::AiDifficulty::HARD: return "hard";
+		}
+		return "none";
+	}
+
+
+	struct GameResult {
+		unsigned seed = 0;
+		double seconds = 0.0; // whole game including the map generation, report.seconds only covers the turns
+		HeadlessSimulation::Report report;
+	};
+
+
+	// most settlements wins, ties go to the player with more resources
+	size_t findLeader(const HeadlessSimulation::Report& report) {
+		size_t leader = 0;
+		for (size_t playerId = 1; playerId < report.players.size(); playerId++) {
+			const auto& player = report.players[playerId];
+			const auto& best = report.players[leader];
+			if (player.settlements > best.settlements
+				|| (player.settlements == best.settlements && player.resources.getTotal() > best.resources.getTotal()))
+				leader = playerId;
+		}
+		return leader;
+	}
+
+
+	std::vector<GameResult> runTournament(const TournamentOptions& options) {
+		std::vector<GameResult> results(options.games);
+		std::atomic<size_t> nextGame = 0;
+
+		const auto worker = [&]() {
+			for (size_t game = nextGame.fetch_add(1, std::memory_order_relaxed); game < results.size();
+				 game = nextGame.fetch_add(1, std::memory_order_relaxed)) {
+				HeadlessSimulation::Config config;
+				config.rounds = options.rounds;
+				config.mapSize = options.mapSize;
+				config.seed = options.seed + static_cast<unsigned>(game);
+				config.aiDifficulty = options.aiDifficulty;
+				config.aiThreads = 1; // the games already run in parallel
+				const auto start = std::chrono::steady_clock::now();
+				HeadlessSimulation::Report report = HeadlessSimulation::run(config);
+				const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+				results[game] = { config.seed, seconds, std::move(report) };
+			}
+		};
+
+		std::vector<std::thread> threads;
+		threads.reserve(options.threads);
+		for (unsigned i = 0; i < options.threads; i++) threads.emplace_back(worker);
+		for (std::thread& thread : threads) thread.join();
+
+		return results;
+	}
+
+
+	void writeCsv(std::ostream& out, const TournamentOptions& options, const std::vector<GameResult>& results) {
+		const size_t playerCount = HeadlessSimulation::Config{}.playerCount;
+
+		out << "game,seed,rounds,map_size,ai,turns,seconds,leader";
+		for (size_t playerId = 0; playerId < playerCount; playerId++)
+			out << ",p" << playerId << "_settlements,p" << playerId << "_roads,p" << playerId << "_resources";
+		out << '\n';
+
+		for (size_t game = 0; game < results.size(); game++) {
+			const auto& [seed, seconds, report] = results[game];
+			out << game << ',' << seed << ',' << options.rounds << ',' << options.mapSize << ',' << toString(options.aiDifficulty) << ',' << report.turns << ','
+				<< seconds << ',' << findLeader(report);
+			for (const auto& player : report.players)
+				out << ',' << player.settlements << ',' << player.roads << ',' << player.resources.getTotal();
+			out << '\n';
+		}
+	}
+
+
+	// to stderr, stdout may carry the CSV
+	void printSummary(const TournamentOptions& options, const std::vector<GameResult>& results, const double wallSeconds) {
+		double gameSeconds = 0.0;
+		size_t turns = 0;
+		std::vector<size_t> wins(HeadlessSimulation::Config{}.playerCount, 0);
+		for (const auto& [seed, seconds, report] : results) {
+			gameSeconds += seconds;
+			turns += report.turns;
+			if (!report.players.empty())
+				wins[findLeader(report)]++;
+		}
+
+		fmt::println(stderr, "[Tournament] {} games x {} rounds on {} threads in {:.3f} s -> {:.1f} games/s, {:.0f} turns/s",
+			results.size(), options.rounds, options.threads, wallSeconds, static_cast<double>(results.size()) / wallSeconds,
+			static_cast<double>(turns) / wallSeconds);
+		// sum of the single game times / wall time = games in flight on average. Compare games/s between runs with
+		// different --threads for the scaling, the games only run truly in parallel if every thread has its own core.
+		fmt::println(stderr, "[Tournament] average concurrency {:.2f} (threads {})", gameSeconds / wallSeconds, options.threads);
+		for (size_t playerId = 0; playerId < wins.size(); playerId++)
+			fmt::println(stderr, "[Tournament] player {} leads {} games", playerId, wins[playerId]);
+	}
+
+
+	// the whole text has to be a number in range, std::stoul would throw or silently truncate to unsigned
+	bool parseNumber(const char* text, unsigned& value) noexcept {
+		const char* end = text + std::strlen(text);
+		unsigned parsed = 0;
+		const auto [ptr, error] = std::from_chars(text, end, parsed);
+		if (error != std::errc() || ptr != end) return false;
+		value = parsed;
+		return true;
+	}
+
+
+	void printUsage() {
+		fmt::println("Usage: tournament [options]");
+		fmt::println("  --games <n>     number of games (default: {})", DEFAULT_GAMES);
+		fmt::println("  --threads <n>   worker threads (default: hardware concurrency)");
+		fmt::println("  --rounds <n>    rounds per game (default: {})", DEFAULT_ROUNDS);
+		fmt::println("  --size <n>      map columns and rows (default: {})", DEFAULT_MAP_SIZE);
+		fmt::println("  --seed <n>      seed of the first game, not 0 (default: {})", DEFAULT_SEED);
+		fmt::println("  --out <path>    CSV file (default: stdout)");
+		fmt::println("  --ai <level>    player 0 is a computer player: easy, medium or hard (default: scripted)");
+		fmt::println("  --help          show this help");
+	}
+} // namespace
+
+
+int main(int argc, char** argv) {
+	TournamentOptions options;
+
+	for (int i = 1; i < argc; i++) {
+		const std::string_view argument = argv[i];
+		bool parsed = true;
+		if (argument == "--games" && i + 1 < argc) {
+			parsed = parseNumber(argv[++i], options.games);
+		} else if (argument == "--threads" && i + 1 < argc) {
+			parsed = parseNumber(argv[++i], options.threads);
+		} else if (argument == "--rounds" && i + 1 < argc) {
+			parsed = parseNumber(argv[++i], options.rounds);
+		} else if (argument == "--size" && i + 1 < argc) {
+			parsed = parseNumber(argv[++i], options.mapSize);
+		} else if (argument == "--seed" && i + 1 < argc) {
+			parsed = parseNumber(argv[++i], options.seed);
+		} else if (argument == "--out" && i + 1 < argc) {
+			options.outputPath = argv[++i];
+		} else if (argument == "--ai" && i + 1 < argc) {
+			const std::string_view level = argv[++i];
+			if (level == "easy") options.aiDifficulty = df::types::AiDifficulty::EASY;
+			else if (level == "medium") options.aiDifficulty = df::types::AiDifficulty::MEDIUM;
+			else if (level == "hard") options.aiDifficulty = df::types::AiDifficulty::HARD;
+			else {
+				std::cerr << "Unknown AI level: " << level << std::endl;
+				printUsage();
+				return EXIT_FAILURE;
+			}
+		} else if (argument == "--help" || argument == "-h") {
+			printUsage();
+			return EXIT_SUCCESS;
+		} else {
+			std::cerr << "Unknown argument: " << argument << std::endl;
+			printUsage();
+			return EXIT_FAILURE;
+		}
+
+		if (!parsed) {
+			std::cerr << "Invalid number for " << argument << ": " << argv[i] << std::endl;
+			printUsage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	// seed 0 means "random" to the world generator, so the seed range must not wrap around
+	const bool seedsValid = options.seed != 0 && options.seed <= std::numeric_limits<unsigned>::max() - options.games;
+	if (options.games == 0 || options.threads == 0 || options.rounds == 0 || !seedsValid
+		|| options.mapSize == 0 || options.mapSize > WorldGenerator::MAX_MAP_DIMENSION) {
+		std::cerr << "Invalid options" << std::endl;
+		printUsage();
+		return EXIT_FAILURE;
+	}
+	options.threads = std::min(options.threads, options.games);
+
+	const auto start = std::chrono::steady_clock::now();
+	const std::vector<GameResult> results = runTournament(options);
+	const double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	if (options.outputPath.empty()) {
+		writeCsv(std::cout, options, results);
+	} else {
+		std::ofstream file(options.outputPath);
+		if (!file) {
+			std::cerr << "Could not open " << options.outputPath << std::endl;
+			return EXIT_FAILURE;
+		}
+		writeCsv(file, options, results);
+	}
+	printSummary(options, results, wallSeconds);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,300 @@
+// Headless world generation benchmark and regression check.
+//
+// Runs WorldGenerator::generateTiles and Graph::regenerate over a grid of generation modes, map sizes and seeds,
+// reports throughput and peak memory and computes a stable hash of the generated maps per configuration.
+// With --verify the hashes are compared against the checked in golden file, so changes to the noise or
+// topology code that alter the generated maps don't go unnoticed.
+
+#include "common.h"
+#include "graph.h"
+#include "worldGenerator.h"
+#include "worldGeneratorConfig.h"
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string_view>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+
+namespace {
+	using namespace df;
+
+	struct BenchmarkMode {
+		const char* name;
+		WorldGeneratorConfig::GenerationMode generationMode;
+		bool useWhittakerBiomes;
+	};
+
+	constexpr std::array<BenchmarkMode, 3> MODES = {{
+		{ "insular", WorldGeneratorConfig::GenerationMode::INSULAR, false },
+		{ "perlin", WorldGeneratorConfig::GenerationMode::PERLIN, false },
+		{ "whittaker", WorldGeneratorConfig::GenerationMode::PERLIN, true },
+	}};
+	// seed 0 means "random", so only non-zero seeds here
+	constexpr std::array<unsigned, 3> SEEDS = { 1, 42, 1337 };
+	constexpr std::array<unsigned, 4> SIZES = { 24, 100, 250, WorldGenerator::MAX_MAP_DIMENSION };
+	constexpr std::array<unsigned, 2> QUICK_SIZES = { 24, 100 };
+
+
+	struct BenchmarkResult {
+		std::string key; // mode/columns x rows/seed, also the key in the golden file
+		size_t tileCount = 0;
+		double generateSeconds = 0.0;
+		double regenerateSeconds = 0.0;
+		size_t peakMemoryKiB = 0;
+		uint64_t tileHash = 0;
+		uint64_t topologyHash = 0;
+	};
+
+
+	// FNV-1a, 64 bit. Fed with fixed width integers only, so the hash does not depend on the platform.
+	class Fnv1a {
+	  public:
+		void add(const uint64_t value) {
+			for (unsigned byte = 0; byte < 8; byte++) {
+				this->hash ^= (value >> (byte * 8)) & 0xff;
+				this->hash *= 0x100000001b3ull;
+			}
+		}
+		uint64_t get() const { return this->hash; }
+
+	  private:
+		uint64_t hash = 0xcbf29ce484222325ull;
+	};
+
+
+	// Peak resident set size of the whole process so far. It never shrinks, so the value
+	// printed after a configuration is the maximum over it and everything that ran before.
+	size_t getPeakMemoryKiB() {
+#if defined(_WIN32)
+		PROCESS_MEMORY_COUNTERS counters;
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+			return counters.PeakWorkingSetSize / 1024;
+		}
+		return 0;
+#elif defined(__APPLE__)
+		struct rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+		return static_cast<size_t>(usage.ru_maxrss) / 1024; // bytes on macOS
+#elif defined(__unix__)
+		struct rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+		return static_cast<size_t>(usage.ru_maxrss); // KiB on Linux
+#else
+		return 0;
+#endif
+	}
+
+
+	uint64_t hashTileTypes(const std::vector<Tile>& tiles, const WorldGeneratorConfig& config) {
+		Fnv1a hash;
+		hash.add(config.columns);
+		hash.add(config.rows);
+		for (const Tile& tile : tiles) {
+			hash.add(tile.getId());
+			hash.add(static_cast<uint64_t>(tile.getType()));
+		}
+		return hash.get();
+	}
+
+
+	// Covers the ids handed out by Graph::populate and the tile -> vertex/edge adjacency.
+	uint64_t hashTopology(const Graph& map) {
+		Fnv1a hash;
+		hash.add(map.getTileCount());
+		hash.add(map.getVertexCount());
+		hash.add(map.getEdgeCount());
+		for (const auto& tile : map.getTiles()) {
+			hash.add(tile->getId());
+			hash.add(static_cast<uint64_t>(tile->getType()));
+			if (const auto vertices = map.getTileVertices(tile)) {
+				for (const VertexHandle vertex : *vertices) hash.add(vertex ? vertex->getId() : UINT64_MAX);
+			}
+			if (const auto edges = map.getTileEdges(tile)) {
+				for (const EdgeHandle edge : *edges) hash.add(edge ? edge->getId() : UINT64_MAX);
+			}
+		}
+		return hash.get();
+	}
+
+
+	std::optional<BenchmarkResult> runConfiguration(const BenchmarkMode& mode, const unsigned size, const unsigned seed) {
+		using clock = std::chrono::steady_clock;
+
+		WorldGeneratorConfig config;
+		config.columns = size;
+		config.rows = size;
+		config.seed = seed;
+		config.generationMode = mode.generationMode;
+		config.useWhittakerBiomes = mode.useWhittakerBiomes;
+
+		BenchmarkResult result;
+		result.key = fmt::format("{}/{}x{}/{}", mode.name, config.columns, config.rows, config.seed);
+
+		const auto generateStart = clock::now();
+		const Result<std::vector<Tile>, ResultError> tiles = WorldGenerator::generateTiles(config);
+		result.generateSeconds = std::chrono::duration<double>(clock::now() - generateStart).count();
+		if (tiles.isErr()) {
+			std::cerr << result.key << ": " << tiles.unwrapErr() << std::endl;
+			return std::nullopt;
+		}
+		const std::vector<Tile> generatedTiles = tiles.unwrap();
+		result.tileCount = generatedTiles.size();
+		result.tileHash = hashTileTypes(generatedTiles, config);
+
+		Graph map;
+		const auto regenerateStart = clock::now();
+		map.regenerate(config);
+		result.regenerateSeconds = std::chrono::duration<double>(clock::now() - regenerateStart).count();
+		result.topologyHash = hashTopology(map);
+		result.peakMemoryKiB = getPeakMemoryKiB();
+
+		return result;
+	}
+
+
+	// One configuration per line: "<key> <tile hash> <topology hash>", '#' starts a comment.
+	std::unordered_map<std::string, std::pair<uint64_t, uint64_t>> readGoldenFile(const std::filesystem::path& path) {
+		std::unordered_map<std::string, std::pair<uint64_t, uint64_t>> golden;
+		std::ifstream file(path);
+		std::string line;
+		while (std::getline(file, line)) {
+			if (line.empty() || line.front() == '#') continue;
+			std::istringstream stream(line);
+			std::string key;
+			uint64_t tileHash = 0;
+			uint64_t topologyHash = 0;
+			if (stream >> key >> std::hex >> tileHash >> topologyHash) {
+				golden[key] = { tileHash, topologyHash };
+			}
+		}
+		return golden;
+	}
+
+
+	bool writeGoldenFile(const std::filesystem::path& path, const std::vector<BenchmarkResult>& results) {
+		std::ofstream file(path);
+		if (!file) return false;
+		file << "# Golden hashes of the generated maps, see src/tools/worldGenBenchmark.cpp.\n";
+		file << "# Regenerate with `worldgen-benchmark --update` ONLY if a change of the generated maps is intended.\n";
+		file << "# The perlin mode draws from std::uniform_int_distribution, which is implementation defined -> recorded with libstdc++.\n";
+		file << "# <mode>/<columns>x<rows>/<seed> <tile type hash> <topology hash>\n";
+		for (const BenchmarkResult& result : results) {
+			file << fmt::format("{} {:016x} {:016x}\n", result.key, result.tileHash, result.topologyHash);
+		}
+		return static_cast<bool>(file);
+	}
+
+
+	void printUsage() {
+		fmt::println("Usage: worldgen-benchmark [options]");
+		fmt::println("  --verify          compare the map hashes against the golden file, fail on mismatch");
+		fmt::println("  --update          write the map hashes to the golden file");
+		fmt::println("  --golden <file>   golden file to use (default: <base path>/test/worldGenGolden.txt)");
+		fmt::println("  --quick           only run the small map sizes");
+		fmt::println("  --help            show this help");
+	}
+} // namespace
+
+
+int main(int argc, char** argv) {
+	bool verify = false;
+	bool update = false;
+	bool quick = false;
+	std::filesystem::path goldenPath = std::filesystem::path(df::getBasePath()) / "test" / "worldGenGolden.txt";
+
+	for (int i = 1; i < argc; i++) {
+		const std::string_view argument = argv[i];
+		if (argument == "--verify") {
+			verify = true;
+		} else if (argument == "--update") {
+			update = true;
+		} else if (argument == "--quick") {
+			quick = true;
+		} else if (argument == "--golden" && i + 1 < argc) {
+			goldenPath = argv[++i];
+		} else if (argument == "--help" || argument == "-h") {
+			printUsage();
+			return EXIT_SUCCESS;
+		} else {
+			std::cerr << "Unknown argument: " << argument << std::endl;
+			printUsage();
+			return EXIT_FAILURE;
+		}
+	}
+
+	std::vector<unsigned> sizes(SIZES.begin(), SIZES.end());
+	if (quick) sizes.assign(QUICK_SIZES.begin(), QUICK_SIZES.end());
+
+	fmt::println("{:<26} {:>9} {:>12} {:>14} {:>12} {:>14} {:>10}  {:<16} {:<16}",
+		"configuration", "tiles", "generate ms", "tiles/s", "regen ms", "tiles/s", "peak MiB", "tile hash", "topology hash");
+
+	std::vector<BenchmarkResult> results;
+	for (const BenchmarkMode& mode : MODES) {
+		for (const unsigned size : sizes) {
+			for (const unsigned seed : SEEDS) {
+				std::optional<BenchmarkResult> result = runConfiguration(mode, size, seed);
+				if (!result) return EXIT_FAILURE;
+
+				fmt::println("{:<26} {:>9} {:>12.2f} {:>14.0f} {:>12.2f} {:>14.0f} {:>10.1f}  {:016x} {:016x}",
+					result->key,
+					result->tileCount,
+					result->generateSeconds * 1000.0,
+					static_cast<double>(result->tileCount) / result->generateSeconds,
+					result->regenerateSeconds * 1000.0,
+					static_cast<double>(result->tileCount) / result->regenerateSeconds,
+					static_cast<double>(result->peakMemoryKiB) / 1024.0,
+					result->tileHash,
+					result->topologyHash);
+				results.push_back(std::move(*result));
+			}
+		}
+	}
+
+	if (update) {
+		if (!writeGoldenFile(goldenPath, results)) {
+			std::cerr << "Could not write golden file " << goldenPath << std::endl;
+			return EXIT_FAILURE;
+		}
+		fmt::println("Wrote {} golden hashes to {}", results.size(), goldenPath.string());
+	}
+
+	if (verify) {
+		const auto golden = readGoldenFile(goldenPath);
+		if (golden.empty()) {
+			std::cerr << "No golden hashes found in " << goldenPath << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		size_t mismatches = 0;
+		for (const BenchmarkResult& result : results) {
+			const auto expected = golden.find(result.key);
+			if (expected == golden.end()) {
+				std::cerr << "MISSING  " << result.key << " has no golden hash" << std::endl;
+				mismatches++;
+			} else if (expected->second.first != result.tileHash || expected->second.second != result.topologyHash) {
+				std::cerr << fmt::format("MISMATCH {} expected {:016x} {:016x}, got {:016x} {:016x}",
+					result.key, expected->second.first, expected->second.second, result.tileHash, result.topologyHash) << std::endl;
+				mismatches++;
+			}
+		}
+
+		if (mismatches > 0) {
+			std::cerr << mismatches << " of " << results.size() << " configurations differ from " << goldenPath << std::endl;
+			return EXIT_FAILURE;
+		}
+		fmt::println("All {} configurations match the golden hashes.", results.size());
+	}
+
+	return EXIT_SUCCESS;
+}
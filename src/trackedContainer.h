@@ -0,0 +1,133 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "indexedContainer.h"
+
+/*
+ * An IndexedContainer that logs which entities got a component added, modified or removed, stamped with the registry's
+ * frame version (Registry::getVersion(), advanced once per frame by Registry::nextFrame()). A system remembers the
+ * version it last ran at and asks for the changes since then instead of walking every entity:
+ *
+ *     const std::uint64_t since = this->lastVersion;
+ *     this->lastVersion = registry->getVersion();
+ *     if (!registry->positions.isTrackedSince(since)) { ...rebuild everything... }
+ *     else for (const auto& change : registry->positions.getChangesSince(since)) { ...update change.entity... }
+ *
+ * Changes made in the frame a system ran are reported to it again the next time (same version), so updates have to be
+ * idempotent. get() and find() only read, components that change after they were added are written through modify()
+ * (or markModified() after writing through a view()).
+*/
+
+namespace df {
+	enum class ComponentChange : std::uint8_t {
+		ADDED,
+		MODIFIED,
+		REMOVED,
+	};
+
+
+	template<typename Component>
+	class TrackedContainer : public IndexedContainer<Component> {
+		using Base = IndexedContainer<Component>;
+
+	public:
+		struct Change {
+			Entity entity;
+			ComponentChange type;
+			std::uint64_t version;
+		};
+
+		// frameVersion: what the changes are stamped with, has to outlive the container
+		explicit TrackedContainer(const std::uint64_t& frameVersion) : version(&frameVersion), trackedSince(frameVersion) {}
+
+		Component& insert(Entity entity, Component component, bool checkForDuplicates = true) {
+			Component& inserted = Base::insert(entity, std::move(component), checkForDuplicates);
+			this->record(entity, ComponentChange::ADDED);
+			return inserted;
+		}
+
+		template<typename... Arguments>
+		Component& emplace(Entity entity, Arguments&&... arguments) {
+			return this->insert(entity, Component(std::forward<Arguments>(arguments)...));
+		}
+
+		template<typename... Arguments>
+		Component& emplace_with_duplicates(Entity entity, Arguments&&... arguments) {
+			return this->insert(entity, Component(std::forward<Arguments>(arguments)...), false);
+		}
+
+		// hide the writable ones of IndexedContainer, a write through them would not be logged
+		const Component& get(Entity entity) { return Base::get(entity); }
+		const Component* find(Entity entity) { return Base::find(entity); }
+
+		// get() for writing
+		Component& modify(Entity entity) {
+			this->markModified(entity);
+			return Base::get(entity);
+		}
+
+		// logged once per entity and frame
+		void markModified(Entity entity) {
+			const size_t id = static_cast<unsigned int>(entity);
+			if (id >= this->modifiedVersions.size()) {
+				this->modifiedVersions.resize(id + 1, 0);
+			}
+			if (this->modifiedVersions[id] == *this->version) return;
+
+			this->modifiedVersions[id] = *this->version;
+			this->record(entity, ComponentChange::MODIFIED);
+		}
+
+		void remove(Entity entity) override {
+			if (!this->has(entity)) return;
+			Base::remove(entity);
+			this->record(entity, ComponentChange::REMOVED);
+		}
+
+		void clear() override {
+			for (Entity entity : this->entities) {
+				this->record(entity, ComponentChange::REMOVED);
+			}
+			Base::clear();
+		}
+
+
+		// Oldest first, an entity can appear more than once (added, then modified, ...). Check has() for what is left.
+		std::span<const Change> getChangesSince(const std::uint64_t since) const {
+			const auto first = std::lower_bound(this->changes.begin(), this->changes.end(), since,
+				[](const Change& change, const std::uint64_t version) { return change.version < version; });
+			return { first, this->changes.end() };
+		}
+
+		bool hasChangedSince(const std::uint64_t since) const {
+			return !this->changes.empty() && this->changes.back().version >= since;
+		}
+
+		// false if changes since then were already forgotten (or since = 0, never ran), the caller has to start over
+		bool isTrackedSince(const std::uint64_t since) const { return since >= this->trackedSince; }
+
+		// Registry::nextFrame() keeps a limited history
+		void forgetChangesBefore(const std::uint64_t before) {
+			if (before <= this->trackedSince) return;
+
+			this->changes.erase(this->changes.begin(), std::lower_bound(this->changes.begin(), this->changes.end(), before,
+				[](const Change& change, const std::uint64_t version) { return change.version < version; }));
+			this->trackedSince = before;
+		}
+
+	private:
+		const std::uint64_t* version;
+		std::uint64_t trackedSince; // changes from this version on are all in the log
+
+		std::vector<Change> changes; // by version
+		std::vector<std::uint64_t> modifiedVersions; // by entity id, last version a MODIFIED was logged
+
+		void record(Entity entity, const ComponentChange type) {
+			this->changes.push_back({ entity, type, *this->version });
+		}
+	};
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+
+
+
+
+namespace df {
+
+	// Dense set of flags, e.g. one per vertex of the map, packed into 64 bit words.
+	// Consumers can iterate the words and skip 64 unset flags at once instead of testing every bit.
+	class BitMask {
+	  public:
+		BitMask() = default;
+		explicit BitMask(size_t size) { this->reset(size); }
+
+		// resize and clear all bits
+		void reset(size_t newSize) {
+			this->bitCount = newSize;
+			this->words.assign((newSize + 63) / 64, 0);
+		}
+
+		size_t getSize() const { return this->bitCount; }
+
+		bool test(size_t index) const {
+			return index < this->bitCount && (this->words[index / 64] >> (index % 64)) & 1u;
+		}
+
+		void set(size_t index, bool value = true) {
+			if (index >= this->bitCount)
+				return;
+
+			const std::uint64_t bit = std::uint64_t{1} << (index % 64);
+			if (value)
+				this->words[index / 64] |= bit;
+			else
+				this->words[index / 64] &= ~bit;
+		}
+
+		size_t countSet() const {
+			size_t count = 0;
+			for (const std::uint64_t word : this->words) count += static_cast<size_t>(std::popcount(word));
+			return count;
+		}
+
+		// calls f(index) for every set bit, in ascending order
+		template <typename F>
+		void forEachSet(F&& f) const {
+			for (size_t wordIndex = 0; wordIndex < this->words.size(); wordIndex++) {
+				std::uint64_t word = this->words[wordIndex];
+				while (word) {
+					f(wordIndex * 64 + static_cast<size_t>(std::countr_zero(word)));
+					word &= word - 1;
+				}
+			}
+		}
+
+		// bits above getSize() in the last word are always 0
+		std::span<const std::uint64_t> getWords() const { return this->words; }
+
+	  private:
+		std::vector<std::uint64_t> words;
+		size_t bitCount = 0;
+	};
+
+} // namespace df
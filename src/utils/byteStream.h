@@ -0,0 +1,138 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+
+
+
+namespace df {
+
+	// Appends little endian integers, LEB128 varints (small ids and counts take one byte) and raw bytes.
+	// Used by the binary file formats (replays, save games).
+	class ByteWriter {
+	  public:
+		explicit ByteWriter(std::vector<std::uint8_t>& bytes) : bytes(bytes) {}
+
+		void writeByte(std::uint8_t value) { this->bytes.push_back(value); }
+
+		void writeFixed(std::uint64_t value, size_t byteCount) {
+			for (size_t i = 0; i < byteCount; ++i)
+				this->bytes.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+		}
+
+		void writeVarint(std::uint64_t value) {
+			while (value >= 0x80) {
+				this->bytes.push_back(static_cast<std::uint8_t>(value | 0x80));
+				value >>= 7;
+			}
+			this->bytes.push_back(static_cast<std::uint8_t>(value));
+		}
+
+		// zigzag -> small negative numbers stay small
+		void writeSigned(std::int64_t value) {
+			this->writeVarint((static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+		}
+
+		void writeFloat(float value) { this->writeFixed(std::bit_cast<std::uint32_t>(value), 4); }
+
+		void writeBytes(std::span<const std::uint8_t> data) { this->bytes.insert(this->bytes.end(), data.begin(), data.end()); }
+
+		// varint length + characters
+		void writeString(std::string_view text) {
+			this->writeVarint(text.size());
+			this->bytes.insert(this->bytes.end(), text.begin(), text.end());
+		}
+
+	  private:
+		std::vector<std::uint8_t>& bytes;
+	};
+
+
+	// Counterpart of ByteWriter with bounds checks: after the first out of range or malformed read every read
+	// returns 0 (or empty) and isOk() stays false, so a decoder can check once at the end.
+	class ByteReader {
+	  public:
+		explicit ByteReader(std::span<const std::uint8_t> bytes) : bytes(bytes) {}
+
+		bool isOk() const { return this->ok; }
+		bool atEnd() const { return this->position >= this->bytes.size(); }
+		size_t getRemaining() const { return this->bytes.size() - this->position; }
+		void fail() {
+			this->ok = false;
+			this->position = this->bytes.size();
+		}
+
+		std::uint8_t readByte() {
+			if (this->atEnd()) {
+				this->fail();
+				return 0;
+			}
+			return this->bytes[this->position++];
+		}
+
+		std::uint64_t readFixed(size_t byteCount) {
+			std::uint64_t value = 0;
+			for (size_t i = 0; i < byteCount; ++i)
+				value |= static_cast<std::uint64_t>(this->readByte()) << (8 * i);
+			return value;
+		}
+
+		std::uint64_t readVarint() {
+			std::uint64_t value = 0;
+			for (unsigned shift = 0; shift < 64; shift += 7) {
+				const std::uint8_t byte = this->readByte();
+				value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+				if ((byte & 0x80) == 0)
+					return value;
+			}
+			this->fail(); // more than 10 bytes
+			return 0;
+		}
+
+		std::int64_t readSigned() {
+			const std::uint64_t value = this->readVarint();
+			return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+		}
+
+		float readFloat() { return std::bit_cast<float>(static_cast<std::uint32_t>(this->readFixed(4))); }
+
+		std::span<const std::uint8_t> readBytes(size_t count) {
+			if (count > this->getRemaining()) {
+				this->fail();
+				return {};
+			}
+			const std::span<const std::uint8_t> result = this->bytes.subspan(this->position, count);
+			this->position += count;
+			return result;
+		}
+
+		std::string readString() {
+			const std::span<const std::uint8_t> characters = this->readBytes(this->readVarint());
+			return std::string(characters.begin(), characters.end());
+		}
+
+		// a count of elements that need at least minimumBytes each -> rejects corrupt counts before any allocation
+		size_t readCount(size_t minimumBytes = 1) {
+			const std::uint64_t count = this->readVarint();
+			if (count > this->getRemaining() / std::max<size_t>(minimumBytes, 1)) {
+				this->fail();
+				return 0;
+			}
+			return static_cast<size_t>(count);
+		}
+
+	  private:
+		std::span<const std::uint8_t> bytes;
+		size_t position = 0;
+		bool ok = true;
+	};
+
+} // namespace df
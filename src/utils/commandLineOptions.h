@@ -1,6 +1,10 @@
 #pragma once
 
+#include <charconv>
 #include <common.h>
+#include <cstring>
+#include <string>
+#include <core/types.h>
 
 
 
@@ -10,6 +14,14 @@ namespace df {
 			enum struct Flags : size_t {
 				HELP = 0,
 				X11,
+				BENCHMARK_MAP_SCALING,
+				HEADLESS,
+				ROUNDS,
+				SEED,
+				AI,
+				RECORD,
+				REPLAY,
+				LOG,
 				count
 			};
 
@@ -28,6 +40,14 @@ namespace df {
 			static constexpr std::array<Flag, static_cast<size_t>(Flags::count)> FLAGS = {
 				Flag{ "--help", "-h", "Show this message." },
 				Flag{ "--X11", std::nullopt, "Force the game to use X11 for windowing. Only available on Linux." },
+				Flag{ "--benchmark-map-scaling", std::nullopt, "Measure generate, populate, regenerate (both) and first-frame times for growing map sizes against the 1 s target, then exit." },
+				Flag{ "--headless", std::nullopt, "Simulate a game with scripted players without window, audio or rendering, report turns/s, then exit." },
+				Flag{ "--rounds", std::nullopt, "<n> Number of rounds to simulate with --headless (default: 100)." },
+				Flag{ "--seed", std::nullopt, "<n> Map seed for --headless, not 0 (default: 42)." },
+				Flag{ "--ai", std::nullopt, "<easy|medium|hard> Player 0 of --headless is a computer player (Monte-Carlo tree search)." },
+				Flag{ "--record", std::nullopt, "<file> Record the --headless game as a binary replay." },
+				Flag{ "--replay", std::nullopt, "<file> Play a recorded replay as fast as possible, check the game state hash every turn, report turns/s, then exit." },
+				Flag{ "--log", std::nullopt, "<levels> Log levels: <level> or <module>=<level>,... e.g. graph=debug,events=trace (trace and debug only in debug builds)." },
 			};
 
 
@@ -57,6 +77,62 @@ namespace df {
 								break;
 							#endif
 
+							case Flags::BENCHMARK_MAP_SCALING:
+								options.benchmarkMapScaling = true;
+								break;
+
+							case Flags::HEADLESS:
+								options.headless = true;
+								break;
+
+							case Flags::ROUNDS:
+								if (i + 1 < argc && parseNumber(argv[i + 1], options.rounds))
+									++i;
+								else
+									fmt::println(stderr, "\"{}\" expects a number. See --help.", FLAGS[j].longName);
+								break;
+
+							case Flags::SEED: {
+								unsigned seed = 0;
+								if (i + 1 < argc && parseNumber(argv[i + 1], seed) && seed != 0) {
+									options.seed = seed;
+									++i;
+								} else {
+									fmt::println(stderr, "\"{}\" expects a number other than 0. See --help.", FLAGS[j].longName);
+								}
+								break;
+							}
+
+							case Flags::AI: {
+								const std::string_view level = i + 1 < argc ? std::string_view(argv[i + 1]) : std::string_view();
+								if (level == "easy") options.aiDifficulty = types::AiDifficulty::EASY;
+								else if (level == "medium") options.aiDifficulty = types::AiDifficulty::MEDIUM;
+								else if (level == "hard") options.aiDifficulty = types::AiDifficulty::HARD;
+								else {
+									fmt::println(stderr, "\"{}\" expects easy, medium or hard. See --help.", FLAGS[j].longName);
+									break;
+								}
+								++i;
+								break;
+							}
+
+							case Flags::RECORD:
+							case Flags::REPLAY:
+								if (i + 1 < argc) {
+									(flag == Flags::RECORD ? options.recordPath : options.replayPath) = argv[++i];
+								} else {
+									fmt::println(stderr, "\"{}\" expects a file name. See --help.", FLAGS[j].longName);
+								}
+								break;
+
+							case Flags::LOG:
+								if (i + 1 < argc) {
+									options.logLevels = argv[++i];
+								} else {
+									fmt::println(stderr, "\"{}\" expects log levels. See --help.", FLAGS[j].longName);
+								}
+								break;
+
 							case Flags::count:
 							default:
 								if (FLAGS[j].shortName)
@@ -74,10 +150,36 @@ namespace df {
 
 			inline bool hasHelp() const noexcept { return help; }
 			inline bool hasX11() const noexcept { return x11; }
+			inline bool hasBenchmarkMapScaling() const noexcept { return benchmarkMapScaling; }
+			inline bool hasHeadless() const noexcept { return headless; }
+			inline size_t getRounds() const noexcept { return rounds; }
+			inline unsigned getSeed() const noexcept { return seed; }
+			inline std::optional<types::AiDifficulty> getAiDifficulty() const noexcept { return aiDifficulty; }
+			inline const std::optional<std::string>& getRecordPath() const noexcept { return recordPath; }
+			inline const std::optional<std::string>& getReplayPath() const noexcept { return replayPath; }
+			inline const std::optional<std::string>& getLogLevels() const noexcept { return logLevels; }
 
 
 		private:
 			bool help = false;
 			bool x11 = false;
+			bool benchmarkMapScaling = false;
+			bool headless = false;
+			size_t rounds = 100;
+			unsigned seed = 42;
+			std::optional<types::AiDifficulty> aiDifficulty;
+			std::optional<std::string> recordPath;
+			std::optional<std::string> replayPath;
+			std::optional<std::string> logLevels;
+
+			template <typename T>
+			static bool parseNumber(const char* text, T& value) noexcept {
+				const char* end = text + std::strlen(text);
+				T parsed{};
+				const auto [ptr, error] = std::from_chars(text, end, parsed);
+				if (error != std::errc() || ptr != end) return false;
+				value = parsed;
+				return true;
+			}
 	};
 }
@@ -0,0 +1,168 @@
+#include "compression.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+
+
+namespace df::compression {
+
+	namespace {
+		constexpr size_t MIN_MATCH = 4;
+		constexpr size_t MAX_OFFSET = 65535;
+		constexpr unsigned HASH_BITS = 14;
+		// the last bytes are always literals, so the match search can read 4 bytes without bounds checks
+		constexpr size_t TAIL_LITERALS = 5;
+		// no input byte decodes to more output than this (a 255 length byte adds 255 bytes to a match)
+		constexpr size_t MAX_EXPANSION = 255;
+
+
+		std::uint32_t read32(const std::uint8_t* data) {
+			std::uint32_t value;
+			std::memcpy(&value, data, sizeof(value));
+			return value;
+		}
+
+		std::uint32_t hashOf(std::uint32_t prefix) {
+			return (prefix * 2654435761u) >> (32 - HASH_BITS);
+		}
+
+		// 4 bit length in the token, 15 = more length bytes follow, 255 = more after this one
+		void writeLength(std::vector<std::uint8_t>& output, size_t length) {
+			for (; length >= 255; length -= 255)
+				output.push_back(255);
+			output.push_back(static_cast<std::uint8_t>(length));
+		}
+
+		void writeSequence(std::vector<std::uint8_t>& output, std::span<const std::uint8_t> literals, size_t offset, size_t matchLength) {
+			const size_t matchCode = matchLength > 0 ? matchLength - MIN_MATCH : 0;
+			output.push_back(static_cast<std::uint8_t>((std::min<size_t>(literals.size(), 15) << 4) | std::min<size_t>(matchCode, 15)));
+			if (literals.size() >= 15)
+				writeLength(output, literals.size() - 15);
+			output.insert(output.end(), literals.begin(), literals.end());
+
+			if (matchLength == 0)
+				return; // last sequence
+			output.push_back(static_cast<std::uint8_t>(offset));
+			output.push_back(static_cast<std::uint8_t>(offset >> 8));
+			if (matchCode >= 15)
+				writeLength(output, matchCode - 15);
+		}
+
+		constexpr std::array<std::uint32_t, 256> makeCrcTable() {
+			std::array<std::uint32_t, 256> table{};
+			for (std::uint32_t i = 0; i < 256; ++i) {
+				std::uint32_t value = i;
+				for (int bit = 0; bit < 8; ++bit)
+					value = (value & 1) ? (value >> 1) ^ 0xedb88320u : value >> 1;
+				table[i] = value;
+			}
+			return table;
+		}
+
+		constexpr std::array<std::uint32_t, 256> CRC_TABLE = makeCrcTable();
+	}
+
+
+	std::vector<std::uint8_t> compress(std::span<const std::uint8_t> input) {
+		std::vector<std::uint8_t> output;
+		output.reserve(input.size() / 2 + 16);
+
+		// position + 1 of the last occurrence of a 4 byte prefix, 0 = none
+		std::vector<std::uint32_t> table(size_t{1} << HASH_BITS, 0);
+		const std::uint8_t* data = input.data();
+		size_t anchor = 0; // start of the pending literals
+		size_t position = 0;
+
+		if (input.size() > TAIL_LITERALS + MIN_MATCH) {
+			const size_t searchEnd = input.size() - TAIL_LITERALS;
+			while (position < searchEnd) {
+				const std::uint32_t prefix = read32(data + position);
+				std::uint32_t& slot = table[hashOf(prefix)];
+				const size_t candidate = slot;
+				slot = static_cast<std::uint32_t>(position + 1);
+
+				if (candidate == 0 || position - (candidate - 1) > MAX_OFFSET || read32(data + candidate - 1) != prefix) {
+					position++;
+					continue;
+				}
+
+				const size_t matchStart = candidate - 1;
+				size_t length = MIN_MATCH;
+				while (position + length < searchEnd && data[matchStart + length] == data[position + length])
+					length++;
+
+				writeSequence(output, input.subspan(anchor, position - anchor), position - matchStart, length);
+				position += length;
+				anchor = position;
+			}
+		}
+
+		writeSequence(output, input.subspan(anchor), 0, 0);
+		return output;
+	}
+
+
+	std::optional<std::vector<std::uint8_t>> decompress(std::span<const std::uint8_t> input, size_t size) {
+		// a damaged size in a file header must not reserve more than the input could ever decode to
+		if (size / MAX_EXPANSION > input.size())
+			return std::nullopt;
+
+		std::vector<std::uint8_t> output;
+		output.reserve(size);
+		size_t position = 0;
+
+		const auto readLength = [&](size_t length) -> std::optional<size_t> {
+			if (length < 15)
+				return length;
+			std::uint8_t byte = 255;
+			while (byte == 255) {
+				if (position >= input.size())
+					return std::nullopt;
+				byte = input[position++];
+				length += byte;
+			}
+			return length;
+		};
+
+		while (position < input.size()) {
+			const std::uint8_t token = input[position++];
+
+			const std::optional<size_t> literalLength = readLength(token >> 4);
+			if (!literalLength || *literalLength > input.size() - position || *literalLength > size - output.size())
+				return std::nullopt;
+			output.insert(output.end(), input.begin() + static_cast<std::ptrdiff_t>(position), input.begin() + static_cast<std::ptrdiff_t>(position + *literalLength));
+			position += *literalLength;
+
+			if (position == input.size())
+				break; // last sequence has no match
+
+			if (input.size() - position < 2)
+				return std::nullopt;
+			const size_t offset = input[position] | (static_cast<size_t>(input[position + 1]) << 8);
+			position += 2;
+			const std::optional<size_t> matchCode = readLength(token & 15);
+			if (!matchCode || offset == 0 || offset > output.size() || *matchCode + MIN_MATCH > size - output.size())
+				return std::nullopt;
+
+			// byte by byte: the match may overlap the bytes it produces (runs)
+			const size_t matchStart = output.size() - offset;
+			for (size_t i = 0; i < *matchCode + MIN_MATCH; ++i)
+				output.push_back(output[matchStart + i]);
+		}
+
+		if (output.size() != size)
+			return std::nullopt;
+		return output;
+	}
+
+
+	std::uint32_t crc32(std::span<const std::uint8_t> data) {
+		std::uint32_t crc = 0xffffffffu;
+		for (const std::uint8_t byte : data)
+			crc = CRC_TABLE[(crc ^ byte) & 0xff] ^ (crc >> 8);
+		return crc ^ 0xffffffffu;
+	}
+
+} // namespace df::compression
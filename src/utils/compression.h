@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+
+
+
+
+namespace df::compression {
+
+	// Byte oriented LZ77 codec in the style of LZ4: sequences of literals followed by a back reference
+	// (16 bit offset, length >= 4) into the last 64 KiB of output. Greedy matching over a hash table of
+	// 4 byte prefixes -> one pass, no entropy coding. Fast enough to run on every save; the repetitive
+	// binary formats of the game (ids, small counts, tile rows) shrink well.
+	std::vector<std::uint8_t> compress(std::span<const std::uint8_t> input);
+
+	// Expects exactly `size` bytes of output, std::nullopt for malformed or truncated input
+	// and for a size the input can't possibly decode to (more than 255 bytes per input byte).
+	std::optional<std::vector<std::uint8_t>> decompress(std::span<const std::uint8_t> input, size_t size);
+
+	// CRC-32 (IEEE 802.3, the one of zip and png) to detect damaged files.
+	std::uint32_t crc32(std::span<const std::uint8_t> data);
+
+} // namespace df::compression
@@ -0,0 +1,236 @@
+#include "log.h"
+
+#include <chrono>
+#include <cstdio>
+#include <optional>
+#include <thread>
+#include <utility>
+
+#include <fmt/base.h>
+#include <core/events/mpscQueue.h>
+
+
+
+namespace df::log {
+
+	namespace {
+		constexpr std::array<std::string_view, static_cast<size_t>(Level::Off) + 1> LEVEL_NAMES = {
+			"trace", "debug", "info", "warning", "error", "off",
+		};
+
+		constexpr std::array<std::string_view, static_cast<size_t>(Module::COUNT)> MODULE_NAMES = {
+			"application", "graph", "world", "game", "events", "save", "render", "audio", "menu",
+		};
+
+
+		template<size_t... Indices>
+		constexpr std::array<std::atomic<Level>, sizeof...(Indices)> makeLevels(std::index_sequence<Indices...>) {
+			return { ((void)Indices, DEFAULT_LEVEL)... };
+		}
+
+
+		std::optional<Level> parseLevel(const std::string_view name) {
+			for (size_t i = 0; i < LEVEL_NAMES.size(); i++) {
+				if (LEVEL_NAMES[i] == name) return static_cast<Level>(i);
+			}
+			return std::nullopt;
+		}
+
+		std::optional<Module> parseModule(const std::string_view name) {
+			for (size_t i = 0; i < MODULE_NAMES.size(); i++) {
+				if (MODULE_NAMES[i] == name) return static_cast<Module>(i);
+			}
+			return std::nullopt;
+		}
+
+
+		// Owns the ring buffer and the thread that empties it. Started by the first message, stopped at exit
+		// after writing what is left.
+		class Writer {
+		public:
+			static constexpr size_t CAPACITY = 4096;
+
+			Writer() : start(std::chrono::steady_clock::now()), thread([this] { this->run(); }) {}
+
+			~Writer() {
+				this->stopping.store(true, std::memory_order_release);
+				this->sequence.fetch_add(1, std::memory_order_release);
+				this->sequence.notify_one();
+				this->thread.join();
+			}
+
+			Writer(const Writer&) = delete;
+			Writer& operator=(const Writer&) = delete;
+
+			// errors wait for room instead of being dropped
+			void push(detail::Record& record) {
+				record.seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - this->start).count();
+				while (!this->queue.tryPush(record)) {
+					if (record.level < Level::Error) {
+						this->dropped.fetch_add(1, std::memory_order_relaxed);
+						return;
+					}
+					this->flush();
+				}
+				this->pushed.fetch_add(1, std::memory_order_relaxed);
+				this->sequence.fetch_add(1, std::memory_order_release);
+				this->sequence.notify_one();
+			}
+
+			void flush() {
+				const std::uint64_t target = this->pushed.load(std::memory_order_relaxed);
+				std::uint64_t done = this->written.load(std::memory_order_acquire);
+				while (done < target) {
+					this->written.wait(done, std::memory_order_acquire);
+					done = this->written.load(std::memory_order_acquire);
+				}
+			}
+
+			size_t getDroppedCount() const { return this->dropped.load(std::memory_order_relaxed); }
+
+		private:
+			MpscQueue<detail::Record> queue{ CAPACITY };
+			const std::chrono::steady_clock::time_point start;
+			std::atomic<std::uint64_t> sequence{ 0 }; // bumped by every push and by the shutdown, the thread sleeps on it
+			std::atomic<std::uint64_t> pushed{ 0 };
+			std::atomic<std::uint64_t> written{ 0 };
+			std::atomic<size_t> dropped{ 0 };
+			std::atomic<bool> stopping{ false };
+			std::thread thread; // last, starts when everything else is initialized
+
+			void run() {
+				detail::Record record;
+				std::uint64_t count = 0;
+				size_t reportedDrops = 0;
+				while (true) {
+					// a push counted in `seen` is complete, so the loop below gets it; later pushes change `sequence`
+					const std::uint64_t seen = this->sequence.load(std::memory_order_acquire);
+					const bool isLastRound = this->stopping.load(std::memory_order_acquire);
+					while (this->queue.tryPop(record)) {
+						print(record);
+						count++;
+					}
+					std::fflush(stdout);
+					std::fflush(stderr);
+					this->written.store(count, std::memory_order_release);
+					this->written.notify_all();
+
+					if (const size_t drops = this->getDroppedCount(); drops != reportedDrops) {
+						fmt::println(stderr, "[log] {} messages dropped, the log buffer was full", drops - reportedDrops);
+						reportedDrops = drops;
+					}
+					if (isLastRound) {
+						return;
+					}
+					this->sequence.wait(seen, std::memory_order_acquire);
+				}
+			}
+
+			static void print(const detail::Record& record) {
+				std::FILE* file = (record.level >= Level::Warning) ? stderr : stdout;
+				fmt::println(file, "[{:9.3f}] {:<7} {:<11} {}", record.seconds, toString(record.level), toString(record.module),
+					std::string_view(record.text, record.length));
+			}
+		};
+
+
+		Writer& writer() {
+			static Writer instance;
+			return instance;
+		}
+	} // namespace
+
+
+	namespace detail {
+		// constant-initialized, usable before main() and from any thread
+		std::array<std::atomic<Level>, static_cast<size_t>(Module::COUNT)> moduleLevels =
+			makeLevels(std::make_index_sequence<static_cast<size_t>(Module::COUNT)>());
+
+
+		void submit(Record& record) noexcept {
+			try {
+				Writer& instance = writer();
+				instance.push(record);
+				if (record.level >= Level::Error) {
+					instance.flush(); // on the console before a crash that may follow
+				}
+			} catch (...) {
+				// the thread couldn't be started, nowhere to log to
+			}
+		}
+	}
+
+
+	void setLevel(const Module module, const Level level) noexcept {
+		detail::moduleLevels[static_cast<size_t>(module)].store(level, std::memory_order_relaxed);
+	}
+
+
+	void setLevel(const Level level) noexcept {
+		for (std::atomic<Level>& moduleLevel : detail::moduleLevels) {
+			moduleLevel.store(level, std::memory_order_relaxed);
+		}
+	}
+
+
+	Level getLevel(const Module module) noexcept {
+		return detail::moduleLevels[static_cast<size_t>(module)].load(std::memory_order_relaxed);
+	}
+
+
+	bool configure(const std::string_view levels) noexcept {
+		std::array<std::optional<Level>, static_cast<size_t>(Module::COUNT)> parsed{};
+
+		size_t begin = 0;
+		while (begin <= levels.size()) {
+			const size_t end = std::min(levels.find(',', begin), levels.size());
+			const std::string_view entry = levels.substr(begin, end - begin);
+			begin = end + 1;
+
+			const size_t separator = entry.find('=');
+			const std::string_view moduleName = (separator == std::string_view::npos) ? "all" : entry.substr(0, separator);
+			const std::optional<Level> level = parseLevel((separator == std::string_view::npos) ? entry : entry.substr(separator + 1));
+			if (!level) return false;
+
+			if (moduleName == "all") {
+				parsed.fill(level);
+			} else if (const std::optional<Module> module = parseModule(moduleName)) {
+				parsed[static_cast<size_t>(*module)] = level;
+			} else {
+				return false;
+			}
+		}
+
+		for (size_t i = 0; i < parsed.size(); i++) {
+			if (parsed[i]) setLevel(static_cast<Module>(i), *parsed[i]);
+		}
+		return true;
+	}
+
+
+	void flush() noexcept {
+		try {
+			writer().flush();
+		} catch (...) {}
+	}
+
+
+	size_t getDroppedCount() noexcept {
+		try {
+			return writer().getDroppedCount();
+		} catch (...) {
+			return 0;
+		}
+	}
+
+
+	std::string_view toString(const Level level) noexcept {
+		return LEVEL_NAMES[std::min(static_cast<size_t>(level), LEVEL_NAMES.size() - 1)];
+	}
+
+
+	std::string_view toString(const Module module) noexcept {
+		return MODULE_NAMES[std::min(static_cast<size_t>(module), MODULE_NAMES.size() - 1)];
+	}
+
+}
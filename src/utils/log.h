@@ -0,0 +1,155 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+
+#include <fmt/format.h>
+
+/*
+ * Leveled logging with a level per module. The calling thread formats the message into a fixed-size record and pushes
+ * it into a lock-free ring buffer, a background thread writes the records to stdout (warnings and errors to stderr).
+ * Logging doesn't allocate or wait for the console; if the ring buffer is full the message is dropped and counted
+ * (errors wait for room).
+ *
+ * Use the macros, not write(): DF_LOG_TRACE and DF_LOG_DEBUG are removed by the preprocessor unless DEBUG is defined
+ * (CMake Debug configuration), their arguments aren't even evaluated. DF_LOG_COMPILED_LEVEL overrides that.
+ * What is compiled in is filtered at runtime, per module: setLevel() / configure(), --log on the command line.
+ *
+ *     DF_LOG_DEBUG(GRAPH, "vertex {} already exists", vertexId);
+*/
+
+// lowest level that is compiled in, as the value of df::log::Level (0 = trace, 1 = debug, 2 = info, ...)
+#ifndef DF_LOG_COMPILED_LEVEL
+	#ifdef DEBUG
+		#define DF_LOG_COMPILED_LEVEL 0
+	#else
+		#define DF_LOG_COMPILED_LEVEL 2
+	#endif
+#endif
+
+
+namespace df::log {
+	// PascalCase, DEBUG is a macro in debug builds
+	enum class Level : std::uint8_t {
+		Trace = 0,
+		Debug,
+		Info,
+		Warning,
+		Error,
+		Off,
+	};
+
+	enum class Module : std::uint8_t {
+		APPLICATION,
+		GRAPH,	// the map graph and WorldNodeMapper
+		WORLD,	// world generation, WorldSystem (camera, keyboard and mouse input)
+		GAME,	// GameState, GameController
+		EVENTS,	// EventBus signals
+		SAVE,	// save files, autosave
+		RENDER,	// render systems, shaders, textures, meshes
+		AUDIO,
+		MENU,
+		COUNT,
+	};
+
+	inline constexpr Level COMPILED_LEVEL = static_cast<Level>(DF_LOG_COMPILED_LEVEL);
+	inline constexpr Level DEFAULT_LEVEL = Level::Info;
+
+
+	namespace detail {
+		// longer messages are cut off
+		inline constexpr size_t MAX_MESSAGE_LENGTH = 240;
+
+		struct Record {
+			Level level = Level::Info;
+			Module module = Module::APPLICATION;
+			std::uint16_t length = 0;
+			float seconds = 0.0f; // since the first message
+			char text[MAX_MESSAGE_LENGTH];
+		};
+
+		extern std::array<std::atomic<Level>, static_cast<size_t>(Module::COUNT)> moduleLevels;
+
+		void submit(Record& record) noexcept;
+	}
+
+
+	inline bool isEnabled(const Module module, const Level level) noexcept {
+		return level >= detail::moduleLevels[static_cast<size_t>(module)].load(std::memory_order_relaxed);
+	}
+
+	void setLevel(Module module, Level level) noexcept;
+	// all modules
+	void setLevel(Level level) noexcept;
+	Level getLevel(Module module) noexcept;
+
+	// "<level>" for all modules or "<module>=<level>,..." (e.g. "graph=debug,events=trace"), module "all" = every module.
+	// Applies nothing and returns false if the text doesn't parse.
+	bool configure(std::string_view levels) noexcept;
+
+	// Blocks until everything logged so far is written.
+	void flush() noexcept;
+	// messages lost because the ring buffer was full
+	size_t getDroppedCount() noexcept;
+
+	std::string_view toString(Level level) noexcept;
+	std::string_view toString(Module module) noexcept;
+
+
+	// Call through the DF_LOG_* macros. Error messages are flushed before this returns.
+	template<typename... Arguments>
+	void write(const Level level, const Module module, fmt::format_string<Arguments...> format, Arguments&&... arguments) noexcept {
+		detail::Record record;
+		record.level = level;
+		record.module = module;
+		try {
+			const auto result = fmt::format_to_n(record.text, detail::MAX_MESSAGE_LENGTH, format, std::forward<Arguments>(arguments)...);
+			record.length = static_cast<std::uint16_t>(std::min(result.size, detail::MAX_MESSAGE_LENGTH));
+		} catch (...) {
+			return; // a throwing formatter of an argument, the message is lost
+		}
+		detail::submit(record);
+	}
+}
+
+
+#define DF_LOG(level, module, ...) \
+	do { \
+		if (::df::log::isEnabled(::df::log::Module::module, level)) { \
+			::df::log::write(level, ::df::log::Module::module, __VA_ARGS__); \
+		} \
+	} while (false)
+
+#if DF_LOG_COMPILED_LEVEL <= 0
+	#define DF_LOG_TRACE(module, ...) DF_LOG(::df::log::Level::Trace, module, __VA_ARGS__)
+#else
+	#define DF_LOG_TRACE(module, ...) ((void)0)
+#endif
+
+#if DF_LOG_COMPILED_LEVEL <= 1
+	#define DF_LOG_DEBUG(module, ...) DF_LOG(::df::log::Level::Debug, module, __VA_ARGS__)
+#else
+	#define DF_LOG_DEBUG(module, ...) ((void)0)
+#endif
+
+#if DF_LOG_COMPILED_LEVEL <= 2
+	#define DF_LOG_INFO(module, ...) DF_LOG(::df::log::Level::Info, module, __VA_ARGS__)
+#else
+	#define DF_LOG_INFO(module, ...) ((void)0)
+#endif
+
+#if DF_LOG_COMPILED_LEVEL <= 3
+	#define DF_LOG_WARNING(module, ...) DF_LOG(::df::log::Level::Warning, module, __VA_ARGS__)
+#else
+	#define DF_LOG_WARNING(module, ...) ((void)0)
+#endif
+
+#if DF_LOG_COMPILED_LEVEL <= 4
+	#define DF_LOG_ERROR(module, ...) DF_LOG(::df::log::Level::Error, module, __VA_ARGS__)
+#else
+	#define DF_LOG_ERROR(module, ...) ((void)0)
+#endif
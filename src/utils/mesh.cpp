@@ -1,6 +1,7 @@
 #include "mesh.h"
 #include <filesystem>
 #include <tiny_obj_loader.h>
+#include "log.h"
 
 
 
@@ -16,12 +17,12 @@ namespace df {
 		tinyobj::ObjReader reader;
 
 		if (!reader.ParseFromFile(assetPath, readerConfig)) {
-			fmt::println(stderr, "Failed to read mesh: {}", reader.Error());
+			DF_LOG_ERROR(RENDER, "Failed to read mesh: {}", reader.Error());
 			return ::std::nullopt;
 		}
 
 		if (!reader.Warning().empty()) {
-			fmt::println(stderr, "Warning while reading mesh: {}", reader.Warning());
+			DF_LOG_WARNING(RENDER, "Warning while reading mesh: {}", reader.Warning());
 		}
 
 		const auto& attrib = reader.GetAttrib();
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+
+
+namespace df {
+
+	// Owns values that are referenced by raw pointers (the graph's node handles).
+	//   - values live in blocks that never reallocate, so a pointer stays valid until clear() (or the pool is destroyed)
+	//   - reserve() before a bulk insert puts all of those values into one block -> one allocation instead of one per value
+	//   - there is no erase, a value that is no longer referenced stays in its block until clear()
+	// Moving the pool moves the blocks, the pointers into them stay valid.
+	template <typename T>
+	class NodePool {
+	  public:
+		// makes sure the next `count` values fit into the current block
+		void reserve(size_t count) {
+			if (this->blocks.empty() || this->blocks.back().capacity() - this->blocks.back().size() < count) {
+				this->addBlock(count);
+			}
+		}
+
+		template <typename... Arguments>
+		T* emplace(Arguments&&... arguments) {
+			if (this->blocks.empty() || this->blocks.back().size() == this->blocks.back().capacity()) {
+				// grows like a vector, without moving the values that are already stored
+				this->addBlock(this->blocks.empty() ? MIN_BLOCK_SIZE : std::max(MIN_BLOCK_SIZE, this->blocks.back().capacity() * 2));
+			}
+			return &this->blocks.back().emplace_back(std::forward<Arguments>(arguments)...);
+		}
+
+		// takes over the values of `values` as a block of their own, returns a pointer to the first one
+		T* adopt(std::vector<T>&& values) {
+			return this->blocks.emplace_back(std::move(values)).data();
+		}
+
+		void clear() { this->blocks.clear(); }
+
+	  private:
+		static constexpr size_t MIN_BLOCK_SIZE = 64;
+
+		std::vector<std::vector<T>> blocks;
+
+		void addBlock(size_t capacity) {
+			this->blocks.emplace_back().reserve(capacity);
+		}
+	};
+} // namespace df
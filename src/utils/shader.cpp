@@ -2,6 +2,7 @@
 
 #include <fstream>
 #include <sstream>
+#include "log.h"
 
 
 
@@ -15,7 +16,7 @@ namespace df {
 			GLsizei length;
 			glGetShaderInfoLog(shader, sizeof(infoLog), &length, infoLog);
 			infoLog[--length] = '\0'; // Remove trailing newline
-			fmt::println("[ GL COMPILE ERROR ]\t{}", infoLog);
+			DF_LOG_ERROR(RENDER, "[ GL COMPILE ERROR ]\t{}", infoLog);
 			exit(1);
 		}
 	}
@@ -29,12 +30,12 @@ namespace df {
 		std::ifstream fragmentShaderFile{ basePath + ".frag.glsl" };
 
 		if (vertexShaderFile.bad()) {
-			fmt::println("Failed to read shader file: {}", basePath + ".vert.glsl");
+			DF_LOG_ERROR(RENDER, "Failed to read shader file: {}", basePath + ".vert.glsl");
 			return std::nullopt;
 		}
 
 		if (fragmentShaderFile.bad()) {
-			fmt::println("Failed to read shader file: {}", basePath + ".frag.glsl");
+			DF_LOG_ERROR(RENDER, "Failed to read shader file: {}", basePath + ".frag.glsl");
 			return std::nullopt;
 		}
 
@@ -72,7 +73,7 @@ namespace df {
 			GLsizei length;
 			glGetProgramInfoLog(self.handle, sizeof(infoLog), &length, infoLog);
 			infoLog[--length] = '\0'; // Remove trailing newline
-			fmt::println("[ GL COMPILE ERROR ]\t{}", infoLog);
+			DF_LOG_ERROR(RENDER, "[ GL COMPILE ERROR ]\t{}", infoLog);
 			exit(1);
 		}
 
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+
+
+
+
+namespace df {
+
+	// Values keyed by a caller-chosen id (settlement id, road id, ...), stored contiguously.
+	//   - find() is one index into a sparse id -> slot table, no hashing and no allocation
+	//   - getValues() is a span over the dense values, e.g. for iterating all settlements
+	//   - erase() moves the last value into the freed slot, so the order of getValues() is not stable
+	// Ids are expected to be small and mostly consecutive (the sparse table is as long as the largest id).
+	template <typename T>
+	class SlotMap {
+	  public:
+		// replaces the value if the id is already used. Throws std::out_of_range for SIZE_MAX (reserved, id + 1 overflows)
+		T& insert(size_t id, T value) {
+			if (id == FREE) {
+				throw std::out_of_range("SlotMap id out of range");
+			}
+			if (id >= this->slots.size()) {
+				this->slots.resize(id + 1, FREE);
+			}
+			if (this->slots[id] != FREE) {
+				return this->values[this->slots[id]] = std::move(value);
+			}
+
+			this->slots[id] = this->values.size();
+			this->ids.push_back(id);
+			return this->values.emplace_back(std::move(value));
+		}
+
+		bool erase(size_t id) {
+			if (!this->contains(id))
+				return false;
+
+			const size_t slot = this->slots[id];
+			const size_t last = this->values.size() - 1;
+			if (slot != last) {
+				this->values[slot] = std::move(this->values[last]);
+				this->ids[slot] = this->ids[last];
+				this->slots[this->ids[slot]] = slot;
+			}
+			this->values.pop_back();
+			this->ids.pop_back();
+			this->slots[id] = FREE;
+			// trailing free ids are handed out again -> inserting and erasing the newest value (undo) leaves no trace
+			while (!this->slots.empty() && this->slots.back() == FREE) {
+				this->slots.pop_back();
+			}
+			return true;
+		}
+
+		void clear() {
+			this->values.clear();
+			this->ids.clear();
+			this->slots.clear();
+		}
+
+		bool contains(size_t id) const { return id < this->slots.size() && this->slots[id] != FREE; }
+
+		T* find(size_t id) { return this->contains(id) ? &this->values[this->slots[id]] : nullptr; }
+		const T* find(size_t id) const { return this->contains(id) ? &this->values[this->slots[id]] : nullptr; }
+
+		std::span<T> getValues() { return this->values; }
+		std::span<const T> getValues() const { return this->values; }
+		// parallel to getValues()
+		std::span<const size_t> getIds() const { return this->ids; }
+
+		size_t getSize() const { return this->values.size(); }
+		bool isEmpty() const { return this->values.empty(); }
+		// one past the largest id in use; ids of erased values are only handed out again if no larger id is in use
+		size_t getNextId() const { return this->slots.size(); }
+
+	  private:
+		static constexpr size_t FREE = SIZE_MAX;
+
+		std::vector<T> values;
+		std::vector<size_t> ids;
+		std::vector<size_t> slots; // id -> index into values, FREE if unused
+	};
+
+} // namespace df
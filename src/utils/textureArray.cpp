@@ -4,8 +4,7 @@
 
 #include "textureArray.h"
 
-#include <iostream>
-#include <ostream>
+#include "log.h"
 
 namespace df {
     TextureArray TextureArray::init(const GLsizei width, const GLsizei height) noexcept {
@@ -43,14 +42,14 @@ namespace df {
         stbi_set_flip_vertically_on_load(true);
         stbi_uc* pixels = stbi_load(path, &width, &height, &channels, 4);
         if (pixels == nullptr) {
-            std::cerr << "Error loading pixels from " << path << std::endl;
+            DF_LOG_ERROR(RENDER, "Error loading pixels from {}", path);
             return {};
         }
         if (width % widthOfSprite != 0) {
-            std::cerr << "TextureArray::init: width is not divisible by widthOfSprite" << std::endl;
+            DF_LOG_WARNING(RENDER, "TextureArray::init: width is not divisible by widthOfSprite");
         }
         if (height % heightOfSprite != 0) {
-            std::cerr << "TextureArray::init: height is not divisible by heightOfSprite" << std::endl;
+            DF_LOG_WARNING(RENDER, "TextureArray::init: height is not divisible by heightOfSprite");
         }
 
         TextureArray self;
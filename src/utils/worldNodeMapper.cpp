@@ -1,14 +1,15 @@
 #include "worldNodeMapper.h"
 #include "edge.h"
-#include "fmt/base.h"
+#include "log.h"
 #include "nlohmann/detail/string_concat.hpp"
 #include "tile.h"
 #include "vertex.h"
 
-#include <cstdint>
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <cstdint>
 #include <limits>
-#include <unordered_set>
 
 
 
@@ -36,18 +37,34 @@ namespace df {
 	}
 
 
+	// Calls fn(tileId, row, col) for the tile closest to worldPos (clamped to the map) and its 8 surrounding grid cells.
+	// The nearest tile/vertex/edge is always part of one of them, so lookups stay O(1) on big maps.
+	template <typename Fn>
+	void forEachTileAround(const glm::vec2& worldPos, const Graph& map, Fn&& fn) {
+		const long long columns = map.getMapWidth();
+		if (columns == 0) return;
+		const long long rows = static_cast<long long>(map.getTileCount()) / columns;
+		if (rows == 0) return;
+
+		// inverse of getTilePosition()
+		const long long estimatedRow = std::clamp(static_cast<long long>(std::lround(worldPos.y / 1.5f)), 0LL, rows - 1);
+		const long long estimatedCol = std::clamp(static_cast<long long>(std::lround(worldPos.x / 2.0f - 0.5f * (estimatedRow & 1))), 0LL, columns - 1);
+
+		for (long long row = std::max(0LL, estimatedRow - 1); row <= std::min(rows - 1, estimatedRow + 1); ++row) {
+			for (long long col = std::max(0LL, estimatedCol - 1); col <= std::min(columns - 1, estimatedCol + 1); ++col) {
+				fn(static_cast<size_t>(row * columns + col), static_cast<uint32_t>(row), static_cast<uint32_t>(col));
+			}
+		}
+	}
+
+
 	std::optional<size_t> WorldNodeMapper::findClosestTileToWorldPos(const glm::vec2 &worldPos, const Graph& map) noexcept {
 		if (map.getTileCount() == 0) return std::nullopt;
 
 		float minDistance = (std::numeric_limits<float>::max)();
 		size_t closestTileId = SIZE_MAX;
-		uint32_t columns = map.getMapWidth();
-
-		for (size_t tileId = 0; tileId < map.getTileCount(); ++tileId) {
-			// calculate tile position based on tileId
-			uint32_t currentRow = tileId / columns;
-			uint32_t currentCol = tileId % columns;
 
+		forEachTileAround(worldPos, map, [&](size_t tileId, uint32_t currentRow, uint32_t currentCol) {
 			glm::vec2 tileCenterPos(WorldNodeMapper::getTilePosition(currentRow, currentCol));
 
 			float distance = glm::distance(worldPos, tileCenterPos);
@@ -55,7 +72,7 @@ namespace df {
 				minDistance = distance;
 				closestTileId = tileId;
 			}
-		}
+		});
 
 		if (closestTileId != SIZE_MAX) return closestTileId;
 		return std::nullopt;
@@ -63,101 +80,72 @@ namespace df {
 
 
 	std::optional<size_t> WorldNodeMapper::findClosestVertexToWorldPos(const glm::vec2 &worldPos, const Graph &map) noexcept {
-		fmt::println("[WorldNodeMapper] findClosestVertexToWorldPos: searching for vertex near world position ({}, {})", worldPos.x, worldPos.y);
+		DF_LOG_TRACE(GRAPH, "findClosestVertexToWorldPos: searching for vertex near world position ({}, {})", worldPos.x, worldPos.y);
 
 		if (map.getVertexCount() == 0) {
-			fmt::println("[WorldNodeMapper] No vertices in map, returning nullopt");
+			DF_LOG_TRACE(GRAPH, "No vertices in map, returning nullopt");
 			return std::nullopt;
 		}
 
 		const float hexagonRadius = 1.0f;
-		const uint32_t columns = map.getMapWidth();
+		const std::array<glm::vec2, 6> vertexOffsets = WorldNodeMapper::getVertexOffsets(hexagonRadius);
 		float minDistance = (std::numeric_limits<float>::max)();
 		size_t closestVertexId = SIZE_MAX;
-		std::unordered_set<size_t> processedVertexIds;
-
-		fmt::println("[WorldNodeMapper] Map has {} tiles, {} columns", map.getTileCount(), columns);
 
-		for (size_t tileId = 0; tileId < map.getTileCount(); ++tileId) {
+		forEachTileAround(worldPos, map, [&](size_t tileId, uint32_t currentRow, uint32_t currentCol) {
 			const TileHandle tile = map.getTile(tileId);
 
-			uint32_t currentRow = tileId / columns;
-			uint32_t currentCol = tileId % columns;
-
 			glm::vec2 tileCenterPos(WorldNodeMapper::getTilePosition(currentRow, currentCol));
 			const auto verticesOpt = map.getTileVertices(tile);
-			if (!verticesOpt) continue;
-			std::array<glm::vec2, 6> vertexOffsets = WorldNodeMapper::getVertexOffsets(hexagonRadius);
+			if (!verticesOpt) return;
 
 			for (size_t i = 0; i < (*verticesOpt).size(); ++i) {
 				const VertexHandle vertex = (*verticesOpt)[i];
-				size_t vertexId = vertex->getId();
-
-				if (vertexId == SIZE_MAX) continue;
-
-				// Skip if already processed the vertex (-> shared between tiles)
-				if (processedVertexIds.find(vertexId) != processedVertexIds.end()) continue;
-				processedVertexIds.insert(vertexId);
+				if (!vertex || vertex->getId() == SIZE_MAX) continue;
 
 				glm::vec2 vertexPosition = tileCenterPos + vertexOffsets[i];
 				float distance = glm::distance(worldPos, vertexPosition);
 
 				if (distance < minDistance) {
-					fmt::println("[WorldNodeMapper] New closest vertex found: vertexId={}, distance={:.3f}, position=({:.3f}, {:.3f})",
-						vertexId, distance, vertexPosition.x, vertexPosition.y);
 					minDistance = distance;
-					closestVertexId = vertexId;
+					closestVertexId = vertex->getId();
 				}
 			}
-		}
+		});
 
 		if (closestVertexId != SIZE_MAX) {
-			fmt::println("[WorldNodeMapper] Closest vertex: vertexId={}, distance={:.3f}", closestVertexId, minDistance);
+			DF_LOG_TRACE(GRAPH, "Closest vertex: vertexId={}, distance={:.3f}", closestVertexId, minDistance);
 			return closestVertexId;
 		}
 
-		fmt::println("[WorldNodeMapper] No valid vertex found, returning nullopt");
+		DF_LOG_TRACE(GRAPH, "No valid vertex found, returning nullopt");
 		return std::nullopt;
 	};
 
 
 	std::optional<size_t> WorldNodeMapper::findClosestEdgeToWorldPos(const glm::vec2 &worldPos, const Graph &map) noexcept {
-		fmt::println("[WorldNodeMapper] findClosestEdgeToWorldPos: searching for edge near world position ({}, {})", worldPos.x, worldPos.y);
+		DF_LOG_TRACE(GRAPH, "findClosestEdgeToWorldPos: searching for edge near world position ({}, {})", worldPos.x, worldPos.y);
 
 		if (map.getEdgeCount() == 0) {
-			fmt::println("[WorldNodeMapper] No edges in map, returning nullopt");
+			DF_LOG_TRACE(GRAPH, "No edges in map, returning nullopt");
 			return std::nullopt;
 		}
 
 		const float hexagonRadius = 1.0f;
-		const uint32_t columns = map.getMapWidth();
+		const std::array<glm::vec2, 6> vertexOffsets = WorldNodeMapper::getVertexOffsets(hexagonRadius);
 		float minDistance = (std::numeric_limits<float>::max)();
 		size_t closestEdgeId = SIZE_MAX;
-		std::unordered_set<size_t> processedEdgeIds;
-
-		fmt::println("[WorldNodeMapper] Map has {} tiles, {} columns", map.getTileCount(), columns);
 
-		for (size_t tileId = 0; tileId < map.getTileCount(); ++tileId) {
+		forEachTileAround(worldPos, map, [&](size_t tileId, uint32_t currentRow, uint32_t currentCol) {
 			const TileHandle tile = map.getTile(tileId);
 
-			uint32_t currentRow = tileId / columns;
-			uint32_t currentCol = tileId % columns;
-
 			glm::vec2 tileCenterPos(WorldNodeMapper::getTilePosition(currentRow, currentCol));
 			const auto edgesOpt = map.getTileEdges(tile);
-			if (!edgesOpt) continue;
-
-			std::array<glm::vec2, 6> vertexOffsets = WorldNodeMapper::getVertexOffsets(hexagonRadius);
+			if (!edgesOpt) return;
 
 			for (size_t i = 0; i < edgesOpt->size(); ++i) {
 				const EdgeHandle edge = (*edgesOpt)[i];
-				size_t edgeId = edge->getId();
-
-				if (edgeId == SIZE_MAX) continue;
-
-				// Skip if already processed edge (-> shared between tiles)
-				if (processedEdgeIds.find(edgeId) != processedEdgeIds.end()) continue;
-				processedEdgeIds.insert(edgeId);
+				if (!edge || edge->getId() == SIZE_MAX) continue;
 
 				// edge-position as center between two neighboring vertices
 				glm::vec2 vertex1Position = tileCenterPos + vertexOffsets[i];
@@ -166,46 +154,49 @@ namespace df {
 
 				float distance = glm::distance(worldPos, edgePosition);
 				if (distance < minDistance) {
-					fmt::println("[WorldNodeMapper] New closest edge found: edgeId={}, distance={:.3f}, position=({:.3f}, {:.3f})",
-						edgeId, distance, edgePosition.x, edgePosition.y);
 					minDistance = distance;
-					closestEdgeId = edgeId;
+					closestEdgeId = edge->getId();
 				}
 			}
-		}
+		});
 
 		if (closestEdgeId != SIZE_MAX) {
-			fmt::println("[WorldNodeMapper] Closest edge: edgeId={}, distance={:.3f}", closestEdgeId, minDistance);
+			DF_LOG_TRACE(GRAPH, "Closest edge: edgeId={}, distance={:.3f}", closestEdgeId, minDistance);
 			return closestEdgeId;
 		}
 
-		fmt::println("[WorldNodeMapper] No valid edge found, returning nullopt");
+		DF_LOG_TRACE(GRAPH, "No valid edge found, returning nullopt");
 		return std::nullopt;
 	};
 
 
+	// Positions are taken relative to the tile with the smallest id that contains the vertex/edge,
+	// the same tile a scan over all tiles would find first.
 	glm::vec2 WorldNodeMapper::getWorldPositionForVertex(size_t vertexId, const Graph& map) noexcept {
 		const float hexagonRadius = 1.0f;
 		const uint32_t columns = map.getMapWidth();
 
-		// find tiles that have this vertex
-		for (size_t tileId = 0; tileId < map.getTileCount(); ++tileId) {
-			const TileHandle tile = map.getTile(tileId);
+		const VertexHandle vertex = map.findVertexById(vertexId);
+		const auto tilesOpt = map.getVertexTiles(vertex);
+		if (!tilesOpt || columns == 0) return glm::vec2(0.0f);
 
-			const auto verticesOpt = map.getTileVertices(tile);
-			if (!verticesOpt) continue;
-			auto vertices = *verticesOpt;
+		TileHandle tile = nullptr;
+		for (const TileHandle candidate : *tilesOpt) {
+			if (candidate && (!tile || candidate->getId() < tile->getId())) tile = candidate;
+		}
+		if (!tile) return glm::vec2(0.0f);
 
-			for (size_t i = 0; i < vertices.size(); ++i) {
-				if (vertices[i]->getId() == vertexId) {
-					uint32_t row = tileId / columns;
-					uint32_t col = tileId % columns;
+		const auto vertices = *map.getTileVertices(tile);
+		for (size_t i = 0; i < vertices.size(); ++i) {
+			if (vertices[i] == vertex) {
+				const size_t tileId = tile->getId();
+				uint32_t row = tileId / columns;
+				uint32_t col = tileId % columns;
 
-					glm::vec2 tileCenterPos = WorldNodeMapper::getTilePosition(row, col);
-					std::array<glm::vec2, 6> vertexOffsets = WorldNodeMapper::getVertexOffsets(hexagonRadius);
+				glm::vec2 tileCenterPos = WorldNodeMapper::getTilePosition(row, col);
+				std::array<glm::vec2, 6> vertexOffsets = WorldNodeMapper::getVertexOffsets(hexagonRadius);
 
-					return tileCenterPos + vertexOffsets[i];
-				}
+				return tileCenterPos + vertexOffsets[i];
 			}
 		}
 		return glm::vec2(0.0f);
@@ -216,29 +207,40 @@ namespace df {
 		const float hexagonRadius = 1.0f;
 		const uint32_t columns = map.getMapWidth();
 
-		// Find tiles that have this edge
-		for (size_t tileId = 0; tileId < map.getTileCount(); ++tileId) {
-			const TileHandle tile = map.getTile(tileId);
-			const auto edgesOpt = map.getTileEdges(tile);
-			if (!edgesOpt) continue;
-			auto edges = *edgesOpt;
-
-			for (size_t i = 0; i < edges.size(); ++i) {
-				if (edges[i]->getId() == edgeId) {
-					uint32_t row = tileId / columns;
-					uint32_t col = tileId % columns;
+		const EdgeHandle edge = map.findEdgeById(edgeId);
+		const auto edgeVerticesOpt = map.getEdgeVertices(edge);
+		if (!edgeVerticesOpt || columns == 0) return glm::vec2(0.0f);
 
-					glm::vec2 tileCenterPos = WorldNodeMapper::getTilePosition(row, col);
-					std::array<glm::vec2, 6> vertexOffsets = WorldNodeMapper::getVertexOffsets(hexagonRadius);
+		// every tile that has this edge also has both of its vertices
+		const auto tilesOpt = map.getVertexTiles((*edgeVerticesOpt)[0]);
+		if (!tilesOpt) return glm::vec2(0.0f);
 
-					// Edge position is middle between two vertices
-					glm::vec2 vertex1Position = tileCenterPos + vertexOffsets[i];
-					glm::vec2 vertex2Position = tileCenterPos + vertexOffsets[(i + 1) % 6];
+		TileHandle tile = nullptr;
+		size_t edgeIndex = 0;
+		for (const TileHandle candidate : *tilesOpt) {
+			if (!candidate || (tile && candidate->getId() > tile->getId())) continue;
 
-					return (vertex1Position + vertex2Position) / 2.0f;
+			const auto edges = *map.getTileEdges(candidate);
+			for (size_t i = 0; i < edges.size(); ++i) {
+				if (edges[i] == edge) {
+					tile = candidate;
+					edgeIndex = i;
 				}
 			}
 		}
-		return glm::vec2(0.0f);
+		if (!tile) return glm::vec2(0.0f);
+
+		const size_t tileId = tile->getId();
+		uint32_t row = tileId / columns;
+		uint32_t col = tileId % columns;
+
+		glm::vec2 tileCenterPos = WorldNodeMapper::getTilePosition(row, col);
+		std::array<glm::vec2, 6> vertexOffsets = WorldNodeMapper::getVertexOffsets(hexagonRadius);
+
+		// Edge position is middle between two vertices
+		glm::vec2 vertex1Position = tileCenterPos + vertexOffsets[edgeIndex];
+		glm::vec2 vertex2Position = tileCenterPos + vertexOffsets[(edgeIndex + 1) % 6];
+
+		return (vertex1Position + vertex2Position) / 2.0f;
 	}
 }
@@ -1,5 +1,6 @@
 #include "window.h"
 #include "GLFW/glfw3.h"
+#include "log.h"
 #include <memory>
 
 
@@ -9,7 +10,7 @@ namespace df {
 		auto self = std::make_unique<Window>();
 
 		if (!self) {
-			fmt::println(stderr, "Failed to allocate window");
+			DF_LOG_ERROR(APPLICATION, "Failed to allocate window");
 
 			return nullptr;
 		}
@@ -35,7 +36,7 @@ namespace df {
 		// if (!(window = glfwCreateWindow(static_cast<int>(width), static_cast<int>(height), title,
 		// nullptr, nullptr))) {
 		if (!window) {
-			fmt::println(stderr, "Failed to create GLFW window");
+			DF_LOG_ERROR(APPLICATION, "Failed to create GLFW window");
 			return nullptr;
 		}
 		self->handle = window;